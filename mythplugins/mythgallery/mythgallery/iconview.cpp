@@ -745,7 +745,10 @@ void IconView::customEvent(QEvent *event)
         if (!td)
             return;
 
-        ThumbItem *thumbitem = m_itemHash.value(td->fileName);
+        // Thumbnails still being made when the directory was left
+        ThumbItem *thumbitem = NULL;
+        if (td->directory == m_currDir)
+            thumbitem = m_itemHash.value(td->fileName);
         if (thumbitem)
         {
             int rotateAngle = thumbitem->GetRotationAngle();
@@ -26,6 +26,7 @@
 #include <QDir>
 #include <QEvent>
 #include <QImageReader>
+#include <QRunnable>
 
 // myth
 #include <mythuihelper.h>
@@ -50,9 +51,31 @@
 QEvent::Type ThumbGenEvent::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
+/// Makes the thumbnail of one file on the ThumbGenerator's pool
+class ThumbGenTask : public QRunnable
+{
+  public:
+    ThumbGenTask(ThumbGenerator &gen, const QString &dir,
+                 const QString &file, bool isGallery) :
+        m_gen(gen), m_dir(dir), m_file(file), m_isGallery(isGallery) {}
+
+    void run(void)
+    {
+        m_gen.makeThumb(m_dir, m_file, m_isGallery);
+        m_gen.taskDone();
+    }
+
+  private:
+    ThumbGenerator &m_gen;
+    QString         m_dir;
+    QString         m_file;
+    bool            m_isGallery;
+};
+
 ThumbGenerator::ThumbGenerator(QObject *parent, int w, int h) :
     MThread("ThumbGenerator"), m_parent(parent),
-    m_isGallery(false), m_width(w), m_height(h)
+    m_isGallery(false), m_width(w), m_height(h),
+    m_pool("ThumbGenerator"), m_tasks(0)
 {
 }
 
@@ -96,92 +119,113 @@ void ThumbGenerator::run()
 {
     RunProlog();
 
+    // A few tasks queued per thread keep the pool busy, the rest stay
+    // in m_fileList where cancel() can drop them.
+    int maxTasks = m_pool.maxThreadCount() * 2;
+
     while (moreWork())
     {
-
         QString file, dir;
         bool    isGallery;
 
         m_mutex.lock();
+        while (m_tasks >= maxTasks)
+            m_taskWait.wait(&m_mutex);
+
         dir       = m_directory;
         isGallery = m_isGallery;
-        file = m_fileList.first();
         if (!m_fileList.isEmpty())
-            m_fileList.pop_front();
+            file = m_fileList.takeFirst();
+        if (!file.isEmpty())
+            m_tasks++;
         m_mutex.unlock();
+
         if (file.isEmpty())
             continue;
 
-        QString   filePath = dir + QString("/") + file;
-        QFileInfo fileInfo(filePath);
-        if (!fileInfo.exists())
-            continue;
+        m_pool.start(new ThumbGenTask(*this, dir, file, isGallery),
+                     "ThumbGenTask");
+    }
 
-        if (isGallery)
-        {
+    m_pool.waitForDone();
 
-            if (fileInfo.isDir())
-                isGallery = checkGalleryDir(fileInfo);
-            else
-                isGallery = checkGalleryFile(fileInfo);
-        }
+    RunEpilog();
+}
 
-        if (!isGallery)
-        {
+void ThumbGenerator::taskDone()
+{
+    m_mutex.lock();
+    m_tasks--;
+    m_taskWait.wakeAll();
+    m_mutex.unlock();
+}
 
-            QString cachePath = QString("%1%2.jpg").arg(getThumbcacheDir(dir))
-                                                   .arg(file);
-            QFileInfo cacheInfo(cachePath);
+void ThumbGenerator::makeThumb(const QString& dir, const QString& file,
+                               bool isGallery)
+{
+    QString   filePath = dir + QString("/") + file;
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists())
+        return;
 
-            if (cacheInfo.exists() &&
-                cacheInfo.lastModified() >= fileInfo.lastModified())
-            {
-                continue;
-            }
-            else
-            {
-                // cached thumbnail not there or out of date
-                QImage image;
+    if (isGallery)
+    {
+
+        if (fileInfo.isDir())
+            isGallery = checkGalleryDir(fileInfo);
+        else
+            isGallery = checkGalleryFile(fileInfo);
+    }
 
-                // Remove the old one if it exists
-                if (cacheInfo.exists())
-                    QFile::remove(cachePath);
+    if (isGallery)
+        return;
 
-                if (fileInfo.isDir())
-                    loadDir(image, fileInfo);
-                else
-                    loadFile(image, fileInfo);
+    QString cachePath = QString("%1%2.jpg").arg(getThumbcacheDir(dir))
+                                           .arg(file);
+    QFileInfo cacheInfo(cachePath);
 
-                if (image.isNull())
-                    continue; // give up;
+    if (cacheInfo.exists() &&
+        cacheInfo.lastModified() >= fileInfo.lastModified())
+    {
+        return;
+    }
 
-                // if the file is a movie save the image to use as a screenshot
-                if (GalleryUtil::IsMovie(fileInfo.filePath()))
-                {
-                    QString screenshotPath = QString("%1%2-screenshot.jpg")
-                            .arg(getThumbcacheDir(dir))
-                            .arg(file);
-                    image.save(screenshotPath, "JPEG", 95);
-                }
+    // cached thumbnail not there or out of date
+    QImage image;
 
-                image = image.scaled(m_width,m_height,
-                                Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                image.save(cachePath, "JPEG", 95);
+    // Remove the old one if it exists
+    if (cacheInfo.exists())
+        QFile::remove(cachePath);
 
-                // deep copies all over
-                ThumbData *td = new ThumbData;
-                td->directory = dir;
-                td->fileName  = file;
-                td->thumb     = image.copy();
+    if (fileInfo.isDir())
+        loadDir(image, fileInfo);
+    else
+        loadFile(image, fileInfo);
 
-                // inform parent we have thumbnail ready for it
-                QApplication::postEvent(m_parent, new ThumbGenEvent(td));
+    if (image.isNull())
+        return; // give up;
 
-            }
-        }
+    // if the file is a movie save the image to use as a screenshot
+    if (GalleryUtil::IsMovie(fileInfo.filePath()))
+    {
+        QString screenshotPath = QString("%1%2-screenshot.jpg")
+                .arg(getThumbcacheDir(dir))
+                .arg(file);
+        image.save(screenshotPath, "JPEG", 95);
     }
 
-    RunEpilog();
+    image = image.scaled(m_width,m_height,
+                    Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    image.save(cachePath, "JPEG", 95);
+
+    // deep copies all over
+    ThumbData *td = new ThumbData;
+    td->directory = dir;
+    td->fileName  = file;
+    td->thumb     = image.copy();
+
+    // inform parent we have thumbnail ready for it
+    QApplication::postEvent(m_parent, new ThumbGenEvent(td));
 }
 
 bool ThumbGenerator::moreWork()
@@ -289,6 +333,8 @@ void ThumbGenerator::loadFile(QImage& image, const QFileInfo& fi)
 {
     if (GalleryUtil::IsMovie(fi.filePath()))
     {
+        QMutexLocker locker(&m_movieLock);
+
         bool thumbnailCreated = false;
         QDir tmpDir("/tmp/mythgallery");
         if (!tmpDir.exists())
@@ -343,11 +389,25 @@ void ThumbGenerator::loadFile(QImage& image, const QFileInfo& fi)
         if (ed)
             exif_data_free(ed);
 
-        if (image.width() > m_width && image.height() > m_height)
+        // Good enough if it doesn't have to be scaled up to fit
+        if (image.width() >= m_width || image.height() >= m_height)
             return;
+        image = QImage();
 #endif
 
-        image.load(fi.absoluteFilePath());
+        QImageReader reader(fi.absoluteFilePath());
+        QSize size = reader.size();
+
+        // Only decode as much as the thumbnail needs, JPEGs are then
+        // decoded by libjpeg at 1/2, 1/4 or 1/8 of their size.
+        if (size.isValid() && m_width > 0 && m_height > 0 &&
+            (size.width() > m_width || size.height() > m_height))
+        {
+            size.scale(m_width, m_height, Qt::KeepAspectRatioByExpanding);
+            reader.setScaledSize(size);
+        }
+
+        image = reader.read();
     }
 }
 
@@ -22,9 +22,11 @@
 #ifndef THUMBGENERATOR_H
 #define THUMBGENERATOR_H
 
+#include <QWaitCondition>
 #include <QStringList>
 #include <QImage>
 
+#include <mthreadpool.h>
 #include <mthread.h>
 
 class QObject;
@@ -47,8 +49,18 @@ class ThumbGenEvent : public QEvent
     static Type kEventType;
 };
 
+/** \class ThumbGenerator
+ *  \brief Creates the missing and outdated thumbnails of a directory.
+ *
+ *  The thread hands the files out to a pool of ThumbGenTask workers, so
+ *  thumbnails are made on every core. Thumbnails are kept in the
+ *  thumbnail cache directory and are only made again when the file is
+ *  modified after its thumbnail.
+ */
 class ThumbGenerator : public MThread
 {
+    friend class ThumbGenTask;
+
 public:
 
     ThumbGenerator(QObject *parent, int w, int h);
@@ -68,6 +80,8 @@ protected:
 private:
 
     bool moreWork();
+    void makeThumb(const QString& dir, const QString& file, bool isGallery);
+    void taskDone();
     bool checkGalleryDir(const QFileInfo& fi);
     bool checkGalleryFile(const QFileInfo& fi);
     void loadDir(QImage& image, const QFileInfo& fi);
@@ -80,6 +94,11 @@ private:
     QMutex       m_mutex;
     int          m_width, m_height;
 
+    MThreadPool     m_pool;
+    int             m_tasks;        ///< tasks started and not done yet
+    QWaitCondition  m_taskWait;
+    QMutex          m_movieLock;    ///< mplayer shares one temp dir
+
 };
 
 #endif /* THUMBGENERATOR_H */
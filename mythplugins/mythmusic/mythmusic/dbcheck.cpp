@@ -11,7 +11,7 @@ using namespace std;
 #include "mythtv/mythdb.h"
 #include "mythtv/schemawizard.h"
 
-const QString currentDatabaseVersion = "1019";
+const QString currentDatabaseVersion = "1020";
 
 static bool doUpgradeMusicDatabaseSchema(QString &dbver);
 
@@ -808,5 +808,17 @@ QString("ALTER DATABASE %1 DEFAULT CHARACTER SET utf8 COLLATE utf8_general_ci;")
             return false;
     }
 
+    if (dbver == "1019")
+    {
+        const QString updates[] = {
+"ALTER TABLE music_songs ADD COLUMN file_mtime INT UNSIGNED NOT NULL DEFAULT 0, "
+"ADD COLUMN inode BIGINT UNSIGNED NOT NULL DEFAULT 0;",
+""
+};
+
+        if (!performActualUpdate(updates, "1020", dbver))
+            return false;
+    }
+
     return true;
 }
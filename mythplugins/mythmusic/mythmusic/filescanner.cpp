@@ -3,6 +3,9 @@
 
 // Qt headers
 #include <QApplication>
+#include <QRunnable>
+#include <QThread>
+#include <QTime>
 #include <QDir>
 
 // MythTV headers
@@ -11,14 +14,94 @@
 #include <mythdialogs.h>
 #include <mythscreenstack.h>
 #include <mythprogressdialog.h>
+#include <mthreadpool.h>
 
 // MythMusic headers
 #include "decoder.h"
 #include "filescanner.h"
 #include "metadata.h"
 #include "metaio.h"
+#include "metaioid3.h"
 
-FileScanner::FileScanner() : m_decoder(NULL)
+/// Database writes done in a single transaction
+#define WRITES_PER_TRANSACTION 500
+
+/*!
+ * \brief Reads the size, modification time and inode of a file without
+ *        opening it.
+ *
+ * \returns False if the file couldn't be stat()ed.
+ */
+bool MusicFileFingerprint::Read(const QString &filename)
+{
+    struct stat stbuf;
+
+    QByteArray fname = filename.toLocal8Bit();
+    if (stat(fname.constData(), &stbuf) != 0)
+        return false;
+
+    size  = stbuf.st_size;
+    mtime = stbuf.st_mtime;
+    inode = stbuf.st_ino;
+    return true;
+}
+
+/// Reads the tags of one music file on the MThreadPool
+class MusicFileReader : public QRunnable
+{
+  public:
+    MusicFileReader(FileScanner &scanner, const QString &filename,
+                    bool update) :
+        m_scanner(scanner), m_filename(filename), m_update(update) {}
+
+    void run(void)
+    {
+        MusicScanResult *result = new MusicScanResult(m_filename, m_update);
+
+        // Taken first, a change while reading is seen by the next scan
+        result->fingerprint.Read(m_filename);
+
+        Decoder *decoder = Decoder::create(m_filename, NULL, NULL, true);
+        if (decoder)
+        {
+            LOG(VB_FILE, LOG_INFO,
+                QString("Reading metadata from %1").arg(m_filename));
+
+            Metadata *db_meta = m_update ? decoder->getMetadata() : NULL;
+            result->data = decoder->readMetadata();
+
+            if (result->data && db_meta)
+            {
+                result->data->setID(db_meta->ID());
+                result->data->setRating(db_meta->Rating());
+            }
+            delete db_meta;
+
+            // Only ID3 tags carry images. Metadata::getTagger() hands out
+            // shared taggers, so this thread uses one of its own.
+            QString extension = m_filename.section('.', -1).toLower();
+            if (result->data && !m_update &&
+                (extension == "mp3" || extension == "mp2" ||
+                 extension == "flac"))
+            {
+                MetaIOID3 tagger;
+                result->art = tagger.getAlbumArtList(m_filename);
+            }
+
+            delete decoder;
+        }
+
+        m_scanner.ReadFinished(result);
+    }
+
+  private:
+    FileScanner &m_scanner;
+    QString      m_filename;
+    bool         m_update;
+};
+
+FileScanner::FileScanner() :
+    m_decoder(NULL), m_transaction(NULL), m_pendingWrites(0)
 {
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -65,7 +148,7 @@ FileScanner::FileScanner() : m_decoder(NULL)
 
 FileScanner::~FileScanner ()
 {
-
+    CommitTransaction();
 }
 
 /*!
@@ -223,12 +306,26 @@ bool FileScanner::HasFileChanged(const QString &filename, const QString &date_mo
 }
 
 /*!
- * \brief Insert file details into database.
- *        If it is an audio file, read the metadata and insert
- *        that information at the same time.
+ * \brief Check if a file is album art, going by the AlbumArtFilter setting
  *
- *        If it is an image file, just insert the filename and
- *        type.
+ * \param filename File to examine
+ *
+ * \returns True if it is an image file
+ */
+static bool is_album_art(const QString &filename)
+{
+    QString extension = filename.section( '.', -1 ) ;
+
+    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter",
+                                              "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
+
+    return nameFilter.indexOf(extension.toLower()) > -1;
+}
+
+/*!
+ * \brief Insert the details of an image file into the music_albumart
+ *        table. Audio files are read by a MusicFileReader and inserted
+ *        by CommitMetadata().
  *
  * \param filename Full path to file.
  *
@@ -236,94 +333,22 @@ bool FileScanner::HasFileChanged(const QString &filename, const QString &date_mo
  */
 void FileScanner::AddFileToDB(const QString &filename)
 {
-    QString extension = filename.section( '.', -1 ) ;
     QString directory = filename;
     directory.remove(0, m_startdir.length());
     directory = directory.section( '/', 0, -2);
 
-    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter",
-                                              "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
+    QString name = filename.section( '/', -1);
 
-    // If this file is an image, insert the details into the music_albumart table
-    if (nameFilter.indexOf(extension.toLower()) > -1)
-    {
-        QString name = filename.section( '/', -1);
-
-        MSqlQuery query(MSqlQuery::InitCon());
-        query.prepare("INSERT INTO music_albumart SET filename = :FILE, "
-                      "directory_id = :DIRID, imagetype = :TYPE;");
-        query.bindValue(":FILE", name);
-        query.bindValue(":DIRID", m_directoryid[directory]);
-        query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
-
-        if (!query.exec() || query.numRowsAffected() <= 0)
-        {
-            MythDB::DBError("music insert artwork", query);
-        }
-        return;
-    }
-
-    Decoder *decoder = Decoder::create(filename, NULL, NULL, true);
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("INSERT INTO music_albumart SET filename = :FILE, "
+                  "directory_id = :DIRID, imagetype = :TYPE;");
+    query.bindValue(":FILE", name);
+    query.bindValue(":DIRID", m_directoryid[directory]);
+    query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
 
-    if (decoder)
+    if (!query.exec() || query.numRowsAffected() <= 0)
     {
-        LOG(VB_FILE, LOG_INFO,
-            QString("Reading metadata from %1").arg(filename));
-        Metadata *data = decoder->readMetadata();
-        if (data) 
-        {
-
-            QString album_cache_string;
-
-            // Set values from cache
-            int did = m_directoryid[directory];
-            if (did > 0)
-                data->setDirectoryId(did);
-
-            int aid = m_artistid[data->Artist().toLower()];
-            if (aid > 0)
-            {
-                data->setArtistId(aid);
-
-                // The album cache depends on the artist id
-                album_cache_string = data->getArtistId() + "#"
-                    + data->Album().toLower();
-
-                if (m_albumid[album_cache_string] > 0)
-                    data->setAlbumId(m_albumid[album_cache_string]);
-            }
-
-            int gid = m_genreid[data->Genre().toLower()];
-            if (gid > 0)
-                data->setGenreId(gid);
-
-            // Commit track info to database
-            data->dumpToDatabase();
-
-            // Update the cache
-            m_artistid[data->Artist().toLower()] =
-                data->getArtistId();
-
-            m_genreid[data->Genre().toLower()] =
-                data->getGenreId();
-
-            album_cache_string = data->getArtistId() + "#"
-                + data->Album().toLower();
-            m_albumid[album_cache_string] = data->getAlbumId();
-
-            // read any embedded images from the tag
-            MetaIO *tagger = data->getTagger();
-            if (tagger && tagger->supportsEmbeddedImages())
-            {
-                AlbumArtList artList = tagger->getAlbumArtList(data->Filename());
-                data->setEmbeddedAlbumArt(artList);
-                data->getAlbumArtImages()->dumpToDatabase();
-            }
-
-            delete data;
-        }
-
-        delete decoder;
+        MythDB::DBError("music insert artwork", query);
     }
 }
 
@@ -475,75 +500,220 @@ void FileScanner::RemoveFileFromDB (const QString &filename)
 }
 
 /*!
- * \brief Updates a file in the database.
+ * \brief Inserts or updates the metadata a MusicFileReader read into the
+ *        database, with the fingerprint of the file.
  *
- * \param filename Full path to file.
+ * \param result Tags of the file, the metadata is cleared.
  *
  * \returns Nothing.
  */
-void FileScanner::UpdateFileInDB(const QString &filename)
+void FileScanner::CommitMetadata(MusicScanResult *result)
 {
-    QString directory = filename;
+    Metadata *data = result->data;
+    if (!data)
+        return;
+
+    QString directory = result->filename;
     directory.remove(0, m_startdir.length());
     directory = directory.section( '/', 0, -2);
 
-    Decoder *decoder = Decoder::create(filename, NULL, NULL, true);
+    QString album_cache_string;
+
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did > 0)
+        data->setDirectoryId(did);
 
-    if (decoder)
+    int aid = m_artistid[data->Artist().toLower()];
+    if (aid > 0)
     {
-        Metadata *db_meta   = decoder->getMetadata();
-        Metadata *disk_meta = decoder->readMetadata();
+        data->setArtistId(aid);
 
-        if (db_meta && disk_meta)
-        {
-            disk_meta->setID(db_meta->ID());
-            disk_meta->setRating(db_meta->Rating());
+        // The album cache depends on the artist id
+        album_cache_string = data->getArtistId() + "#"
+            + data->Album().toLower();
 
-            QString album_cache_string;
+        if (m_albumid[album_cache_string] > 0)
+            data->setAlbumId(m_albumid[album_cache_string]);
+    }
 
-            // Set values from cache
-            int did = m_directoryid[directory];
-            if (did > 0)
-                disk_meta->setDirectoryId(did);
+    int gid = m_genreid[data->Genre().toLower()];
+    if (gid > 0)
+        data->setGenreId(gid);
 
-            int aid = m_artistid[disk_meta->Artist().toLower()];
-            if (aid > 0)
-            {
-                disk_meta->setArtistId(aid);
+    // Commit track info to database
+    data->dumpToDatabase();
 
-                // The album cache depends on the artist id
-                album_cache_string = disk_meta->getArtistId() + "#" +
-                    disk_meta->Album().toLower();
+    // Update the cache
+    m_artistid[data->Artist().toLower()] =
+        data->getArtistId();
 
-                if (m_albumid[album_cache_string] > 0)
-                    disk_meta->setAlbumId(m_albumid[album_cache_string]);
-            }
+    m_genreid[data->Genre().toLower()] =
+        data->getGenreId();
+
+    album_cache_string = data->getArtistId() + "#"
+        + data->Album().toLower();
+    m_albumid[album_cache_string] = data->getAlbumId();
+
+    // add any embedded images from the tag
+    if (!result->art.isEmpty())
+    {
+        data->setEmbeddedAlbumArt(result->art);
+        data->getAlbumArtImages()->dumpToDatabase();
+    }
+
+    if (data->ID() > 0 && result->fingerprint.IsValid())
+        SaveFingerprint(data->ID(), result->fingerprint);
+
+    delete data;
+    result->data = NULL;
+}
+
+/*!
+ * \brief Stores the fingerprint of a song's file, the next scan skips
+ *        the file while it is unchanged.
+ *
+ * \returns Nothing.
+ */
+void FileScanner::SaveFingerprint(int songid, const MusicFileFingerprint &fp)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("UPDATE music_songs SET size = :SIZE, "
+                  "file_mtime = :MTIME, inode = :INODE "
+                  "WHERE song_id = :ID ;");
+    query.bindValue(":SIZE", fp.size);
+    query.bindValue(":MTIME", fp.mtime);
+    query.bindValue(":INODE", fp.inode);
+    query.bindValue(":ID", songid);
+
+    if (!query.exec())
+        MythDB::DBError("FileScanner::SaveFingerprint", query);
+}
 
-            int gid = m_genreid[disk_meta->Genre().toLower()];
-            if (gid > 0)
-                disk_meta->setGenreId(gid);
-
-            // Commit track info to database
-            disk_meta->dumpToDatabase();
-
-            // Update the cache
-            m_artistid[disk_meta->Artist().toLower()]
-                = disk_meta->getArtistId();
-            m_genreid[disk_meta->Genre().toLower()]
-                = disk_meta->getGenreId();
-            album_cache_string = disk_meta->getArtistId() + "#" +
-                disk_meta->Album().toLower();
-            m_albumid[album_cache_string] = disk_meta->getAlbumId();
+/*!
+ * \brief Starts a transaction, the queries this thread makes until
+ *        CommitTransaction() use the same connection and take part in it.
+ *
+ * \returns Nothing.
+ */
+void FileScanner::BeginTransaction(void)
+{
+    CommitTransaction();
+
+    m_transaction = new MSqlQuery(MSqlQuery::InitCon());
+    if (!m_transaction->exec("START TRANSACTION"))
+        MythDB::DBError("FileScanner::BeginTransaction", *m_transaction);
+    m_pendingWrites = 0;
+}
+
+void FileScanner::CommitTransaction(void)
+{
+    if (!m_transaction)
+        return;
+
+    if (!m_transaction->exec("COMMIT"))
+        MythDB::DBError("FileScanner::CommitTransaction", *m_transaction);
+    delete m_transaction;
+    m_transaction = NULL;
+}
+
+/// Commits the transaction every WRITES_PER_TRANSACTION writes
+void FileScanner::CountWrite(void)
+{
+    if (++m_pendingWrites >= WRITES_PER_TRANSACTION)
+        BeginTransaction();
+}
+
+void FileScanner::ReadFinished(MusicScanResult *result)
+{
+    QMutexLocker locker(&m_readLock);
+    m_readResults.push_back(result);
+    m_readWait.wakeAll();
+}
+
+/*!
+ * \brief Reads the tags of the new and changed music files on the
+ *        MThreadPool and writes them to the database as they come in.
+ *
+ * \param music_files MusicLoadedMap
+ * \param progress Dialog to report the progress to, may be NULL
+ * \param counter Files handled so far, for the progress
+ *
+ * \returns Nothing.
+ */
+void FileScanner::ReadMusicFiles(MusicLoadedMap &music_files,
+                                 MythUIProgressDialog *progress,
+                                 uint &counter)
+{
+    QList<QPair<QString,bool> > to_read;
+    MusicLoadedMap::Iterator iter;
+    for (iter = music_files.begin(); iter != music_files.end(); iter++)
+    {
+        if ((*iter == kFileSystem || *iter == kNeedUpdate) &&
+            !is_album_art(iter.key()))
+        {
+            to_read.push_back(qMakePair(iter.key(), *iter == kNeedUpdate));
         }
+    }
 
-        if (disk_meta)
-            delete disk_meta;
+    if (to_read.isEmpty())
+        return;
 
-        if (db_meta)
-            delete db_meta;
+    // Registers the decoders before the readers race to do it
+    Decoder::all();
+
+    // Enough readers to keep every core busy, without piling up results
+    int max_in_flight = qMax(QThread::idealThreadCount(), 1) * 4;
+    int next = 0, in_flight = 0, done = 0;
+
+    QTime timer;
+    timer.start();
+
+    while (done < to_read.size())
+    {
+        while (in_flight < max_in_flight && next < to_read.size())
+        {
+            MThreadPool::globalInstance()->start(
+                new MusicFileReader(*this, to_read[next].first,
+                                    to_read[next].second),
+                "MusicFileReader");
+            next++;
+            in_flight++;
+        }
+
+        m_readLock.lock();
+        if (m_readResults.isEmpty())
+            m_readWait.wait(&m_readLock, 100);
+        QList<MusicScanResult*> results = m_readResults;
+        m_readResults.clear();
+        m_readLock.unlock();
 
-        delete decoder;
+        while (!results.isEmpty())
+        {
+            MusicScanResult *result = results.takeFirst();
+            CommitMetadata(result);
+            delete result;
+
+            CountWrite();
+            in_flight--;
+            done++;
+            counter++;
+        }
+
+        if (progress)
+        {
+            int elapsed = qMax(timer.elapsed(), 1);
+            progress->SetMessage(
+                QObject::tr("Reading music files, %1 per second")
+                    .arg(done * 1000 / elapsed));
+            progress->SetProgress(counter);
+        }
+        qApp->processEvents();
     }
+
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("FileScanner: Read %1 music files in %2 seconds")
+            .arg(done).arg(timer.elapsed() / 1000.0, 0, 'f', 1));
 }
 
 /*!
@@ -599,28 +769,30 @@ void FileScanner::SearchDir(QString &directory)
         file_checking = NULL;
     }
 
-     /*
-       This can be optimised quite a bit by consolidating all commands
-       via a lot of refactoring.
-
-       1) group all files of the same decoder type, and don't
-       create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-       singletons, it should be a fairly simple change.
+    // On InnoDB every write is a commit of its own otherwise
+    BeginTransaction();
 
-       2) RemoveFileFromDB should group the remove into one big SQL.
-
-       3) UpdateFileInDB, same as 1.
-     */
+    QMap<int, MusicFileFingerprint>::const_iterator fit =
+        m_missingFingerprints.begin();
+    for (; fit != m_missingFingerprints.end(); ++fit)
+    {
+        SaveFingerprint(fit.key(), *fit);
+        CountWrite();
+    }
+    m_missingFingerprints.clear();
 
+    // Removals and artwork first, music files are read in parallel below
     uint counter = 0;
     for (iter = music_files.begin(); iter != music_files.end(); iter++)
     {
-        if (*iter == kFileSystem)
+        if (*iter == kFileSystem && is_album_art(iter.key()))
             AddFileToDB(iter.key());
         else if (*iter == kDatabase)
             RemoveFileFromDB(iter.key ());
-        else if (*iter == kNeedUpdate)
-            UpdateFileInDB(iter.key());
+        else
+            continue;
+
+        CountWrite();
 
         if (file_checking)
         {
@@ -628,6 +800,11 @@ void FileScanner::SearchDir(QString &directory)
             qApp->processEvents();
         }
     }
+
+    ReadMusicFiles(music_files, file_checking, counter);
+
+    CommitTransaction();
+
     if (file_checking)
         file_checking->Close();
 
@@ -647,7 +824,8 @@ void FileScanner::ScanMusic(MusicLoadedMap &music_files)
     MusicLoadedMap::Iterator iter;
 
     MSqlQuery query(MSqlQuery::InitCon());
-    if (!query.exec("SELECT CONCAT_WS('/', path, filename), date_modified "
+    if (!query.exec("SELECT CONCAT_WS('/', path, filename), date_modified, "
+                    "song_id, size, file_mtime, inode "
                     "FROM music_songs LEFT JOIN music_directories ON "
                     "music_songs.directory_id=music_directories.directory_id "
                     "WHERE filename NOT LIKE ('%://%')"))
@@ -694,7 +872,28 @@ void FileScanner::ScanMusic(MusicLoadedMap &music_files)
                         }
                         continue;
                     }
-                    else if (HasFileChanged(name, query.value(1).toString()))
+                    MusicFileFingerprint stored;
+                    stored.size  = query.value(3).toULongLong();
+                    stored.mtime = query.value(4).toULongLong();
+                    stored.inode = query.value(5).toULongLong();
+
+                    MusicFileFingerprint current;
+                    bool changed;
+                    if (stored.IsValid() && current.Read(name))
+                    {
+                        changed = !(stored == current);
+                    }
+                    else
+                    {
+                        // Scanned before fingerprints were kept
+                        changed = HasFileChanged(name,
+                                                 query.value(1).toString());
+                        if (!changed && current.Read(name))
+                            m_missingFingerprints[query.value(2).toInt()] =
+                                current;
+                    }
+
+                    if (changed)
                         music_files[name] = kNeedUpdate;
                     else
                         music_files.erase(iter);
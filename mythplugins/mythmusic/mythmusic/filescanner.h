@@ -1,7 +1,18 @@
 #ifndef _FILESCANNER_H_
 #define _FILESCANNER_H_
 
-class Metadata;
+// Qt headers
+#include <QWaitCondition>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+// MythMusic headers
+#include "metadata.h"
+
+class MythUIProgressDialog;
+class MusicFileReader;
+class MSqlQuery;
 class Decoder;
 
 enum MusicFileLocation
@@ -15,8 +26,43 @@ enum MusicFileLocation
 typedef QMap <QString, MusicFileLocation> MusicLoadedMap;
 typedef QMap<QString, int> IdCache;
 
+/// What a file looked like on disk, unchanged files are not read again
+class MusicFileFingerprint
+{
+  public:
+    MusicFileFingerprint() : size(0), mtime(0), inode(0) {}
+    bool Read(const QString &filename);
+    bool IsValid(void) const { return mtime; }
+    bool operator==(const MusicFileFingerprint &other) const
+    {
+        return size == other.size && mtime == other.mtime &&
+               inode == other.inode;
+    }
+
+    quint64 size;
+    quint64 mtime;
+    quint64 inode;
+};
+
+/// Tags of a music file, read by a MusicFileReader
+class MusicScanResult
+{
+  public:
+    MusicScanResult(const QString &f, bool u) :
+        filename(f), update(u), data(NULL) {}
+    ~MusicScanResult() { delete data; }
+
+    QString              filename;
+    bool                 update;       ///< already in the database
+    Metadata            *data;         ///< NULL if the file was unreadable
+    AlbumArtList         art;          ///< embedded images
+    MusicFileFingerprint fingerprint;
+};
+
 class FileScanner
 {
+    friend class MusicFileReader;
+
     public:
         FileScanner ();
         ~FileScanner ();
@@ -29,9 +75,16 @@ class FileScanner
         bool HasFileChanged(const QString &filename, const QString &date_modified);
         void AddFileToDB(const QString &filename);
         void RemoveFileFromDB (const QString &filename);
-        void UpdateFileInDB(const QString &filename);
+        void CommitMetadata(MusicScanResult *result);
+        void SaveFingerprint(int songid, const MusicFileFingerprint &fp);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
+        void ReadMusicFiles(MusicLoadedMap &music_files,
+                            MythUIProgressDialog *progress, uint &counter);
+        void ReadFinished(MusicScanResult *result);
+        void BeginTransaction(void);
+        void CommitTransaction(void);
+        void CountWrite(void);
         void cleanDB();
 
         QString         m_startdir;
@@ -41,6 +94,16 @@ class FileScanner
         IdCache         m_albumid;
 
         Decoder             *m_decoder;
+
+        /// Fingerprints of unchanged files that don't have one yet
+        QMap<int, MusicFileFingerprint> m_missingFingerprints;
+
+        MSqlQuery               *m_transaction;
+        uint                     m_pendingWrites;
+
+        QMutex                   m_readLock;
+        QWaitCondition           m_readWait;
+        QList<MusicScanResult*>  m_readResults;
 };
 
 #endif // _FILESCANNER_H_
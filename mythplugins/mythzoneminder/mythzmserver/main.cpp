@@ -36,6 +36,9 @@
 // default location of zoneminders config file
 #define ZM_CONFIG "/etc/zm.conf"
 
+// how often to look for new frames when a client is subscribed to them
+#define LIVE_FRAME_CHECK_USEC (1000000 / 50)
+
 // Care should be taken to keep these in sync with the exit codes in
 // libmythbase/exitcodes.h (which is not included here to keep this code 
 // separate from mythtv libraries).
@@ -260,9 +263,29 @@ int main(int argc, char **argv)
     // main loop
     while (!quit)
     {
+        // are any clients waiting for live frames?
+        bool subscribed = false;
+        map<int, ZMServer*>::iterator it = serverList.begin();
+        for (; it != serverList.end(); ++it)
+        {
+            if (it->second && it->second->isSubscribed())
+            {
+                subscribed = true;
+                break;
+            }
+        }
+
         // the maximum time select() should wait
-        timeout.tv_sec = DB_CHECK_TIME;
-        timeout.tv_usec = 0;
+        if (subscribed)
+        {
+            timeout.tv_sec = 0;
+            timeout.tv_usec = LIVE_FRAME_CHECK_USEC;
+        }
+        else
+        {
+            timeout.tv_sec = DB_CHECK_TIME;
+            timeout.tv_usec = 0;
+        }
 
         read_fds = master; // copy it
         res = select(fdmax+1, &read_fds, NULL, NULL, &timeout);
@@ -277,7 +300,9 @@ int main(int argc, char **argv)
             // select timed out
             // just kick the DB connection to keep it alive
             kickDatabase(debug);
-            continue;
+
+            if (!subscribed)
+                continue;
         }
 
         // run through the existing connections looking for data to read
@@ -348,6 +373,13 @@ int main(int argc, char **argv)
                 }
             }
         }
+
+        // send any new frames to the subscribed clients
+        for (it = serverList.begin(); it != serverList.end(); ++it)
+        {
+            if (it->second)
+                it->second->pushLiveFrames();
+        }
     }
 
     mysql_close(&g_dbConn);
@@ -0,0 +1,161 @@
+/* zmfakemonitor.cpp
+ * ============================================================
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published bythe Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+/*
+ * Stands in for zmc when testing live frames without a camera. It creates
+ * a monitor's shared memory the way ZM 1.22.3 and later lay it out and
+ * fills the image ring with a moving test pattern at the given rate.
+ *
+ * The monitor still has to be set up in ZM's database with the same id,
+ * size, colours and image buffer count, and zmc must not be running for it.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/shm.h>
+
+#include "zmserver.h"
+
+// ZM's default shared memory key, ZM_SHM_KEY in its config
+#define DEFAULT_SHM_KEY 0x7a6d2000
+
+static bool quit = false;
+
+static void signal_handler(int sig)
+{
+    (void) sig;
+    quit = true;
+}
+
+static void usage(const char *name)
+{
+    cout << "Usage: " << name << " monitorid width height [colours] "
+            "[buffercount] [fps] [shmkey]" << endl << endl
+         << "colours is 1 or 3 bytes per pixel (default 3), buffercount "
+            "is the monitor's image buffer count (default 50), fps "
+            "defaults to 25 and shmkey to 0x" << hex << DEFAULT_SHM_KEY
+         << dec << endl;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int monitorID   = atoi(argv[1]);
+    int width       = atoi(argv[2]);
+    int height      = atoi(argv[3]);
+    int bpp         = (argc > 4) ? atoi(argv[4]) : 3;
+    int bufferCount = (argc > 5) ? atoi(argv[5]) : 50;
+    int fps         = (argc > 6) ? atoi(argv[6]) : 25;
+    key_t shmKey    = (argc > 7) ? strtol(argv[7], NULL, 16) : DEFAULT_SHM_KEY;
+
+    if (monitorID <= 0 || width <= 0 || height <= 0 ||
+        (bpp != 1 && bpp != 3) || bufferCount <= 0 || fps <= 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // same layout as ZMServer::initMonitor() expects
+    int frameSize = width * height * bpp;
+    int sharedDataSize = sizeof(SharedData) + sizeof(TriggerData) +
+        (bufferCount * sizeof(struct timeval)) + (bufferCount * frameSize);
+
+    int shmid = shmget((shmKey & 0xffffff00) | monitorID, sharedDataSize,
+                       IPC_CREAT | 0666);
+    if (shmid == -1)
+    {
+        cout << "Failed to shmget for monitor " << monitorID << ": "
+             << strerror(errno) << endl;
+        return EXIT_FAILURE;
+    }
+
+    void *shm_ptr = shmat(shmid, 0, 0);
+    if (shm_ptr == (void *) -1)
+    {
+        cout << "Failed to shmat for monitor " << monitorID << ": "
+             << strerror(errno) << endl;
+        shmctl(shmid, IPC_RMID, NULL);
+        return EXIT_FAILURE;
+    }
+
+    memset(shm_ptr, 0, sharedDataSize);
+
+    SharedData *sharedData = (SharedData *) shm_ptr;
+    TriggerData *triggerData = (TriggerData *) (sharedData + 1);
+    struct timeval *timestamps = (struct timeval *) (triggerData + 1);
+    unsigned char *images = (unsigned char *) (timestamps + bufferCount);
+
+    sharedData->size = sizeof(SharedData);
+    sharedData->valid = true;
+    sharedData->active = true;
+    sharedData->signal = true;
+    sharedData->state = IDLE;
+    sharedData->last_write_index = bufferCount;
+    sharedData->last_read_index = bufferCount;
+    triggerData->size = sizeof(TriggerData);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    cout << "Writing " << width << "x" << height << " frames for monitor "
+         << monitorID << " at " << fps << " fps, ^C to stop" << endl;
+
+    int stride = width * bpp;
+    long long frameCount = 0;
+
+    while (!quit)
+    {
+        int index = frameCount % bufferCount;
+        unsigned char *frame = images + index * frameSize;
+
+        // a grey ramp with a bar sweeping across it, so dropped or
+        // repeated frames show
+        int bar = (frameCount * 4) % width;
+        for (int y = 0; y < height; y++)
+        {
+            unsigned char *row = frame + y * stride;
+            for (int x = 0; x < width; x++)
+            {
+                unsigned char value = (x >= bar && x < bar + 8) ?
+                    255 : (unsigned char) ((x + y + frameCount) & 0x7f);
+                memset(row + x * bpp, value, bpp);
+            }
+        }
+
+        gettimeofday(&timestamps[index], NULL);
+        sharedData->last_image_time = timestamps[index].tv_sec;
+        sharedData->last_write_index = index;
+        frameCount++;
+
+        usleep(1000000 / fps);
+    }
+
+    cout << "Wrote " << frameCount << " frames" << endl;
+
+    shmdt(shm_ptr);
+    shmctl(shmid, IPC_RMID, NULL);
+
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 
 
 #include <iostream>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -24,6 +25,7 @@
 #include <netinet/in.h>
 #include <sys/stat.h>
 #include <sys/shm.h>
+#include <sys/uio.h>
 
 #ifdef linux
 #  include <sys/vfs.h>
@@ -48,7 +50,7 @@
 #include "zmserver.h"
 
 // the version of the protocol we understand
-#define ZM_PROTOCOL_VERSION "6"
+#define ZM_PROTOCOL_VERSION "7"
 
 // the maximum image size we are ever likely to get from ZM
 #define MAX_IMAGE_SIZE  (2048*1536*3)
@@ -64,6 +66,10 @@
 #define ERROR_INVALID_POINTERS "Cannot get shared memory pointers"
 #define ERROR_INVALID_MONITOR_FUNCTION  "Invalid Monitor Function"
 #define ERROR_INVALID_MONITOR_ENABLE_VALUE "Invalid Monitor Enable Value"
+#define ERROR_INVALID_SCALE    "Invalid Scale"
+
+// the largest downscale factor a client can ask live frames to be sent at
+#define MAX_LIVE_SCALE  8
 
 MYSQL   g_dbConn;
 string  g_zmversion = "";
@@ -204,6 +210,8 @@ ZMServer::ZMServer(int sock, bool debug)
 
     m_sock = sock;
     m_debug = debug;
+    m_liveScale = 1;
+    m_pendingPos = 0;
 
     // get the shared memory key
     char buf[100];
@@ -300,6 +308,10 @@ void ZMServer::processRequest(char* buf, int nbytes)
         handleGetAnalyseFrame(tokens);
     else if (tokens[0] == "GET_LIVE_FRAME")
         handleGetLiveFrame(tokens);
+    else if (tokens[0] == "SUBSCRIBE_LIVE_FRAMES")
+        handleSubscribeLiveFrames(tokens);
+    else if (tokens[0] == "UNSUBSCRIBE_LIVE_FRAMES")
+        handleUnsubscribeLiveFrames();
     else if (tokens[0] == "GET_FRAME_LIST")
         handleGetFrameList(tokens);
     else if (tokens[0] == "GET_CAMERA_LIST")
@@ -318,8 +330,12 @@ void ZMServer::processRequest(char* buf, int nbytes)
         send("UNKNOWN_COMMAND");
 }
 
-bool ZMServer::send(const string s) const
+bool ZMServer::send(const string s)
 {
+    // a reply must not end up in the middle of a pushed frame
+    if (!flushPending(true))
+        return false;
+
     // send length
     uint32_t len = s.size();
     char buf[9];
@@ -336,25 +352,125 @@ bool ZMServer::send(const string s) const
         return true;
 }
 
-bool ZMServer::send(const string s, const unsigned char *buffer, int dataLen) const
+bool ZMServer::send(const string s, const unsigned char *buffer, int dataLen)
 {
-    // send length
+    if (!flushPending(true))
+        return false;
+
+    // length, message and data go out in one writev() so the data can be
+    // sent straight from the shared memory without being copied first
     uint32_t len = s.size();
     char buf[9];
     sprintf(buf, "%8d", len);
-    int status = ::send(m_sock, buf, 8, MSG_NOSIGNAL);
+
+    struct iovec iov[3];
+    iov[0].iov_base = buf;
+    iov[0].iov_len  = 8;
+    iov[1].iov_base = (void*) s.c_str();
+    iov[1].iov_len  = s.size();
+    iov[2].iov_base = (void*) buffer;
+    iov[2].iov_len  = dataLen;
+
+    struct iovec *vec = iov;
+    int count = 3;
+
+    while (count > 0)
+    {
+        ssize_t status = writev(m_sock, vec, count);
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        // skip what was written, a blocking socket can still write
+        // less than asked for if it is interrupted
+        while (count > 0 && (size_t) status >= vec->iov_len)
+        {
+            status -= vec->iov_len;
+            vec++;
+            count--;
+        }
+
+        if (count > 0)
+        {
+            vec->iov_base = (char*) vec->iov_base + status;
+            vec->iov_len -= status;
+        }
+    }
+
+    return true;
+}
+
+// Sends a pushed message without blocking, what the socket won't take
+// of a message it has started on is kept and sent before anything else.
+// Returns false if the client has gone.
+bool ZMServer::sendLater(const string s, const unsigned char *buffer, int dataLen)
+{
+    uint32_t len = s.size();
+    char buf[9];
+    sprintf(buf, "%8d", len);
+
+    struct iovec iov[3];
+    iov[0].iov_base = buf;
+    iov[0].iov_len  = 8;
+    iov[1].iov_base = (void*) s.c_str();
+    iov[1].iov_len  = s.size();
+    iov[2].iov_base = (void*) buffer;
+    iov[2].iov_len  = dataLen;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 3;
+
+    ssize_t status;
+    do
+        status = sendmsg(m_sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    while (status == -1 && errno == EINTR);
+
+    // a frame the socket has no room for at all is just dropped
     if (status == -1)
-        return false;
+        return (errno == EAGAIN || errno == EWOULDBLOCK);
 
-    // send message
-    status = ::send(m_sock, s.c_str(), s.size(), MSG_NOSIGNAL);
-    if ( status == -1 )
-        return false;
+    // otherwise keep a copy of the rest, zmc will overwrite the frame in
+    // the shared memory before long
+    for (int x = 0; x < 3; x++)
+    {
+        const unsigned char *base = (const unsigned char*) iov[x].iov_base;
+        size_t skip = min((size_t) status, iov[x].iov_len);
 
-    // send data
-    status = ::send(m_sock, buffer, dataLen, MSG_NOSIGNAL);
-    if ( status == -1 )
-        return false;
+        m_pending.insert(m_pending.end(), base + skip, base + iov[x].iov_len);
+        status -= skip;
+    }
+
+    return true;
+}
+
+// Sends what is left of a pushed frame, if block is false only as much as
+// the socket takes without waiting.  Returns false if the client has gone.
+bool ZMServer::flushPending(bool block)
+{
+    while (m_pendingPos < m_pending.size())
+    {
+        ssize_t status = ::send(m_sock, &m_pending[m_pendingPos],
+                                m_pending.size() - m_pendingPos,
+                                MSG_NOSIGNAL | (block ? 0 : MSG_DONTWAIT));
+        if (status == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (!block && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return true;
+            return false;
+        }
+
+        m_pendingPos += status;
+    }
+
+    m_pending.clear();
+    m_pendingPos = 0;
 
     return true;
 }
@@ -909,7 +1025,6 @@ void ZMServer::handleGetAnalyseFrame(vector<string> tokens)
 
 void ZMServer::handleGetLiveFrame(vector<string> tokens)
 {
-    static unsigned char buffer[MAX_IMAGE_SIZE];
     char str[100];
 
     // we need to periodically kick the DB connection here to make sure it
@@ -954,8 +1069,9 @@ void ZMServer::handleGetLiveFrame(vector<string> tokens)
         return;
     }
 
-    // read a frame from the shared memory
-    int dataSize = getFrame(buffer, sizeof(buffer), monitor);
+    // find the latest frame in the shared memory
+    unsigned char *data = getFrame(monitor);
+    int dataSize = data ? monitor->frame_size : 0;
 
     if (m_debug)
         cout << "Frame size: " <<  dataSize << endl;
@@ -977,7 +1093,166 @@ void ZMServer::handleGetLiveFrame(vector<string> tokens)
     ADD_STR(outStr, str)
 
     // send the data
-    send(outStr, buffer, dataSize);
+    send(outStr, data, dataSize);
+}
+
+void ZMServer::handleSubscribeLiveFrames(vector<string> tokens)
+{
+    // the client sends the scale then the id's of the monitors it wants
+    if (tokens.size() < 3)
+    {
+        sendError(ERROR_TOKEN_COUNT);
+        return;
+    }
+
+    int scale = atoi(tokens[1].c_str());
+    if (scale < 1 || scale > MAX_LIVE_SCALE)
+    {
+        sendError(ERROR_INVALID_SCALE);
+        return;
+    }
+
+    vector<int> monitors;
+    for (uint x = 2; x < tokens.size(); x++)
+    {
+        int monitorID = atoi(tokens[x].c_str());
+
+        if (m_monitors.find(monitorID) == m_monitors.end())
+        {
+            sendError(ERROR_INVALID_MONITOR);
+            return;
+        }
+
+        MONITOR *monitor = m_monitors[monitorID];
+        if (monitor->shared_data == NULL || monitor->shared_images == NULL)
+        {
+            sendError(ERROR_INVALID_POINTERS);
+            return;
+        }
+
+        // start with whatever frame is in the shared memory now
+        monitor->last_read = -1;
+        monitors.push_back(monitorID);
+    }
+
+    if (m_debug)
+        cout << "Subscribed to live frames from " << monitors.size()
+             << " monitors at 1/" << scale << " size" << endl;
+
+    m_liveMonitors = monitors;
+    m_liveScale = scale;
+
+    string outStr("");
+    ADD_STR(outStr, "OK")
+    send(outStr);
+}
+
+void ZMServer::handleUnsubscribeLiveFrames(void)
+{
+    m_liveMonitors.clear();
+
+    string outStr("");
+    ADD_STR(outStr, "OK")
+    send(outStr);
+}
+
+// Called from the main loop, sends each subscribed monitor's latest
+// frame if it has moved on since the last one sent.
+void ZMServer::pushLiveFrames(void)
+{
+    if (m_liveMonitors.empty())
+        return;
+
+    // don't get stuck behind a client that isn't keeping up, it gets
+    // the rest of the last frame first and drops frames until then
+    if (!flushPending(false))
+    {
+        // the main loop will notice the client has gone
+        m_liveMonitors.clear();
+        return;
+    }
+
+    char str[100];
+
+    for (uint x = 0; x < m_liveMonitors.size() && m_pending.empty(); x++)
+    {
+        MONITOR *monitor = m_monitors[m_liveMonitors[x]];
+
+        unsigned char *data = getFrame(monitor);
+        if (!data)
+            continue;
+
+        int width = monitor->width;
+        int height = monitor->height;
+        int dataSize = monitor->frame_size;
+
+        if (m_liveScale > 1)
+        {
+            dataSize = scaleFrame(data, monitor, m_liveScale);
+            data = &m_scaleBuffer[0];
+            width /= m_liveScale;
+            height /= m_liveScale;
+        }
+
+        string outStr("");
+        ADD_STR(outStr, "LIVE_FRAME")
+
+        sprintf(str, "%d", monitor->mon_id);
+        ADD_STR(outStr, str)
+
+        ADD_STR(outStr, monitor->status)
+
+        sprintf(str, "%d", width);
+        ADD_STR(outStr, str)
+
+        sprintf(str, "%d", height);
+        ADD_STR(outStr, str)
+
+        sprintf(str, "%d", dataSize);
+        ADD_STR(outStr, str)
+
+        if (!sendLater(outStr, data, dataSize))
+        {
+            m_liveMonitors.clear();
+            return;
+        }
+    }
+}
+
+// Shrinks a frame by averaging each scale x scale block of pixels,
+// returns the size of the frame left in m_scaleBuffer.
+int ZMServer::scaleFrame(const unsigned char *data, MONITOR *monitor, int scale)
+{
+    int bpp = (monitor->palette == 1) ? 1 : 3;
+    int width = monitor->width / scale;
+    int height = monitor->height / scale;
+    int srcStride = monitor->width * bpp;
+    int area = scale * scale;
+
+    m_scaleBuffer.resize(width * height * bpp);
+    unsigned char *dst = &m_scaleBuffer[0];
+
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *row = data + (y * scale) * srcStride;
+
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned char *block = row + (x * scale) * bpp;
+
+            for (int c = 0; c < bpp; c++)
+            {
+                int sum = 0;
+                for (int j = 0; j < scale; j++)
+                    for (int i = 0; i < scale; i++)
+                        sum += block[j * srcStride + i * bpp + c];
+
+                *dst++ = sum / area;
+            }
+        }
+    }
+
+    return width * height * bpp;
 }
 
 void ZMServer::handleGetFrameList(vector<string> tokens)
@@ -1368,18 +1643,19 @@ void ZMServer::initMonitor(MONITOR *monitor)
             ((monitor->image_buffer_count) * sizeof(struct timeval));
 }
 
-int ZMServer::getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor)
+// Returns the latest frame in the shared memory or NULL if there
+// isn't a new one.  The frame is used in place, zmc will overwrite
+// it once it has gone round the ring of image_buffer_count frames.
+unsigned char *ZMServer::getFrame(MONITOR *monitor)
 {
-    (void) bufferSize;
-
     // is there a new frame available?
     if (monitor->shared_data->last_write_index == monitor->last_read)
-        return 0;
+        return NULL;
 
     // sanity check last_read
     if (monitor->shared_data->last_write_index < 0 ||
             monitor->shared_data->last_write_index >= monitor->image_buffer_count)
-        return 0;
+        return NULL;
 
     monitor->last_read = monitor->shared_data->last_write_index;
 
@@ -1405,15 +1681,7 @@ int ZMServer::getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor)
             break;
     }
 
-    unsigned char *data = monitor->shared_images +
-            monitor->frame_size * monitor->last_read;
-
-    // FIXME: should do some sort of compression JPEG??
-    // just copy the data to our buffer for now
-    memcpy(buffer, data, monitor->frame_size);
-
-
-    return monitor->frame_size;
+    return monitor->shared_images + monitor->frame_size * monitor->last_read;
 }
 
 string ZMServer::getZMSetting(const string &setting)
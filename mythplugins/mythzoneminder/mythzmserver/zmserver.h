@@ -154,14 +154,21 @@ class ZMServer
 
     void processRequest(char* buf, int nbytes);
 
+    // live frames are pushed to subscribed clients from the main loop
+    bool isSubscribed(void) const { return !m_liveMonitors.empty(); }
+    void pushLiveFrames(void);
+
   private:
     string getZMSetting(const string &setting);
-    bool send(const string s) const;
-    bool send(const string s, const unsigned char *buffer, int dataLen) const;
+    bool send(const string s);
+    bool send(const string s, const unsigned char *buffer, int dataLen);
+    bool sendLater(const string s, const unsigned char *buffer, int dataLen);
+    bool flushPending(bool block);
     void sendError(string error);
     void getMonitorList(void);
     void initMonitor(MONITOR *monitor);
-    int  getFrame(unsigned char *buffer, int bufferSize, MONITOR *monitor);
+    unsigned char *getFrame(MONITOR *monitor);
+    int  scaleFrame(const unsigned char *data, MONITOR *monitor, int scale);
     long long getDiskSpace(const string &filename, long long &total, long long &used);
     void tokenize(const string &command, vector<string> &tokens);
     void handleHello(void);
@@ -177,6 +184,8 @@ class ZMServer
     void handleGetEventFrame(vector<string> tokens);
     void handleGetAnalyseFrame(vector<string> tokens);
     void handleGetLiveFrame(vector<string> tokens);
+    void handleSubscribeLiveFrames(vector<string> tokens);
+    void handleUnsubscribeLiveFrames(void);
     void handleGetFrameList(vector<string> tokens);
     void handleDeleteEvent(vector<string> tokens);
     void handleDeleteEventList(vector<string> tokens);
@@ -192,6 +201,12 @@ class ZMServer
     string               m_eventFileFormat;
     string               m_analyseFileFormat;
     key_t                m_shmKey;
+    vector<int>          m_liveMonitors;
+    int                  m_liveScale;
+    vector<unsigned char> m_scaleBuffer;
+    // the part of a pushed frame the client hasn't taken yet
+    vector<unsigned char> m_pending;
+    size_t               m_pendingPos;
 };
 
 
@@ -18,7 +18,7 @@
 #include "zmclient.h"
 
 // the protocol version we understand
-#define ZM_PROTOCOL_VERSION "6"
+#define ZM_PROTOCOL_VERSION "7"
 
 #define BUFFER_SIZE  (2048*1536*3)
 
@@ -26,6 +26,7 @@ ZMClient::ZMClient()
     : QObject(NULL),
       m_socket(NULL),
       m_socketLock(QMutex::Recursive),
+      m_liveSocket(NULL),
       m_hostname("localhost"),
       m_port(6548),
       m_bConnected(false),
@@ -233,6 +234,8 @@ void ZMClient::shutdown()
     if (m_socket)
         m_socket->close();
 
+    unsubscribeLiveFrames();
+
     m_zmclientReady = false;
     m_bConnected = false;
 }
@@ -247,6 +250,8 @@ ZMClient::~ZMClient()
         m_zmclientReady = false;
     }
 
+    unsubscribeLiveFrames();
+
     if (m_retryTimer)
         delete m_retryTimer;
 }
@@ -449,7 +454,8 @@ void ZMClient::deleteEventList(vector<Event*> *eventList)
     sendReceiveStringList(strList);
 }
 
-bool ZMClient::readData(unsigned char *data, int dataSize)
+bool ZMClient::readData(MythSocket *socket, unsigned char *data,
+                        int dataSize)
 {
     qint64 read = 0;
     int errmsgtime = 0;
@@ -459,7 +465,7 @@ bool ZMClient::readData(unsigned char *data, int dataSize)
 
     while (dataSize > 0)
     {
-        qint64 sret = m_socket->readBlock((char*) data + read, dataSize);
+        qint64 sret = socket->readBlock((char*) data + read, dataSize);
         if (sret > 0)
         {
             read += sret;
@@ -469,18 +475,18 @@ bool ZMClient::readData(unsigned char *data, int dataSize)
                 timer.start();
             }
         }
-        else if (sret < 0 && m_socket->error() != MSocketDevice::NoError)
+        else if (sret < 0 && socket->error() != MSocketDevice::NoError)
         {
             LOG(VB_GENERAL, LOG_ERR, QString("readData: Error, readBlock %1")
-                    .arg(m_socket->errorToString()));
-            m_socket->close();
+                    .arg(socket->errorToString()));
+            socket->close();
             return false;
         }
-        else if (!m_socket->isValid())
+        else if (!socket->isValid())
         {
             LOG(VB_GENERAL, LOG_ERR,
                 "readData: Error, socket went unconnected");
-            m_socket->close();
+            socket->close();
             return false;
         }
         else
@@ -530,7 +536,7 @@ void ZMClient::getEventFrame(int monitorID, int eventID, int frameNo, MythImage
 
     // grab the image data
     unsigned char *data = new unsigned char[imageSize];
-    if (!readData(data, imageSize))
+    if (!readData(m_socket, data, imageSize))
     {
         LOG(VB_GENERAL, LOG_ERR,
             "ZMClient::getEventFrame(): Failed to get image data");
@@ -569,7 +575,7 @@ void ZMClient::getAnalyseFrame(int monitorID, int eventID, int frameNo, QImage &
 
     // grab the image data
     unsigned char *data = new unsigned char[imageSize];
-    if (!readData(data, imageSize))
+    if (!readData(m_socket, data, imageSize))
     {
         LOG(VB_GENERAL, LOG_ERR,
             "ZMClient::getAnalyseFrame(): Failed to get image data");
@@ -623,7 +629,7 @@ int ZMClient::getLiveFrame(int monitorID, QString &status, unsigned char* buffer
     if (imageSize == 0)
         return 0;
 
-    if (!readData(buffer, imageSize))
+    if (!readData(m_socket, buffer, imageSize))
     {
         LOG(VB_GENERAL, LOG_ERR,
             "ZMClient::getLiveFrame(): Failed to get image data");
@@ -633,6 +639,106 @@ int ZMClient::getLiveFrame(int monitorID, QString &status, unsigned char* buffer
     return imageSize;
 }
 
+/** \brief Asks the server to push frames from the monitors as they arrive.
+ *
+ *   The frames come over a connection of their own so they don't get
+ *   mixed up with the replies to other requests, read them with
+ *   readLiveFrame(). A scale above 1 has the server shrink the frames
+ *   by that factor first.
+ */
+bool ZMClient::subscribeLiveFrames(const QList<int> &monitors, int scale)
+{
+    unsubscribeLiveFrames();
+
+    if (!m_bConnected || monitors.isEmpty())
+        return false;
+
+    m_liveSocket = new MythSocket();
+    if (!m_liveSocket->connect(m_hostname, m_port))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient: Failed to connect for live frames");
+        unsubscribeLiveFrames();
+        return false;
+    }
+
+    QStringList strList("SUBSCRIBE_LIVE_FRAMES");
+    strList << QString::number(scale);
+    for (int x = 0; x < monitors.count(); x++)
+        strList << QString::number(monitors[x]);
+
+    if (!m_liveSocket->writeStringList(strList) ||
+        !m_liveSocket->readStringList(strList, false) ||
+        strList.isEmpty() || strList[0] != "OK")
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("ZMClient: Failed to subscribe to live frames - %1")
+                .arg(strList.isEmpty() ? QString() : strList[0]));
+        unsubscribeLiveFrames();
+        return false;
+    }
+
+    return true;
+}
+
+void ZMClient::unsubscribeLiveFrames(void)
+{
+    if (m_liveSocket)
+    {
+        // the server drops the subscription when the connection closes
+        m_liveSocket->close();
+        m_liveSocket->DownRef();
+        m_liveSocket = NULL;
+    }
+}
+
+/** \brief Reads the next frame pushed by the server.
+ *  \return The size of the frame, 0 if none is waiting or on error.
+ */
+int ZMClient::readLiveFrame(int &monitorID, QString &status, int &width,
+                            int &height, unsigned char *buffer, int bufferSize)
+{
+    if (!m_liveSocket || m_liveSocket->bytesAvailable() <= 0)
+        return 0;
+
+    QStringList strList;
+    if (!m_liveSocket->readStringList(strList, false) ||
+        strList.size() < 6 || strList[0] != "LIVE_FRAME")
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient::readLiveFrame(): Bad live frame header");
+        unsubscribeLiveFrames();
+        return 0;
+    }
+
+    monitorID = strList[1].toInt();
+    status = strList[2];
+    width = strList[3].toInt();
+    height = strList[4].toInt();
+    int imageSize = strList[5].toInt();
+
+    if (bufferSize < imageSize)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient::readLiveFrame(): Live frame buffer is too small!");
+        unsubscribeLiveFrames();
+        return 0;
+    }
+
+    if (imageSize == 0)
+        return 0;
+
+    if (!readData(m_liveSocket, buffer, imageSize))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "ZMClient::readLiveFrame(): Failed to get image data");
+        unsubscribeLiveFrames();
+        return 0;
+    }
+
+    return imageSize;
+}
+
 void ZMClient::getCameraList(QStringList &cameraList)
 {
     cameraList.clear();
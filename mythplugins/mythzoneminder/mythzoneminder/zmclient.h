@@ -46,6 +46,11 @@ class MPUBLIC ZMClient : public QObject
     void getEventFrame(int monitorID, int eventID, int frameNo, MythImage **image);
     void getAnalyseFrame(int monitorID, int eventID, int frameNo, QImage &image);
     int  getLiveFrame(int monitorID, QString &status, unsigned char* buffer, int bufferSize);
+    bool subscribeLiveFrames(const QList<int> &monitors, int scale);
+    void unsubscribeLiveFrames(void);
+    bool isSubscribed(void) { return m_liveSocket != NULL; }
+    int  readLiveFrame(int &monitorID, QString &status, int &width, int &height,
+                       unsigned char *buffer, int bufferSize);
     void getFrameList(int eventID, vector<Frame*> *frameList);
     void deleteEvent(int eventID);
     void deleteEventList(vector<Event*> *eventList);
@@ -60,11 +65,12 @@ class MPUBLIC ZMClient : public QObject
     void restartConnection(void);  // Try to re-establish the connection to 
                                    // ZMServer every 10 seconds
   private:
-    bool readData(unsigned char *data, int dataSize);
+    bool readData(MythSocket *socket, unsigned char *data, int dataSize);
     bool sendReceiveStringList(QStringList &strList);
 
     MythSocket       *m_socket;
     QMutex            m_socketLock;
+    MythSocket       *m_liveSocket;  // Frames pushed by the server
     QString           m_hostname;
     uint              m_port;
     bool              m_bConnected;
@@ -31,6 +31,7 @@
 #define MAX_IMAGE_SIZE  (2048*1536*3)
 
 const int FRAME_UPDATE_TIME = 1000 / 10;  // try to update the frame 10 times a second
+const int LIVE_FRAME_CHECK_TIME = 1000 / 25; // look for pushed frames 25 times a second
 
 ZMLivePlayer::ZMLivePlayer(MythScreenStack *parent)
              :MythScreenType(parent, "zmliveview")
@@ -133,6 +134,9 @@ bool ZMLivePlayer::initMonitorLayout()
 
 ZMLivePlayer::~ZMLivePlayer()
 {
+    if (class ZMClient *zm = ZMClient::get())
+        zm->unsubscribeLiveFrames();
+
     gCoreContext->SaveSetting("ZoneMinderLiveLayout", m_monitorLayout);
 
     GetMythUI()->DoRestoreScreensaver();
@@ -181,12 +185,15 @@ bool ZMLivePlayer::keyPressEvent(QKeyEvent *event)
         {
             if (m_paused)
             {
-                m_frameTimer->start(FRAME_UPDATE_TIME);
                 m_paused = false;
+                subscribeLiveFrames();
+                m_frameTimer->start(FRAME_UPDATE_TIME);
             }
             else
             {
                 m_frameTimer->stop();
+                if (class ZMClient *zm = ZMClient::get())
+                    zm->unsubscribeLiveFrames();
                 m_paused = true;
             }
         }
@@ -245,9 +252,37 @@ void ZMLivePlayer::changePlayerMonitor(int playerNo)
     m_players->at(playerNo - 1)->setMonitor(mon);
     m_players->at(playerNo - 1)->updateCamera();
 
+    subscribeLiveFrames();
     m_frameTimer->start(FRAME_UPDATE_TIME);
 }
 
+/// Has the server push frames for the monitors being shown, shrunk
+/// to suit the layout. Without it we fall back to asking for them.
+void ZMLivePlayer::subscribeLiveFrames(void)
+{
+    class ZMClient *zm = ZMClient::get();
+    if (!zm || !m_players || m_paused)
+        return;
+
+    QList<int> monList;
+    vector<Player*>::iterator i = m_players->begin();
+    for (; i != m_players->end(); i++)
+    {
+        if (!monList.contains((*i)->getMonitor()->id))
+            monList.append((*i)->getMonitor()->id);
+    }
+
+    int scale = 1;
+    if (m_monitorCount >= 9)
+        scale = 3;
+    else if (m_monitorCount >= 4)
+        scale = 2;
+
+    if (!zm->subscribeLiveFrames(monList, scale))
+        LOG(VB_GENERAL, LOG_NOTICE,
+            "Live frames not pushed by the server, asking for them instead");
+}
+
 void ZMLivePlayer::updateFrame()
 {
     class ZMClient *zm = ZMClient::get();
@@ -257,6 +292,38 @@ void ZMLivePlayer::updateFrame()
     static unsigned char buffer[MAX_IMAGE_SIZE];
     m_frameTimer->stop();
 
+    if (zm->isSubscribed())
+    {
+        // show what the server has pushed since we last looked, but no
+        // more than a couple of frames per camera so the UI keeps up,
+        // the server drops frames while we are behind
+        int monitorID, width, height;
+        QString status;
+        uint maxFrames = 2 * m_players->size();
+        for (uint frames = 0; frames < maxFrames &&
+             zm->readLiveFrame(monitorID, status, width, height,
+                               buffer, sizeof(buffer)) > 0; frames++)
+        {
+            vector<Player*>::iterator i = m_players->begin();
+            for (; i != m_players->end(); i++)
+            {
+                Player *p = *i;
+                if (p->getMonitor()->id == monitorID)
+                {
+                    if (p->getMonitor()->status != status)
+                    {
+                        p->getMonitor()->status = status;
+                        p->updateStatus();
+                    }
+                    p->updateFrame(buffer, width, height);
+                }
+            }
+        }
+
+        m_frameTimer->start(LIVE_FRAME_CHECK_TIME);
+        return;
+    }
+
     // get a list of monitor id's that need updating
     QList<int> monList;
     Player *p;
@@ -288,7 +355,8 @@ void ZMLivePlayer::updateFrame()
                         p->getMonitor()->status = status;
                         p->updateStatus();
                     }
-                    p->updateFrame(buffer);
+                    p->updateFrame(buffer, p->getMonitor()->width,
+                                   p->getMonitor()->height);
                 }
             }
         }
@@ -371,6 +439,7 @@ void ZMLivePlayer::setMonitorLayout(int layout, bool restore)
             monitorNo = 1;
     }
 
+    subscribeLiveFrames();
     updateFrame();
 }
 
@@ -428,16 +497,20 @@ void Player::setWidgets(MythUIImage *image, MythUIText *status, MythUIText  *cam
         m_cameraText->SetVisible(true);
 }
 
-void Player::updateFrame(const unsigned char* buffer)
+void Player::updateFrame(const unsigned char* buffer, int width, int height)
 {
     unsigned int pos_data;
     unsigned int pos_rgba = 0;
     unsigned int r,g,b;
 
+    // frames are never bigger than the monitor, they may be shrunk
+    if (width * height > m_monitor.width * m_monitor.height)
+        return;
+
     if (m_monitor.palette == MP_GREY)
     {
         // grey palette
-        for (pos_data = 0; pos_data < (unsigned int) (m_monitor.width * m_monitor.height); )
+        for (pos_data = 0; pos_data < (unsigned int) (width * height); )
         {
             m_rgba[pos_rgba++] = buffer[pos_data];   //b
             m_rgba[pos_rgba++] = buffer[pos_data];   //g
@@ -448,7 +521,7 @@ void Player::updateFrame(const unsigned char* buffer)
     else
     {
         // all other color palettes
-        for (pos_data = 0; pos_data < (unsigned int) (m_monitor.width * m_monitor.height * 3); )
+        for (pos_data = 0; pos_data < (unsigned int) (width * height * 3); )
         {
             r = buffer[pos_data++];
             g = buffer[pos_data++];
@@ -470,7 +543,7 @@ void Player::updateFrame(const unsigned char* buffer)
         }
     }
 
-    QImage image(m_rgba, m_monitor.width, m_monitor.height, QImage::Format_ARGB32);
+    QImage image(m_rgba, width, height, QImage::Format_ARGB32);
 
     if (m_image)
     {
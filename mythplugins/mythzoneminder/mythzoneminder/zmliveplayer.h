@@ -36,7 +36,7 @@ class Player
     Player(void);
     ~Player(void);
 
-    void updateFrame(const uchar* buffer);
+    void updateFrame(const uchar* buffer, int width, int height);
     void updateStatus(void);
     void updateCamera();
 
@@ -84,6 +84,7 @@ class ZMLivePlayer : public MythScreenType
     bool hideAll();
     void stopPlayers(void);
     void changePlayerMonitor(int playerNo);
+    void subscribeLiveFrames(void);
 
     QTimer               *m_frameTimer;
     bool                  m_paused;
@@ -106,8 +106,8 @@ package MythTV;
 # Note: as of July 21, 2010, this is actually a string, to account for proto
 # versions of the form "58a".  This will get used if protocol versions are 
 # changed on a fixes branch ongoing.
-    our $PROTO_VERSION = "69";
-    our $PROTO_TOKEN = "63835135";
+    our $PROTO_VERSION = "71";
+    our $PROTO_TOKEN = "05e82186";
 
 # currentDatabaseVersion is defined in libmythtv in
 # mythtv/libs/libmythtv/dbcheck.cpp and should be the current MythTV core
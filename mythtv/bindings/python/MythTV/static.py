@@ -8,8 +8,8 @@ OWN_VERSION = (0,25,-1,2)
 SCHEMA_VERSION = 1280
 NVSCHEMA_VERSION = 1007
 MUSICSCHEMA_VERSION = 1018
-PROTO_VERSION = '69'
-PROTO_TOKEN = '63835135'
+PROTO_VERSION = '71'
+PROTO_TOKEN = '05e82186'
 BACKEND_SEP = '[]:[]'
 INSTALL_PREFIX = '/usr/local'
 
@@ -0,0 +1,201 @@
+/*
+ * Benchmark for the DSMCC object carousel cache
+ * Feeds the carousel sections of one PID of a recorded multiplex to the
+ * Dsmcc object the MHEG engine uses, reports how far into the capture
+ * each requested object became available (the page load latency) and
+ * then times repeated lookups of those objects.
+ * compile with g++ -O2 -o dsmccbench dsmccbench.cpp \
+ *     `pkg-config --cflags --libs QtCore QtSql QtNetwork QtGui` \
+ *     -I../../../libs/libmythtv -I../../../libs/libmythbase \
+ *     -I../../../libs/libmyth -I../../../libs -I../../.. \
+ *     -L../../../libs/libmythtv -L../../../libs/libmythbase \
+ *     -L../../../libs/libmyth \
+ *     -lmythtv-0.24 -lmyth-0.24 -lmythbase-0.24
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+#include <QTime>
+
+#include "dsmcc.h"
+
+#define TS_PACKET_SIZE  188
+#define UK_PROFILE      0x0106
+#define DEFAULT_PATH    "//a"
+#define DEFAULT_LOOKUPS 100000
+
+/* Reassembles the private sections carried on one PID */
+class SectionAssembler
+{
+  public:
+    SectionAssembler(Dsmcc *dsmcc, int tag, unsigned carouselId) :
+        m_dsmcc(dsmcc), m_tag(tag), m_carouselId(carouselId),
+        m_synced(false), m_sections(0) {}
+
+    void AddPacket(const unsigned char *pkt)
+    {
+        bool start = pkt[1] & 0x40;
+        int  afc   = (pkt[3] >> 4) & 0x3;
+        int  off   = 4;
+
+        if (!(afc & 0x1))
+            return; // No payload
+        if (afc & 0x2)
+            off += 1 + pkt[4];
+        if (off >= TS_PACKET_SIZE)
+            return;
+
+        if (start)
+        {
+            int pointer = pkt[off++];
+            if (m_synced && off + pointer <= TS_PACKET_SIZE)
+                Append(pkt + off, pointer);
+            m_buf.clear();
+            m_synced = true;
+            off += pointer;
+        }
+
+        if (m_synced && off < TS_PACKET_SIZE)
+            Append(pkt + off, TS_PACKET_SIZE - off);
+    }
+
+    uint Sections(void) const { return m_sections; }
+
+  private:
+    void Append(const unsigned char *data, int len)
+    {
+        m_buf.append((const char*)data, len);
+
+        // Hand over every complete section in the buffer
+        while (m_buf.size() >= 3 && (unsigned char)m_buf[0] != 0xff)
+        {
+            const unsigned char *sec = (const unsigned char*)m_buf.constData();
+            int seclen = 3 + (((sec[1] & 0x0f) << 8) | sec[2]);
+            if (m_buf.size() < seclen)
+                return;
+
+            m_dsmcc->ProcessSection(sec, seclen, m_tag, m_carouselId,
+                                    UK_PROFILE);
+            m_sections++;
+            m_buf.remove(0, seclen);
+        }
+
+        if (!m_buf.isEmpty() && (unsigned char)m_buf[0] == 0xff)
+            m_buf.clear(); // Stuffing up to the next section start
+    }
+
+    Dsmcc     *m_dsmcc;
+    int        m_tag;
+    unsigned   m_carouselId;
+    bool       m_synced;
+    uint       m_sections;
+    QByteArray m_buf;
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 5)
+    {
+        fprintf(stderr, "\nUsage:\n\n%s <capture.ts> <pid> <component tag> "
+                "<carousel id> [object path...]\n\nLoads '%s' by default, "
+                "then looks each object up %d times.\n\n",
+                argv[0], DEFAULT_PATH, DEFAULT_LOOKUPS);
+        return 1;
+    }
+
+    QFile file(argv[1]);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        fprintf(stderr, "Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    int      pid        = strtol(argv[2], NULL, 0);
+    int      tag        = strtol(argv[3], NULL, 0);
+    unsigned carouselId = strtoul(argv[4], NULL, 0);
+
+    QStringList paths;
+    for (int i = 5; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths.push_back(DEFAULT_PATH);
+
+    QVector<QStringList> objects;
+    for (int i = 0; i < paths.size(); i++)
+        objects.push_back(paths[i].split('/', QString::SkipEmptyParts));
+
+    Dsmcc dsmcc;
+    dsmcc.AddTap(tag, carouselId);
+    SectionAssembler assembler(&dsmcc, tag, carouselId);
+
+    QVector<bool> loaded(objects.size(), false);
+    int remaining = objects.size();
+    qint64 offset = 0;
+    QByteArray result;
+    QTime timer;
+    timer.start();
+
+    unsigned char pkt[TS_PACKET_SIZE];
+    while (remaining &&
+           file.read((char*)pkt, TS_PACKET_SIZE) == TS_PACKET_SIZE)
+    {
+        offset += TS_PACKET_SIZE;
+        if (pkt[0] != 0x47 || (((pkt[1] & 0x1f) << 8) | pkt[2]) != pid)
+            continue;
+
+        uint before = assembler.Sections();
+        assembler.AddPacket(pkt);
+        if (assembler.Sections() == before)
+            continue;
+
+        for (int i = 0; i < objects.size(); i++)
+        {
+            if (loaded[i] || dsmcc.GetDSMCCObject(objects[i], result) != 0)
+                continue;
+
+            loaded[i] = true;
+            remaining--;
+            printf("%s: %d bytes after %lld KB of capture, %d sections, "
+                   "%d ms\n", paths[i].toLocal8Bit().constData(),
+                   result.size(), offset / 1024, assembler.Sections(),
+                   timer.elapsed());
+        }
+    }
+
+    for (int i = 0; i < objects.size(); i++)
+    {
+        if (!loaded[i])
+        {
+            printf("%s: not found in %lld KB of capture\n",
+                   paths[i].toLocal8Bit().constData(), offset / 1024);
+        }
+    }
+
+    if (remaining == objects.size())
+        return 1;
+
+    timer.restart();
+    for (int n = 0; n < DEFAULT_LOOKUPS; n++)
+    {
+        for (int i = 0; i < objects.size(); i++)
+        {
+            if (loaded[i])
+                dsmcc.GetDSMCCObject(objects[i], result);
+        }
+    }
+    int msecs = timer.elapsed();
+
+    printf("%d lookups of %d objects in %d ms, %.3f us per lookup\n",
+           DEFAULT_LOOKUPS, objects.size() - remaining, msecs,
+           (msecs * 1000.0) / DEFAULT_LOOKUPS / (objects.size() - remaining));
+
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * Benchmark for MythTV video filter chains
+ * Runs a chain of filters over raw YV12 (yuv420p) frames and reports the
+ * speed of each filter in frames per second.
+ * See mythtv/filters/README for more information
+ * compile with gcc -O2 -o filterbench filterbench.c \
+ *     -I../../../libs/libmythtv -I../../../libs/libmythbase \
+ *     -ldl -lpthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "filter.h"
+#include "frame.h"
+
+#define MAX_FILTERS 16
+#define DEFAULT_FILTER_DIR "/usr/local/lib/mythtv/filters"
+
+/* Slice executor, the equivalent of libmythtv's FilterSlicePool */
+typedef struct SlicePool
+{
+    FilterSliceExecutor executor;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  job_cond;
+    pthread_cond_t  done_cond;
+    pthread_t      *workers;
+    int             nworkers;
+    int             stop;
+    unsigned        generation;
+
+    filter_slice_fn func;
+    VideoFilter    *vf;
+    VideoFrame     *frame;
+    int             field;
+    int             nslices;
+    int             next_slice;
+    int             remaining;
+} SlicePool;
+
+typedef struct BenchFilter
+{
+    VideoFilter *vf;
+    void        *handle;
+    char         name[64];
+    double       seconds;
+} BenchFilter;
+
+static void run_slices(SlicePool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (pool->func && pool->next_slice < pool->nslices)
+    {
+        filter_slice_fn func  = pool->func;
+        VideoFilter    *vf    = pool->vf;
+        VideoFrame     *frame = pool->frame;
+        int             field = pool->field;
+        int           nslices = pool->nslices;
+        int             slice = pool->next_slice++;
+
+        pthread_mutex_unlock(&pool->lock);
+        func(vf, frame, field, slice, nslices);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->remaining == 0)
+            pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void *slice_worker(void *arg)
+{
+    SlicePool *pool = (SlicePool *)arg;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop)
+    {
+        if (seen == pool->generation)
+        {
+            pthread_cond_wait(&pool->job_cond, &pool->lock);
+            continue;
+        }
+        seen = pool->generation;
+
+        pthread_mutex_unlock(&pool->lock);
+        run_slices(pool);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void pool_execute(FilterSliceExecutor *executor, filter_slice_fn func,
+                         VideoFilter *vf, VideoFrame *frame, int field,
+                         int nslices)
+{
+    SlicePool *pool = (SlicePool *)executor;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->func       = func;
+    pool->vf         = vf;
+    pool->frame      = frame;
+    pool->field      = field;
+    pool->nslices    = nslices;
+    pool->next_slice = 0;
+    pool->remaining  = nslices;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->job_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_slices(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->remaining > 0)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pool->func = NULL;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static int pool_init(SlicePool *pool, int threads)
+{
+    int i;
+
+    memset(pool, 0, sizeof(SlicePool));
+    pool->executor.execute = &pool_execute;
+    pool->executor.threads = threads;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    if (threads < 2)
+        return 1;
+
+    pool->workers = calloc(threads - 1, sizeof(pthread_t));
+    if (!pool->workers)
+        return 0;
+
+    for (i = 0; i < threads - 1; i++)
+    {
+        if (pthread_create(&pool->workers[i], NULL, slice_worker, pool))
+            return 0;
+        pool->nworkers++;
+    }
+    return 1;
+}
+
+static void pool_cleanup(SlicePool *pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->job_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nworkers; i++)
+        pthread_join(pool->workers[i], NULL);
+    free(pool->workers);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * .000000001;
+}
+
+static int load_filter(BenchFilter *bf, const char *dir, char *spec,
+                       int *width, int *height, int threads,
+                       FilterSliceExecutor *executor)
+{
+    char path[4096];
+    char *opts = strchr(spec, '=');
+    struct dirent *entry;
+    DIR *d;
+
+    if (opts)
+        *opts++ = '\0';
+    snprintf(bf->name, sizeof(bf->name), "%s", spec);
+
+    d = opendir(dir);
+    if (!d)
+    {
+        fprintf(stderr, "Can't open filter directory '%s'\n", dir);
+        return 0;
+    }
+
+    while ((entry = readdir(d)))
+    {
+        const ConstFilterInfo *info;
+        void *handle;
+
+        if (entry->d_name[0] == '.')
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        handle = dlopen(path, RTLD_NOW);
+        if (!handle)
+            continue;
+
+        info = (const ConstFilterInfo *)dlsym(handle, "filter_table");
+        for (; info && info->filter_init; info++)
+        {
+            if (strcmp(info->name, spec))
+                continue;
+
+            bf->vf = info->filter_init(FMT_YV12, FMT_YV12, width, height,
+                                       opts, threads);
+            if (!bf->vf)
+            {
+                fprintf(stderr, "Filter '%s' failed to initialize\n", spec);
+                dlclose(handle);
+                closedir(d);
+                return 0;
+            }
+
+            bf->handle        = handle;
+            bf->vf->handle    = handle;
+            bf->vf->inpixfmt  = FMT_YV12;
+            bf->vf->outpixfmt = FMT_YV12;
+            bf->vf->opts      = opts;
+            bf->vf->info      = NULL;
+            bf->vf->executor  = executor;
+            closedir(d);
+            return 1;
+        }
+        dlclose(handle);
+    }
+    closedir(d);
+
+    fprintf(stderr, "Filter '%s' not found in '%s'\n", spec, dir);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "\nUsage:\n\n"
+            "%s [-t threads] [-n frames] [-d filterdir] [-2]\n"
+            "    -s <width>x<height> <input.yuv> <filter[=opts][,filter...]>\n\n"
+            "Runs the filter chain over the raw YV12 (yuv420p) frames in the\n"
+            "input file, rewinding it until the requested number of frames\n"
+            "has been processed, and reports the speed of each filter.  -2\n"
+            "calls the chain once per field, as the player does for double\n"
+            "rate deinterlacers.  The default filter directory is\n"
+            "%s.\n\n", prog, DEFAULT_FILTER_DIR);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = DEFAULT_FILTER_DIR;
+    BenchFilter filters[MAX_FILTERS];
+    int nfilters = 0, threads = 1, frames = 300, fields = 1;
+    int width = 0, height = 0, fwidth, fheight;
+    int i, f, field, opt, done, size;
+    double total = 0.0, start;
+    SlicePool pool;
+    VideoFrame frame;
+    char *chain, *spec, *save = NULL;
+    FILE *in;
+
+    while ((opt = getopt(argc, argv, "t:n:d:s:2")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': threads = atoi(optarg); break;
+            case 'n': frames = atoi(optarg); break;
+            case 'd': dir = optarg; break;
+            case 's': sscanf(optarg, "%dx%d", &width, &height); break;
+            case '2': fields = 2; break;
+            default: usage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2 || width < 16 || height < 16 || frames < 1 ||
+        threads < 1)
+        usage(argv[0]);
+
+    in = fopen(argv[optind], "rb");
+    if (!in)
+    {
+        fprintf(stderr, "Can't open input file '%s'\n", argv[optind]);
+        return 1;
+    }
+
+    if (!pool_init(&pool, threads))
+    {
+        fprintf(stderr, "Failed to start %d slice threads\n", threads);
+        return 1;
+    }
+
+    fwidth  = width;
+    fheight = height;
+    chain = strdup(argv[optind + 1]);
+    for (spec = strtok_r(chain, ",", &save); spec;
+         spec = strtok_r(NULL, ",", &save))
+    {
+        if (nfilters == MAX_FILTERS)
+        {
+            fprintf(stderr, "Too many filters, at most %d are supported\n",
+                    MAX_FILTERS);
+            return 1;
+        }
+        memset(&filters[nfilters], 0, sizeof(BenchFilter));
+        if (!load_filter(&filters[nfilters], dir, spec, &fwidth, &fheight,
+                         threads, &pool.executor))
+            return 1;
+        if (fwidth != width || fheight != height)
+        {
+            fprintf(stderr, "Filter '%s' changes the frame size, which is "
+                    "not supported\n", filters[nfilters].name);
+            return 1;
+        }
+        nfilters++;
+    }
+
+    size = width * height * 3 / 2;
+    memset(&frame, 0, sizeof(VideoFrame));
+    frame.codec      = FMT_YV12;
+    frame.buf        = malloc(size + 64);
+    frame.width      = width;
+    frame.height     = height;
+    frame.aspect     = (float)width / height;
+    frame.frame_rate = 25.0;
+    frame.bpp        = 12;
+    frame.size       = size;
+    frame.interlaced_frame = 1;
+    frame.top_field_first  = 1;
+    frame.pitches[0] = width;
+    frame.pitches[1] = width >> 1;
+    frame.pitches[2] = width >> 1;
+    frame.offsets[0] = 0;
+    frame.offsets[1] = width * height;
+    frame.offsets[2] = width * height * 5 / 4;
+
+    if (!frame.buf)
+    {
+        fprintf(stderr, "Couldn't allocate memory for frame\n");
+        return 1;
+    }
+
+    for (done = 0; done < frames; done++)
+    {
+        if (fread(frame.buf, size, 1, in) != 1)
+        {
+            rewind(in);
+            if (fread(frame.buf, size, 1, in) != 1)
+            {
+                fprintf(stderr, "Input holds less than one %dx%d frame\n",
+                        width, height);
+                return 1;
+            }
+        }
+        frame.frameNumber = done;
+        frame.timecode    = done * 40;
+
+        for (field = 0; field < fields; field++)
+        {
+            for (f = 0; f < nfilters; f++)
+            {
+                VideoFilter *vf = filters[f].vf;
+                if (!vf->filter)
+                    continue;
+                start = now();
+                vf->filter(vf, &frame, field);
+                filters[f].seconds += now() - start;
+            }
+        }
+    }
+
+    printf("%d frames of %dx%d with %d slice thread%s\n", frames,
+           width, height, threads, threads > 1 ? "s" : "");
+    for (i = 0; i < nfilters; i++)
+    {
+        total += filters[i].seconds;
+        if (filters[i].seconds > 0.0)
+        {
+            printf("  %-24s %10.2f fps  %8.3f ms/frame\n", filters[i].name,
+                   frames / filters[i].seconds,
+                   filters[i].seconds * 1000.0 / frames);
+        }
+        else
+        {
+            printf("  %-24s %10s\n", filters[i].name, "removed");
+        }
+    }
+    if (total > 0.0)
+    {
+        printf("  %-24s %10.2f fps  %8.3f ms/frame\n", "chain",
+               frames / total, total * 1000.0 / frames);
+    }
+
+    for (i = 0; i < nfilters; i++)
+    {
+        if (filters[i].vf->cleanup)
+            filters[i].vf->cleanup(filters[i].vf);
+        free(filters[i].vf);
+        dlclose(filters[i].handle);
+    }
+    pool_cleanup(&pool);
+    free(frame.buf);
+    free(chain);
+    fclose(in);
+
+    return 0;
+}
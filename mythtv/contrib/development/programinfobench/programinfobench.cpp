@@ -0,0 +1,126 @@
+/*
+ * Benchmark for ProgramInfo::Compact()
+ * Builds a list of recordings like the frontend's recording list, with
+ * every string allocated separately as it is when read from the database
+ * or the network, and reports the memory it takes. Run it once with
+ * "plain" and once with "compact" to compare the memory taken without and
+ * with the repeated values shared through Compact().
+ * compile with g++ -O2 -o programinfobench programinfobench.cpp \
+ *     `pkg-config --cflags --libs QtCore QtSql QtNetwork QtGui` \
+ *     -I../../../libs/libmyth -I../../../libs/libmythbase \
+ *     -I../../../libs -I../../.. \
+ *     -L../../../libs/libmyth -L../../../libs/libmythbase \
+ *     -lmyth-0.24 -lmythbase-0.24
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QTime>
+
+#include "programinfo.h"
+
+#define DEFAULT_PROGRAMS 50000
+
+/* Resident set size in KB, Linux only */
+static long rss_kb(void)
+{
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+        return 0;
+
+    return fields[1].toLong() * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void fill_programs(ProgramList &list, int count, bool compact)
+{
+    QDateTime start = QDateTime::currentDateTime();
+    start.setTime(QTime(start.time().hour(), 0));
+
+    for (int i = 0; i < count; i++)
+    {
+        // Recordings cluster on few start times, channels and series
+        QDateTime startts = start.addSecs(-(i / 20) * 1800);
+        QDateTime endts   = startts.addSecs(1800);
+        int chan = i % 200;
+
+        ProgramInfo *pginfo = new ProgramInfo(
+            QString("Program title %1").arg(i % 500),
+            QString("Episode \"%1\"").arg(i),
+            QString("A description of about the usual length, long "
+                    "enough to matter, number %1.").arg(i),
+            i % 10, i % 24,
+            QString("Drama"),
+
+            1000 + chan, QString::number(chan),
+            QString("CHAN%1").arg(chan), QString("Channel %1").arg(chan),
+            QString(),
+
+            QString("Default"), QString("Default"),
+
+            QString("%1_%2.mpg").arg(1000 + chan)
+                .arg(startts.toString("yyyyMMddhhmmss")),
+
+            QString("backend"), QString("Default"),
+
+            QString("EP%1").arg(i % 500, 8, 10, QChar('0')),
+            QString("EP%1").arg(i, 12, 10, QChar('0')),
+            QString("ttvdb.py_%1").arg(70000 + i % 500),
+
+            0, 1000000000ULL,
+
+            QDateTime(startts), QDateTime(endts),
+            QDateTime(startts), QDateTime(endts),
+
+            0.0f, 0, QDate(), QDateTime(endts),
+
+            rsRecorded, 0, kDupsInAll, kDupCheckSubDesc, 0, 0, 0, 0, 0);
+
+        if (compact)
+            pginfo->Compact();
+
+        list.push_back(pginfo);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    // Freed memory is not returned to the system reliably, so each
+    // variant has to be measured in a process of its own
+    bool compact = (argc < 2) || QString(argv[1]) != "plain";
+    int  count   = (argc > 2) ? atoi(argv[2]) : DEFAULT_PROGRAMS;
+    if ((argc > 1 && QString(argv[1]) != "plain" &&
+         QString(argv[1]) != "compact") || count <= 0)
+    {
+        fprintf(stderr, "\nUsage:\n\n%s [plain|compact] [programs]\n\n"
+                "Builds %d compacted recordings by default.\n\n",
+                argv[0], DEFAULT_PROGRAMS);
+        return 1;
+    }
+
+    ProgramList list;
+    long before = rss_kb();
+    QTime timer;
+    timer.start();
+
+    fill_programs(list, count, compact);
+
+    int msecs = timer.elapsed();
+    long used = rss_kb() - before;
+
+    printf("%s: %d programs in %d ms, %ld KB, %ld bytes per program\n",
+           compact ? "compact" : "plain", count, msecs, used,
+           used * 1024 / count);
+
+    return 0;
+}
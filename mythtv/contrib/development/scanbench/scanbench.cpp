@@ -0,0 +1,181 @@
+/*
+ * Benchmark for the channel scanner
+ * Scans a directory of captured multiplexes, named "<frequency>.ts", with
+ * the TSFileChannel in place of a tuner and reports how long it took and
+ * what was found. With more than one input the transports are split
+ * across them by the ScanCoordinator, as they are for idle tuners.
+ * compile with g++ -O2 -o scanbench scanbench.cpp \
+ *     `pkg-config --cflags --libs QtCore QtSql QtNetwork QtGui` \
+ *     -I../../../libs/libmythtv -I../../../libs/libmythtv/channelscan \
+ *     -I../../../libs/libmythtv/mpeg -I../../../libs/libmythbase \
+ *     -I../../../libs/libmyth -I../../../libs -I../../.. \
+ *     -L../../../libs/libmythtv -L../../../libs/libmythbase \
+ *     -L../../../libs/libmyth \
+ *     -lmythtv-0.24 -lmyth-0.24 -lmythbase-0.24
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFileInfo>
+#include <QDir>
+#include <QTime>
+
+#include "channelscanner.h"
+#include "channelscan_sm.h"
+#include "scancoordinator.h"
+#include "tsfilechannel.h"
+#include "dtvconfparser.h"
+#include "scanmonitor.h"
+
+#define DEFAULT_INPUTS 1
+
+class BenchScanner : public ChannelScanner
+{
+  public:
+    BenchScanner() : inputs(0) {}
+
+    bool Start(const QString &dir, const QString &sistandard, int ninputs)
+    {
+        DTVChannelList transports;
+        QStringList files = QDir(dir).entryList(
+            QStringList("*.ts"), QDir::Files, QDir::Name);
+        for (int i = 0; i < files.size(); i++)
+        {
+            bool ok;
+            DTVMultiplex mplex;
+            mplex.frequency = QFileInfo(files[i]).baseName().toULongLong(&ok);
+            if (ok)
+                transports.push_back(DTVTransport(mplex));
+        }
+
+        if (transports.empty())
+        {
+            fprintf(stderr, "No <frequency>.ts captures in '%s'\n",
+                    dir.toLocal8Bit().constData());
+            return false;
+        }
+
+        QString tuner_type = (sistandard == "dvb") ? "OFDM" : "ATSC";
+
+        scanMonitor = new ScanMonitor(this);
+        channel = NewChannel(dir, 1);
+        if (!channel)
+            return false;
+
+        sigmonScanner = new ChannelScanSM(
+            scanMonitor, "TSFILE", channel, 0 /* sourceid */,
+            1000, 4000, QString::null, false);
+        if (!sigmonScanner->ScanForChannels(0, sistandard, tuner_type,
+                                            transports))
+        {
+            return false;
+        }
+
+        for (int i = 1; i < ninputs; i++)
+        {
+            ChannelBase *chan = NewChannel(dir, i + 1);
+            if (!chan)
+                return false;
+
+            if (!coordinator)
+                coordinator = new ScanCoordinator(scanMonitor, sigmonScanner);
+
+            coordinator->AddScanner(
+                new ChannelScanSM(scanMonitor, "TSFILE", chan, 0,
+                                  1000, 4000, QString::null, false), chan);
+        }
+
+        if (coordinator)
+            coordinator->DistributeTransports();
+
+        inputs = ninputs;
+        printf("Scanning %d captures on %d inputs\n",
+               (int)transports.size(), inputs);
+
+        timer.start();
+        sigmonScanner->StartScanner();
+        if (coordinator)
+            coordinator->StartScanners();
+
+        return true;
+    }
+
+  protected:
+    ChannelBase *NewChannel(const QString &dir, uint cardid)
+    {
+        TSFileChannel *chan = new TSFileChannel(NULL, dir);
+        chan->SetCardID(cardid);
+        if (!chan->Open())
+        {
+            delete chan;
+            return NULL;
+        }
+        return chan;
+    }
+
+    void HandleEvent(const ScannerEvent *scanEvent)
+    {
+        if (scanEvent->type() != ScannerEvent::ScanComplete)
+            return;
+
+        int msecs = timer.elapsed();
+
+        ScanDTVTransportList transports;
+        sigmonScanner->StopScanner();
+        if (coordinator)
+        {
+            coordinator->StopScanners();
+            transports = coordinator->GetChannelList();
+        }
+        else
+            transports = sigmonScanner->GetChannelList();
+
+        uint services = 0;
+        for (uint i = 0; i < transports.size(); i++)
+            services += transports[i].channels.size();
+
+        printf("Found %d transports with %u services in %d ms, "
+               "%.1f ms per transport per input\n",
+               (int)transports.size(), services, msecs,
+               transports.empty() ? 0.0 :
+               (double)msecs * inputs / transports.size());
+
+        QCoreApplication::exit(0);
+    }
+
+    void InformUser(const QString &error)
+    {
+        fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+    }
+
+  private:
+    int   inputs;
+    QTime timer;
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "\nUsage:\n\n%s <capture dir> [dvb|atsc|mpeg] "
+                "[inputs]\n\nScans the <frequency>.ts captures in the "
+                "directory on %d input(s) by default.\n\n",
+                argv[0], DEFAULT_INPUTS);
+        return 1;
+    }
+
+    QString sistandard = (argc > 2) ? argv[2] : "dvb";
+    int inputs = (argc > 3) ? atoi(argv[3]) : DEFAULT_INPUTS;
+
+    BenchScanner scanner;
+    if (!scanner.Start(argv[1], sistandard, std::max(inputs, 1)))
+        return 1;
+
+    return app.exec();
+}
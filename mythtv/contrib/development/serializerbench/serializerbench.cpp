@@ -0,0 +1,144 @@
+/*
+ * Benchmark for the services API serializers
+ * Builds a DTC::ProgramList like Guide/GetProgramGuide returns and times
+ * the XML and JSON serializers writing it to a device that discards the
+ * output, as the chunked HTTP response does once a chunk is sent.
+ * compile with g++ -O2 -o serializerbench serializerbench.cpp \
+ *     `pkg-config --cflags --libs QtCore QtXml` \
+ *     -I../../../libs/libmythupnp -I../../../libs/libmythupnp/serializers \
+ *     -I../../../libs/libmythservicecontracts \
+ *     -I../../../libs/libmythservicecontracts/datacontracts \
+ *     -I../../../libs/libmythbase \
+ *     -L../../../libs/libmythupnp -L../../../libs/libmythservicecontracts \
+ *     -L../../../libs/libmythbase \
+ *     -lmythupnp-0.24 -lmythservicecontracts-0.24 -lmythbase-0.24
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QDateTime>
+#include <QTime>
+
+#include "xmlSerializer.h"
+#include "jsonSerializer.h"
+#include "programList.h"
+
+#define DEFAULT_PROGRAMS 50000
+#define DEFAULT_RUNS     3
+
+/* Counts what is written and throws it away */
+class NullDevice : public QIODevice
+{
+  public:
+    NullDevice() : m_bytes(0) { open(QIODevice::WriteOnly); }
+
+    qint64 Bytes(void) const { return m_bytes; }
+
+  protected:
+    qint64 readData(char *, qint64) { return -1; }
+    qint64 writeData(const char *, qint64 len)
+    {
+        m_bytes += len;
+        return len;
+    }
+
+  private:
+    qint64 m_bytes;
+};
+
+static void fill_programs(DTC::ProgramList *list, int count)
+{
+    QDateTime start = QDateTime::currentDateTime();
+
+    for (int i = 0; i < count; i++)
+    {
+        DTC::Program *prog = list->AddNewProgram();
+
+        prog->setStartTime(start.addSecs(i * 1800));
+        prog->setEndTime(start.addSecs(i * 1800 + 1800));
+        prog->setTitle(QString("Program title %1").arg(i % 500));
+        prog->setSubTitle(QString("Episode \"%1\"").arg(i));
+        prog->setCategory("Drama");
+        prog->setCatType("series");
+        prog->setSeriesId(QString("EP%1").arg(i % 500, 8, 10, QChar('0')));
+        prog->setProgramId(QString("EP%1").arg(i, 12, 10, QChar('0')));
+        prog->setHostname("backend");
+        prog->setAirdate(start.date());
+        prog->setDescription("A description of about the usual length, "
+                             "long enough to matter for the encoders/escaping.");
+        prog->setSeason(i % 10);
+        prog->setEpisode(i % 24);
+
+        DTC::ChannelInfo *chan = prog->Channel();
+        chan->setChanId(1000 + i % 200);
+        chan->setChanNum(QString::number(i % 200));
+        chan->setCallSign(QString("CHAN%1").arg(i % 200));
+        chan->setChannelName(QString("Channel %1").arg(i % 200));
+        chan->setSerializeDetails(false);
+    }
+
+    list->setCount(count);
+    list->setTotalAvailable(count);
+    list->setAsOf(start);
+}
+
+static void report(const char *name, int run, qint64 bytes, int msecs)
+{
+    double mb = bytes / (1024.0 * 1024.0);
+
+    msecs = std::max(msecs, 1);
+    printf("%-5s run %d: %8.2f MB in %6d ms, %7.2f MB/s\n",
+           name, run, mb, msecs, mb * 1000.0 / msecs);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int count = (argc > 1) ? atoi(argv[1]) : DEFAULT_PROGRAMS;
+    int runs  = (argc > 2) ? atoi(argv[2]) : DEFAULT_RUNS;
+
+    if (count < 1 || runs < 1)
+    {
+        fprintf(stderr, "\nUsage:\n\n%s [programs] [runs]\n\n"
+                "Serializes a list of programs, %d programs and %d runs by "
+                "default.\n\n", argv[0], DEFAULT_PROGRAMS, DEFAULT_RUNS);
+        return 1;
+    }
+
+    DTC::ProgramList::InitializeCustomTypes();
+
+    QTime tm;
+    tm.start();
+    DTC::ProgramList list;
+    fill_programs(&list, count);
+    printf("Built %d programs in %d ms\n", count, tm.elapsed());
+
+    for (int i = 0; i < runs; i++)
+    {
+        NullDevice dev;
+        XmlSerializer *ser = new XmlSerializer(&dev, "GetProgramGuide");
+
+        tm.start();
+        ser->Serialize(&list, "ProgramList");
+        delete ser;
+        report("XML", i + 1, dev.Bytes(), tm.elapsed());
+    }
+
+    for (int i = 0; i < runs; i++)
+    {
+        NullDevice dev;
+        JSONSerializer *ser = new JSONSerializer(&dev, "GetProgramGuide");
+
+        tm.start();
+        ser->Serialize(&list, "ProgramList");
+        delete ser;
+        report("JSON", i + 1, dev.Bytes(), tm.elapsed());
+    }
+
+    return 0;
+}
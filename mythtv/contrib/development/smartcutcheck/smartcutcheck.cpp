@@ -0,0 +1,195 @@
+/*
+ * Check for mythtranscode's H.264 smart cut on streams that start mid GOP
+ * Copies an H.264 transport stream from a packet boundary part way into
+ * it, so the first video packets are the tail of a PES packet and have no
+ * timestamps, runs H264SmartCut on the copy without a cutlist and checks
+ * that every video packet of the output kept its size and its timestamp
+ * relative to the first one. Exits with 1 if any of them didn't.
+ * compile with g++ -O2 -o smartcutcheck smartcutcheck.cpp \
+ *     ../../../programs/mythtranscode/h264smartcut.cpp \
+ *     ../../../programs/mythtranscode/mpeg2fix.cpp \
+ *     ../../../programs/mythtranscode/helper.c \
+ *     ../../../programs/mythtranscode/replex/*.c \
+ *     `pkg-config --cflags --libs QtCore QtSql QtNetwork QtGui` \
+ *     -I../../../programs/mythtranscode \
+ *     -I../../../programs/mythtranscode/replex \
+ *     -I../../../libs/libmythtv -I../../../libs/libmythtv/mpeg \
+ *     -I../../../libs/libmythbase -I../../../libs/libmyth \
+ *     -I../../../libs -I../../../external/FFmpeg -I../../.. \
+ *     -L../../../libs/libmythtv -L../../../libs/libmythbase \
+ *     -L../../../libs/libmyth -L../../../external/FFmpeg/libavformat \
+ *     -L../../../external/FFmpeg/libavcodec \
+ *     -L../../../external/FFmpeg/libavutil \
+ *     -lmythtv-0.24 -lmyth-0.24 -lmythbase-0.24 \
+ *     -lmythavformat -lmythavcodec -lmythavutil
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QVector>
+#include <QFile>
+
+#include "h264smartcut.h"
+
+#define TS_PACKET_SIZE  188
+#define DEFAULT_OFFSET  (1024 * 1024)
+
+/// Size and timestamp of one video packet
+typedef struct {
+    int     size;
+    int64_t pts;
+    bool    timestamped;
+} check_packet_t;
+
+/// Copies the input from offset, rounded down to a TS packet boundary
+static bool copy_from(const QString &infile, const QString &outfile,
+                      qint64 offset)
+{
+    QFile in(infile), out(outfile);
+    if (!in.open(QIODevice::ReadOnly) ||
+        !out.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        !in.seek(offset - offset % TS_PACKET_SIZE))
+    {
+        return false;
+    }
+
+    while (!in.atEnd())
+    {
+        QByteArray data = in.read(1024 * 1024);
+        if (data.isEmpty() || out.write(data) != data.size())
+            return false;
+    }
+
+    return true;
+}
+
+static bool read_video(const QString &filename,
+                       QVector<check_packet_t> &packets)
+{
+    AVFormatContext *fc = NULL;
+    QByteArray fname = filename.toLocal8Bit();
+    if (av_open_input_file(&fc, fname.constData(), NULL, 0, NULL) ||
+        av_find_stream_info(fc) < 0)
+    {
+        return false;
+    }
+
+    int vidId = -1;
+    for (uint i = 0; i < fc->nb_streams && vidId < 0; i++)
+    {
+        if (fc->streams[i]->codec->codec_type == CODEC_TYPE_VIDEO)
+            vidId = i;
+    }
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    while (vidId >= 0 && av_read_frame(fc, &pkt) >= 0)
+    {
+        if (pkt.stream_index == vidId)
+        {
+            check_packet_t packet;
+            packet.size = pkt.size;
+            packet.pts = (pkt.pts != (int64_t) AV_NOPTS_VALUE) ?
+                pkt.pts : pkt.dts;
+            packet.timestamped = (packet.pts != (int64_t) AV_NOPTS_VALUE);
+            packets.push_back(packet);
+        }
+        av_free_packet(&pkt);
+    }
+
+    av_close_input_file(fc);
+    return vidId >= 0;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "\nUsage:\n\n%s input.ts [offset]\n\nStarts the "
+                "copy %d bytes into the input by default.\n\n",
+                argv[0], DEFAULT_OFFSET);
+        return 2;
+    }
+
+    QString infile  = argv[1];
+    qint64  offset  = (argc > 2) ? atoll(argv[2]) : DEFAULT_OFFSET;
+    QString cutfile = "/tmp/smartcutcheck-in.ts";
+    QString outfile = "/tmp/smartcutcheck-out.ts";
+
+    av_register_all();
+
+    QVector<check_packet_t> in, out;
+    if (!copy_from(infile, cutfile, offset) || !read_video(cutfile, in))
+    {
+        fprintf(stderr, "Couldn't make a copy of %s from byte %lld\n",
+                argv[1], offset);
+        return 2;
+    }
+
+    int leading = 0;
+    while (leading < in.size() && !in[leading].timestamped)
+        leading++;
+    if (!leading)
+    {
+        fprintf(stderr, "No video packets without timestamps at the start "
+                "of the copy, try another offset\n");
+        return 2;
+    }
+
+    H264SmartCut cutter(cutfile, outfile, NULL, false);
+    if (cutter.Start() != REENCODE_OK || !read_video(outfile, out) ||
+        out.size() < 4)
+    {
+        fprintf(stderr, "Smart cut of %s failed\n",
+                cutfile.toLocal8Bit().constData());
+        return 1;
+    }
+
+    // The output starts at the first keyframe, find it by its sizes
+    int first = leading;
+    for (; first + 4 <= in.size(); first++)
+    {
+        if (in[first].size == out[0].size &&
+            in[first + 1].size == out[1].size &&
+            in[first + 2].size == out[2].size &&
+            in[first + 3].size == out[3].size)
+        {
+            break;
+        }
+    }
+
+    int errors = 0;
+    for (int i = 0; i < out.size(); i++)
+    {
+        int j = first + i;
+        if (j >= in.size())
+        {
+            printf("output packet %d has no input packet\n", i);
+            errors++;
+            break;
+        }
+
+        int64_t want = (in[j].pts - in[first].pts) & 0x1ffffffffLL;
+        int64_t got  = (out[i].pts - out[0].pts) & 0x1ffffffffLL;
+        if (out[i].size < in[j].size || want != got)
+        {
+            if (errors++ < 10)
+                printf("output packet %d: size %d pts +%lld, input packet "
+                       "%d: size %d pts +%lld\n", i, out[i].size,
+                       (long long) got, j, in[j].size, (long long) want);
+        }
+    }
+
+    printf("%d leading packets without timestamps, %d of %d video packets "
+           "copied, %d mismatched\n", leading, out.size(),
+           in.size() - leading, errors);
+
+    QFile::remove(cutfile);
+    QFile::remove(outfile);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,302 @@
+/*
+ * Load generator for the backend protocol socket
+ *
+ * Opens many connections to a backend, announces them as playback
+ * clients and keeps one cheap request outstanding on each of them.
+ * Reports the request rate and the latency of the answers, which shows
+ * how the backend's socket handling scales with the number of clients.
+ *
+ * compile with gcc -O2 -o socketload socketload.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define DEFAULT_PORT     "6543"
+/* keep in step with MYTH_PROTO_VERSION/TOKEN in libmythbase/mythversion.h */
+#define DEFAULT_VERSION  "71"
+#define DEFAULT_TOKEN    "05e82186"
+#define HEADER_SIZE      8
+#define MAX_MESSAGE      65536
+
+struct conn {
+    int    fd;
+    char   buf[MAX_MESSAGE];
+    int    have;        /* bytes of the current answer read so far */
+    int    want;        /* size of the answer, -1 until the header is in */
+    double sent;        /* when the outstanding request was sent */
+    int    requests;
+};
+
+static double now (void) {
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Sends a message with the 8 character length header of the protocol */
+static int send_message (int fd, const char *msg) {
+    char   out[MAX_MESSAGE + HEADER_SIZE + 1];
+    int    len = strlen (msg);
+    int    pos = 0;
+
+    snprintf (out, sizeof(out), "%-8d%s", len, msg);
+    len += HEADER_SIZE;
+    while (pos < len)
+    {
+        int rval = write (fd, out + pos, len - pos);
+        if (rval < 0 && errno == EINTR)
+            continue;
+        if (rval <= 0)
+            return -1;
+        pos += rval;
+    }
+    return 0;
+}
+
+/* Reads a whole message, only used while connecting */
+static int read_message (int fd, char *buf, int size) {
+    int len, pos = 0;
+
+    while (pos < HEADER_SIZE)
+    {
+        int rval = read (fd, buf + pos, HEADER_SIZE - pos);
+        if (rval <= 0)
+            return -1;
+        pos += rval;
+    }
+    buf[HEADER_SIZE] = 0;
+    len = atoi (buf);
+    if (len < 0 || len >= size)
+        return -1;
+
+    pos = 0;
+    while (pos < len)
+    {
+        int rval = read (fd, buf + pos, len - pos);
+        if (rval <= 0)
+            return -1;
+        pos += rval;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+static int open_connection (const char *host, const char *port,
+                            const char *version, const char *token, int id) {
+    struct addrinfo hints, *res, *ai;
+    char   msg[256];
+    int    fd = -1, one = 1;
+
+    memset (&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo (host, port, &hints, &res))
+        return -1;
+
+    for (ai = res; ai; ai = ai->ai_next)
+    {
+        fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (connect (fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close (fd);
+        fd = -1;
+    }
+    freeaddrinfo (res);
+    if (fd < 0)
+        return -1;
+
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    snprintf (msg, sizeof(msg), "MYTH_PROTO_VERSION %s %s", version, token);
+    if (send_message (fd, msg) || read_message (fd, msg, sizeof(msg)) < 0 ||
+        strncmp (msg, "ACCEPT", 6))
+    {
+        fprintf (stderr, "Protocol version %s rejected: %s\n", version, msg);
+        close (fd);
+        return -1;
+    }
+
+    snprintf (msg, sizeof(msg), "ANN Playback socketload-%d 0", id);
+    if (send_message (fd, msg) || read_message (fd, msg, sizeof(msg)) < 0 ||
+        strncmp (msg, "OK", 2))
+    {
+        close (fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int main (int argc, char **argv) {
+    const char    *host, *port = DEFAULT_PORT;
+    const char    *version = DEFAULT_VERSION, *token = DEFAULT_TOKEN;
+    const char    *requests[] = { "QUERY_UPTIME", "QUERY_LOAD" };
+    struct conn   *conns;
+    struct pollfd *pfds;
+    int            count, duration, i, open_count = 0, done = 0;
+    double         start, report, total_latency = 0.0, max_latency = 0.0;
+    double         period_latency = 0.0;
+    int            period_done = 0;
+
+    if (argc < 4 || (count = atoi (argv[2])) < 1 ||
+        (duration = atoi (argv[3])) < 1)
+    {
+        fprintf (stderr,
+                "\nUsage:\n\n"
+                "%s <host> <connections> <seconds> [port] [version] [token]\n\n"
+                "Opens the connections to the backend on host and sends them\n"
+                "QUERY_UPTIME and QUERY_LOAD requests for the given number of\n"
+                "seconds, one outstanding request per connection. The port\n"
+                "defaults to %s, the protocol version and token to %s %s.\n\n",
+                argv[0], DEFAULT_PORT, DEFAULT_VERSION, DEFAULT_TOKEN);
+        exit (1);
+    }
+    host = argv[1];
+    if (argc > 4)
+        port = argv[4];
+    if (argc > 5)
+        version = argv[5];
+    if (argc > 6)
+        token = argv[6];
+
+    conns = calloc (count, sizeof(struct conn));
+    pfds = calloc (count, sizeof(struct pollfd));
+    if (!conns || !pfds)
+        exit (1);
+
+    for (i = 0; i < count; i++)
+    {
+        conns[i].fd = open_connection (host, port, version, token, i);
+        if (conns[i].fd < 0)
+        {
+            fprintf (stderr, "Connection %d failed\n", i);
+            continue;
+        }
+        open_count++;
+    }
+    printf ("%d of %d connections open\n", open_count, count);
+    if (!open_count)
+        exit (1);
+
+    start = report = now ();
+    for (i = 0; i < count; i++)
+    {
+        if (conns[i].fd < 0)
+            continue;
+        conns[i].want = -1;
+        conns[i].sent = now ();
+        send_message (conns[i].fd, requests[0]);
+    }
+
+    while (now () - start < duration)
+    {
+        int nfds = 0;
+
+        for (i = 0; i < count; i++)
+        {
+            pfds[i].fd = conns[i].fd;
+            pfds[i].events = POLLIN;
+            pfds[i].revents = 0;
+            nfds++;
+        }
+
+        if (poll (pfds, nfds, 1000) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror ("poll");
+            break;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            struct conn *c = &conns[i];
+            int rval, need;
+
+            if (c->fd < 0 || !(pfds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            need = (c->want < 0) ? HEADER_SIZE : c->want;
+            rval = read (c->fd, c->buf + c->have, need - c->have);
+            if (rval <= 0)
+            {
+                fprintf (stderr, "Connection %d closed by the backend\n", i);
+                close (c->fd);
+                c->fd = -1;
+                continue;
+            }
+            c->have += rval;
+            if (c->have < need)
+                continue;
+
+            if (c->want < 0)
+            {
+                c->buf[HEADER_SIZE] = 0;
+                c->want = atoi (c->buf);
+                c->have = 0;
+                if (c->want > 0 && c->want < MAX_MESSAGE)
+                    continue;
+            }
+
+            /* whole answer is in, send the next request */
+            {
+                double latency = now () - c->sent;
+                total_latency += latency;
+                period_latency += latency;
+                if (latency > max_latency)
+                    max_latency = latency;
+                done++;
+                period_done++;
+            }
+
+            c->requests++;
+            c->have = 0;
+            c->want = -1;
+            c->sent = now ();
+            send_message (c->fd, requests[c->requests % 2]);
+        }
+
+        if (now () - report >= 1.0)
+        {
+            double elapsed = now () - report;
+            printf ("%8.0f requests/s, %7.2f ms average latency\n",
+                    period_done / elapsed,
+                    period_done ? period_latency * 1000.0 / period_done : 0.0);
+            fflush (stdout);
+            report = now ();
+            period_done = 0;
+            period_latency = 0.0;
+        }
+    }
+
+    printf ("\n%d requests in %.1f s: %.0f requests/s, "
+            "%.2f ms average latency, %.2f ms maximum latency\n",
+            done, now () - start, done / (now () - start),
+            done ? total_latency * 1000.0 / done : 0.0, max_latency * 1000.0);
+
+    for (i = 0; i < count; i++)
+    {
+        if (conns[i].fd >= 0)
+        {
+            send_message (conns[i].fd, "DONE");
+            close (conns[i].fd);
+        }
+    }
+    free (pfds);
+    free (conns);
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Benchmark for LiveTV channel changes
+ * Starts LiveTV on the next free recorder and changes channel the way the
+ * frontend does, reporting for each change how long the recorder took to
+ * accept it, until the new program was in the chain returned by the
+ * recorder and until the LIVETV_CHAIN UPDATE event carrying it arrived.
+ * compile with g++ -O2 -o zapbench zapbench.cpp \
+ *     `pkg-config --cflags --libs QtCore QtSql QtNetwork QtGui` \
+ *     -I../../../libs/libmythtv -I../../../libs/libmythbase \
+ *     -I../../../libs/libmyth -I../../../libs -I../../.. \
+ *     -L../../../libs/libmythtv -L../../../libs/libmythbase \
+ *     -L../../../libs/libmyth \
+ *     -lmythtv-0.24 -lmyth-0.24 -lmythbase-0.24
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTime>
+
+#include "mythcontext.h"
+#include "mythcorecontext.h"
+#include "mythversion.h"
+#include "mythevent.h"
+#include "remoteencoder.h"
+#include "tvremoteutil.h"
+#include "livetvchain.h"
+#include "tv.h"
+
+#define DEFAULT_ZAPS    10
+#define ZAP_TIMEOUT     30000
+
+class ZapBench : public QObject
+{
+  public:
+    ZapBench(RemoteEncoder *rec) :
+        m_rec(rec), m_events(0)
+    {
+        gCoreContext->addListener(this);
+    }
+
+   ~ZapBench()
+    {
+        gCoreContext->removeListener(this);
+    }
+
+    bool Start(const QString &startchan)
+    {
+        m_chain.InitializeNewChain("zapbench");
+        m_rec->Setup();
+        m_rec->SpawnLiveTV(m_chain.GetID(), false, startchan);
+
+        if (!WaitForChain(1))
+        {
+            fprintf(stderr, "LiveTV did not start\n");
+            return false;
+        }
+        return true;
+    }
+
+    void Stop(void)
+    {
+        m_rec->StopLiveTV();
+        m_chain.DestroyChain();
+    }
+
+    /// Changes channel, up when channum is empty, and waits for the
+    /// new program to show up in the chain.
+    bool Zap(const QString &channum, int &accepted, int &queried, int &pushed)
+    {
+        int count = m_rec->GetLiveTVChain().value(1).toInt() + 1;
+        QTime timer;
+        timer.start();
+
+        m_rec->PauseRecorder();
+        if (channum.isEmpty())
+            m_rec->ChangeChannel(CHANNEL_DIRECTION_UP);
+        else
+            m_rec->SetChannel(channum);
+        accepted = timer.elapsed();
+
+        queried = pushed = -1;
+        while ((queried < 0 || pushed < 0) && timer.elapsed() < ZAP_TIMEOUT)
+        {
+            if (queried < 0 &&
+                m_rec->GetLiveTVChain().value(1).toInt() >= count)
+            {
+                queried = timer.elapsed();
+            }
+
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+            if (pushed < 0 && m_chain.TotalSize() >= count)
+                pushed = timer.elapsed();
+        }
+
+        return queried >= 0 && pushed >= 0;
+    }
+
+    QString GetChannelName(void) const { return m_chain.GetChannelName(-1); }
+    uint GetEvents(void) const { return m_events; }
+
+  protected:
+    void customEvent(QEvent *e)
+    {
+        if ((MythEvent::Type)(e->type()) != MythEvent::MythEventMessage)
+            return;
+
+        MythEvent *me = (MythEvent *)e;
+        if (me->Message() != "LIVETV_CHAIN UPDATE " + m_chain.GetID())
+            return;
+
+        m_events++;
+        m_chain.ReloadAll(me->ExtraDataList());
+    }
+
+  private:
+    bool WaitForChain(int count)
+    {
+        QTime timer;
+        timer.start();
+        while (m_chain.TotalSize() < count && timer.elapsed() < ZAP_TIMEOUT)
+        {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+            if (m_chain.TotalSize() < count)
+                m_chain.ReloadAll(m_rec->GetLiveTVChain());
+        }
+        return m_chain.TotalSize() >= count;
+    }
+
+    RemoteEncoder *m_rec;
+    LiveTVChain    m_chain;
+    uint           m_events;
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc > 1 && QString(argv[1]).startsWith("-"))
+    {
+        fprintf(stderr, "\nUsage:\n\n%s [zaps] [channel...]\n\nChanges "
+                "channel up %d times by default, or cycles through the "
+                "given channels.\n\n", argv[0], DEFAULT_ZAPS);
+        return 1;
+    }
+
+    int zaps = (argc > 1) ? atoi(argv[1]) : DEFAULT_ZAPS;
+    QStringList channels;
+    for (int i = 2; i < argc; i++)
+        channels.push_back(argv[i]);
+
+    gContext = new MythContext(MYTH_BINARY_VERSION);
+    if (!gContext->Init(false) || !gCoreContext->ConnectToMasterServer(false))
+    {
+        fprintf(stderr, "Could not connect to the master backend\n");
+        return 1;
+    }
+
+    RemoteEncoder *rec = RemoteRequestNextFreeRecorder(-1);
+    if (!rec || !rec->IsValidRecorder())
+    {
+        fprintf(stderr, "No free recorder\n");
+        return 1;
+    }
+
+    ZapBench bench(rec);
+    if (!bench.Start(channels.empty() ? QString() : channels[0]))
+        return 1;
+
+    int ok = 0, total_accepted = 0, total_queried = 0, total_pushed = 0;
+    for (int i = 0; i < zaps; i++)
+    {
+        QString channum = channels.empty() ? QString() :
+            channels[(i + 1) % channels.size()];
+
+        int accepted, queried, pushed;
+        if (!bench.Zap(channum, accepted, queried, pushed))
+        {
+            printf("zap %d: no new program after %d ms\n", i + 1,
+                   ZAP_TIMEOUT);
+            continue;
+        }
+
+        printf("zap %d to %s: accepted %d ms, queried %d ms, "
+               "pushed %d ms\n", i + 1,
+               bench.GetChannelName().toLocal8Bit().constData(),
+               accepted, queried, pushed);
+
+        ok++;
+        total_accepted += accepted;
+        total_queried  += queried;
+        total_pushed   += pushed;
+    }
+
+    bench.Stop();
+
+    if (!ok)
+        return 1;
+
+    printf("%d of %d zaps, average accepted %d ms, queried %d ms, "
+           "pushed %d ms, %u chain updates\n", ok, zaps,
+           total_accepted / ok, total_queried / ok, total_pushed / ok,
+           bench.GetEvents());
+
+    delete rec;
+
+    return 0;
+}
@@ -136,56 +136,68 @@ static void adjustRegionMMX(uint8_t *buf, uint8_t *end, const uint8_t *table,
 }
 #endif /* HAVE_MMX */
 
-static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+static void adjustSlice(VideoFilter *vf, VideoFrame *frame, int field,
+                        int slice, int nslices)
 {
     (void)field;
     ThisFilter *filter = (ThisFilter *) vf;
-    TF_VARS;
+    int cheight = (frame->codec == FMT_YV12) ?
+        (frame->height >> 1) : frame->height;
+    int ystart = filter_slice_row(frame->height, slice,     nslices, 2);
+    int yend   = filter_slice_row(frame->height, slice + 1, nslices, 2);
+    int cstart = filter_slice_row(cheight,       slice,     nslices, 1);
+    int cend   = filter_slice_row(cheight,       slice + 1, nslices, 1);
+
+    unsigned char *ybuf = frame->buf + frame->offsets[0];
+    unsigned char *ubuf = frame->buf + frame->offsets[1];
+    unsigned char *vbuf = frame->buf + frame->offsets[2];
+    unsigned char *ybeg = ybuf + (frame->pitches[0] * ystart);
+    unsigned char *yend_p = ybuf + (frame->pitches[0] * yend);
+    unsigned char *ubeg = ubuf + (frame->pitches[1] * cstart);
+    unsigned char *uend = ubuf + (frame->pitches[1] * cend);
+    unsigned char *vbeg = vbuf + (frame->pitches[2] * cstart);
+    unsigned char *vend = vbuf + (frame->pitches[2] * cend);
 
-    TF_START;
+#if HAVE_MMX
+    if (filter->yfilt)
+        adjustRegionMMX(ybeg, yend_p, filter->ytable,
+                        &(filter->yshift), &(filter->yscale),
+                        &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
+    else
+        adjustRegion(ybeg, yend_p, filter->ytable);
+
+    if (filter->cfilt)
+    {
+        adjustRegionMMX(ubeg, uend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+        adjustRegionMMX(vbeg, vend, filter->ctable,
+                        &(filter->cshift), &(filter->cscale),
+                        &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
+    }
+    else
     {
-        unsigned char *ybeg = frame->buf + frame->offsets[0];
-        unsigned char *yend = ybeg + (frame->pitches[0] * frame->height);
-        int cheight = (frame->codec == FMT_YV12) ?
-            (frame->height >> 1) : frame->height;
-        unsigned char *ubeg = frame->buf + frame->offsets[1];
-        unsigned char *uend = ubeg + (frame->pitches[1] * cheight);
-        unsigned char *vbeg = frame->buf + frame->offsets[2];
-        unsigned char *vend = ubeg + (frame->pitches[2] * cheight);
+        adjustRegion(ubeg, uend, filter->ctable);
+        adjustRegion(vbeg, vend, filter->ctable);
+    }
 
-#if HAVE_MMX
-        if (filter->yfilt)
-            adjustRegionMMX(ybeg, yend, filter->ytable,
-                            &(filter->yshift), &(filter->yscale),
-                            &(filter->ymin), mm_cpool + 1, mm_cpool + 2);
-        else
-            adjustRegion(ybeg, yend, filter->ytable);
-
-        if (filter->cfilt)
-        {
-            adjustRegionMMX(ubeg, uend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-            adjustRegionMMX(vbeg, vend, filter->ctable,
-                            &(filter->cshift), &(filter->cscale),
-                            &(filter->cmin), mm_cpool + 3, mm_cpool + 4);
-        }
-        else
-        {
-            adjustRegion(ubeg, uend, filter->ctable);
-            adjustRegion(vbeg, vend, filter->ctable);
-        }
-
-        if (filter->yfilt || filter->cfilt)
-            emms();
+    if (filter->yfilt || filter->cfilt)
+        emms();
 
 #else /* HAVE_MMX */
-        adjustRegion(ybeg, yend, filter->ytable);
-        adjustRegion(ubeg, uend, filter->ctable);
-        adjustRegion(vbeg, vend, filter->ctable);
+    adjustRegion(ybeg, yend_p, filter->ytable);
+    adjustRegion(ubeg, uend, filter->ctable);
+    adjustRegion(vbeg, vend, filter->ctable);
 #endif /* HAVE_MMX */
-    }
-    TF_END(filter, "Adjust: ");
+}
+
+static int adjustFilter (VideoFilter *vf, VideoFrame *frame, int field)
+{
+    TF_VARS;
+
+    TF_START;
+    filter_run_slices(vf, &adjustSlice, frame, field);
+    TF_END((ThisFilter *) vf, "Adjust: ");
     return 0;
 }
 
@@ -41,6 +41,7 @@ typedef struct ThisFilter
     int pitches[3];
     int mm_flags;
     int line_size;
+    int line_stride;
     int prev_size;
     uint8_t *line;
     uint8_t *prev;
@@ -312,9 +313,11 @@ static int init_buf(ThisFilter *filter, VideoFrame *frame)
     if (!alloc_prev(filter, frame->size))
         return 0;
 
+    // one line buffer per plane so the planes can be filtered in parallel
     int sz = imax(imax(frame->pitches[0], frame->pitches[1]), frame->pitches[2]);
-    if (!alloc_line(filter, sz))
+    if (!alloc_line(filter, sz * 3))
         return 0;
+    filter->line_stride = sz;
 
     if ((filter->prev_size  != frame->size)       ||
         (filter->offsets[0] != frame->offsets[0]) ||
@@ -332,43 +335,48 @@ static int init_buf(ThisFilter *filter, VideoFrame *frame)
     return 1;
 }
 
-static int denoise3DFilter(VideoFilter *f, VideoFrame *frame, int field)
+/* The filter is recursive down each plane, so the planes rather than
+ * horizontal bands are spread over the slices. */
+static void denoise3DSlice(VideoFilter *f, VideoFrame *frame, int field,
+                           int slice, int nslices)
 {
     (void)field;
     ThisFilter *filter = (ThisFilter*) f;
-    TF_VARS;
-
-    if (!init_buf(filter, frame))
-        return -1;
-
-    TF_START;
+    int i;
 
 #ifdef MMX
     if (filter->mm_flags & FF_MM_MMX)
         emms();
 #endif
 
-    (filter->filtfunc)(frame->buf   + frame->offsets[0],
-                       filter->prev + frame->offsets[0],
-                       filter->line,  frame->pitches[0], frame->height,
-                       filter->coefs[0] + 256,
-                       filter->coefs[1] + 256);
-
-    (filter->filtfunc)(frame->buf   + frame->offsets[1],
-                       filter->prev + frame->offsets[1],
-                       filter->line,  frame->pitches[1], frame->height >> 1,
-                       filter->coefs[2] + 256,
-                       filter->coefs[3] + 256);
-
-    (filter->filtfunc)(frame->buf   + frame->offsets[2],
-                       filter->prev + frame->offsets[2],
-                       filter->line,  frame->pitches[2], frame->height >> 1,
-                       filter->coefs[2] + 256,
-                       filter->coefs[3] + 256);
+    for (i = slice; i < 3; i += nslices)
+    {
+        int height = i ? (frame->height >> 1) : frame->height;
+        (filter->filtfunc)(frame->buf   + frame->offsets[i],
+                           filter->prev + frame->offsets[i],
+                           filter->line + i * filter->line_stride,
+                           frame->pitches[i], height,
+                           filter->coefs[i ? 2 : 0] + 256,
+                           filter->coefs[i ? 3 : 1] + 256);
+    }
+
 #ifdef MMX
     if (filter->mm_flags & FF_MM_MMX)
         emms();
 #endif
+}
+
+static int denoise3DFilter(VideoFilter *f, VideoFrame *frame, int field)
+{
+    ThisFilter *filter = (ThisFilter*) f;
+    TF_VARS;
+
+    if (!init_buf(filter, frame))
+        return -1;
+
+    TF_START;
+
+    filter_run_slices(f, &denoise3DSlice, frame, field);
 
     TF_END(filter, "Denoise3D: ");
     return 0;
@@ -15,23 +15,30 @@ typedef struct ThisFilter
     TF_STRUCT;
 } ThisFilter;
 
-int invert(VideoFilter *vf, VideoFrame *frame, int field)
+static void invert_slice(VideoFilter *vf, VideoFrame *frame, int field,
+                         int slice, int nslices)
 {
-    (void)field;
-    int size = frame->size;
-    unsigned char *buf = frame->buf;
-    TF_VARS;
-
     (void)vf;
-
-    TF_START;
-
+    (void)field;
+    int start = filter_slice_row(frame->size, slice, nslices, 16);
+    int end = filter_slice_row(frame->size, slice + 1, nslices, 16);
+    unsigned char *buf = frame->buf + start;
+    int size = end - start;
 
     while (size--)
     {
         *buf = 255 - (*buf);
         buf++;
     }
+}
+
+int invert(VideoFilter *vf, VideoFrame *frame, int field)
+{
+    TF_VARS;
+
+    TF_START;
+
+    filter_run_slices(vf, &invert_slice, frame, field);
 
     TF_END((ThisFilter *)vf, "Invert");
 
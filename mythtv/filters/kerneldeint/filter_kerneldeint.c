@@ -11,7 +11,6 @@
 
 #include <string.h>
 #include <math.h>
-#include <pthread.h>
 
 #include "filter.h"
 #include "frame.h"
@@ -36,26 +35,10 @@ static const mmx_t mm_cpool[] = { { 0x0000000000000000LL }, };
 #define mmx_t int
 #endif
 
-struct DeintThread
-{
-    int       ready;
-    pthread_t id;
-    int       exists;
-};
-
 typedef struct ThisFilter
 {
     VideoFilter vf;
 
-    struct DeintThread *threads;
-    VideoFrame *frame;
-    int         field;
-    int         ready;
-    int         kill_threads;
-    int         actual_threads;
-    int         requested_threads;
-    pthread_mutex_t mutex;
-
     int       skipchroma;
     int       mm_flags;
     int       width;
@@ -417,37 +400,14 @@ static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
 #endif
 }
 
-static void *KernelThread(void *args)
+static void KernelSlice(VideoFilter *f, VideoFrame *frame, int field,
+                        int slice, int nslices)
 {
-    ThisFilter *filter = (ThisFilter*)args;
-
-    pthread_mutex_lock(&(filter->mutex));
-    int num = filter->actual_threads;
-    filter->actual_threads = num + 1;
-    pthread_mutex_unlock(&(filter->mutex));
-
-    while (!filter->kill_threads)
-    {
-        usleep(1000);
-        if (filter->ready &&
-            filter->frame != NULL &&
-            filter->threads[num].ready)
-        {
-            filter_func(
-                filter, filter->frame->buf, filter->frame->offsets,
-                filter->frame->pitches, filter->frame->width,
-                filter->frame->height, filter->field,
-                filter->frame->top_field_first, filter->double_rate,
-                filter->dirty_frame, num, filter->actual_threads);
-
-            pthread_mutex_lock(&(filter->mutex));
-            filter->ready = filter->ready - 1;
-            filter->threads[num].ready = 0;
-            pthread_mutex_unlock(&(filter->mutex));
-        }
-    }
-    pthread_exit(NULL);
-    return NULL;
+    ThisFilter *filter = (ThisFilter *) f;
+    filter_func(
+        filter, frame->buf, frame->offsets, frame->pitches,
+        frame->width, frame->height, field, frame->top_field_first,
+        filter->double_rate, filter->dirty_frame, slice, nslices);
 }
 
 static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
@@ -480,20 +440,11 @@ static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
         }
     }
 
-    if (filter->actual_threads > 1 && filter->double_rate)
+    // Only the double rate path can be split into bands, the single
+    // rate path filters in place using the lines above as reference.
+    if (filter->double_rate)
     {
-        int i;
-        for (i = 0; i < filter->actual_threads; i++)
-            filter->threads[i].ready = 1;
-        filter->frame = frame;
-        filter->field = field;
-        filter->ready = filter->actual_threads;
-        i = 0;
-        while (filter->ready > 0 && i < 1000)
-        {
-            usleep(1000);
-            i++;
-        }
+        filter_run_slices(f, &KernelSlice, frame, field);
     }
     else
     {
@@ -522,15 +473,6 @@ static void CleanupKernelDeintFilter(VideoFilter *f)
             free(*p);
         *p= NULL;
     }
-
-    if (filter->threads != NULL)
-    {
-        filter->kill_threads = 1;
-        for (i = 0; i < filter->requested_threads; i++)
-            if (filter->threads[i].exists)
-                pthread_join(filter->threads[i].id, NULL);
-        free(filter->threads);
-    }
 }
 
 static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
@@ -588,70 +530,6 @@ static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
     filter->vf.filter  = &KernelDeint;
     filter->vf.cleanup = &CleanupKernelDeintFilter;
 
-    filter->frame = NULL;
-    filter->field = 0;
-    filter->ready = 0;
-    filter->kill_threads = 0;
-    filter->actual_threads  = 0;
-    filter->requested_threads  = threads;
-    filter->threads = NULL; 
-
-    if (filter->requested_threads > 1)
-    {
-        filter->threads = (struct DeintThread *) calloc(threads,
-                          sizeof(struct DeintThread));
-        if (filter->threads == NULL)
-        {
-            LOG(VB_GENERAL, LOG_ERR, "KernelDeint: failed to allocate memory "
-                    "for threads - falling back to existing, single thread.");
-            filter->requested_threads = 1;
-        }
-    }
-
-    if (filter->requested_threads > 1)
-    {
-        pthread_mutex_init(&(filter->mutex), NULL);
-        int success = 0;
-        for (int i = 0; i < filter->requested_threads; i++)
-        {
-            if (pthread_create(&(filter->threads[i].id), NULL,
-                               KernelThread, (void*)filter) != 0)
-                filter->threads[i].exists = 0;
-            else
-            {
-                success++;
-                filter->threads[i].exists = 1;
-            }
-        }
-
-        if (success < filter->requested_threads)
-        {
-            LOG(VB_GENERAL, LOG_NOTICE,
-                "KernelDeint: failed to create all threads - "
-                "falling back to existing, single thread.");
-        }
-        else
-        {
-            int timeout = 0;
-            while (filter->actual_threads != filter->requested_threads)
-            {
-                timeout++;
-                if (timeout > 5000)
-                {
-                    LOG(VB_GENERAL, LOG_NOTICE,
-                        "KernelDeint: waited too long for "
-                        "threads to start.- continuing.");
-                    break;
-                }
-                usleep(1000);
-            }
-            LOG(VB_PLAYBACK, LOG_INFO, "KernelDeint: Created threads.");
-        }
-    }
-
-    if (filter->actual_threads < 1 )
-        LOG(VB_PLAYBACK, LOG_INFO, "KernelDeint: Using existing thread.");
-
     return (VideoFilter *) filter;
 }
 
@@ -127,27 +127,29 @@ static void init_vars(ThisFilter *tf, VideoFrame *frame,
     buf[2] = frame->buf + frame->offsets[2];
 }
 
-static int quickdnr(VideoFilter *f, VideoFrame *frame, int field)
+static void slice_range(VideoFrame *frame, int *height, int plane,
+                        int slice, int nslices, int *beg, int *end)
+{
+    int sz = height[plane] * frame->pitches[plane];
+    *beg = filter_slice_row(sz, slice,     nslices, 8);
+    *end = filter_slice_row(sz, slice + 1, nslices, 8);
+}
+
+static void quickdnr_slice(VideoFilter *f, VideoFrame *frame, int field,
+                           int slice, int nslices)
 {
     (void)field;
     ThisFilter *tf = (ThisFilter *)f;
     int thr1[3], thr2[3], height[3];
     uint8_t *avg[3], *buf[3];
-    int i, y;
-
-    TF_VARS;
-
-    TF_START;
-
-    if (!init_avg(tf, frame))
-        return 0;
+    int i, y, beg, end;
 
     init_vars(tf, frame, thr1, thr2, height, avg, buf);
 
     for (i = 0; i < 3; i++)
     {
-        int sz = height[i] * frame->pitches[i];
-        for (y = 0; y < sz; y++)
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
+        for (y = beg; y < end; y++)
         {
             if (abs(avg[i][y] - buf[i][y]) < thr1[i])
                 buf[i][y] = avg[i][y] = (avg[i][y] + buf[i][y]) >> 1;
@@ -155,19 +157,11 @@ static int quickdnr(VideoFilter *f, VideoFrame *frame, int field)
                 avg[i][y] = buf[i][y];
         }
     }
-
-    TF_END(tf, "QuickDNR: ");
-
-    return 0;
 }
 
-static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
+static int quickdnr(VideoFilter *f, VideoFrame *frame, int field)
 {
-    (void)field;
     ThisFilter *tf = (ThisFilter *)f;
-    int thr1[3], thr2[3], height[3];
-    uint8_t *avg[3], *buf[3];
-    int i, y;
 
     TF_VARS;
 
@@ -176,12 +170,28 @@ static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
     if (!init_avg(tf, frame))
         return 0;
 
+    filter_run_slices(f, &quickdnr_slice, frame, field);
+
+    TF_END(tf, "QuickDNR: ");
+
+    return 0;
+}
+
+static void quickdnr2_slice(VideoFilter *f, VideoFrame *frame, int field,
+                            int slice, int nslices)
+{
+    (void)field;
+    ThisFilter *tf = (ThisFilter *)f;
+    int thr1[3], thr2[3], height[3];
+    uint8_t *avg[3], *buf[3];
+    int i, y, beg, end;
+
     init_vars(tf, frame, thr1, thr2, height, avg, buf);
 
     for (i = 0; i < 3; i++)
     {
-        int sz = height[i] * frame->pitches[i];
-        for (y = 0; y < sz; y++)
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
+        for (y = beg; y < end; y++)
         {
             int t = abs(avg[i][y] - buf[i][y]);
             if (t < thr1[i])
@@ -196,6 +206,20 @@ static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
             }
         }
     }
+}
+
+static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
+{
+    ThisFilter *tf = (ThisFilter *)f;
+
+    TF_VARS;
+
+    TF_START;
+
+    if (!init_avg(tf, frame))
+        return 0;
+
+    filter_run_slices(f, &quickdnr2_slice, frame, field);
 
     TF_END(tf, "QuickDNR2: ");
 
@@ -204,23 +228,18 @@ static int quickdnr2(VideoFilter *f, VideoFrame *frame, int field)
 
 #ifdef MMX
 
-static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
+static void quickdnrMMX_slice(VideoFilter *f, VideoFrame *frame, int field,
+                              int slice, int nslices)
 {
     (void)field;
     ThisFilter *tf = (ThisFilter *)f;
     const uint64_t sign_convert = 0x8080808080808080LL;
     int thr1[3], thr2[3], height[3];
-    uint64_t *avg[3], *buf[3];
-    int i, y;
-
-    TF_VARS;
+    uint8_t *avg8[3], *buf8[3];
+    uint64_t *avg, *buf;
+    int i, y, beg, end;
 
-    TF_START;
-
-    if (!init_avg(tf, frame))
-        return 0;
-
-    init_vars(tf, frame, thr1, thr2, height, (uint8_t**) avg, (uint8_t**) buf);
+    init_vars(tf, frame, thr1, thr2, height, avg8, buf8);
 
     /*
       Removed all the prefetches. These don't do anything when
@@ -240,14 +259,16 @@ static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
 
     for (i = 0; i < 3; i++)
     {
-        int sz = (height[i] * frame->pitches[i]) >> 3;
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
+        avg = (uint64_t*) (avg8[i] + beg);
+        buf = (uint64_t*) (buf8[i] + beg);
 
         if (0 == i)
             __asm__ volatile("movq (%0), %%mm5" : : "r" (&tf->Luma_threshold_mask1));
         else
             __asm__ volatile("movq (%0), %%mm5" : : "r" (&tf->Chroma_threshold_mask1));
 
-        for (y = 0; y < sz; y++)
+        for (y = beg; y < (end & ~0x7); y += 8)
         {
             __asm__ volatile(
             "movq (%0), %%mm0     \n\t" // avg[i]
@@ -272,10 +293,10 @@ static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
             "por %%mm7, %%mm3     \n\t"
             "movq %%mm3, (%0)     \n\t"
             "movq %%mm3, (%1)     \n\t"
-            : : "r" (avg[i]), "r" (buf[i])
+            : : "r" (avg), "r" (buf)
             );
-            buf[i]++;
-            avg[i]++;
+            buf++;
+            avg++;
         }
     }
 
@@ -284,19 +305,9 @@ static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
     // filter the leftovers from the mmx rutine
     for (i = 0; i < 3; i++)
     {
-        int thr1[3], thr2[3], height[3];
-        uint8_t *avg8[3], *buf8[3];
-        int end, beg;
-
-        init_vars(tf, frame, thr1, thr2, height, avg8, buf8);
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
 
-        end = height[i] * frame->pitches[i];
-        beg = end & ~0x7;
-
-        if (beg == end)
-            continue;
-
-        for (y = beg; y < end; y++)
+        for (y = end & ~0x7; y < end; y++)
         {
             if (abs(avg8[i][y] - buf8[i][y]) < thr1[i])
                 buf8[i][y] = avg8[i][y] = (avg8[i][y] + buf8[i][y]) >> 1;
@@ -304,21 +315,11 @@ static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
                 avg8[i][y] = buf8[i][y];
         }
     }
-
-    TF_END(tf, "QuickDNRmmx: ");
-
-    return 0;
 }
 
-
-static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
+static int quickdnrMMX(VideoFilter *f, VideoFrame *frame, int field)
 {
-    (void)field;
     ThisFilter *tf = (ThisFilter *)f;
-    const uint64_t sign_convert = 0x8080808080808080LL;
-    int thr1[3], thr2[3], height[3];
-    uint64_t *avg[3], *buf[3];
-    int i, y;
 
     TF_VARS;
 
@@ -327,7 +328,25 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
     if (!init_avg(tf, frame))
         return 0;
 
-    init_vars(tf, frame, thr1, thr2, height, (uint8_t**) avg, (uint8_t**) buf);
+    filter_run_slices(f, &quickdnrMMX_slice, frame, field);
+
+    TF_END(tf, "QuickDNRmmx: ");
+
+    return 0;
+}
+
+static void quickdnr2MMX_slice(VideoFilter *f, VideoFrame *frame, int field,
+                               int slice, int nslices)
+{
+    (void)field;
+    ThisFilter *tf = (ThisFilter *)f;
+    const uint64_t sign_convert = 0x8080808080808080LL;
+    int thr1[3], thr2[3], height[3];
+    uint8_t *avg8[3], *buf8[3];
+    uint64_t *avg, *buf;
+    int i, y, beg, end;
+
+    init_vars(tf, frame, thr1, thr2, height, avg8, buf8);
 
     __asm__ volatile("emms\n\t");
 
@@ -335,14 +354,16 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
 
     for (i = 0; i < 3; i++)
     {
-        int sz = (height[i] * frame->pitches[i]) >> 3;
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
+        avg = (uint64_t*) (avg8[i] + beg);
+        buf = (uint64_t*) (buf8[i] + beg);
 
         if (0 == i)
             __asm__ volatile("movq (%0), %%mm5" : : "r" (&tf->Luma_threshold_mask1));
         else
             __asm__ volatile("movq (%0), %%mm5" : : "r" (&tf->Chroma_threshold_mask1));
 
-        for (y = 0; y < sz; y++)
+        for (y = beg; y < (end & ~0x7); y += 8)
         {
             uint64_t *mask2 = (0 == i) ?
                 &tf->Luma_threshold_mask2 : &tf->Chroma_threshold_mask2;
@@ -393,12 +414,12 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
                 "movq %%mm3, (%0)     \n\t"
                 "movq %%mm3, (%1)     \n\t"
                 : :
-                "r" (avg[i]),
-                "r" (buf[i]),
+                "r" (avg),
+                "r" (buf),
                 "r" (mask2)
                 );
-            buf[i]++;
-            avg[i]++;
+            buf++;
+            avg++;
         }
     }
 
@@ -407,19 +428,9 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
     // filter the leftovers from the mmx rutine
     for (i = 0; i < 3; i++)
     {
-        int thr1[3], thr2[3], height[3];
-        uint8_t *avg8[3], *buf8[3];
-        int end, beg;
-
-        init_vars(tf, frame, thr1, thr2, height, avg8, buf8);
-
-        end = height[i] * frame->pitches[i];
-        beg = end & ~0x7;
+        slice_range(frame, height, i, slice, nslices, &beg, &end);
 
-        if (beg == end)
-            continue;
-
-        for (y = beg; y < end; y++)
+        for (y = end & ~0x7; y < end; y++)
         {
             int t = abs(avg8[i][y] - buf8[i][y]);
             if (t < thr1[i])
@@ -434,6 +445,20 @@ static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
             }
         }
     }
+}
+
+static int quickdnr2MMX(VideoFilter *f, VideoFrame *frame, int field)
+{
+    ThisFilter *tf = (ThisFilter *)f;
+
+    TF_VARS;
+
+    TF_START;
+
+    if (!init_avg(tf, frame))
+        return 0;
+
+    filter_run_slices(f, &quickdnr2MMX_slice, frame, field);
 
     TF_END(tf, "QuickDNR2mmx: ");
 
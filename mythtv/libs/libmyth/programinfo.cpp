@@ -14,7 +14,9 @@ using namespace std;
 
 // Qt headers
 #include <QRegExp>
+#include <QMutex>
 #include <QMap>
+#include <QSet>
 #include <QUrl>
 #include <QFile>
 #include <QFileInfo>
@@ -79,6 +81,72 @@ static void set_flag(uint32_t &flags, int flag_to_set, bool is_set)
         flags |= flag_to_set;
 }
 
+/// Pooled values are pruned when a pool grows past this
+#define MAX_POOLED 20000
+
+static QMutex                  s_poolLock;
+static QSet<QString>           s_stringPool;
+static QHash<qint64,QDateTime> s_timePool;
+/// Size at which the string pool is pruned next, at least MAX_POOLED and
+/// twice what was left after the last pruning so that pruning stays
+/// linear in the number of inserts even when little can be dropped
+static int                     s_stringPoolPruneAt = MAX_POOLED;
+
+/// Replaces str with the pooled copy of its value, s_poolLock must be held
+static void pool_string(QString &str)
+{
+    if (str.isEmpty())
+        return;
+
+    QSet<QString>::const_iterator it = s_stringPool.find(str);
+    if (it != s_stringPool.end())
+    {
+        str = *it;
+        return;
+    }
+
+    if (s_stringPool.size() >= s_stringPoolPruneAt)
+    {
+        // Only the pool still refers to the detached ones
+        QSet<QString>::iterator pit = s_stringPool.begin();
+        while (pit != s_stringPool.end())
+        {
+            if ((*pit).isDetached())
+                pit = s_stringPool.erase(pit);
+            else
+                ++pit;
+        }
+        s_stringPoolPruneAt = max(MAX_POOLED, s_stringPool.size() * 2);
+    }
+
+    s_stringPool.insert(str);
+}
+
+/// Replaces dt with the pooled copy of its value, s_poolLock must be held
+static void pool_time(QDateTime &dt)
+{
+    if (!dt.isValid() || dt.time().msec())
+        return;
+
+    // toTime_t() is (uint)-1 for everything it can't represent
+    uint secs = dt.toTime_t();
+    if (secs == (uint) -1)
+        return;
+
+    qint64 key = ((qint64) secs << 2) | dt.timeSpec();
+    QHash<qint64,QDateTime>::const_iterator it = s_timePool.find(key);
+    if (it != s_timePool.end())
+    {
+        dt = *it;
+        return;
+    }
+
+    if (s_timePool.size() >= MAX_POOLED)
+        s_timePool.clear();
+
+    s_timePool.insert(key, dt);
+}
+
 /** \fn ProgramInfo::ProgramInfo(void)
  *  \brief Null constructor.
  */
@@ -1240,6 +1308,40 @@ void ProgramInfo::ToStringList(QStringList &list) const
  *      ToStringList(QStringList&) const
  */
 
+/** \fn ProgramInfo::Compact(void)
+ *  \brief Shares the values that repeat across programs, like channel
+ *         names, groups, hostnames, categories and times, with the other
+ *         compacted ProgramInfo instances.
+ *
+ *  QString and QDateTime are implicitly shared, so large lists hold each
+ *  distinct value once instead of once per program. Nothing changes for
+ *  the users of the values.
+ */
+void ProgramInfo::Compact(void)
+{
+    QMutexLocker locker(&s_poolLock);
+
+    pool_string(title);
+    pool_string(category);
+    pool_string(chanstr);
+    pool_string(chansign);
+    pool_string(channame);
+    pool_string(chanplaybackfilters);
+    pool_string(recgroup);
+    pool_string(playgroup);
+    pool_string(hostname);
+    pool_string(storagegroup);
+    pool_string(seriesid);
+    pool_string(inetref);
+    pool_string(catType);
+
+    pool_time(startts);
+    pool_time(endts);
+    pool_time(recstartts);
+    pool_time(recendts);
+    pool_time(lastmodified);
+}
+
 bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
                                  QStringList::const_iterator  listend)
 {
@@ -1311,6 +1413,8 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
         positionMapDBReplacement = NULL;
     }
 
+    Compact();
+
     return true;
 }
 
@@ -4464,6 +4568,7 @@ bool LoadFromProgram(
                 query.value(10).toInt(), // repeat
 
                 schedList, oneChanid));
+        destination.back()->Compact();
     }
 
     return true;
@@ -4536,6 +4641,7 @@ bool LoadFromOldRecorded(
             query.value(15).toUInt(),
 
             query.value(19).toInt()));
+        destination.back()->Compact();
     }
 
     return true;
@@ -4696,6 +4802,7 @@ bool LoadFromRecorded(
                 query.value(42).toUInt(),
                 query.value(43).toUInt(),
                 query.value(44).toUInt()));
+        destination.back()->Compact();
 
         if (save_not_commflagged)
             destination.back()->SaveCommFlagged(COMM_FLAG_NOT_FLAGGED);
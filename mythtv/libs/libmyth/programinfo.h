@@ -272,6 +272,8 @@ class MPUBLIC ProgramInfo
                        uint star_range = 10) const;
     virtual void SubstituteMatches(QString &str);
 
+    void Compact(void);
+
     // Used for scheduling recordings
     bool IsSameProgram(const ProgramInfo &other) const;
     bool IsSameTimeslot(const ProgramInfo &other) const;
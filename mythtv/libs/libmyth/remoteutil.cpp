@@ -1,5 +1,6 @@
 #include <unistd.h>
 
+#include <QDataStream>
 #include <QFileInfo>
 #include <QFile>
 #include <QDir>
@@ -35,6 +36,102 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     return info;
 }
 
+/** \brief Asks the backend for the recordings that changed since
+ *         generation of epoch with QUERY_RECORDINGS_DELTA.
+ *
+ *  Pass an empty epoch and generation 0 for the whole list. On success
+ *  epoch and generation are those of the backend's current list.
+ *
+ *  \param full    set if changed holds the whole list
+ *  \param changed recordings added or changed, owned by the caller
+ *  \param removed ProgramInfo::MakeUniqueKey() of the removed recordings
+ *  \return false if the request failed.
+ */
+bool RemoteGetRecordedListDelta(
+    QString &epoch, uint &generation, bool &full,
+    vector<ProgramInfo *> &changed, QStringList &removed)
+{
+    QStringList strlist(
+        QString("QUERY_RECORDINGS_DELTA %1 %2")
+            .arg(epoch.isEmpty() ? QString("0") : epoch).arg(generation));
+
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 6)
+    {
+        return false;
+    }
+
+    int     length     = strlist[3].toInt();
+    quint16 checksum16 = strlist[4].toUInt();
+    QByteArray data = QByteArray::fromBase64(strlist[5].toAscii());
+    if (data.size() < length)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("RemoteGetRecordedListDelta() size check failed %1 < %2")
+                .arg(data.size()).arg(length));
+        return false;
+    }
+    data.resize(length);
+
+    if (checksum16 != qChecksum(data.constData(), data.size()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "RemoteGetRecordedListDelta() checksum failed");
+        return false;
+    }
+
+    data = qUncompress(data);
+
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    vector<ProgramInfo *> list;
+    quint32 count;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        QStringList fields;
+        quint32 numfields;
+        in >> numfields;
+        for (quint32 f = 0; f < numfields && in.status() == QDataStream::Ok;
+             f++)
+        {
+            QByteArray field;
+            in >> field;
+            fields.push_back(QString::fromUtf8(field));
+        }
+
+        QStringList::const_iterator it = fields.begin();
+        list.push_back(new ProgramInfo(it, fields.end()));
+    }
+
+    QStringList keys;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        QByteArray key;
+        in >> key;
+        keys.push_back(QString::fromUtf8(key));
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "RemoteGetRecordedListDelta() bad list");
+        while (!list.empty())
+        {
+            delete list.back();
+            list.pop_back();
+        }
+        return false;
+    }
+
+    epoch      = strlist[0];
+    generation = strlist[1].toUInt();
+    full       = (strlist[2] == "FULL");
+    changed.insert(changed.end(), list.begin(), list.end());
+    removed   += keys;
+
+    return true;
+}
+
 bool RemoteGetLoad(float load[3])
 {
     QStringList strlist(QString("QUERY_LOAD"));
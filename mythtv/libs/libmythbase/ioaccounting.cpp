@@ -0,0 +1,118 @@
+// C headers
+#include <sys/time.h>
+#include <cmath>
+
+// Qt headers
+#include <QMutex>
+#include <QHash>
+
+// MythTV headers
+#include "ioaccounting.h"
+#include "compat.h"
+
+/// Time constant of the averages, in microseconds
+#define IO_AVERAGE_USECS (60 * 1000000.0)
+/// I/O needed before the throughput is trusted, less is mostly noise
+#define IO_MIN_THROUGHPUT_BYTES (8 * 1024 * 1024)
+
+/// Exponentially decaying sums of the I/O of one directory
+class IODirStats
+{
+  public:
+    IODirStats() : last(0), written(0.0), read(0.0), ioBytes(0.0),
+                   ioUSecs(0.0), ioCalls(0.0) {}
+
+    void Decay(qint64 now)
+    {
+        if (last && now > last)
+        {
+            double decay = exp(-(now - last) / IO_AVERAGE_USECS);
+            written *= decay;
+            read    *= decay;
+            ioBytes *= decay;
+            ioUSecs *= decay;
+            ioCalls *= decay;
+        }
+        last = now;
+    }
+
+    void AddDiskTime(qint64 bytes, qint64 usecs)
+    {
+        ioBytes += bytes;
+        ioUSecs += usecs;
+        ioCalls += 1.0;
+    }
+
+    qint64 last;
+    double written;
+    double read;
+    double ioBytes;
+    double ioUSecs;
+    double ioCalls;
+};
+
+static QMutex                     s_ioLock;
+static QHash<QString,IODirStats>  s_ioStats;
+
+/// Counts bytes written to the page cache, they are timed by AddSync()
+void IOAccounting::AddWrite(const QString &dir, qint64 bytes)
+{
+    QMutexLocker locker(&s_ioLock);
+    IODirStats &stats = s_ioStats[dir];
+    stats.Decay(GetMicroseconds());
+    stats.written += bytes;
+}
+
+/// Counts bytes written earlier that a sync took usecs to reach the disk
+void IOAccounting::AddSync(const QString &dir, qint64 bytes, qint64 usecs)
+{
+    QMutexLocker locker(&s_ioLock);
+    IODirStats &stats = s_ioStats[dir];
+    stats.Decay(GetMicroseconds());
+    stats.AddDiskTime(bytes, usecs);
+}
+
+/// Counts bytes read in usecs, not including any waits for more data
+void IOAccounting::AddRead(const QString &dir, qint64 bytes, qint64 usecs)
+{
+    QMutexLocker locker(&s_ioLock);
+    IODirStats &stats = s_ioStats[dir];
+    stats.Decay(GetMicroseconds());
+    stats.read += bytes;
+    stats.AddDiskTime(bytes, usecs);
+}
+
+/** \fn IOAccounting::GetStats(const QString&, Stats&)
+ *  \brief Returns the recent I/O done in dir by this process.
+ *  \return false if there was no I/O in dir.
+ */
+bool IOAccounting::GetStats(const QString &dir, Stats &stats)
+{
+    QMutexLocker locker(&s_ioLock);
+
+    QHash<QString,IODirStats>::iterator it = s_ioStats.find(dir);
+    if (it == s_ioStats.end())
+        return false;
+
+    (*it).Decay(GetMicroseconds());
+
+    // The decaying sums divided by the time constant are the rates
+    stats.writeRate = (*it).written * 1000000.0 / IO_AVERAGE_USECS;
+    stats.readRate  = (*it).read * 1000000.0 / IO_AVERAGE_USECS;
+    stats.throughput = 0.0;
+    if ((*it).ioBytes >= IO_MIN_THROUGHPUT_BYTES && (*it).ioUSecs >= 1.0)
+        stats.throughput = (*it).ioBytes * 1000000.0 / (*it).ioUSecs;
+    stats.latency = 0.0;
+    if ((*it).ioCalls >= 1.0)
+        stats.latency = (*it).ioUSecs / (*it).ioCalls;
+
+    return true;
+}
+
+/// \brief Returns a monotonic enough clock for timing I/O calls.
+qint64 IOAccounting::GetMicroseconds(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (qint64) tv.tv_sec * 1000000 + tv.tv_usec;
+}
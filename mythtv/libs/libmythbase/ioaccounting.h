@@ -0,0 +1,40 @@
+#ifndef _IOACCOUNTING_H_
+#define _IOACCOUNTING_H_
+
+#include <QString>
+
+#include "mythbaseexp.h"
+
+/** \class IOAccounting
+ *  \brief Measures the file I/O of this process per directory, so the
+ *         storage scheduler can see how busy a filesystem really is.
+ *
+ *  Rates are averaged over about a minute, older I/O fades out.
+ *  The throughput is how many bytes were moved per second spent in
+ *  reads and in the syncs that flush writes to disk. Writes themselves
+ *  only reach the page cache and are not timed.
+ */
+class MBASE_PUBLIC IOAccounting
+{
+  public:
+    class Stats
+    {
+      public:
+        Stats() : writeRate(0.0), readRate(0.0), throughput(0.0),
+                  latency(0.0) {}
+
+        double writeRate;   ///< bytes per second written
+        double readRate;    ///< bytes per second read
+        double throughput;  ///< bytes per second of I/O time, 0 if unknown
+        double latency;     ///< microseconds per I/O call
+    };
+
+    static void AddWrite(const QString &dir, qint64 bytes);
+    static void AddSync(const QString &dir, qint64 bytes, qint64 usecs);
+    static void AddRead(const QString &dir, qint64 bytes, qint64 usecs);
+    static bool GetStats(const QString &dir, Stats &stats);
+
+    static qint64 GetMicroseconds(void);
+};
+
+#endif // _IOACCOUNTING_H_
@@ -23,7 +23,7 @@ HEADERS += unzip.h unzip_p.h zipentry_p.h iso639.h iso3166.h mythmedia.h
 HEADERS += util.h mythhdd.h mythcdrom.h autodeletedeque.h dbutil.h
 HEADERS += mythhttppool.h mythhttphandler.h mythdeque.h mythlogging.h
 HEADERS += mythbaseutil.h referencecounter.h version.h mythcommandlineparser.h
-HEADERS += mythscheduler.h
+HEADERS += mythscheduler.h remotefilehttp.h storagegroupindex.h ioaccounting.h
 
 SOURCES += mthread.cpp mthreadpool.cpp
 SOURCES += mythsocket.cpp mythsocketthread.cpp msocketdevice.cpp
@@ -36,7 +36,8 @@ SOURCES += mythcoreutil.cpp mythdownloadmanager.cpp mythtranslation.cpp
 SOURCES += unzip.cpp iso639.cpp iso3166.cpp mythmedia.cpp util.cpp
 SOURCES += mythhdd.cpp mythcdrom.cpp dbutil.cpp
 SOURCES += mythhttppool.cpp mythhttphandler.cpp logging.cpp
-SOURCES += referencecounter.cpp mythcommandlineparser.cpp
+SOURCES += referencecounter.cpp mythcommandlineparser.cpp remotefilehttp.cpp
+SOURCES += storagegroupindex.cpp ioaccounting.cpp
 
 win32:SOURCES += msocketdevice_win.cpp
 unix {
@@ -62,6 +63,7 @@ inc.files += mythcoreutil.h mythlocale.h mythdownloadmanager.h
 inc.files += mythtranslation.h iso639.h iso3166.h mythmedia.h util.h
 inc.files += mythcdrom.h autodeletedeque.h dbutil.h mythhttppool.h mythdeque.h
 inc.files += referencecounter.h mythcommandlineparser.h mthread.h mthreadpool.h
+inc.files += ioaccounting.h
 
 # Allow both #include <blah.h> and #include <libmyth/blah.h>
 inc2.path  = $${PREFIX}/include/mythtv/libmyth
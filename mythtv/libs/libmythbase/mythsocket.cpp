@@ -832,6 +832,11 @@ bool MythSocket::connect(const QHostAddress &hadr, quint16 port)
     setReceiveBufferSize(kSocketBufferSize);
     setAddressReusable(true);
     setKeepalive(true);
+
+    // The connect may have created a new descriptor for this socket
+    if (m_cb)
+        s_readyread_thread->UpdateReadyRead(this);
+
     if (state() == Connecting)
     {
         setState(Connected);
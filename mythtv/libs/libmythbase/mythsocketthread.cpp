@@ -1,5 +1,6 @@
 // ANSI C
 #include <cstdlib>
+#include <cstring> // for memset
 
 // C++
 #include <algorithm> // for min/max
@@ -14,6 +15,9 @@
 #include <sys/types.h>  // for fnctl
 #include <fcntl.h>      // for fnctl
 #include <errno.h>      // for checking errno
+#ifdef linux
+#include <sys/epoll.h>  // for epoll
+#endif
 
 #ifndef O_NONBLOCK
 #define O_NONBLOCK 0 /* not actually supported in MINGW */
@@ -33,9 +37,10 @@
 #define LOC     QString("MythSocketThread: ")
 
 const uint MythSocketThread::kShortWait = 100;
+const int  MythSocketThread::kMaxEpollEvents = 64;
 
 MythSocketThread::MythSocketThread()
-    : MThread("Socket"), m_readyread_run(false)
+    : MThread("Socket"), m_readyread_run(false), m_epoll_fd(-1)
 {
     for (int i = 0; i < 2; i++)
     {
@@ -79,6 +84,12 @@ void MythSocketThread::CloseReadyReadPipe(void) const
             m_readyread_pipe_flags[i] = 0;
         }
     }
+
+    if (m_epoll_fd >= 0)
+    {
+        ::close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
 }
 
 void MythSocketThread::StartReadyReadThread(void)
@@ -88,6 +99,39 @@ void MythSocketThread::StartReadyReadThread(void)
     {
         atexit(ShutdownRRT);
         setup_pipe(m_readyread_pipe, m_readyread_pipe_flags);
+
+#ifdef linux
+        // epoll needs the pipe to be woken up, without it select() is used
+        if (m_readyread_pipe[0] >= 0 &&
+            (m_readyread_pipe_flags[0] & O_NONBLOCK) &&
+            !getenv("MYTHTV_NOEPOLL"))
+        {
+            m_epoll_fd = epoll_create(kMaxEpollEvents);
+            if (m_epoll_fd < 0)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "epoll_create failed, using select" + ENO);
+            }
+            else
+            {
+                // The pipe is the only descriptor without a socket pointer
+                struct epoll_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN;
+                ev.data.ptr = NULL;
+                if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD,
+                              m_readyread_pipe[0], &ev) < 0)
+                {
+                    LOG(VB_GENERAL, LOG_WARNING, LOC +
+                        "Can't add the readyread pipe to epoll, "
+                        "using select" + ENO);
+                    ::close(m_epoll_fd);
+                    m_epoll_fd = -1;
+                }
+            }
+        }
+#endif
+
         m_readyread_run = true;
         start();
         m_readyread_started_wait.wait(&m_readyread_lock);
@@ -123,6 +167,16 @@ void MythSocketThread::RemoveFromReadyRead(MythSocket *sock)
     WakeReadyReadThread();
 }
 
+/// \brief Tells the thread the descriptor of sock may have changed.
+void MythSocketThread::UpdateReadyRead(MythSocket *sock)
+{
+    {
+        QMutexLocker locker(&m_readyread_lock);
+        m_readyread_updatelist.push_back(sock);
+    }
+    WakeReadyReadThread();
+}
+
 void MythSocketThread::WakeReadyReadThread(void) const
 {
     if (!isRunning())
@@ -188,6 +242,9 @@ void MythSocketThread::ProcessAddRemoveQueues(void)
         m_readyread_addlist.pop_front();
         m_readyread_list.push_back(sock);
     }
+
+    // The fd set is built from scratch every time
+    m_readyread_updatelist.clear();
 }
 
 void MythSocketThread::run(void)
@@ -195,6 +252,19 @@ void MythSocketThread::run(void)
     RunProlog();
     LOG(VB_SOCKET, LOG_DEBUG, LOC + "readyread thread start");
 
+    if (m_epoll_fd >= 0)
+        RunEpoll();
+    else
+        RunSelect();
+
+    LOG(VB_SOCKET, LOG_DEBUG, LOC + "readyread thread exit");
+    RunEpilog();
+}
+
+/// \brief Waits for readable sockets with select(), the fd set is rebuilt
+///        from all sockets on every iteration.
+void MythSocketThread::RunSelect(void)
+{
     QMutexLocker locker(&m_readyread_lock);
     m_readyread_started_wait.wakeAll();
     while (m_readyread_run)
@@ -376,7 +446,182 @@ void MythSocketThread::run(void)
         m_readyread_lock.lock();
         LOG(VB_SOCKET, LOG_DEBUG, LOC + "Reacquired ready read lock");
     }
+}
 
-    LOG(VB_SOCKET, LOG_DEBUG, LOC + "readyread thread exit");
-    RunEpilog();
+#ifdef linux
+
+void MythSocketThread::EpollAdd(MythSocket *sock)
+{
+    int fd = sock->socket();
+    m_epoll_sockets[sock] = fd;
+
+    if (fd < 0)
+        return; // added when UpdateReadyRead() reports a descriptor
+
+    // Edge triggered, so a socket with unread data doesn't wake us over
+    // and over. Sockets with an event stay in m_epoll_pending until they
+    // have been read empty.
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = sock;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        LOG(VB_SOCKET, LOG_ERR, SLOC(sock) + "epoll_ctl add failed" + ENO);
+        m_epoll_sockets[sock] = -1;
+        return;
+    }
+
+    // Data may have arrived before the socket was added
+    m_epoll_pending.insert(sock);
+}
+
+void MythSocketThread::ProcessEpollQueues(void)
+{
+    while (!m_readyread_dellist.empty())
+    {
+        MythSocket *sock = m_readyread_dellist.front();
+        m_readyread_dellist.pop_front();
+
+        QHash<MythSocket*,int>::iterator it = m_epoll_sockets.find(sock);
+        if (it == m_epoll_sockets.end())
+            continue;
+
+        // A closed descriptor has left the epoll set on its own, and its
+        // number may already belong to another socket.
+        if (*it >= 0 && *it == sock->socket())
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, *it, NULL);
+
+        m_epoll_sockets.erase(it);
+        m_epoll_pending.remove(sock);
+        m_readyread_downref_list.push_back(sock);
+    }
+
+    while (!m_readyread_addlist.empty())
+    {
+        MythSocket *sock = m_readyread_addlist.front();
+        m_readyread_addlist.pop_front();
+
+        // Already watched, only the reference needs to be given back
+        if (m_epoll_sockets.contains(sock))
+            m_readyread_downref_list.push_back(sock);
+        else
+            EpollAdd(sock);
+    }
+
+    while (!m_readyread_updatelist.empty())
+    {
+        MythSocket *sock = m_readyread_updatelist.front();
+        m_readyread_updatelist.pop_front();
+
+        QHash<MythSocket*,int>::const_iterator it = m_epoll_sockets.find(sock);
+        if (it != m_epoll_sockets.end() && *it != sock->socket())
+            EpollAdd(sock);
+    }
 }
+
+/// \brief Waits for readable sockets with epoll, adding and removing a
+///        socket is O(1) and only sockets with events are looked at.
+void MythSocketThread::RunEpoll(void)
+{
+    struct epoll_event events[kMaxEpollEvents];
+
+    QMutexLocker locker(&m_readyread_lock);
+    m_readyread_started_wait.wakeAll();
+    while (m_readyread_run)
+    {
+        ProcessEpollQueues();
+
+        // Nothing pending, wait for events. Pending sockets are locked or
+        // waiting for their readyRead() handler, whoever has them wakes us
+        // up through the pipe when done.
+        m_readyread_lock.unlock();
+        LOG(VB_SOCKET, LOG_DEBUG, LOC + "Waiting on epoll..");
+        int nfds = epoll_wait(m_epoll_fd, events, kMaxEpollEvents, -1);
+        m_readyread_lock.lock();
+
+        if (nfds < 0)
+        {
+            if (errno != EINTR)
+            {
+                LOG(VB_SOCKET, LOG_ERR, LOC + "epoll_wait returned error" +
+                    ENO);
+                m_readyread_wait.wait(&m_readyread_lock, kShortWait);
+            }
+            continue;
+        }
+
+        // Sockets removed since the wait are no longer in m_epoll_sockets,
+        // they are only dereferenced below so the pointers are still good.
+        ProcessEpollQueues();
+
+        for (int i = 0; i < nfds; i++)
+        {
+            MythSocket *sock = (MythSocket*) events[i].data.ptr;
+            if (!sock)
+            {
+                char dummy[128];
+                while (::read(m_readyread_pipe[0], dummy, 128) > 0);
+            }
+            else if (m_epoll_sockets.contains(sock))
+            {
+                m_epoll_pending.insert(sock);
+            }
+        }
+
+        QList<MythSocket*> pending = m_epoll_pending.toList();
+        QList<MythSocket*> downref = m_readyread_downref_list;
+        m_readyread_downref_list.clear();
+
+        // ReadyToBeRead allows calls back into the socket so we need
+        // to release the lock for a little while.
+        m_readyread_lock.unlock();
+
+        QList<MythSocket*>::const_iterator it = downref.begin();
+        for (; it != downref.end(); ++it)
+            (*it)->DownRef();
+
+        QList<MythSocket*> done;
+        QTime tm = QTime::currentTime();
+        for (it = pending.begin(); it != pending.end() && m_readyread_run;
+             ++it)
+        {
+            MythSocket *sock = *it;
+            if (!sock->TryLock(false))
+                continue; // whoever has it wakes us when done
+
+            if (sock->state() != MythSocket::Connected ||
+                !sock->m_cb || !sock->m_useReadyReadCallback)
+            {
+                // Nobody to tell, the next data brings a new event
+                done.push_back(sock);
+            }
+            else if (!sock->m_notifyread)
+            {
+                if (sock->bytesAvailable() > 0 || sock->closedByRemote())
+                    ReadyToBeRead(sock);
+                else
+                    done.push_back(sock);
+            }
+            sock->Unlock(false);
+        }
+
+        LOG(VB_SOCKET, LOG_DEBUG, LOC +
+            QString("Processed %1 pending sockets in %2ms")
+                .arg(pending.size()).arg(tm.elapsed()));
+
+        m_readyread_lock.lock();
+
+        for (it = done.begin(); it != done.end(); ++it)
+            m_epoll_pending.remove(*it);
+    }
+}
+
+#else // linux
+
+void MythSocketThread::RunEpoll(void)
+{
+    RunSelect();
+}
+
+#endif // linux
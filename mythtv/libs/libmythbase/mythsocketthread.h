@@ -4,6 +4,8 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <QList>
+#include <QHash>
+#include <QSet>
 
 #include "mythbaseexp.h"
 #include "mthread.h"
@@ -24,9 +26,14 @@ class MythSocketThread : public MThread
 
     void AddToReadyRead(MythSocket *sock);
     void RemoveFromReadyRead(MythSocket *sock);
+    void UpdateReadyRead(MythSocket *sock);
 
   private:
+    void RunSelect(void);
+    void RunEpoll(void);
     void ProcessAddRemoveQueues(void);
+    void ProcessEpollQueues(void);
+    void EpollAdd(MythSocket *sock);
     void ReadyToBeRead(MythSocket *sock);
     void CloseReadyReadPipe(void) const;
 
@@ -42,8 +49,17 @@ class MythSocketThread : public MThread
     QList<MythSocket*> m_readyread_dellist;
     QList<MythSocket*> m_readyread_addlist;
     QList<MythSocket*> m_readyread_downref_list;
+    QList<MythSocket*> m_readyread_updatelist;
+
+    /// epoll instance, -1 when the select() loop is used
+    mutable int             m_epoll_fd;
+    /// sockets in the epoll set and the descriptor they were added with
+    QHash<MythSocket*,int>  m_epoll_sockets;
+    /// sockets that had an event and may still have data to be read
+    QSet<MythSocket*>       m_epoll_pending;
 
     static const uint kShortWait;
+    static const int  kMaxEpollEvents;
 };
 
 #endif // _MYTH_SOCKET_THREAD_H_
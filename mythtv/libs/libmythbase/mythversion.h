@@ -34,9 +34,12 @@
  *   MythTV Python Bindings
  *       mythtv/bindings/python/MythTV/static.py (version number)
  *       mythtv/bindings/python/MythTV/mythproto.py (layout)
+ *
+ *   Development tools
+ *       mythtv/contrib/development/socketload/socketload.c (version number)
  */
-#define MYTH_PROTO_VERSION "69"
-#define MYTH_PROTO_TOKEN "63835135"
+#define MYTH_PROTO_VERSION "71"
+#define MYTH_PROTO_TOKEN "05e82186"
 
 /** \brief Increment this whenever the MythTV core database schema changes.
  *
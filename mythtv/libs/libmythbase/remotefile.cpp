@@ -6,6 +6,7 @@ using namespace std;
 #include "mythconfig.h"
 #include "mythdb.h"
 #include "remotefile.h"
+#include "remotefilehttp.h"
 #include "mythcorecontext.h"
 #include "mythsocket.h"
 #include "compat.h"
@@ -21,7 +22,8 @@ RemoteFile::RemoteFile(const QString &_path, bool write, bool useRA,
     lock(QMutex::NonRecursive),
     controlSock(NULL),    sock(NULL),
     query("QUERY_FILETRANSFER %1"),
-    writemode(write)
+    writemode(write),
+    http(NULL),           sockposition(0)
 {
     if (writemode)
     {
@@ -44,6 +46,7 @@ RemoteFile::~RemoteFile()
         controlSock->DownRef();
     if (sock)
         sock->DownRef();
+    delete http;
 }
 
 MythSocket *RemoteFile::openSocket(bool control)
@@ -182,9 +185,50 @@ bool RemoteFile::Open(void)
         Close();
         return false;
     }
+
+    openHTTP();
     return true;
 }
 
+/** \fn RemoteFile::openHTTP(void)
+ *  \brief Sets up reading of the file through the backend's HttpServer.
+ *
+ *  The file data socket is kept open, it is still used for writing
+ *  and for reading data beyond what the backend reported as the
+ *  file size, since it waits for a recording in progress to grow.
+ */
+void RemoteFile::openHTTP(void)
+{
+    delete http;
+    http = NULL;
+
+    QUrl qurl(path);
+    QString sgroup = qurl.userName();
+    if (writemode || !usereadahead || sgroup.isEmpty() ||
+        !gCoreContext->GetNumSetting("RemoteFileHTTPRange", 1))
+    {
+        return;
+    }
+
+    QString filename = qurl.path();
+    if (!qurl.fragment().isEmpty() || path.right(1) == "#")
+        filename = filename + "#" + qurl.fragment();
+
+    if (filename.left(1) == "/")
+        filename = filename.right(filename.length()-1);
+
+    int port = GetMythDB()->GetSettingOnHost("BackendStatusPort",
+                                             qurl.host()).toInt();
+    if (port <= 0)
+        port = 6544;
+
+    http = new RemoteFileHTTP(sock->peerAddress(), port, sgroup,
+                              filename, filesize);
+
+    LOG(VB_FILE, LOG_INFO, QString("RemoteFile: Reading %1 over HTTP port %2")
+            .arg(path).arg(port));
+}
+
 void RemoteFile::Close(void)
 {
     if (!controlSock)
@@ -210,6 +254,8 @@ void RemoteFile::Close(void)
         controlSock->DownRef();
         controlSock = NULL;
     }
+    delete http;
+    http = NULL;
 
     lock.unlock();
 }
@@ -358,7 +404,7 @@ void RemoteFile::Reset(void)
 
 long long RemoteFile::Seek(long long pos, int whence, long long curpos)
 {
-    lock.lock();
+    QMutexLocker locker(&lock);
     if (!sock)
     {
         LOG(VB_NETWORK, LOG_ERR, "RemoteFile::Seek(): Called with no socket");
@@ -371,6 +417,29 @@ long long RemoteFile::Seek(long long pos, int whence, long long curpos)
     if (!controlSock->isOpen() || controlSock->error())
         return 0;
 
+    if (http && whence != SEEK_END)
+    {
+        // Reads are served over HTTP, so there is no buffered data to
+        // discard. The data socket only follows if a read falls back to it.
+        if (whence == SEEK_CUR)
+            pos += (curpos > 0) ? curpos : readposition;
+        if (pos < 0)
+            return -1;
+        readposition = pos;
+        return readposition;
+    }
+
+    long long retval = SeekInternal(pos, whence, curpos);
+    locker.unlock();
+
+    Reset();
+
+    return retval;
+}
+
+/// \brief Seeks the backend file transfer, the caller must hold the lock.
+long long RemoteFile::SeekInternal(long long pos, int whence, long long curpos)
+{
     QStringList strlist( QString(query).arg(recordernum) );
     strlist << "SEEK";
     strlist << QString::number(pos);
@@ -382,12 +451,10 @@ long long RemoteFile::Seek(long long pos, int whence, long long curpos)
 
     controlSock->writeStringList(strlist);
     controlSock->readStringList(strlist);
-    lock.unlock();
 
     long long retval = strlist[0].toLongLong();
-    readposition = retval;
-
-    Reset();
+    if (retval >= 0)
+        readposition = sockposition = retval;
 
     return retval;
 }
@@ -497,6 +564,37 @@ int RemoteFile::Read(void *data, int size)
     if (!controlSock->isOpen() || controlSock->error())
         return -1;
 
+    if (http && http->CanRead(readposition))
+    {
+        int ret = http->Read(readposition, data, size);
+
+        statslock.lock();
+        cachestats = http->GetStats();
+        statslock.unlock();
+
+        if (ret > 0)
+        {
+            readposition += ret;
+            return ret;
+        }
+
+        LOG(VB_GENERAL, LOG_WARNING, "RemoteFile::Read(): HTTP read failed, "
+            "falling back to the file data socket");
+        delete http;
+        http = NULL;
+
+        statslock.lock();
+        cachestats.clear();
+        statslock.unlock();
+    }
+
+    if (sockposition != readposition)
+    {
+        // the data socket is behind after reads served over HTTP
+        if (SeekInternal(readposition, SEEK_SET, readposition) < 0)
+            return -1;
+    }
+
     if (sock->bytesAvailable() > 0)
     {
         LOG(VB_NETWORK, LOG_ERR,
@@ -580,6 +678,8 @@ int RemoteFile::Read(void *data, int size)
 
     if (error || sent != recv)
         recv = -1;
+    else
+        readposition = sockposition = readposition + recv;
 
     return recv;
 }
@@ -595,6 +695,14 @@ bool RemoteFile::SaveAs(QByteArray &data)
     return true;
 }
 
+/// \brief Returns the block cache hit rate and fetch latency of the
+///        HTTP transport, or an empty string if it is not in use.
+QString RemoteFile::GetCacheStats(void) const
+{
+    QMutexLocker locker(&statslock);
+    return cachestats;
+}
+
 void RemoteFile::SetTimeout(bool fast)
 {
     if (timeoutisfast == fast)
@@ -10,6 +10,7 @@
 #include "mythbaseexp.h"
 
 class MythSocket;
+class RemoteFileHTTP;
 
 class MBASE_PUBLIC RemoteFile
 {
@@ -54,8 +55,12 @@ class MBASE_PUBLIC RemoteFile
     QStringList GetAuxiliaryFiles(void) const
         { return auxfiles; }
 
+    QString GetCacheStats(void) const;
+
   private:
     MythSocket     *openSocket(bool control);
+    void            openHTTP(void);
+    long long       SeekInternal(long long pos, int whence, long long curpos);
 
     QString         path;
     bool            usereadahead;
@@ -74,6 +79,11 @@ class MBASE_PUBLIC RemoteFile
 
     QStringList     possibleauxfiles;
     QStringList     auxfiles;
+
+    RemoteFileHTTP *http;
+    long long       sockposition;
+    mutable QMutex  statslock;
+    QString         cachestats;
 };
 
 #endif
@@ -0,0 +1,402 @@
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
+// Qt headers
+#include <QStringList>
+#include <QUrl>
+
+// MythTV headers
+#include "remotefilehttp.h"
+#include "msocketdevice.h"
+#include "mythlogging.h"
+#include "mythtimer.h"
+
+#define LOC QString("RemoteFileHTTP: ")
+
+/// Size of the process wide block cache
+#define BLOCK_CACHE_SIZE     (64 * 1024 * 1024)
+/// Most blocks fetched with a single Range request
+#define MAX_FETCH_BLOCKS     16
+/// Idle connections are dropped well before HttpServer's keep alive timeout
+#define MAX_IDLE_MS          5000
+#define MAX_IDLE_CONNECTIONS 8
+#define HTTP_TIMEOUT_MS      10000
+#define MAX_HEADER_SIZE      16384
+
+RemoteBlockCache *RemoteBlockCache::s_cache = NULL;
+static QMutex s_cacheLock;
+
+RemoteBlockCache *RemoteBlockCache::GetCache(void)
+{
+    QMutexLocker locker(&s_cacheLock);
+    if (!s_cache)
+        s_cache = new RemoteBlockCache(BLOCK_CACHE_SIZE);
+    return s_cache;
+}
+
+RemoteBlockCache::RemoteBlockCache(uint max_bytes) :
+    m_bytes(0), m_maxBytes(max_bytes)
+{
+}
+
+/// \brief Copies a cached block to data and marks it as recently used.
+bool RemoteBlockCache::Get(const QString &file, long long block,
+                           QByteArray &data)
+{
+    QMutexLocker locker(&m_lock);
+    BlockIndex::iterator it = m_index.find(BlockKey(file, block));
+    if (it == m_index.end())
+        return false;
+
+    m_blocks.splice(m_blocks.begin(), m_blocks, *it);
+    data = (*it)->second;
+    return true;
+}
+
+bool RemoteBlockCache::Contains(const QString &file, long long block) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_index.contains(BlockKey(file, block));
+}
+
+/// \brief Adds a block, evicting the least recently used blocks if
+///        the cache would grow beyond its size limit.
+void RemoteBlockCache::Put(const QString &file, long long block,
+                           const QByteArray &data)
+{
+    QMutexLocker locker(&m_lock);
+    BlockKey key(file, block);
+    if (m_index.contains(key))
+        return;
+
+    m_blocks.push_front(Block(key, data));
+    m_index.insert(key, m_blocks.begin());
+    m_bytes += data.size();
+
+    while (m_bytes > m_maxBytes && m_blocks.size() > 1)
+    {
+        m_bytes -= m_blocks.back().second.size();
+        m_index.remove(m_blocks.back().first);
+        m_blocks.pop_back();
+    }
+}
+
+namespace
+{
+    class IdleConnection
+    {
+      public:
+        QString        host;
+        MSocketDevice *sock;
+        MythTimer      idle;
+    };
+}
+
+static QMutex               s_poolLock;
+static list<IdleConnection> s_idleConnections;
+
+/** \brief Returns an idle keep-alive connection to addr:port, or a new
+ *         connection if there is none.
+ *  \param reused set to true if the connection came from the pool, the
+ *                server may have closed it in the meantime.
+ */
+static MSocketDevice *take_connection(const QHostAddress &addr, quint16 port,
+                                      bool &reused)
+{
+    QString host = QString("%1:%2").arg(addr.toString()).arg(port);
+
+    s_poolLock.lock();
+    list<IdleConnection>::iterator it = s_idleConnections.begin();
+    while (it != s_idleConnections.end())
+    {
+        if (it->idle.elapsed() > MAX_IDLE_MS)
+        {
+            delete it->sock;
+            it = s_idleConnections.erase(it);
+        }
+        else if (it->host == host)
+        {
+            MSocketDevice *sock = it->sock;
+            s_idleConnections.erase(it);
+            s_poolLock.unlock();
+            reused = true;
+            return sock;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    s_poolLock.unlock();
+
+    reused = false;
+    MSocketDevice *sock = new MSocketDevice(MSocketDevice::Stream);
+    if (!sock->connect(addr, port))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Could not connect to %1").arg(host));
+        delete sock;
+        return NULL;
+    }
+    return sock;
+}
+
+static void return_connection(const QHostAddress &addr, quint16 port,
+                              MSocketDevice *sock)
+{
+    IdleConnection conn;
+    conn.host = QString("%1:%2").arg(addr.toString()).arg(port);
+    conn.sock = sock;
+    conn.idle.start();
+
+    QMutexLocker locker(&s_poolLock);
+    if (s_idleConnections.size() >= MAX_IDLE_CONNECTIONS)
+    {
+        delete s_idleConnections.back().sock;
+        s_idleConnections.pop_back();
+    }
+    s_idleConnections.push_front(conn);
+}
+
+/// \brief Waits until data is available, returns false on timeout
+///        or if the connection was closed.
+static bool wait_for_data(MSocketDevice *sock, MythTimer &timer)
+{
+    while (timer.elapsed() < HTTP_TIMEOUT_MS)
+    {
+        bool timeout = false;
+        qint64 avail = sock->waitForMore(100, &timeout);
+        if (avail > 0)
+            return true;
+        if (avail < 0 || !timeout)
+            return false;
+    }
+    return false;
+}
+
+RemoteFileHTTP::RemoteFileHTTP(const QHostAddress &addr, quint16 port,
+                               const QString &sgroup, const QString &filename,
+                               long long filesize) :
+    m_addr(addr),             m_port(port),
+    m_knownSize(filesize),
+    m_hits(0),                m_misses(0),
+    m_fetches(0),             m_fetchLatency(0.0f)
+{
+    m_path = QString("/Content/GetFile?StorageGroup=%1&FileName=%2")
+        .arg(QString(QUrl::toPercentEncoding(sgroup)))
+        .arg(QString(QUrl::toPercentEncoding(filename)));
+    m_cacheKey = QString("%1:%2%3")
+        .arg(addr.toString()).arg(port).arg(m_path);
+}
+
+/** \fn RemoteFileHTTP::Read(long long, void*, int)
+ *  \brief Reads up to size bytes at pos from the block cache, fetching
+ *         missing blocks from the backend.
+ *  \return number of bytes read, or -1 if nothing could be read.
+ */
+int RemoteFileHTTP::Read(long long pos, void *data, int size)
+{
+    RemoteBlockCache *cache = RemoteBlockCache::GetCache();
+    size = (int) min((long long) size, m_knownSize - pos);
+
+    int got = 0;
+    while (got < size)
+    {
+        long long cur    = pos + got;
+        long long block  = cur / kBlockSize;
+        int       offset = cur % kBlockSize;
+        QByteArray buf;
+
+        if (cache->Get(m_cacheKey, block, buf))
+        {
+            m_hits++;
+        }
+        else
+        {
+            // fetch the whole run of missing blocks this read needs
+            long long last = (pos + size - 1) / kBlockSize;
+            int count = 1;
+            while (block + count <= last && count < MAX_FETCH_BLOCKS &&
+                   !cache->Contains(m_cacheKey, block + count))
+            {
+                count++;
+            }
+            m_misses += count;
+
+            if (!Fetch(block, count, buf))
+                return got ? got : -1;
+        }
+
+        int len = min(buf.size() - offset, size - got);
+        if (len <= 0)
+            break;
+        memcpy((char *)data + got, buf.constData() + offset, len);
+        got += len;
+    }
+
+    return got;
+}
+
+/** \fn RemoteFileHTTP::Fetch(long long, int, QByteArray&)
+ *  \brief Fetches count blocks starting at block first with one Range
+ *         request and adds the complete blocks to the cache.
+ *
+ *  A pooled connection may have been closed by the server since it was
+ *  last used, in which case the request is retried on a new connection.
+ */
+bool RemoteFileHTTP::Fetch(long long first, int count, QByteArray &body)
+{
+    long long start = first * kBlockSize;
+    long long end   = start + (long long) count * kBlockSize - 1;
+
+    QByteArray request = QString(
+        "GET %1 HTTP/1.1\r\n"
+        "Host: %2:%3\r\n"
+        "Range: bytes=%4-%5\r\n"
+        "Connection: Keep-Alive\r\n"
+        "\r\n")
+        .arg(m_path).arg(m_addr.toString()).arg(m_port)
+        .arg(start).arg(end).toLatin1();
+
+    MythTimer timer;
+    timer.start();
+
+    bool ok = false;
+    for (int attempt = 0; attempt < 2 && !ok; attempt++)
+    {
+        bool reused = false;
+        MSocketDevice *sock = take_connection(m_addr, m_port, reused);
+        if (!sock)
+            return false;
+
+        bool keepalive = false;
+        ok = Request(sock, request, body, keepalive);
+        if (ok && keepalive)
+            return_connection(m_addr, m_port, sock);
+        else
+            delete sock;
+
+        if (!reused)
+            break;
+    }
+
+    if (!ok)
+    {
+        LOG(VB_FILE, LOG_ERR, LOC + QString("Range %1-%2 of %3 failed")
+                .arg(start).arg(end).arg(m_path));
+        return false;
+    }
+
+    int elapsed = timer.elapsed();
+    m_fetchLatency = m_fetches ?
+        (m_fetchLatency * 7.0f + elapsed) / 8.0f : (float) elapsed;
+    m_fetches++;
+
+    for (int i = 0; (i + 1) * kBlockSize <= body.size(); i++)
+    {
+        RemoteBlockCache::GetCache()->Put(
+            m_cacheKey, first + i, body.mid(i * kBlockSize, kBlockSize));
+    }
+
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("Fetched %1 bytes at %2 in %3ms")
+            .arg(body.size()).arg(start).arg(elapsed));
+
+    return !body.isEmpty();
+}
+
+/** \fn RemoteFileHTTP::Request(MSocketDevice*, const QByteArray&, QByteArray&, bool&)
+ *  \brief Sends a Range request and reads the partial content response.
+ *  \param keepalive set to true if the connection may be reused.
+ */
+bool RemoteFileHTTP::Request(MSocketDevice *sock, const QByteArray &request,
+                             QByteArray &body, bool &keepalive)
+{
+    if (sock->writeBlock(request.constData(), request.size()) !=
+        request.size())
+    {
+        return false;
+    }
+
+    MythTimer timer;
+    timer.start();
+
+    // Read the response header, anything after it is the start of the body
+    QByteArray data;
+    int hdrlen;
+    while ((hdrlen = data.indexOf("\r\n\r\n")) < 0)
+    {
+        if (data.size() > MAX_HEADER_SIZE || !wait_for_data(sock, timer))
+            return false;
+
+        int old = data.size();
+        data.resize(old + sock->bytesAvailable());
+        qint64 ret = sock->readBlock(data.data() + old, data.size() - old);
+        if (ret <= 0)
+            return false;
+        data.resize(old + ret);
+    }
+
+    QStringList lines = QString::fromLatin1(data.constData(), hdrlen)
+        .split("\r\n");
+    QStringList status = lines[0].split(' ', QString::SkipEmptyParts);
+    if (status.size() < 2 || status[1] != "206")
+    {
+        LOG(VB_FILE, LOG_ERR, LOC + QString("Unexpected response '%1'")
+                .arg(lines[0]));
+        return false;
+    }
+
+    long long length = -1;
+    keepalive = !status[0].endsWith("1.0");
+    for (int i = 1; i < lines.size(); i++)
+    {
+        int colon = lines[i].indexOf(':');
+        if (colon < 0)
+            continue;
+        QString name  = lines[i].left(colon).trimmed().toLower();
+        QString value = lines[i].mid(colon + 1).trimmed();
+
+        if (name == "content-length")
+        {
+            length = value.toLongLong();
+        }
+        else if (name == "content-range")
+        {
+            // bytes <start>-<end>/<total>, the file may have grown
+            long long total = value.section('/', 1).toLongLong();
+            m_knownSize = max(m_knownSize, total);
+        }
+        else if (name == "connection")
+        {
+            keepalive = value.toLower() == "keep-alive";
+        }
+    }
+
+    if (length < 0 || length > (long long) MAX_FETCH_BLOCKS * kBlockSize)
+        return false;
+
+    body = data.mid(hdrlen + 4);
+    int have = body.size();
+    body.resize(length);
+    while (have < length)
+    {
+        if (!wait_for_data(sock, timer))
+            return false;
+        qint64 ret = sock->readBlock(body.data() + have, length - have);
+        if (ret <= 0)
+            return false;
+        have += ret;
+    }
+
+    return true;
+}
+
+/// \brief Returns the block cache hit rate and average fetch latency.
+QString RemoteFileHTTP::GetStats(void) const
+{
+    uint lookups = m_hits + m_misses;
+    return QString("HTTP, %1% cache hits, %2ms/fetch")
+        .arg(lookups ? (m_hits * 100) / lookups : 0)
+        .arg((int) m_fetchLatency);
+}
@@ -0,0 +1,95 @@
+// -*- Mode: c++ -*-
+#ifndef REMOTE_FILE_HTTP_H
+#define REMOTE_FILE_HTTP_H
+
+// C++ headers
+#include <list>
+using namespace std;
+
+// Qt headers
+#include <QHostAddress>
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+
+class MSocketDevice;
+
+/** \class RemoteBlockCache
+ *  \brief Process wide LRU cache of file blocks fetched by RemoteFileHTTP.
+ *
+ *  Only complete blocks are cached, so blocks of a file that is still
+ *  being recorded never change once they are in the cache.
+ */
+class RemoteBlockCache
+{
+  public:
+    static RemoteBlockCache *GetCache(void);
+
+    bool Get(const QString &file, long long block, QByteArray &data);
+    bool Contains(const QString &file, long long block) const;
+    void Put(const QString &file, long long block, const QByteArray &data);
+
+  private:
+    explicit RemoteBlockCache(uint max_bytes);
+
+    typedef QPair<QString,long long>          BlockKey;
+    typedef pair<BlockKey,QByteArray>         Block;
+    typedef list<Block>                       BlockList;
+    typedef QHash<BlockKey,BlockList::iterator> BlockIndex;
+
+    mutable QMutex m_lock;
+    BlockList      m_blocks;   ///< most recently used first
+    BlockIndex     m_index;
+    uint           m_bytes;
+    uint           m_maxBytes;
+
+    static RemoteBlockCache *s_cache;
+};
+
+/** \class RemoteFileHTTP
+ *  \brief Reads a backend file through the backend's HttpServer.
+ *
+ *  Reads are split into kBlockSize aligned blocks. Blocks missing from
+ *  the RemoteBlockCache are fetched with a single Range request over a
+ *  pooled keep-alive connection, so seeking back into a recently read
+ *  region does not touch the network at all.
+ *
+ *  This class is not thread safe, RemoteFile serializes access to it.
+ */
+class RemoteFileHTTP
+{
+  public:
+    RemoteFileHTTP(const QHostAddress &addr, quint16 port,
+                   const QString &sgroup, const QString &filename,
+                   long long filesize);
+
+    /// \brief Returns true if the data at pos is known to exist
+    ///        on the backend, later data must be read via Myth protocol.
+    bool CanRead(long long pos) const
+        { return pos >= 0 && pos < m_knownSize; }
+    int Read(long long pos, void *data, int size);
+
+    QString GetStats(void) const;
+
+    static const int kBlockSize = 256 * 1024;
+
+  private:
+    bool Fetch(long long first, int count, QByteArray &body);
+    bool Request(MSocketDevice *sock, const QByteArray &request,
+                 QByteArray &body, bool &keepalive);
+
+    QHostAddress m_addr;
+    quint16      m_port;
+    QString      m_path;       ///< request path and query
+    QString      m_cacheKey;
+    long long    m_knownSize;
+
+    uint         m_hits;
+    uint         m_misses;
+    uint         m_fetches;
+    float        m_fetchLatency; ///< average in ms
+};
+
+#endif // REMOTE_FILE_HTTP_H
@@ -4,6 +4,7 @@
 #include <QUrl>
 
 #include "storagegroup.h"
+#include "storagegroupindex.h"
 #include "mythcorecontext.h"
 #include "mythdb.h"
 #include "mythlogging.h"
@@ -590,6 +591,15 @@ QString StorageGroup::FindFileDir(QString filename)
     QString result = "";
     QFileInfo checkFile("");
 
+    StorageGroupIndex *index = StorageGroupIndex::GetInstance();
+    if (index && index->Lookup(m_dirlist, filename, result))
+    {
+        LOG(VB_FILE, LOG_DEBUG, LOC +
+            QString("FindFileDir: Index has '%1' in '%2'")
+                .arg(filename).arg(result));
+        return result;
+    }
+
     int curDir = 0;
     while (curDir < m_dirlist.size())
     {
@@ -600,6 +610,9 @@ QString StorageGroup::FindFileDir(QString filename)
         checkFile.setFile(testFile);
         if (checkFile.exists() || checkFile.isSymLink())
         {
+            if (index)
+                index->AddFile(m_dirlist[curDir], filename);
+
             QString tmp = m_dirlist[curDir];
             tmp.detach();
             return tmp;
@@ -752,6 +765,75 @@ void StorageGroup::CheckAllStorageGroupDirs(void)
     }
 }
 
+/** \brief Starts the index of the files in this host's storage
+ *         directories, which speeds up FindFileDir().
+ *
+ *   Meant for the backend, must be called from its main thread.
+ */
+void StorageGroup::StartFileIndex(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    query.prepare("SELECT DISTINCT dirname "
+                  "FROM storagegroup "
+                  "WHERE hostname = :HOSTNAME;");
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+    if (!query.exec() || !query.isActive())
+    {
+        MythDB::DBError("StorageGroup::StartFileIndex()", query);
+        return;
+    }
+
+    QStringList dirs;
+    while (query.next())
+    {
+        /* The storagegroup.dirname column uses utf8_bin collation, so Qt
+         * uses QString::fromAscii() for toString(). Explicitly convert the
+         * value using QString::fromUtf8() to prevent corruption. */
+        QString dirname = QString::fromUtf8(query.value(0)
+                                            .toByteArray().constData());
+        dirname.replace(QRegExp("^\\s*"), "");
+        dirname.replace(QRegExp("\\s*$"), "");
+        if (dirname.right(1) == "/")
+            dirname.remove(dirname.length() - 1, 1);
+
+        if (!dirs.contains(dirname))
+            dirs << dirname;
+    }
+
+    StorageGroupIndex::Start(dirs);
+}
+
+/// \brief Tells the file index about a file that was just created.
+void StorageGroup::AddToFileIndex(const QString &pathname)
+{
+    StorageGroupIndex *index = StorageGroupIndex::GetInstance();
+    if (index)
+        index->AddFile(pathname.section('/', 0, -2),
+                       pathname.section('/', -1));
+}
+
+/// \brief Tells the file index about a file that was just deleted.
+void StorageGroup::RemoveFromFileIndex(const QString &pathname)
+{
+    StorageGroupIndex *index = StorageGroupIndex::GetInstance();
+    if (index)
+        index->RemoveFile(pathname.section('/', 0, -2),
+                          pathname.section('/', -1));
+}
+
+/// \return false if the file index isn't used in this process
+bool StorageGroup::GetFileIndexStats(uint &files, quint64 &hits,
+                                     quint64 &misses)
+{
+    StorageGroupIndex *index = StorageGroupIndex::GetInstance();
+    if (!index)
+        return false;
+
+    index->GetStats(files, hits, misses);
+    return true;
+}
+
 QStringList StorageGroup::getRecordingsGroups(void)
 {
     QStringList groups;
@@ -48,6 +48,12 @@ class MBASE_PUBLIC StorageGroup
     static QStringList getRecordingsGroups(void);
     static QStringList getGroupDirs(QString groupname, QString host);
 
+    static void StartFileIndex(void);
+    static void AddToFileIndex(const QString &pathname);
+    static void RemoveFromFileIndex(const QString &pathname);
+    static bool GetFileIndexStats(uint &files, quint64 &hits,
+                                  quint64 &misses);
+
     static void ClearGroupToUseCache(void);
     static QString GetGroupToUse(
         const QString &host, const QString &sgroup);
@@ -0,0 +1,198 @@
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QDir>
+
+#include "storagegroupindex.h"
+#include "mythlogging.h"
+#include "mthreadpool.h"
+
+#define LOC QString("SGIndex: ")
+
+QMutex             StorageGroupIndex::s_lock;
+StorageGroupIndex *StorageGroupIndex::s_instance = NULL;
+
+/// Lists a storage directory into the index, off the caller's thread
+class StorageGroupIndexLister : public QRunnable
+{
+  public:
+    StorageGroupIndexLister(StorageGroupIndex *index, const QString &dir) :
+        m_index(index), m_dir(dir) {}
+
+    void run(void)
+    {
+        m_index->ListDir(m_dir);
+    }
+
+  private:
+    StorageGroupIndex *m_index;
+    QString            m_dir;
+};
+
+StorageGroupIndex::StorageGroupIndex(const QStringList &dirs) :
+    m_hits(0), m_misses(0), m_watcher(new QFileSystemWatcher(this))
+{
+    QStringList::const_iterator it = dirs.begin();
+    for (; it != dirs.end(); ++it)
+    {
+        if (QDir(*it).exists())
+            m_watcher->addPath(*it);
+    }
+
+    connect(m_watcher, SIGNAL(directoryChanged(const QString&)),
+            this,      SLOT(DirectoryChanged(const QString&)));
+}
+
+/** \fn StorageGroupIndex::Start(const QStringList&)
+ *  \brief Creates the index and starts listing dirs into it.
+ *
+ *  Must be called from a thread with an event loop, the inotify
+ *  notifications are delivered to it.
+ */
+void StorageGroupIndex::Start(const QStringList &dirs)
+{
+    QMutexLocker locker(&s_lock);
+
+    if (s_instance)
+        return;
+
+    s_instance = new StorageGroupIndex(dirs);
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Indexing %1 storage directories").arg(dirs.size()));
+
+    QStringList::const_iterator it = dirs.begin();
+    for (; it != dirs.end(); ++it)
+    {
+        MThreadPool::globalInstance()->start(
+            new StorageGroupIndexLister(s_instance, *it),
+            "StorageGroupIndexLister");
+    }
+}
+
+/// Returns the index, or NULL if Start() wasn't called in this process
+StorageGroupIndex *StorageGroupIndex::GetInstance(void)
+{
+    QMutexLocker locker(&s_lock);
+    return s_instance;
+}
+
+/** \fn StorageGroupIndex::Lookup(const QStringList&, const QString&, QString&)
+ *  \brief Finds the first directory of dirs that holds filename.
+ *
+ *  \return false if the index doesn't know, the caller has to scan.
+ */
+bool StorageGroupIndex::Lookup(const QStringList &dirs,
+                               const QString &filename, QString &dir)
+{
+    if (filename.contains('/'))
+        return false;
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString,QStringList>::const_iterator it = m_files.find(filename);
+    if (it != m_files.end())
+    {
+        QStringList::const_iterator dit = dirs.begin();
+        for (; dit != dirs.end() && dir.isEmpty(); ++dit)
+        {
+            if ((*it).contains(*dit))
+                dir = *dit;
+        }
+    }
+
+    if (dir.isEmpty())
+    {
+        m_misses++;
+        return false;
+    }
+
+    locker.unlock();
+
+    QFileInfo checkFile(dir + "/" + filename);
+    bool exists = checkFile.exists() || checkFile.isSymLink();
+
+    if (!exists)
+    {
+        LOG(VB_FILE, LOG_DEBUG, LOC +
+            QString("'%1' is no longer in '%2'").arg(filename).arg(dir));
+        RemoveFile(dir, filename);
+        dir.clear();
+    }
+
+    locker.relock();
+    if (exists)
+        m_hits++;
+    else
+        m_misses++;
+
+    return exists;
+}
+
+void StorageGroupIndex::AddFile(const QString &dir, const QString &filename)
+{
+    if (filename.contains('/'))
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    QStringList &dirs = m_files[filename];
+    if (!dirs.contains(dir))
+        dirs.push_back(dir);
+}
+
+void StorageGroupIndex::RemoveFile(const QString &dir, const QString &filename)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString,QStringList>::iterator it = m_files.find(filename);
+    if (it == m_files.end())
+        return;
+
+    (*it).removeAll(dir);
+    if ((*it).isEmpty())
+        m_files.erase(it);
+}
+
+/// \brief Replaces what the index knows about dir with its current files.
+void StorageGroupIndex::ListDir(const QString &dir)
+{
+    QStringList files = QDir(dir).entryList(QDir::Files | QDir::System |
+                                            QDir::Hidden);
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString,QStringList>::iterator it = m_files.begin();
+    while (it != m_files.end())
+    {
+        (*it).removeAll(dir);
+        if ((*it).isEmpty())
+            it = m_files.erase(it);
+        else
+            ++it;
+    }
+
+    QStringList::const_iterator fit = files.begin();
+    for (; fit != files.end(); ++fit)
+        m_files[*fit].push_back(dir);
+
+    LOG(VB_FILE, LOG_DEBUG, LOC +
+        QString("Indexed %1 files in '%2'").arg(files.size()).arg(dir));
+}
+
+void StorageGroupIndex::DirectoryChanged(const QString &dir)
+{
+    MThreadPool::globalInstance()->start(
+        new StorageGroupIndexLister(this, dir), "StorageGroupIndexLister");
+}
+
+void StorageGroupIndex::GetStats(uint &files, quint64 &hits,
+                                 quint64 &misses) const
+{
+    QMutexLocker locker(&m_lock);
+    files  = m_files.size();
+    hits   = m_hits;
+    misses = m_misses;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,57 @@
+#ifndef _STORAGEGROUPINDEX_H
+#define _STORAGEGROUPINDEX_H
+
+#include <QStringList>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+
+class QFileSystemWatcher;
+
+/** \class StorageGroupIndex
+ *  \brief Remembers which storage directories hold a file, so
+ *         StorageGroup::FindFileDir() doesn't have to stat the file in
+ *         every directory of the group.
+ *
+ *  The directories are listed when the index is started and again when
+ *  inotify reports a change in them. Entries are checked with a single
+ *  stat before they are used, stale and missing entries fall back to the
+ *  scan of the group. Only files directly in a storage directory are
+ *  indexed.
+ */
+class StorageGroupIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static void Start(const QStringList &dirs);
+    static StorageGroupIndex *GetInstance(void);
+
+    bool Lookup(const QStringList &dirs, const QString &filename,
+                QString &dir);
+    void AddFile(const QString &dir, const QString &filename);
+    void RemoveFile(const QString &dir, const QString &filename);
+    void ListDir(const QString &dir);
+
+    void GetStats(uint &files, quint64 &hits, quint64 &misses) const;
+
+  private slots:
+    void DirectoryChanged(const QString &dir);
+
+  private:
+    StorageGroupIndex(const QStringList &dirs);
+    ~StorageGroupIndex() {}
+
+    mutable QMutex              m_lock;
+    QHash<QString,QStringList>  m_files;    ///< file, directories it is in
+    quint64                     m_hits;
+    quint64                     m_misses;
+    QFileSystemWatcher         *m_watcher;
+
+    static QMutex               s_lock;
+    static StorageGroupIndex   *s_instance;
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
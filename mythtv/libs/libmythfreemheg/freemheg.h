@@ -44,6 +44,7 @@ class MHEG
   public:
     virtual ~MHEG() {}
     virtual void SetBooting() = 0;
+    // Draw the visibles that overlap the region, bottom of the stack first.
     virtual void DrawDisplay(QRegion toDraw) = 0;
     // Run synchronous actions and process any asynchronous events until the queues are empty.
     // Returns the number of milliseconds until wake-up or 0 if none.
@@ -103,7 +104,8 @@ class MHContext
     // Set the input register.  This sets the keys that are to be handled by MHEG.  Flushes the key queue.
     virtual void SetInputRegister(int nReg) = 0;
 
-    // An area of the screen/image needs to be redrawn.
+    // An area of the screen/image needs to be redrawn.  The region is everything
+    // that has changed since the last call, the rest of the display is as it was.
     virtual void RequireRedraw(const QRegion &region) = 0;
 
     // Creation functions for various visibles.
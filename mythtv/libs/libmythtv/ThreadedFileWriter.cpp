@@ -19,6 +19,7 @@
 #include "mythlogging.h"
 
 #include "mythtimer.h"
+#include "ioaccounting.h"
 #include "compat.h"
 
 #define LOC QString("TFW(%1:%2): ").arg(filename).arg(fd)
@@ -61,6 +62,7 @@ ThreadedFileWriter::ThreadedFileWriter(const QString &fname,
     // file stuff
     filename(fname),                     flags(pflags),
     mode(pmode),                         fd(-1),
+    ioDir(fname.section('/', 0, -2)),    unsyncedBytes(0),
     // state
     flush(false),                        in_dtor(false),
     ignore_writes(false),                tfw_min_write_size(kMinWriteSize),
@@ -69,6 +71,7 @@ ThreadedFileWriter::ThreadedFileWriter(const QString &fname,
     writeThread(NULL),                   syncThread(NULL)
 {
     filename.detach();
+    ioDir.detach();
 }
 
 /** \fn ThreadedFileWriter::Open(void)
@@ -295,6 +298,12 @@ void ThreadedFileWriter::Sync(void)
 {
     if (fd >= 0)
     {
+        buflock.lock();
+        qint64 bytes = unsyncedBytes;
+        unsyncedBytes = 0;
+        buflock.unlock();
+
+        qint64 ioStart = IOAccounting::GetMicroseconds();
 #if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
         // fdatasync tries to avoid updating metadata, but will in
         // practice always update metadata if any data is written
@@ -303,6 +312,12 @@ void ThreadedFileWriter::Sync(void)
 #else
         fsync(fd);
 #endif
+
+        if (bytes > 0)
+        {
+            IOAccounting::AddSync(ioDir, bytes,
+                                  IOAccounting::GetMicroseconds() - ioStart);
+        }
     }
 }
 
@@ -451,6 +466,11 @@ void ThreadedFileWriter::DiskLoop(void)
         buf->lastUsed = QDateTime::currentDateTime();
         emptyBuffers.push_back(buf);
 
+        // write() only fills the page cache, the disk time is
+        // accounted when Sync() flushes these bytes
+        IOAccounting::AddWrite(ioDir, tot);
+        unsyncedBytes += tot;
+
         if (writeTimer.elapsed() > 1000)
         {
             LOG(VB_GENERAL, LOG_WARNING, LOC +
@@ -66,6 +66,8 @@ class ThreadedFileWriter
     int             flags;
     mode_t          mode;
     int             fd;
+    QString         ioDir;  ///< directory the writes are accounted to
+    qint64          unsyncedBytes;      // protected by buflock
 
     // state
     bool            flush;              // protected by buflock
@@ -772,6 +772,26 @@ void AvFormatDecoder::SetEof(bool eof)
     DecoderBase::SetEof(eof);
 }
 
+void AvFormatDecoder::SetTrickPlay(bool enable)
+{
+    if (trickplay == enable)
+        return;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("%1 keyframe only trick-play")
+            .arg(enable ? "Enabling" : "Disabling"));
+
+    QMutexLocker locker(avcodeclock);
+    DecoderBase::SetTrickPlay(enable);
+
+    int index = selectedTrack[kTrackTypeVideo].av_stream_index;
+    if (ic && index >= 0 && index < (int)ic->nb_streams)
+    {
+        AVCodecContext *enc = ic->streams[index]->codec;
+        enc->skip_frame = (enable) ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+    }
+}
+
 void AvFormatDecoder::Reset(bool reset_video_data, bool seek_reset,
                             bool reset_file)
 {
@@ -2960,6 +2980,14 @@ bool AvFormatDecoder::PreProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
 
     justAfterChange = false;
 
+    // In trick-play only keyframes, as flagged by the MPEG and H.264
+    // parsers above, are handed to the codec.
+    if (trickplay && !exitafterdecoded && !(pkt->flags & PKT_FLAG_KEY))
+    {
+        av_free_packet(pkt);
+        return false;
+    }
+
     if (exitafterdecoded)
         gotvideo = 1;
 
@@ -100,6 +100,7 @@ class AvFormatDecoder : public DecoderBase
    ~AvFormatDecoder();
 
     virtual void SetEof(bool eof);
+    virtual void SetTrickPlay(bool enable); // DecoderBase
 
     void CloseCodecs();
     void CloseContext();
@@ -154,6 +154,7 @@ ChannelScanSM::ChannelScanSM(
       extend_scan_list(false),
       // Optional state
       scanDTVTunerType(DTVTunerType::kTunerTypeUnknown),
+      coordinator(NULL),
       // State
       scanning(false),
       threadExit(false),
@@ -339,6 +340,34 @@ bool ChannelScanSM::ScanExistingTransports(uint sourceid, bool follow_nit)
     return scanning;
 }
 
+/**
+ *  \brief Scans the given transports, used by the ScanCoordinator
+ *         to hand each input its share of another scanner's list.
+ *
+ *   This replaces any list set up earlier, so it must be called
+ *   before StartScanner().
+ */
+bool ChannelScanSM::ScanTransportList(
+    const transport_scan_items_t &transports, bool follow_nit)
+{
+    scanning = false;
+    scanTransports = transports;
+    nextIt = current = scanTransports.end();
+
+    extend_scan_list  = follow_nit;
+    waitingForTables  = false;
+    transportsScanned = 0;
+    timer.start();
+
+    if (scanTransports.empty())
+        return false;
+
+    nextIt   = scanTransports.begin();
+    scanning = true;
+
+    return true;
+}
+
 void ChannelScanSM::HandlePAT(const ProgramAssociationTable *pat)
 {
     LOG(VB_CHANSCAN, LOG_INFO, LOC +
@@ -419,6 +448,8 @@ void ChannelScanSM::HandleSDT(uint tsid, const ServiceDescriptionTable *sdt)
 
     uint id = sdt->OriginalNetworkID() << 16 | sdt->TSID();
     ts_scanned.insert(id);
+    if (coordinator)
+        coordinator->TransportScanned(id, (*current).tuning.frequency);
 
     for (uint i = 0; !currentTestingDecryption && i < sdt->ServiceCount(); i++)
     {
@@ -696,6 +727,13 @@ void ChannelScanSM::UpdateScanTransports(const NetworkInformationTable *nit)
                 continue;
             }
 
+            // another input may already be scanning it
+            if (coordinator &&
+                coordinator->IsTransportKnown(id, tuning.frequency))
+            {
+                break;
+            }
+
             extend_transports[id] = tuning;
             break;
         }
@@ -1571,7 +1609,9 @@ void ChannelScanSM::HandleActiveScan(void)
         QMap<uint32_t,DTVMultiplex>::iterator it = extend_transports.begin();
         while (it != extend_transports.end())
         {
-            if (!ts_scanned.contains(it.key()))
+            if (!ts_scanned.contains(it.key()) &&
+                (!coordinator ||
+                 coordinator->ClaimTransport(it.key(), (*it).frequency)))
             {
                 QString name = QString("TransportID %1").arg(it.key() & 0xffff);
                 TransportScanItem item(sourceID, name, *it, signalTimeout);
@@ -1588,7 +1628,10 @@ void ChannelScanSM::HandleActiveScan(void)
     }
     else
     {
-        scan_monitor->ScanComplete();
+        if (coordinator)
+            coordinator->ScanComplete(this);
+        else
+            scan_monitor->ScanComplete();
         scanning = false;
         current = nextIt = scanTransports.end();
     }
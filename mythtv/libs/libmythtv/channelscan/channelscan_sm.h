@@ -44,6 +44,7 @@
 #include "scanmonitor.h"
 #include "signalmonitorlistener.h"
 #include "dtvconfparserhelpers.h" // for DTVTunerType
+#include "scancoordinator.h"
 
 class MThread;
 class MSqlQuery;
@@ -112,15 +113,23 @@ class ChannelScanSM : public MPEGStreamListener,
         const DTVChannelList&);
 
     bool ScanExistingTransports(uint sourceid, bool follow_nit);
+    bool ScanTransportList(const transport_scan_items_t &transports,
+                           bool follow_nit);
 
     void SetAnalog(bool is_analog);
     void SetSourceID(int _SourceID)   { sourceID                = _SourceID; }
     void SetSignalTimeout(uint val)    { signalTimeout = val; }
     void SetChannelTimeout(uint val)   { channelTimeout = val; }
     void SetScanDTVTunerType(DTVTunerType t) { scanDTVTunerType = t; }
+    void SetCoordinator(ScanCoordinator *c) { coordinator = c; }
 
+    DTVTunerType GetScanDTVTunerType(void) const { return scanDTVTunerType; }
     uint GetSignalTimeout(void)  const { return signalTimeout; }
     uint GetChannelTimeout(void) const { return channelTimeout; }
+    bool IsFollowingNIT(void)    const { return extend_scan_list; }
+    /// Only safe to call before StartScanner()
+    transport_scan_items_t GetScanTransports(void) const
+        { return scanTransports; }
 
     SignalMonitor    *GetSignalMonitor(void) { return signalMonitor; }
     DTVSignalMonitor *GetDTVSignalMonitor(void);
@@ -216,6 +225,7 @@ class ChannelScanSM : public MPEGStreamListener,
 
     // Optional info
     DTVTunerType      scanDTVTunerType;
+    ScanCoordinator  *coordinator;
 
     // State
     bool              scanning;
@@ -249,8 +259,15 @@ class ChannelScanSM : public MPEGStreamListener,
 
 inline void ChannelScanSM::UpdateScanPercentCompleted(void)
 {
-    int tmp = (transportsScanned * 100) /
-              (scanTransports.size() + extend_transports.size());
+    uint total = scanTransports.size() + extend_transports.size();
+    if (coordinator)
+    {
+        coordinator->UpdateScanPercentCompleted(
+            this, transportsScanned, total);
+        return;
+    }
+
+    int tmp = (transportsScanned * 100) / total;
     scan_monitor->ScanPercentComplete(tmp);
 }
 
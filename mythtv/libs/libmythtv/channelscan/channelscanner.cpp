@@ -34,20 +34,24 @@ using namespace std;
 #include "iptvchannelfetcher.h"
 #include "dvbsignalmonitor.h"
 #include "scanwizardconfig.h"
+#include "scancoordinator.h"
 #include "channelscan_sm.h"
 #include "channelscanner.h"
+#include "tvremoteutil.h"
 #include "hdhrchannel.h"
 #include "scanmonitor.h"
 #include "asichannel.h"
 #include "dvbchannel.h"
 #include "v4lchannel.h"
 #include "cardutil.h"
+#include "mythcorecontext.h"
+#include "inputinfo.h"
 
 #define LOC QString("ChScan: ")
 
 ChannelScanner::ChannelScanner() :
     scanMonitor(NULL), channel(NULL), sigmonScanner(NULL), freeboxScanner(NULL),
-    freeToAirOnly(false), serviceRequirements(kRequireAV)
+    coordinator(NULL), freeToAirOnly(false), serviceRequirements(kRequireAV)
 {
 }
 
@@ -64,6 +68,16 @@ ChannelScanner::~ChannelScanner()
 
 void ChannelScanner::Teardown(void)
 {
+    // Stop the scanner first, its thread reports to the coordinator
+    if (sigmonScanner)
+        sigmonScanner->StopScanner();
+
+    if (coordinator)
+    {
+        delete coordinator;
+        coordinator = NULL;
+    }
+
     if (sigmonScanner)
     {
         delete sigmonScanner;
@@ -127,7 +141,6 @@ void ChannelScanner::Scan(
         return;
     }
 
-    sigmonScanner->StartScanner();
     scanMonitor->ScanUpdateStatusText("");
 
     bool ok = false;
@@ -227,6 +240,21 @@ void ChannelScanner::Scan(
         ok = sigmonScanner->ScanCurrentTransport(sistandard);
     }
 
+    // Spread scans of a transport list over the idle inputs
+    if (ok && ((ScanTypeSetting::FullScan_ATSC     == scantype) ||
+               (ScanTypeSetting::FullScan_DVBC     == scantype) ||
+               (ScanTypeSetting::FullScan_DVBT     == scantype) ||
+               (ScanTypeSetting::FullTransportScan == scantype)))
+    {
+        AddIdleInputs(scantype, cardid, sourceid,
+                      do_ignore_signal_timeout, do_test_decryption);
+    }
+
+    if (sigmonScanner)
+        sigmonScanner->StartScanner();
+    if (coordinator)
+        coordinator->StartScanners();
+
     if (!ok)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to handle tune complete.");
@@ -298,54 +326,10 @@ bool ChannelScanner::ImportM3U(
     return ok;
 }
 
-void ChannelScanner::PreScanCommon(
-    int scantype,
-    uint cardid,
-    const QString &inputname,
-    uint sourceid,
-    bool do_ignore_signal_timeout,
-    bool do_test_decryption)
+static ChannelBase *create_channel(
+    const QString &card_type, const QString &device)
 {
-    uint signal_timeout  = 1000;
-    uint channel_timeout = 40000;
-    CardUtil::GetTimeouts(cardid, signal_timeout, channel_timeout);
-
-    QString device = CardUtil::GetVideoDevice(cardid);
-    if (device.isEmpty())
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "No Device");
-        InformUser(QObject::tr("Programmer Error: No Device"));
-        return;
-    }
-
-    if (!scanMonitor)
-        scanMonitor = new ScanMonitor(this);
-
-    QString card_type = CardUtil::GetRawCardType(cardid);
-
-    if ("DVB" == card_type)
-    {
-        QString sub_type = CardUtil::ProbeDVBType(device).toUpper();
-        bool need_nit = (("QAM"  == sub_type) ||
-                         ("QPSK" == sub_type) ||
-                         ("OFDM" == sub_type));
-
-        // Ugh, Some DVB drivers don't fully support signal monitoring...
-        if ((ScanTypeSetting::TransportScan     == scantype) ||
-            (ScanTypeSetting::FullTransportScan == scantype))
-        {
-            signal_timeout = (do_ignore_signal_timeout) ?
-                channel_timeout * 10 : signal_timeout;
-        }
-
-        // ensure a minimal signal timeout of 1 second
-        signal_timeout = max(signal_timeout, 1000U);
-
-        // Make sure that channel_timeout is at least 7 seconds to catch
-        // at least one SDT section. kDVBTableTimeout in ChannelScanSM
-        // ensures that we catch the NIT then.
-        channel_timeout = max(channel_timeout, need_nit * 7 * 1000U);
-    }
+    ChannelBase *channel = NULL;
 
 #ifdef USING_DVB
     if ("DVB" == card_type)
@@ -371,6 +355,70 @@ void ChannelScanner::PreScanCommon(
     }
 #endif // USING_ASI
 
+    return channel;
+}
+
+static void get_scan_timeouts(
+    int scantype, uint cardid, bool do_ignore_signal_timeout,
+    uint &signal_timeout, uint &channel_timeout)
+{
+    signal_timeout  = 1000;
+    channel_timeout = 40000;
+    CardUtil::GetTimeouts(cardid, signal_timeout, channel_timeout);
+
+    if ("DVB" != CardUtil::GetRawCardType(cardid))
+        return;
+
+    QString sub_type = CardUtil::ProbeDVBType(
+        CardUtil::GetVideoDevice(cardid)).toUpper();
+    bool need_nit = (("QAM"  == sub_type) ||
+                     ("QPSK" == sub_type) ||
+                     ("OFDM" == sub_type));
+
+    // Ugh, Some DVB drivers don't fully support signal monitoring...
+    if ((ScanTypeSetting::TransportScan     == scantype) ||
+        (ScanTypeSetting::FullTransportScan == scantype))
+    {
+        signal_timeout = (do_ignore_signal_timeout) ?
+            channel_timeout * 10 : signal_timeout;
+    }
+
+    // ensure a minimal signal timeout of 1 second
+    signal_timeout = max(signal_timeout, 1000U);
+
+    // Make sure that channel_timeout is at least 7 seconds to catch
+    // at least one SDT section. kDVBTableTimeout in ChannelScanSM
+    // ensures that we catch the NIT then.
+    channel_timeout = max(channel_timeout, need_nit * 7 * 1000U);
+}
+
+void ChannelScanner::PreScanCommon(
+    int scantype,
+    uint cardid,
+    const QString &inputname,
+    uint sourceid,
+    bool do_ignore_signal_timeout,
+    bool do_test_decryption)
+{
+    uint signal_timeout, channel_timeout;
+    get_scan_timeouts(scantype, cardid, do_ignore_signal_timeout,
+                      signal_timeout, channel_timeout);
+
+    QString device = CardUtil::GetVideoDevice(cardid);
+    if (device.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No Device");
+        InformUser(QObject::tr("Programmer Error: No Device"));
+        return;
+    }
+
+    if (!scanMonitor)
+        scanMonitor = new ScanMonitor(this);
+
+    QString card_type = CardUtil::GetRawCardType(cardid);
+
+    channel = create_channel(card_type, device);
+
     if (!channel)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Channel not created");
@@ -442,3 +490,100 @@ void ChannelScanner::PreScanCommon(
 
     MonitorProgress(mon, mon, dvbm, using_rotor);
 }
+
+/** \brief Adds a scanner for every other idle input on this host that
+ *         is connected to the video source and shares the transports
+ *         of the scan between them.
+ *
+ *   Inputs are only used if they are of the same card type as the
+ *   input the scan was started on, do not share its tuner and can
+ *   be opened, i.e. are not in use by a running backend. This can
+ *   be turned off with the "ParallelChannelScan" setting.
+ */
+void ChannelScanner::AddIdleInputs(
+    int scantype, uint cardid, uint sourceid,
+    bool do_ignore_signal_timeout, bool do_test_decryption)
+{
+    if (!sigmonScanner || !gCoreContext->GetNumSetting("ParallelChannelScan", 1))
+        return;
+
+    QString card_type = CardUtil::GetRawCardType(cardid);
+    QString device    = CardUtil::GetVideoDevice(cardid);
+    QString sub_type  = card_type;
+    if ("DVB" == card_type)
+        sub_type = CardUtil::ProbeDVBType(device).toUpper();
+
+    vector<uint> local_cards = CardUtil::GetCardIDs(
+        QString::null, card_type, gCoreContext->GetHostName());
+    vector<uint> source_cards = CardUtil::GetCardIDs(sourceid);
+    QStringList devices(device);
+
+    for (uint i = 0; i < source_cards.size(); i++)
+    {
+        uint other = source_cards[i];
+        if (find(local_cards.begin(), local_cards.end(), other) ==
+            local_cards.end())
+        {
+            continue;
+        }
+
+        QString other_device = CardUtil::GetVideoDevice(other);
+        if (devices.contains(other_device))
+            continue;
+
+        if (("DVB" == card_type) &&
+            (CardUtil::ProbeDVBType(other_device).toUpper() != sub_type))
+        {
+            continue;
+        }
+
+        QStringList inputs = CardUtil::GetInputNames(other, sourceid);
+        if (inputs.empty())
+            continue;
+
+        TunedInputInfo busy_input;
+        if (gCoreContext->IsConnectedToMaster() &&
+            RemoteIsBusy(other, busy_input))
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Card %1 is busy, not scanning on it").arg(other));
+            continue;
+        }
+
+        ChannelBase *other_channel = create_channel(card_type, other_device);
+        if (!other_channel)
+            continue;
+
+        other_channel->SetCardID(other);
+        if (!other_channel->Open())
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Card %1 could not be opened, not scanning on it")
+                    .arg(other));
+            delete other_channel;
+            continue;
+        }
+
+        uint signal_timeout, channel_timeout;
+        get_scan_timeouts(scantype, other, do_ignore_signal_timeout,
+                          signal_timeout, channel_timeout);
+
+        ChannelScanSM *scanner = new ChannelScanSM(
+            scanMonitor, card_type, other_channel, sourceid,
+            signal_timeout, channel_timeout, inputs[0],
+            do_test_decryption);
+        scanner->SetScanDTVTunerType(sigmonScanner->GetScanDTVTunerType());
+
+        if (!coordinator)
+            coordinator = new ScanCoordinator(scanMonitor, sigmonScanner);
+        coordinator->AddScanner(scanner, other_channel);
+        devices << other_device;
+
+        LOG(VB_CHANSCAN, LOG_INFO, LOC +
+            QString("Also scanning on card %1 (%2)")
+                .arg(other).arg(other_device));
+    }
+
+    if (coordinator)
+        coordinator->DistributeTransports();
+}
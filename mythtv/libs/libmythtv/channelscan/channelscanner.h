@@ -38,6 +38,7 @@
 
 class ScanMonitor;
 class IPTVChannelFetcher;
+class ScanCoordinator;
 class ChannelScanSM;
 class ChannelBase;
 
@@ -86,6 +87,10 @@ class MTV_PUBLIC ChannelScanner
         uint sourceid, bool do_ignore_signal_timeout,
         bool do_test_decryption);
 
+    void AddIdleInputs(int scantype, uint cardid, uint sourceid,
+                       bool do_ignore_signal_timeout,
+                       bool do_test_decryption);
+
     virtual void MonitorProgress(
         bool /*lock*/, bool /*strength*/, bool /*snr*/, bool /*rotor*/) { }
 
@@ -100,6 +105,9 @@ class MTV_PUBLIC ChannelScanner
     ChannelScanSM      *sigmonScanner;
     IPTVChannelFetcher *freeboxScanner;
 
+    /// Runs the scan on the other idle inputs of the source, if any
+    ScanCoordinator    *coordinator;
+
     /// imported channels
     DTVChannelList      channels;
 
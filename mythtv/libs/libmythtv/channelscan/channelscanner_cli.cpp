@@ -32,6 +32,7 @@ using namespace std;
 // MythTv headers
 #include "channelscanner_cli.h"
 #include "channelscan_sm.h"
+#include "scancoordinator.h"
 #include "channelimporter.h"
 
 #define LOC      QString("ChScanCLI: ")
@@ -63,7 +64,13 @@ void ChannelScannerCLI::HandleEvent(const ScannerEvent *scanEvent)
         if (sigmonScanner)
         {
             sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
+            if (coordinator)
+            {
+                coordinator->StopScanners();
+                transports = coordinator->GetChannelList();
+            }
+            else
+                transports = sigmonScanner->GetChannelList();
         }
 
         Teardown();
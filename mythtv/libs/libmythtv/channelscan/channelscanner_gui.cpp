@@ -41,6 +41,7 @@ using namespace std;
 #include "channelimporter.h"
 #include "loglist.h"
 #include "channelscan_sm.h"
+#include "scancoordinator.h"
 
 #include "channelbase.h"
 #include "dtvsignalmonitor.h"
@@ -109,7 +110,13 @@ void ChannelScannerGUI::HandleEvent(const ScannerEvent *scanEvent)
         if (sigmonScanner)
         {
             sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
+            if (coordinator)
+            {
+                coordinator->StopScanners();
+                transports = coordinator->GetChannelList();
+            }
+            else
+                transports = sigmonScanner->GetChannelList();
         }
 
         Teardown();
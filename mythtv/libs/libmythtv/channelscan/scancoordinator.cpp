@@ -0,0 +1,177 @@
+// -*- Mode: c++ -*-
+/*
+ *  This file is licensed under GPL v2 or (at your option) any later version.
+ *
+ */
+
+// MythTV headers
+#include "scancoordinator.h"
+#include "channelscan_sm.h"
+#include "scanmonitor.h"
+#include "channelbase.h"
+#include "mythlogging.h"
+
+#define LOC QString("ScanCoordinator: ")
+
+ScanCoordinator::ScanCoordinator(
+    ScanMonitor *_scan_monitor, ChannelScanSM *primary) :
+    scan_monitor(_scan_monitor)
+{
+    scanners.push_back(primary);
+    primary->SetCoordinator(this);
+}
+
+ScanCoordinator::~ScanCoordinator()
+{
+    // The primary belongs to ChannelScanner, but its thread must not
+    // call back into the coordinator once it is gone
+    scanners[0]->StopScanner();
+    StopScanners();
+
+    scanners[0]->SetCoordinator(NULL);
+
+    for (uint i = 1; i < scanners.size(); i++)
+        delete scanners[i];
+
+    for (uint i = 0; i < channels.size(); i++)
+        delete channels[i];
+}
+
+/// Takes ownership of a scanner for another input and its channel
+void ScanCoordinator::AddScanner(ChannelScanSM *scanner, ChannelBase *channel)
+{
+    scanner->SetCoordinator(this);
+    scanners.push_back(scanner);
+    channels.push_back(channel);
+}
+
+/**
+ *  \brief Deals the transports of the first scanner out to all of them.
+ *
+ *   Transports are dealt round robin so every input gets a share of
+ *   each band, the scanners then run independently. Transports found
+ *   through the NIT are scanned by whichever scanner claims them first.
+ */
+void ScanCoordinator::DistributeTransports(void)
+{
+    const transport_scan_items_t all = scanners[0]->GetScanTransports();
+    bool follow_nit = scanners[0]->IsFollowingNIT();
+
+    vector<transport_scan_items_t> shares(scanners.size());
+    transport_scan_items_t::const_iterator it = all.begin();
+    for (uint i = 0; it != all.end(); ++it, ++i)
+        shares[i % shares.size()].push_back(*it);
+
+    QMutexLocker locker(&lock);
+    completed.clear();
+    progress.clear();
+    transport_ids.clear();
+    frequencies.clear();
+
+    for (it = all.begin(); it != all.end(); ++it)
+        frequencies.insert((*it).tuning.frequency);
+
+    for (uint i = 0; i < scanners.size(); i++)
+    {
+        if (!scanners[i]->ScanTransportList(shares[i], follow_nit))
+            completed.insert(scanners[i]);
+
+        progress[scanners[i]] = qMakePair(0U, (uint)shares[i].size());
+    }
+
+    LOG(VB_CHANSCAN, LOG_INFO, LOC +
+        QString("Scanning %1 transports on %2 inputs")
+            .arg(all.size()).arg(scanners.size()));
+}
+
+/// Starts the scanners added with AddScanner(), the first one is
+/// started by its ChannelScanner
+void ScanCoordinator::StartScanners(void)
+{
+    for (uint i = 1; i < scanners.size(); i++)
+        scanners[i]->StartScanner();
+}
+
+void ScanCoordinator::StopScanners(void)
+{
+    for (uint i = 1; i < scanners.size(); i++)
+        scanners[i]->StopScanner();
+}
+
+/// Everything the scanners found, duplicates are left to ChannelImporter
+ScanDTVTransportList ScanCoordinator::GetChannelList(void) const
+{
+    ScanDTVTransportList list = scanners[0]->GetChannelList();
+
+    for (uint i = 1; i < scanners.size(); i++)
+    {
+        ScanDTVTransportList tmp = scanners[i]->GetChannelList();
+        list.insert(list.end(), tmp.begin(), tmp.end());
+    }
+
+    return list;
+}
+
+/// True if any scanner has scanned or queued the transport
+bool ScanCoordinator::IsTransportKnown(uint32_t id, uint64_t frequency)
+{
+    QMutexLocker locker(&lock);
+
+    return transport_ids.contains(id) || frequencies.contains(frequency);
+}
+
+/// Records the transport as scanned or queued, returns false if another
+/// scanner already has it
+bool ScanCoordinator::ClaimTransport(uint32_t id, uint64_t frequency)
+{
+    QMutexLocker locker(&lock);
+
+    if (transport_ids.contains(id) || frequencies.contains(frequency))
+        return false;
+
+    transport_ids.insert(id);
+    frequencies.insert(frequency);
+
+    return true;
+}
+
+/// Records the ids of a transport tuned from the list it was given
+void ScanCoordinator::TransportScanned(uint32_t id, uint64_t frequency)
+{
+    QMutexLocker locker(&lock);
+
+    transport_ids.insert(id);
+    frequencies.insert(frequency);
+}
+
+void ScanCoordinator::ScanComplete(const ChannelScanSM *scanner)
+{
+    QMutexLocker locker(&lock);
+
+    completed.insert(scanner);
+
+    LOG(VB_CHANSCAN, LOG_INFO, LOC + QString("%1 of %2 scanners done")
+            .arg(completed.size()).arg(scanners.size()));
+
+    if (completed.size() == (int)scanners.size())
+        scan_monitor->ScanComplete();
+}
+
+void ScanCoordinator::UpdateScanPercentCompleted(
+    const ChannelScanSM *scanner, uint scanned, uint total)
+{
+    QMutexLocker locker(&lock);
+
+    progress[scanner] = qMakePair(scanned, total);
+
+    uint all_scanned = 0, all_total = 0;
+    QMap<const ChannelScanSM*, QPair<uint,uint> >::const_iterator it;
+    for (it = progress.begin(); it != progress.end(); ++it)
+    {
+        all_scanned += (*it).first;
+        all_total   += (*it).second;
+    }
+
+    if (all_total)
+        scan_monitor->ScanPercentComplete((all_scanned * 100) / all_total);
+}
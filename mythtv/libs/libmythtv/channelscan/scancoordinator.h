@@ -0,0 +1,80 @@
+// -*- Mode: c++ -*-
+/*
+ *  This file is licensed under GPL v2 or (at your option) any later version.
+ *
+ */
+
+#ifndef _SCAN_COORDINATOR_H_
+#define _SCAN_COORDINATOR_H_
+
+// C++ headers
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QMutex>
+#include <QPair>
+#include <QMap>
+#include <QSet>
+
+// MythTV headers
+#include "dtvmultiplex.h"
+
+class ChannelScanSM;
+class ChannelBase;
+class ScanMonitor;
+
+/** \class ScanCoordinator
+ *  \brief Splits one transport scan across several inputs.
+ *
+ *   The transports the first scanner was set up to scan are dealt
+ *   out to it and to one ChannelScanSM per additional idle input
+ *   connected to the same video source. Each scanner tunes its own
+ *   share, the ScanMonitor only sees a ScanComplete() once all of
+ *   them are done and GetChannelList() returns everything found,
+ *   ChannelImporter merges transports found more than once.
+ *
+ *   Transports found through the NIT are claimed here before a
+ *   scanner queues them, so only one of the scanners tunes each.
+ */
+class ScanCoordinator
+{
+  public:
+    ScanCoordinator(ScanMonitor *_scan_monitor, ChannelScanSM *primary);
+    ~ScanCoordinator();
+
+    void AddScanner(ChannelScanSM *scanner, ChannelBase *channel);
+    uint GetScannerCount(void) const { return scanners.size(); }
+
+    void DistributeTransports(void);
+    void StartScanners(void);
+    void StopScanners(void);
+
+    ScanDTVTransportList GetChannelList(void) const;
+
+    // Called from the scanner threads
+    bool IsTransportKnown(uint32_t id, uint64_t frequency);
+    bool ClaimTransport(uint32_t id, uint64_t frequency);
+    void TransportScanned(uint32_t id, uint64_t frequency);
+    void ScanComplete(const ChannelScanSM *scanner);
+    void UpdateScanPercentCompleted(const ChannelScanSM *scanner,
+                                    uint scanned, uint total);
+
+  private:
+    ScanMonitor           *scan_monitor;
+    /// The first scanner belongs to the ChannelScanner, the rest to us
+    vector<ChannelScanSM*> scanners;
+    vector<ChannelBase*>   channels;
+
+    QMutex                       lock;
+    QSet<const ChannelScanSM*>   completed;
+    /// Transports scanned or queued by any scanner, by network and
+    /// transport id and by frequency
+    QSet<uint32_t>               transport_ids;
+    QSet<uint64_t>               frequencies;
+    /// Transports scanned and to scan, per scanner
+    QMap<const ChannelScanSM*, QPair<uint,uint> > progress;
+};
+
+#endif // _SCAN_COORDINATOR_H_
@@ -38,7 +38,8 @@ DecoderBase::DecoderBase(MythPlayer *parent, const ProgramInfo &pginfo)
       m_positionMapLock(QMutex::Recursive),
       dontSyncPositionMap(false),
 
-      exactseeks(false), livetv(false), watchingrecording(false),
+      exactseeks(false), trickplay(false),
+      livetv(false), watchingrecording(false),
 
       hasKeyFrameAdjustTable(false), lowbuffers(false),
       getrawframes(false), getrawvideo(false),
@@ -591,6 +592,50 @@ bool DecoderBase::DoRewindSeek(long long desiredFrame)
     return true;
 }
 
+/** \brief Finds the stream positions of the keyframes trick-play
+ *         will show next.
+ *
+ *   Starting at fromFrame the keyframe closest to every step frames
+ *   (negative steps for rewind) is looked up in the position map,
+ *   up to count distinct keyframes.
+ *
+ *  \return number of positions appended to positions.
+ */
+uint DecoderBase::GetTrickPlayPositions(long long fromFrame, long long step,
+                                        uint count,
+                                        QList<long long> &positions)
+{
+    if (!step || ringBuffer->IsDisc() || !GetPositionMapSize())
+        return 0;
+
+    uint found = 0;
+    long long last_pos = -1;
+    long long frame = fromFrame;
+    for (uint i = 0; i < count; i++)
+    {
+        frame += step;
+        if (frame < 0)
+            break;
+
+        int pre_idx, post_idx;
+        FindPosition(frame, hasKeyFrameAdjustTable, pre_idx, post_idx);
+
+        QMutexLocker locker(&m_positionMapLock);
+        int pos_idx = (step > 0) ? max(pre_idx, post_idx) : pre_idx;
+        if (pos_idx >= (int)m_positionMap.size())
+            break;
+        long long pos = m_positionMap[pos_idx].pos;
+        if (pos < 0 || pos == last_pos)
+            continue;
+
+        positions.push_back(pos);
+        last_pos = pos;
+        found++;
+    }
+
+    return found;
+}
+
 void DecoderBase::ResetPosMap(void)
 {
     QMutexLocker locker(&m_positionMapLock);
@@ -102,6 +102,12 @@ class DecoderBase
     bool getExactSeeks(void) const { return exactseeks;  }
     void setLiveTVMode(bool live)  { livetv = live;      }
 
+    /// Only keyframes are decoded while trick-play is enabled
+    virtual void SetTrickPlay(bool enable) { trickplay = enable; }
+    bool GetTrickPlay(void) const  { return trickplay;   }
+    uint GetTrickPlayPositions(long long fromFrame, long long step,
+                               uint count, QList<long long> &positions);
+
     // Must be done while player is paused.
     void SetProgramInfo(const ProgramInfo &pginfo);
 
@@ -261,6 +267,7 @@ class DecoderBase
     bool dontSyncPositionMap;
 
     bool exactseeks;
+    bool trickplay;
     bool livetv;
     bool watchingrecording;
 
@@ -26,9 +26,15 @@
  *   directories and gateways. For example, the BBC radio channels
  *   Radio 1, Radio 2, Radio 3 and Radio 4 all share the same object
  *   carousel and differ only in the DownloadServerInitiate message.
+ *
+ *   The contents of the files are kept up to kMaxCacheSize, past that
+ *   the files of the least recently used module are dropped and the
+ *   module is collected again from the carousel when it is next needed.
  */
 
-DSMCCCache::DSMCCCache(Dsmcc *dsmcc)
+const qint64 DSMCCCache::kMaxCacheSize = 16 * 1024 * 1024;
+
+DSMCCCache::DSMCCCache(Dsmcc *dsmcc) : m_nCacheSize(0)
 {
     // Delete all this when the cache is deleted.
     m_Dsmcc = dsmcc;
@@ -36,8 +42,8 @@ DSMCCCache::DSMCCCache(Dsmcc *dsmcc)
 
 DSMCCCache::~DSMCCCache()
 {
-    QMap<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir;
-    QMap<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil;
+    QHash<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir;
+    QHash<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil;
 
     for (dir = m_Directories.begin(); dir != m_Directories.end(); ++dir)
         delete *dir;
@@ -133,7 +139,7 @@ bool operator < (const DSMCCCacheReference &ref1,
 DSMCCCacheDir *DSMCCCache::Srg(const DSMCCCacheReference &ref)
 {
     // Check to see that it isn't already there.  It shouldn't be.
-    QMap<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
+    QHash<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
         m_Gateways.find(ref);
 
     if (dir != m_Gateways.end())
@@ -148,6 +154,7 @@ DSMCCCacheDir *DSMCCCache::Srg(const DSMCCCacheReference &ref)
 
     DSMCCCacheDir *pSrg = new DSMCCCacheDir(ref);
     m_Gateways.insert(ref, pSrg);
+    m_Paths.clear();
 
     return pSrg;
 }
@@ -156,7 +163,7 @@ DSMCCCacheDir *DSMCCCache::Srg(const DSMCCCacheReference &ref)
 DSMCCCacheDir *DSMCCCache::Directory(const DSMCCCacheReference &ref)
 {
     // Check to see that it isn't already there.  It shouldn't be.
-    QMap<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
+    QHash<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
         m_Directories.find(ref);
 
     if (dir != m_Directories.end())
@@ -171,6 +178,7 @@ DSMCCCacheDir *DSMCCCache::Directory(const DSMCCCacheReference &ref)
 
     DSMCCCacheDir *pDir = new DSMCCCacheDir(ref);
     m_Directories.insert(ref, pDir);
+    m_Paths.clear();
 
     return pDir;
 }
@@ -186,20 +194,75 @@ void DSMCCCache::CacheFileData(const DSMCCCacheReference &ref,
         QString("[DSMCCCache] Adding file data size %1 for reference %2")
             .arg(data.size()).arg(ref.toString()));
 
-    QMap<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil =
+    QHash<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil =
         m_Files.find(ref);
 
     if (fil == m_Files.end())
     {
         pFile = new DSMCCCacheFile(ref);
         m_Files.insert(ref, pFile);
+        m_ModuleFiles[ref.ModuleKey()].append(ref);
     }
     else
     {
         pFile = *fil;
+        m_nCacheSize -= pFile->m_Contents.size();
     }
 
     pFile->m_Contents = data; // Save the data (this is use-counted by Qt).
+    m_nCacheSize += data.size();
+
+    m_Evicted.remove(ref.ModuleKey());
+    TouchModule(ref.ModuleKey());
+    EvictModules();
+}
+
+// Make the module the most recently used one.
+void DSMCCCache::TouchModule(quint64 module)
+{
+    if (!m_ModuleLRU.isEmpty() && m_ModuleLRU.last() == module)
+        return;
+
+    m_ModuleLRU.removeOne(module);
+    m_ModuleLRU.append(module);
+}
+
+// Drop the files of the least recently used modules until the
+// contents fit in kMaxCacheSize again.  The most recently used
+// module is always kept, it is the one being added or read.
+void DSMCCCache::EvictModules(void)
+{
+    while (m_nCacheSize > kMaxCacheSize && m_ModuleLRU.size() > 1)
+    {
+        quint64 module = m_ModuleLRU.takeFirst();
+        QList<DSMCCCacheReference> files = m_ModuleFiles.take(module);
+
+        QList<DSMCCCacheReference>::const_iterator it = files.begin();
+        for (; it != files.end(); ++it)
+        {
+            DSMCCCacheFile *fil = m_Files.take(*it);
+            if (fil)
+            {
+                m_nCacheSize -= fil->m_Contents.size();
+                delete fil;
+            }
+        }
+
+        m_Evicted.insert(module);
+
+        LOG(VB_DSMCC, LOG_INFO,
+            QString("[DSMCCCache] Dropped %1 files of module %2-%3, "
+                    "%4 bytes cached")
+                .arg(files.size()).arg(module >> 16).arg(module & 0xffff)
+                .arg(m_nCacheSize));
+    }
+}
+
+bool DSMCCCache::TakeEvicted(unsigned long carouselId,
+                             unsigned short moduleId)
+{
+    return m_Evicted.remove(
+        DSMCCCacheReference::ModuleKey(carouselId, moduleId));
 }
 
 // Add a file to the directory.
@@ -213,6 +276,7 @@ void DSMCCCache::AddFileInfo(DSMCCCacheDir *pDir, const BiopBinding *pBB)
         pBB->m_ior.m_profile_body->GetReference();
 
     pDir->m_Files.insert(name, *entry);
+    m_Paths.clear();
 
     LOG(VB_DSMCC, LOG_INFO,
         QString("[DSMCCCache] Added file name %1 reference %2 parent %3")
@@ -230,6 +294,7 @@ void DSMCCCache::AddDirInfo(DSMCCCacheDir *pDir, const BiopBinding *pBB)
         pBB->m_ior.m_profile_body->GetReference();
 
     pDir->m_SubDirectories.insert(name, *entry);
+    m_Paths.clear();
 
     LOG(VB_DSMCC, LOG_INFO,
         QString("[DSMCCCache] added subdirectory name %1 reference %2 parent %3")
@@ -240,7 +305,7 @@ void DSMCCCache::AddDirInfo(DSMCCCacheDir *pDir, const BiopBinding *pBB)
 DSMCCCacheFile *DSMCCCache::FindFileData(DSMCCCacheReference &ref)
 {
     // Find a file.
-    QMap<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil =
+    QHash<DSMCCCacheReference, DSMCCCacheFile*>::Iterator fil =
         m_Files.find(ref);
 
     if (fil == m_Files.end())
@@ -252,7 +317,7 @@ DSMCCCacheFile *DSMCCCache::FindFileData(DSMCCCacheReference &ref)
 DSMCCCacheDir *DSMCCCache::FindDir(DSMCCCacheReference &ref)
 {
     // Find a directory.
-    QMap<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
+    QHash<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
         m_Directories.find(ref);
 
     if (dir == m_Directories.end())
@@ -264,7 +329,7 @@ DSMCCCacheDir *DSMCCCache::FindDir(DSMCCCacheReference &ref)
 DSMCCCacheDir *DSMCCCache::FindGateway(DSMCCCacheReference &ref)
 {
     // Find a gateway.
-    QMap<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
+    QHash<DSMCCCacheReference, DSMCCCacheDir*>::Iterator dir =
         m_Gateways.find(ref);
 
     if (dir == m_Gateways.end())
@@ -279,35 +344,62 @@ DSMCCCacheDir *DSMCCCache::FindGateway(DSMCCCacheReference &ref)
 // currently exist and +1 if the carousel has not so far loaded
 // the object or one of the parent files.
 int DSMCCCache::GetDSMObject(QStringList &objectPath, QByteArray &result)
+{
+    const QString path = objectPath.join("/");
+    DSMCCCacheReference ref;
+
+    QHash<QString, DSMCCCacheReference>::const_iterator it =
+        m_Paths.find(path);
+    if (it != m_Paths.end())
+    {
+        ref = *it;
+    }
+    else
+    {
+        int res = ResolvePath(objectPath, ref);
+        if (res != 0)
+            return res;
+        m_Paths.insert(path, ref);
+    }
+
+    DSMCCCacheFile *fil = FindFileData(ref);
+
+    if (fil == NULL) // Exists but not yet set, or dropped.
+        return 1;
+
+    TouchModule(ref.ModuleKey());
+    result = fil->m_Contents;
+    return 0;
+}
+
+// Find the reference of the file with the given path.  Returns
+// the same values as GetDSMObject.
+int DSMCCCache::ResolvePath(const QStringList &objectPath,
+                            DSMCCCacheReference &result)
 {
     DSMCCCacheDir *dir = FindGateway(m_GatewayRef);
     if (dir == NULL)
         return 1; // No gateway yet.
 
-    QStringList::Iterator it = objectPath.begin();
+    QStringList::const_iterator it = objectPath.begin();
     while (it != objectPath.end())
     {
         QString name = *it;
         ++it;
         if (it == objectPath.end())
         { // It's a leaf - look in the file names
-            QMap<QString, DSMCCCacheReference>::Iterator ref =
+            QHash<QString, DSMCCCacheReference>::Iterator ref =
                 dir->m_Files.find(name);
 
             if (ref == dir->m_Files.end())
                 return -1; // Not there.
 
-            DSMCCCacheFile *fil = FindFileData(*ref);
-
-            if (fil == NULL) // Exists but not yet set.
-                return 1;
-
-            result = fil->m_Contents;
+            result = *ref;
             return 0;
         }
         else
         { // It's a directory
-            QMap<QString, DSMCCCacheReference>::Iterator ref =
+            QHash<QString, DSMCCCacheReference>::Iterator ref =
                 dir->m_SubDirectories.find(name);
 
             if (ref == dir->m_SubDirectories.end())
@@ -332,5 +424,6 @@ void DSMCCCache::SetGateway(const DSMCCCacheReference &ref)
         LOG(VB_DSMCC, LOG_INFO, QString("[DSMCCCache] Setting gateway to reference %1")
             .arg(ref.toString()));
         m_GatewayRef = ref;
+        m_Paths.clear();
     }
 }
@@ -6,7 +6,9 @@
 #define DSMCC_CACHE_H
 
 #include <QStringList>
-#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QSet>
 
 class BiopBinding;
 
@@ -48,6 +50,13 @@ class DSMCCCacheReference
 
     QString toString(void) const;
 
+    /// Key identifying the module the object is carried in
+    quint64 ModuleKey(void) const
+        { return ModuleKey(m_nCarouselId, m_nModuleId); }
+    static quint64 ModuleKey(unsigned long carouselId,
+                             unsigned short moduleId)
+        { return ((quint64)carouselId << 16) | moduleId; }
+
   public:
     unsigned long  m_nCarouselId; // Reference info for the module
     unsigned short m_nModuleId;
@@ -59,6 +68,19 @@ class DSMCCCacheReference
                             const DSMCCCacheReference&);
 };
 
+// Operators required for QHash
+inline bool operator == (const DSMCCCacheReference &ref1,
+                         const DSMCCCacheReference &ref2)
+{
+    return ref1.Equal(ref2);
+}
+
+inline uint qHash(const DSMCCCacheReference &ref)
+{
+    return qHash(static_cast<const QByteArray&>(ref.m_Key)) ^
+        (uint)(ref.ModuleKey() * 0x9E3779B1U) ^ ref.m_nStreamTag;
+}
+
 // A directory
 class DSMCCCacheDir
 {
@@ -67,8 +89,8 @@ class DSMCCCacheDir
     DSMCCCacheDir(const DSMCCCacheReference &r) : m_Reference(r) {}
 
     // These maps give the cache reference for each name
-    QMap<QString, DSMCCCacheReference> m_SubDirectories;
-    QMap<QString, DSMCCCacheReference> m_Files;
+    QHash<QString, DSMCCCacheReference> m_SubDirectories;
+    QHash<QString, DSMCCCacheReference> m_Files;
 
     DSMCCCacheReference m_Reference;
 };
@@ -108,18 +130,41 @@ class DSMCCCache
     // Return the contents.
     int GetDSMObject(QStringList &objectPath, QByteArray &result);
 
+    // True once if the files of the module were dropped from the cache,
+    // the module then has to be collected from the carousel again.
+    bool TakeEvicted(unsigned long carouselId, unsigned short moduleId);
+
+    /// Upper limit for the contents of the files held
+    static const qint64 kMaxCacheSize;
+
   protected:
     // Find File, Directory or Gateway by reference.
     DSMCCCacheFile *FindFileData(DSMCCCacheReference &ref);
     DSMCCCacheDir *FindDir(DSMCCCacheReference &ref);
     DSMCCCacheDir *FindGateway(DSMCCCacheReference &ref);
 
+    // Resolve a path to the reference of a file.
+    int ResolvePath(const QStringList &objectPath, DSMCCCacheReference &ref);
+
+    // Keep the file contents within kMaxCacheSize.
+    void TouchModule(quint64 module);
+    void EvictModules(void);
+
     DSMCCCacheReference m_GatewayRef; // Reference to the gateway
 
     // The set of directories, files and gateways.
-    QMap<DSMCCCacheReference, DSMCCCacheDir*> m_Directories;
-    QMap<DSMCCCacheReference, DSMCCCacheDir*> m_Gateways;
-    QMap<DSMCCCacheReference, DSMCCCacheFile*> m_Files;
+    QHash<DSMCCCacheReference, DSMCCCacheDir*> m_Directories;
+    QHash<DSMCCCacheReference, DSMCCCacheDir*> m_Gateways;
+    QHash<DSMCCCacheReference, DSMCCCacheFile*> m_Files;
+
+    // Paths resolved so far, cleared when a directory changes.
+    QHash<QString, DSMCCCacheReference> m_Paths;
+
+    // The files held for each module, modules least recently used first.
+    QHash<quint64, QList<DSMCCCacheReference> > m_ModuleFiles;
+    QList<quint64> m_ModuleLRU;
+    QSet<quint64>  m_Evicted;
+    qint64         m_nCacheSize;
 
   public:
     Dsmcc *m_Dsmcc;
@@ -145,7 +145,7 @@ ObjCarousel::ObjCarousel(Dsmcc *dsmcc)
 
 ObjCarousel::~ObjCarousel()
 {
-    QLinkedList<DSMCCCacheModuleData*>::iterator it = m_Cache.begin();
+    QHash<quint64, DSMCCCacheModuleData*>::iterator it = m_Cache.begin();
     for (; it != m_Cache.end(); ++it)
         delete *it;
     m_Cache.clear();
@@ -161,24 +161,27 @@ void ObjCarousel::AddModuleInfo(DsmccDii *dii, Dsmcc *status,
         // Do we already know this module?
         // If so and it is the same version we don't need to do anything.
         // If the version has changed we have to replace it.
-        QLinkedList<DSMCCCacheModuleData*>::iterator it = m_Cache.begin();
-        for ( ; it != m_Cache.end(); ++it)
+        quint64 key = DSMCCCacheReference::ModuleKey(dii->download_id,
+                                                     info->module_id);
+        QHash<quint64, DSMCCCacheModuleData*>::iterator it = m_Cache.find(key);
+        if (it != m_Cache.end())
         {
             DSMCCCacheModuleData *cachep = *it;
-            if (cachep->CarouselId() == dii->download_id &&
-                    cachep->ModuleId() == info->module_id)
+            /* already known */
+            if (cachep->Version() == info->module_version)
             {
-                /* already known */
-                if (cachep->Version() == info->module_version)
+                LOG(VB_DSMCC, LOG_DEBUG, QString("[dsmcc] Already Know Module %1")
+                        .arg(info->module_id));
+
+                if (cachep->ModuleSize() == info->module_size)
+                {
+                    // Unless its files have since been dropped from the
+                    // file cache, then it has to be collected again.
+                    bFound = !filecache.TakeEvicted(dii->download_id,
+                                                    info->module_id);
+                }
+                else
                 {
-                    LOG(VB_DSMCC, LOG_DEBUG, QString("[dsmcc] Already Know Module %1")
-                            .arg(info->module_id));
-
-                    if (cachep->ModuleSize() == info->module_size)
-                    {
-                        bFound = true;
-                        break;
-                    }
                     // It seems that when ITV4 starts broadcasting it
                     // updates the contents of a file but doesn't
                     // update the version.  This is a work-around.
@@ -189,6 +192,10 @@ void ObjCarousel::AddModuleInfo(DsmccDii *dii, Dsmcc *status,
                              .arg(info->module_size)
                              .arg(cachep->DataSize()));
                 }
+            }
+
+            if (!bFound)
+            {
                 // Version has changed - Drop old data.
                 LOG(VB_DSMCC, LOG_INFO, QString("[dsmcc] Updated Module %1")
                         .arg(info->module_id));
@@ -196,7 +203,6 @@ void ObjCarousel::AddModuleInfo(DsmccDii *dii, Dsmcc *status,
                 // Remove and delete the cache object.
                 m_Cache.erase(it);
                 delete cachep;
-                break;
             }
         }
 
@@ -217,7 +223,7 @@ void ObjCarousel::AddModuleInfo(DsmccDii *dii, Dsmcc *status,
         status->AddTap(tag, cachep->CarouselId());
 
         // Add this module to the cache.
-        m_Cache.append(cachep);
+        m_Cache.insert(key, cachep);
     }
 }
 
@@ -231,35 +237,32 @@ void ObjCarousel::AddModuleData(DsmccDb *ddb, const unsigned char *data)
     LOG(VB_DSMCC, LOG_DEBUG, QString("[dsmcc] Data block on carousel %1").arg(m_id));
 
     // Search the saved module info for this module
-    QLinkedList<DSMCCCacheModuleData*>::iterator it = m_Cache.begin();
-    for (; it != m_Cache.end(); ++it)
+    QHash<quint64, DSMCCCacheModuleData*>::iterator it =
+        m_Cache.find(DSMCCCacheReference::ModuleKey(m_id, ddb->module_id));
+    if (it != m_Cache.end())
     {
         DSMCCCacheModuleData *cachep = *it;
-        if (cachep->CarouselId() == m_id &&
-            (cachep->ModuleId() == ddb->module_id))
+        // Add the block to the module
+        unsigned char *tmp_data = cachep->AddModuleData(ddb, data);
+        if (tmp_data)
         {
-            // Add the block to the module
-            unsigned char *tmp_data = cachep->AddModuleData(ddb, data);
-            if (tmp_data)
+            // It is complete and we have the data
+            unsigned int len   = cachep->DataSize();
+            unsigned long curp = 0;
+            LOG(VB_DSMCC, LOG_DEBUG, QString("[biop] Module size (uncompressed) = %1").arg(len));
+
+            // Now process the BIOP tables in this module.
+            // Tables may be file contents or the descriptions of
+            // directories or service gateways (root directories).
+            while (curp < len)
             {
-                // It is complete and we have the data
-                unsigned int len   = cachep->DataSize();
-                unsigned long curp = 0;
-                LOG(VB_DSMCC, LOG_DEBUG, QString("[biop] Module size (uncompressed) = %1").arg(len));
-
-                // Now process the BIOP tables in this module.
-                // Tables may be file contents or the descriptions of
-                // directories or service gateways (root directories).
-                while (curp < len)
-                {
-                    BiopMessage bm;
-                    if (!bm.Process(cachep, &filecache, tmp_data, &curp))
-                        break;
-                }
-                free(tmp_data);
+                BiopMessage bm;
+                if (!bm.Process(cachep, &filecache, tmp_data, &curp))
+                    break;
             }
-            return;
+            free(tmp_data);
         }
+        return;
     }
     LOG(VB_DSMCC, LOG_INFO, QString("[dsmcc] Data block module %1 not on carousel %2")
         .arg(ddb->module_id).arg(m_id));
@@ -5,7 +5,7 @@
 #ifndef DSMCC_OBJCAROUSEL_H
 #define DSMCC_OBJCAROUSEL_H
 
-#include <QLinkedList>
+#include <QHash>
 
 #include <vector>
 using namespace std;
@@ -70,7 +70,8 @@ class ObjCarousel
     void AddModuleData(DsmccDb *ddb, const unsigned char *data);
 
     DSMCCCache                     filecache;
-    QLinkedList<DSMCCCacheModuleData*> m_Cache;
+    /// Modules by DSMCCCacheReference::ModuleKey()
+    QHash<quint64, DSMCCCacheModuleData*> m_Cache;
     /// Component tags matched to this carousel.
     vector<unsigned short>         m_Tags;
     unsigned long                  m_id;
@@ -17,6 +17,7 @@
 #include "mythconfig.h" // gives us HAVE_POSIX_FADVISE
 #include "compat.h"
 #include "util.h"
+#include "ioaccounting.h"
 
 #if HAVE_POSIX_FADVISE < 1
 static int posix_fadvise(int, off_t, off_t, int) { return 0; }
@@ -374,6 +375,21 @@ bool FileRingBuffer::IsOpen(void) const
     return ret;
 }
 
+/** \brief Asks the kernel to start reading 'length' bytes at 'pos'.
+ *
+ *   This is only effective for local files, the myth protocol has
+ *   no way to request data ahead of the current read position.
+ *
+ *   WARNING: Must be called with rwlock in locked state.
+ */
+void FileRingBuffer::PrefetchHint(long long pos, uint length)
+{
+    if (remotefile || fd2 < 0 || pos < 0)
+        return;
+
+    posix_fadvise(fd2, pos, length, POSIX_FADV_WILLNEED);
+}
+
 /** \fn FileRingBuffer::safe_read(int, void*, uint)
  *  \brief Reads data from the file-descriptor.
  *
@@ -402,9 +418,17 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
     if (stopreads)
         return 0;
 
+    // Only the time spent in reads that return data is accounted, the
+    // waits for a file that is still being written are not disk I/O
+    qint64 ioUSecs = 0;
+
     while (tot < sz)
     {
+        qint64 ioStart = IOAccounting::GetMicroseconds();
         ret = read(fd2, (char *)data + tot, sz - tot);
+        if (ret > 0)
+            ioUSecs += IOAccounting::GetMicroseconds() - ioStart;
+
         if (ret < 0)
         {
             if (errno == EAGAIN)
@@ -445,6 +469,10 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
         if (tot < sz)
             usleep(60000);
     }
+
+    if (tot > 0)
+        IOAccounting::AddRead(filename.section('/', 0, -2), tot, ioUSecs);
+
     return tot;
 }
 
@@ -32,4 +32,6 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     }
     int safe_read(int fd, void *data, uint sz);
     int safe_read(RemoteFile *rf, void *data, uint sz);
+
+    virtual void PrefetchHint(long long pos, uint length);
 };
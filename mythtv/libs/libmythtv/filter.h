@@ -20,6 +20,7 @@ typedef struct FmtConv_
 #define FMT_NULL {FMT_NONE,FMT_NONE}
 
 typedef struct VideoFilter_ VideoFilter;
+typedef struct FilterSliceExecutor_ FilterSliceExecutor;
 
 typedef VideoFilter*(*init_filter)(int, int, int *, int *, char *, int);
 
@@ -51,10 +52,61 @@ struct VideoFilter_
     VideoFrameType outpixfmt;
     char *opts;
     FilterInfo *info;
+    FilterSliceExecutor *executor; /* Shared slice workers, may be NULL */
 };
 
 #define FILT_NULL {NULL,NULL,NULL,NULL,NULL}
 
+/*
+ * Slice-parallel processing
+ *
+ * The host owns a pool of worker threads shared by every filter in a
+ * chain and hands it to each filter through VideoFilter::executor after
+ * filter_init() returns. A filter that can work on horizontal bands
+ * splits its work into a slice function and calls filter_run_slices()
+ * from its filter() callback; the call returns once every band is done.
+ * Without an executor the slice function is simply called once for the
+ * whole frame.
+ */
+typedef void (*filter_slice_fn)(VideoFilter *vf, VideoFrame *frame,
+                                int field, int slice, int nslices);
+
+struct FilterSliceExecutor_
+{
+    void (*execute)(FilterSliceExecutor *executor, filter_slice_fn func,
+                    VideoFilter *vf, VideoFrame *frame, int field,
+                    int nslices);
+    int threads;
+};
+
+static inline int filter_slice_count(const VideoFilter *vf)
+{
+    if (!vf->executor || vf->executor->threads < 2)
+        return 1;
+    return vf->executor->threads;
+}
+
+static inline void filter_run_slices(VideoFilter *vf, filter_slice_fn func,
+                                     VideoFrame *frame, int field)
+{
+    int nslices = filter_slice_count(vf);
+    if (nslices > 1)
+        vf->executor->execute(vf->executor, func, vf, frame, field, nslices);
+    else
+        func(vf, frame, field, 0, 1);
+}
+
+/* First row of band 'slice' out of 'nslices' for a plane of 'rows' rows,
+ * rounded down to a multiple of 'align' (which must be a power of two).
+ * filter_slice_row(rows, n, n) returns rows. */
+static inline int filter_slice_row(int rows, int slice, int nslices,
+                                   int align)
+{
+    if (slice >= nslices)
+        return rows;
+    return (int)(((long long)rows * slice) / nslices) & ~(align - 1);
+}
+
 #ifdef TIME_FILTER
 
 #ifndef TF_INTERVAL
@@ -14,6 +14,7 @@
 // MythTV headers
 #include "mythcontext.h"
 #include "filtermanager.h"
+#include "filterslicepool.h"
 #include "mythdirs.h"
 
 #define LOC QString("FilterManager: ")
@@ -51,6 +52,22 @@ FilterChain::~FilterChain()
         free(filter);
     }
     filters.clear();
+
+    delete slicePool;
+    slicePool = NULL;
+}
+
+void FilterChain::SetSlicePool(FilterSlicePool *pool)
+{
+    if (pool == slicePool)
+        return;
+    delete slicePool;
+    slicePool = pool;
+}
+
+FilterSliceExecutor *FilterChain::GetSliceExecutor(void) const
+{
+    return slicePool;
 }
 
 void FilterChain::ProcessFrame(VideoFrame *frame, FrameScanType scan)
@@ -377,6 +394,10 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
         delete FiltChain;
         FiltChain = NULL;
     }
+    else if (max_threads > 1)
+    {
+        FiltChain->SetSlicePool(new FilterSlicePool(max_threads));
+    }
 
     for (i = 0; i < FiltInfoChain.size(); i++)
     {
@@ -384,7 +405,8 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
         NewFilt = LoadFilter(FiltInfoChain[i], FmtList[i]->in,
                              FmtList[i]->out, postfilt_width,
                              postfilt_height, tmp.constData(),
-                             max_threads);
+                             max_threads,
+                             FiltChain ? FiltChain->GetSliceExecutor() : NULL);
 
         if (!NewFilt)
         {
@@ -490,7 +512,8 @@ VideoFilter * FilterManager::LoadFilter(const FilterInfo *FiltInfo,
                                         VideoFrameType inpixfmt,
                                         VideoFrameType outpixfmt, int &width,
                                         int &height, const char *opts,
-                                        int max_threads)
+                                        int max_threads,
+                                        FilterSliceExecutor *executor)
 {
     void *handle;
     VideoFilter *Filter;
@@ -554,5 +577,6 @@ VideoFilter * FilterManager::LoadFilter(const FilterInfo *FiltInfo,
     else
         Filter->opts = NULL;
     Filter->info = const_cast<FilterInfo*>(FiltInfo);
+    Filter->executor = executor;
     return Filter;
 }
@@ -19,18 +19,25 @@ typedef map<QString,FilterInfo*> filter_map_t;
 
 #include "videoouttypes.h"
 
+class FilterSlicePool;
+
 class FilterChain
 {
   public:
-    FilterChain() { }
+    FilterChain() : slicePool(NULL) { }
     virtual ~FilterChain();
 
     void ProcessFrame(VideoFrame *Frame, FrameScanType scan = kScan_Ignore);
 
     void Append(VideoFilter *f) { filters.push_back(f); }
 
+    /// \brief Gives the chain ownership of the workers its filters share.
+    void SetSlicePool(FilterSlicePool *pool);
+    FilterSliceExecutor *GetSliceExecutor(void) const;
+
   private:
     vector<VideoFilter*> filters;
+    FilterSlicePool     *slicePool;
 };
 
 class FilterManager
@@ -42,7 +49,8 @@ class FilterManager
     VideoFilter *LoadFilter(const FilterInfo *Filt, VideoFrameType inpixfmt,
                             VideoFrameType outpixfmt, int &width,
                             int &height, const char *opts,
-                            int max_threads);
+                            int max_threads,
+                            FilterSliceExecutor *executor = NULL);
 
     FilterChain *LoadFilters(QString filters, VideoFrameType &inpixfmt,
                              VideoFrameType &outpixfmt, int &width,
@@ -0,0 +1,144 @@
+// C++ headers
+#include <algorithm>
+
+// MythTV headers
+#include "filterslicepool.h"
+#include "mythlogging.h"
+
+#define LOC QString("FilterSlicePool: ")
+
+/// \brief Runs FilterSlicePool::WorkerLoop(void)
+void FilterSliceThread::run(void)
+{
+    RunProlog();
+    m_parent->WorkerLoop();
+    RunEpilog();
+}
+
+/** \fn FilterSlicePool::FilterSlicePool(int)
+ *  \brief Starts threads - 1 workers, the thread calling execute()
+ *         always processes slices as well.
+ */
+FilterSlicePool::FilterSlicePool(int threads) :
+    m_stop(false),      m_generation(0),
+    m_func(NULL),       m_filter(NULL),
+    m_frame(NULL),      m_field(0),
+    m_nslices(0),       m_nextSlice(0),
+    m_remaining(0)
+{
+    execute       = &FilterSlicePool::Execute;
+    this->threads = max(threads, 1);
+
+    for (int i = 1; i < this->threads; i++)
+    {
+        m_workers.push_back(new FilterSliceThread(this, i));
+        m_workers.back()->start();
+    }
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Created %1 worker threads").arg(m_workers.size()));
+}
+
+FilterSlicePool::~FilterSlicePool()
+{
+    m_lock.lock();
+    m_stop = true;
+    m_jobWait.wakeAll();
+    m_lock.unlock();
+
+    vector<FilterSliceThread*>::iterator it = m_workers.begin();
+    for (; it != m_workers.end(); ++it)
+        delete *it;
+    m_workers.clear();
+}
+
+void FilterSlicePool::Execute(FilterSliceExecutor *executor,
+                              filter_slice_fn func, VideoFilter *vf,
+                              VideoFrame *frame, int field, int nslices)
+{
+    static_cast<FilterSlicePool*>(executor)->Run(
+        func, vf, frame, field, nslices);
+}
+
+void FilterSlicePool::Run(filter_slice_fn func, VideoFilter *vf,
+                          VideoFrame *frame, int field, int nslices)
+{
+    if (nslices < 2 || m_workers.empty())
+    {
+        for (int i = 0; i < max(nslices, 1); i++)
+            func(vf, frame, field, i, max(nslices, 1));
+        return;
+    }
+
+    QMutexLocker jobLocker(&m_jobLock);
+
+    m_lock.lock();
+    m_func      = func;
+    m_filter    = vf;
+    m_frame     = frame;
+    m_field     = field;
+    m_nslices   = nslices;
+    m_nextSlice = 0;
+    m_remaining = nslices;
+    m_generation++;
+    m_jobWait.wakeAll();
+    m_lock.unlock();
+
+    RunSlices();
+
+    m_lock.lock();
+    while (m_remaining > 0)
+        m_doneWait.wait(&m_lock);
+    m_func   = NULL;
+    m_filter = NULL;
+    m_frame  = NULL;
+    m_lock.unlock();
+}
+
+/** \fn FilterSlicePool::RunSlices(void)
+ *  \brief Processes slices of the current job until none are left.
+ *
+ *  The job is sampled together with the slice number, so a worker
+ *  waking up late can never run a slice against a finished job.
+ */
+void FilterSlicePool::RunSlices(void)
+{
+    QMutexLocker locker(&m_lock);
+    while (m_func && m_nextSlice < m_nslices)
+    {
+        filter_slice_fn func  = m_func;
+        VideoFilter    *vf    = m_filter;
+        VideoFrame     *frame = m_frame;
+        int             field = m_field;
+        int           nslices = m_nslices;
+        int             slice = m_nextSlice++;
+
+        locker.unlock();
+        func(vf, frame, field, slice, nslices);
+        locker.relock();
+
+        if (--m_remaining == 0)
+            m_doneWait.wakeAll();
+    }
+}
+
+void FilterSlicePool::WorkerLoop(void)
+{
+    uint seen = 0;
+
+    m_lock.lock();
+    while (!m_stop)
+    {
+        if (seen == m_generation)
+        {
+            m_jobWait.wait(&m_lock);
+            continue;
+        }
+        seen = m_generation;
+
+        m_lock.unlock();
+        RunSlices();
+        m_lock.lock();
+    }
+    m_lock.unlock();
+}
@@ -0,0 +1,72 @@
+// -*- Mode: c++ -*-
+#ifndef FILTER_SLICE_POOL_H
+#define FILTER_SLICE_POOL_H
+
+extern "C" {
+#include "filter.h"
+}
+
+#include <vector>
+using namespace std;
+
+#include <QWaitCondition>
+#include <QMutex>
+
+#include "mthread.h"
+
+class FilterSlicePool;
+
+class FilterSliceThread : public MThread
+{
+  public:
+    FilterSliceThread(FilterSlicePool *p, int num) :
+        MThread(QString("FilterSlice%1").arg(num)), m_parent(p) {}
+    virtual ~FilterSliceThread() { wait(); m_parent = NULL; }
+    virtual void run(void);
+  private:
+    FilterSlicePool *m_parent;
+};
+
+/** \class FilterSlicePool
+ *  \brief Worker threads shared by all the filters of a FilterChain.
+ *
+ *  The pool is handed to each filter as its VideoFilter::executor.
+ *  A filter passes a slice function to FilterSliceExecutor::execute(),
+ *  the slices are handed out to the workers and to the calling thread,
+ *  and execute() returns once every slice of the frame has been
+ *  processed. Only one job runs at a time.
+ */
+class FilterSlicePool : public FilterSliceExecutor
+{
+    friend class FilterSliceThread;
+  public:
+    explicit FilterSlicePool(int threads);
+    ~FilterSlicePool();
+
+  private:
+    static void Execute(FilterSliceExecutor *executor, filter_slice_fn func,
+                        VideoFilter *vf, VideoFrame *frame, int field,
+                        int nslices);
+    void Run(filter_slice_fn func, VideoFilter *vf, VideoFrame *frame,
+             int field, int nslices);
+    void RunSlices(void);
+    void WorkerLoop(void);
+
+  private:
+    QMutex          m_jobLock;     ///< serializes Run() callers
+    QMutex          m_lock;        ///< protects everything below
+    QWaitCondition  m_jobWait;
+    QWaitCondition  m_doneWait;
+    bool            m_stop;
+    uint            m_generation;
+    filter_slice_fn m_func;
+    VideoFilter    *m_filter;
+    VideoFrame     *m_frame;
+    int             m_field;
+    int             m_nslices;
+    int             m_nextSlice;
+    int             m_remaining;
+    vector<FilterSliceThread*> m_workers;
+};
+
+#endif // FILTER_SLICE_POOL_H
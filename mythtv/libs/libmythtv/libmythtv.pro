@@ -144,6 +144,7 @@ HEADERS += videodbcheck.h
 HEADERS += tvremoteutil.h           tv.h
 HEADERS += jobqueue.h
 HEADERS += filtermanager.h          recordingprofile.h
+HEADERS += filterslicepool.h
 HEADERS += remoteencoder.h          videosource.h
 HEADERS += cardutil.h               sourceutil.h
 HEADERS += videometadatautil.h
@@ -172,6 +173,7 @@ SOURCES += videodbcheck.cpp
 SOURCES += tvremoteutil.cpp         tv.cpp
 SOURCES += jobqueue.cpp
 SOURCES += filtermanager.cpp        recordingprofile.cpp
+SOURCES += filterslicepool.cpp
 SOURCES += remoteencoder.cpp        videosource.cpp
 SOURCES += cardutil.cpp             sourceutil.cpp
 SOURCES += videometadatautil.cpp
@@ -406,9 +408,11 @@ using_backend {
     HEADERS += channelbase.h               dtvchannel.h
     HEADERS += signalmonitor.h             dtvsignalmonitor.h
     HEADERS += scriptsignalmonitor.h
+    HEADERS += tsfilechannel.h             tsfilesignalmonitor.h
     HEADERS += inputinfo.h                 inputgroupmap.h
     SOURCES += channelbase.cpp             dtvchannel.cpp
     SOURCES += signalmonitor.cpp           dtvsignalmonitor.cpp
+    SOURCES += tsfilechannel.cpp           tsfilesignalmonitor.cpp
     SOURCES += inputinfo.cpp               inputgroupmap.cpp
 
     # Channel scanner stuff
@@ -435,6 +439,7 @@ using_backend {
     HEADERS += channelscan/panedvbutilsimport.h
     HEADERS += channelscan/panesingle.h
     HEADERS += channelscan/scanmonitor.h
+    HEADERS += channelscan/scancoordinator.h
     HEADERS += channelscan/scanwizardconfig.h
 
     SOURCES += channelscan/channelscan_sm.cpp
@@ -448,6 +453,7 @@ using_backend {
     SOURCES += channelscan/multiplexsetting.cpp
     SOURCES += channelscan/paneanalog.cpp
     SOURCES += channelscan/scanmonitor.cpp
+    SOURCES += channelscan/scancoordinator.cpp
     SOURCES += channelscan/scanwizardconfig.cpp
 
     # EIT stuff
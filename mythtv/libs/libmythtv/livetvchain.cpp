@@ -1,18 +1,124 @@
+// Qt headers
+#include <QWaitCondition>
+#include <QRunnable>
+
+// MythTV headers
 #include "livetvchain.h"
 #include "mythcontext.h"
 #include "mythdb.h"
 #include "mythlogging.h"
 #include "programinfo.h"
 #include "mythsocket.h"
+#include "mthreadpool.h"
 #include "cardutil.h"
 
 #define LOC QString("LiveTVChain(%1): ").arg(m_id)
 
+/// Fields per chain entry in ToStringList()
+#define ENTRY_FIELDS 8
+
+/** \class LiveTVChainWriter
+ *  \brief Writes the tvchain table in the background.
+ *
+ *   The chain the recorder keeps in memory is the authoritative one,
+ *   the table is only there for persistence so channel changes don't
+ *   have to wait on it. Writes are run one at a time in the order they
+ *   were queued.
+ */
+class LiveTVChainWriter : public QRunnable
+{
+  public:
+    LiveTVChainWriter() : m_running(false) { setAutoDelete(false); }
+
+    void Queue(const QString &desc, const QString &sql,
+               const MSqlBindings &bindings);
+    void Flush(void);
+    void run(void);
+
+  private:
+    class Write
+    {
+      public:
+        Write(const QString &d, const QString &s, const MSqlBindings &b) :
+            desc(d), sql(s), bindings(b) {}
+
+        QString      desc;
+        QString      sql;
+        MSqlBindings bindings;
+    };
+
+    QMutex         m_lock;
+    QWaitCondition m_done;
+    bool           m_running;
+    QList<Write>   m_writes;
+};
+
+static QMutex             chain_writer_lock;
+static LiveTVChainWriter *chain_writer = NULL;
+
+static LiveTVChainWriter *get_chain_writer(void)
+{
+    QMutexLocker locker(&chain_writer_lock);
+    if (!chain_writer)
+        chain_writer = new LiveTVChainWriter();
+    return chain_writer;
+}
+
+void LiveTVChainWriter::Queue(
+    const QString &desc, const QString &sql, const MSqlBindings &bindings)
+{
+    QMutexLocker locker(&m_lock);
+    m_writes.push_back(Write(desc, sql, bindings));
+
+    if (!m_running)
+    {
+        m_running = true;
+        MThreadPool::globalInstance()->start(this, "LiveTVChainWriter");
+    }
+}
+
+/// Waits for the queued writes to reach the database
+void LiveTVChainWriter::Flush(void)
+{
+    QMutexLocker locker(&m_lock);
+    while (m_running)
+        m_done.wait(&m_lock);
+}
+
+void LiveTVChainWriter::run(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    while (!m_writes.empty())
+    {
+        Write next = m_writes.front();
+        locker.unlock();
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(next.sql);
+        query.bindValues(next.bindings);
+        if (!query.exec())
+            MythDB::DBError(next.desc, query);
+
+        locker.relock();
+        m_writes.pop_front();
+    }
+
+    m_running = false;
+    m_done.wakeAll();
+}
+
 /** \class LiveTVChain
  *  \brief Keeps track of recordings in a current LiveTV instance
+ *
+ *   The recorder's (TVRec's) chain is authoritative. Every change to it
+ *   is pushed to the frontends with the LIVETV_CHAIN UPDATE event and
+ *   frontends can ask the recorder for it with GET_LIVETV_CHAIN, the
+ *   tvchain table is written in the background and only read when
+ *   neither is available.
  */
 LiveTVChain::LiveTVChain() :
-    m_id(""), m_maxpos(0), m_lock(QMutex::Recursive),
+    m_id(""), m_maxpos(0), m_pushed(false), m_lock(QMutex::Recursive),
     m_curpos(0), m_cur_chanid(0),
     m_switchid(-1), m_jumppos(0)
 {
@@ -57,6 +163,7 @@ void LiveTVChain::AppendNewProgram(ProgramInfo *pginfo, QString channum,
     newent.starttime = pginfo->GetRecordingStartTime();
     newent.starttime.setTime(QTime(tmptime.hour(), tmptime.minute(),
                                    tmptime.second()));
+    newent.endtime = pginfo->GetRecordingEndTime();
     newent.discontinuity = discont;
     newent.hostprefix = m_hostprefix;
     newent.cardtype = m_cardtype;
@@ -65,32 +172,32 @@ void LiveTVChain::AppendNewProgram(ProgramInfo *pginfo, QString channum,
 
     m_chain.append(newent);
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("INSERT INTO tvchain (chanid, starttime, endtime, chainid,"
-                  " chainpos, discontinuity, watching, hostprefix, cardtype, "
-                  " channame, input) "
-                  "VALUES(:CHANID, :START, :END, :CHAINID, :CHAINPOS, "
-                  " :DISCONT, :WATCHING, :PREFIX, :CARDTYPE, :CHANNAME, "
-                  " :INPUT );");
-    query.bindValue(":CHANID", pginfo->GetChanID());
-    query.bindValue(":START", pginfo->GetRecordingStartTime());
-    query.bindValue(":END", pginfo->GetRecordingEndTime());
-    query.bindValue(":CHAINID", m_id);
-    query.bindValue(":CHAINPOS", m_maxpos);
-    query.bindValue(":DISCONT", discont);
-    query.bindValue(":WATCHING", 0);
-    query.bindValue(":PREFIX", m_hostprefix);
-    query.bindValue(":CARDTYPE", m_cardtype);
-    query.bindValue(":CHANNAME", channum);
-    query.bindValue(":INPUT", inputname);
-
-    if (!query.exec() || !query.isActive())
-        MythDB::DBError("Chain: AppendNewProgram", query);
-    else
-        LOG(VB_RECORD, LOG_INFO, QString("Chain: Appended@%3 '%1_%2'")
-                .arg(newent.chanid)
-                .arg(newent.starttime.toString("yyyyMMddhhmmss"))
-                .arg(m_maxpos));
+    MSqlBindings bindings;
+    bindings[":CHANID"] = pginfo->GetChanID();
+    bindings[":START"] = pginfo->GetRecordingStartTime();
+    bindings[":END"] = pginfo->GetRecordingEndTime();
+    bindings[":CHAINID"] = m_id;
+    bindings[":CHAINPOS"] = m_maxpos;
+    bindings[":DISCONT"] = discont;
+    bindings[":WATCHING"] = 0;
+    bindings[":PREFIX"] = m_hostprefix;
+    bindings[":CARDTYPE"] = m_cardtype;
+    bindings[":CHANNAME"] = channum;
+    bindings[":INPUT"] = inputname;
+
+    get_chain_writer()->Queue(
+        "Chain: AppendNewProgram",
+        "INSERT INTO tvchain (chanid, starttime, endtime, chainid,"
+        " chainpos, discontinuity, watching, hostprefix, cardtype, "
+        " channame, input) "
+        "VALUES(:CHANID, :START, :END, :CHAINID, :CHAINPOS, "
+        " :DISCONT, :WATCHING, :PREFIX, :CARDTYPE, :CHANNAME, "
+        " :INPUT );", bindings);
+
+    LOG(VB_RECORD, LOG_INFO, QString("Chain: Appended@%3 '%1_%2'")
+            .arg(newent.chanid)
+            .arg(newent.starttime.toString("yyyyMMddhhmmss"))
+            .arg(m_maxpos));
 
     m_maxpos++;
     BroadcastUpdate();
@@ -100,21 +207,21 @@ void LiveTVChain::FinishedRecording(ProgramInfo *pginfo)
 {
     QMutexLocker lock(&m_lock);
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("UPDATE tvchain SET endtime = :END "
-                  "WHERE chanid = :CHANID AND starttime = :START ;");
-    query.bindValue(":END", pginfo->GetRecordingEndTime());
-    query.bindValue(":CHANID", pginfo->GetChanID());
-    query.bindValue(":START", pginfo->GetRecordingStartTime());
+    MSqlBindings bindings;
+    bindings[":END"] = pginfo->GetRecordingEndTime();
+    bindings[":CHANID"] = pginfo->GetChanID();
+    bindings[":START"] = pginfo->GetRecordingStartTime();
 
-    if (!query.exec() || !query.isActive())
-        MythDB::DBError("Chain: FinishedRecording", query);
-    else
-        LOG(VB_RECORD, LOG_INFO,
-            QString("Chain: Updated endtime for '%1_%2' to %3")
-                .arg(pginfo->GetChanID())
-                .arg(pginfo->GetRecordingStartTime(MythDate))
-                .arg(pginfo->GetRecordingEndTime(MythDate)));
+    get_chain_writer()->Queue(
+        "Chain: FinishedRecording",
+        "UPDATE tvchain SET endtime = :END "
+        "WHERE chanid = :CHANID AND starttime = :START ;", bindings);
+
+    LOG(VB_RECORD, LOG_INFO,
+        QString("Chain: Updated endtime for '%1_%2' to %3")
+            .arg(pginfo->GetChanID())
+            .arg(pginfo->GetRecordingStartTime(MythDate))
+            .arg(pginfo->GetRecordingEndTime(MythDate)));
 
     QList<LiveTVChainEntry>::iterator it;
     for (it = m_chain.begin(); it != m_chain.end(); ++it)
@@ -141,29 +248,29 @@ void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
             del = it;
             ++it;
 
-            MSqlQuery query(MSqlQuery::InitCon());
+            MSqlBindings bindings;
             if (it != m_chain.end())
             {
                 (*it).discontinuity = true;
-                query.prepare("UPDATE tvchain SET discontinuity = :DISCONT "
-                              "WHERE chanid = :CHANID AND starttime = :START "
-                              "AND chainid = :CHAINID ;");
-                query.bindValue(":CHANID", (*it).chanid);
-                query.bindValue(":START", (*it).starttime);
-                query.bindValue(":CHAINID", m_id);
-                query.bindValue(":DISCONT", true);
-                if (!query.exec())
-                    MythDB::DBError("LiveTVChain::DeleteProgram -- "
-                                    "discontinuity", query);
+                bindings[":CHANID"] = (*it).chanid;
+                bindings[":START"] = (*it).starttime;
+                bindings[":CHAINID"] = m_id;
+                bindings[":DISCONT"] = true;
+                get_chain_writer()->Queue(
+                    "LiveTVChain::DeleteProgram -- discontinuity",
+                    "UPDATE tvchain SET discontinuity = :DISCONT "
+                    "WHERE chanid = :CHANID AND starttime = :START "
+                    "AND chainid = :CHAINID ;", bindings);
+                bindings.clear();
             }
 
-            query.prepare("DELETE FROM tvchain WHERE chanid = :CHANID "
-                          "AND starttime = :START AND chainid = :CHAINID ;");
-            query.bindValue(":CHANID", (*del).chanid);
-            query.bindValue(":START", (*del).starttime);
-            query.bindValue(":CHAINID", m_id);
-            if (!query.exec())
-                MythDB::DBError("LiveTVChain::DeleteProgram -- delete", query);
+            bindings[":CHANID"] = (*del).chanid;
+            bindings[":START"] = (*del).starttime;
+            bindings[":CHAINID"] = m_id;
+            get_chain_writer()->Queue(
+                "LiveTVChain::DeleteProgram -- delete",
+                "DELETE FROM tvchain WHERE chanid = :CHANID "
+                "AND starttime = :START AND chainid = :CHAINID ;", bindings);
 
             m_chain.erase(del);
 
@@ -176,7 +283,9 @@ void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
 void LiveTVChain::BroadcastUpdate(void)
 {
     QString message = QString("LIVETV_CHAIN UPDATE %1").arg(m_id);
-    MythEvent me(message);
+    QStringList data;
+    ToStringList(data);
+    MythEvent me(message, data);
     gCoreContext->dispatch(me);
 }
 
@@ -186,46 +295,71 @@ void LiveTVChain::DestroyChain(void)
 
     m_chain.clear();
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("DELETE FROM tvchain WHERE chainid = :CHAINID ;");
-    query.bindValue(":CHAINID", m_id);
+    MSqlBindings bindings;
+    bindings[":CHAINID"] = m_id;
+    get_chain_writer()->Queue(
+        "LiveTVChain::DestroyChain",
+        "DELETE FROM tvchain WHERE chainid = :CHAINID ;", bindings);
+}
 
-    if (!query.exec())
-        MythDB::DBError("LiveTVChain::DestroyChain", query);
+/** \brief Waits for this process' tvchain table writes to complete.
+ *
+ *   Call this before handing a chain over to another process which will
+ *   read it back from the database.
+ */
+void LiveTVChain::FlushWrites(void)
+{
+    get_chain_writer()->Flush();
 }
 
-void LiveTVChain::ReloadAll(void)
+/** \brief Reloads the chain.
+ *
+ *  \param data A chain from ToStringList(), as sent by the recorder with
+ *              the LIVETV_CHAIN UPDATE event or GET_LIVETV_CHAIN query.
+ *              When it is empty the chain is read from the database.
+ */
+void LiveTVChain::ReloadAll(const QStringList &data)
 {
     QMutexLocker lock(&m_lock);
 
     int prev_size = m_chain.size();
-    m_chain.clear();
-
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("SELECT chanid, starttime, endtime, discontinuity, "
-                  "chainpos, hostprefix, cardtype, channame, input "
-                  "FROM tvchain "
-                  "WHERE chainid = :CHAINID ORDER BY chainpos;");
-    query.bindValue(":CHAINID", m_id);
 
-    if (query.exec() && query.isActive() && query.size() > 0)
+    if (!data.isEmpty() && LoadFromStringList(data))
     {
-        while (query.next())
-        {
+        m_pushed = true;
+    }
+    else
+    {
+        m_chain.clear();
 
-            LiveTVChainEntry entry;
-            entry.chanid = query.value(0).toUInt();
-            entry.starttime = query.value(1).toDateTime();
-            entry.endtime = query.value(2).toDateTime();
-            entry.discontinuity = query.value(3).toInt();
-            entry.hostprefix = query.value(5).toString();
-            entry.cardtype = query.value(6).toString();
-            entry.channum = query.value(7).toString();
-            entry.inputname = query.value(8).toString();
+        // Our own writes at least must have reached the table
+        FlushWrites();
 
-            m_maxpos = query.value(4).toInt() + 1;
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare("SELECT chanid, starttime, endtime, discontinuity, "
+                      "chainpos, hostprefix, cardtype, channame, input "
+                      "FROM tvchain "
+                      "WHERE chainid = :CHAINID ORDER BY chainpos;");
+        query.bindValue(":CHAINID", m_id);
 
-            m_chain.append(entry);
+        if (query.exec() && query.isActive() && query.size() > 0)
+        {
+            while (query.next())
+            {
+                LiveTVChainEntry entry;
+                entry.chanid = query.value(0).toUInt();
+                entry.starttime = query.value(1).toDateTime();
+                entry.endtime = query.value(2).toDateTime();
+                entry.discontinuity = query.value(3).toInt();
+                entry.hostprefix = query.value(5).toString();
+                entry.cardtype = query.value(6).toString();
+                entry.channum = query.value(7).toString();
+                entry.inputname = query.value(8).toString();
+
+                m_maxpos = query.value(4).toInt() + 1;
+
+                m_chain.append(entry);
+            }
         }
     }
 
@@ -592,3 +726,65 @@ QString LiveTVChain::toString() const
     }
     return ret;
 }
+
+/** \brief Serializes the chain for the LIVETV_CHAIN UPDATE event and
+ *         the GET_LIVETV_CHAIN recorder query.
+ *  \sa ReloadAll(const QStringList&)
+ */
+void LiveTVChain::ToStringList(QStringList &list) const
+{
+    QMutexLocker lock(&m_lock);
+
+    list << QString::number(m_maxpos);
+    list << QString::number(m_chain.size());
+
+    QList<LiveTVChainEntry>::const_iterator it = m_chain.begin();
+    for (; it != m_chain.end(); ++it)
+    {
+        list << QString::number((*it).chanid);
+        list << (*it).starttime.toString(Qt::ISODate);
+        list << (*it).endtime.toString(Qt::ISODate);
+        list << QString::number((*it).discontinuity);
+        list << (*it).hostprefix;
+        list << (*it).cardtype;
+        list << (*it).channum;
+        list << (*it).inputname;
+    }
+}
+
+bool LiveTVChain::LoadFromStringList(const QStringList &list)
+{
+    if (list.size() < 2)
+        return false;
+
+    bool ok;
+    int maxpos = list[0].toInt(&ok);
+    int count  = list[1].toInt();
+    if (!ok || count < 0 || list.size() != 2 + count * ENTRY_FIELDS)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Ignoring malformed chain of %1 items").arg(list.size()));
+        return false;
+    }
+
+    QList<LiveTVChainEntry> chain;
+    QStringList::const_iterator it = list.begin() + 2;
+    for (int i = 0; i < count; i++)
+    {
+        LiveTVChainEntry entry;
+        entry.chanid        = (*it++).toUInt();
+        entry.starttime     = QDateTime::fromString(*it++, Qt::ISODate);
+        entry.endtime       = QDateTime::fromString(*it++, Qt::ISODate);
+        entry.discontinuity = (*it++).toInt();
+        entry.hostprefix    = *it++;
+        entry.cardtype      = *it++;
+        entry.channum       = *it++;
+        entry.inputname     = *it++;
+        chain.append(entry);
+    }
+
+    m_chain  = chain;
+    m_maxpos = maxpos;
+
+    return true;
+}
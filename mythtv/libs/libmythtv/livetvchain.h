@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QDateTime>
+#include <QStringList>
 #include <QMutex>
 #include <QList>
 
@@ -42,10 +43,12 @@ class MTV_PUBLIC LiveTVChain
     void FinishedRecording(ProgramInfo *pginfo);
     void DeleteProgram(ProgramInfo *pginfo);
 
-    void ReloadAll();
+    void ReloadAll(const QStringList &data = QStringList());
 
     // const gets
     QString GetID(void)  const { return m_id; }
+    /// Returns true once the chain has been loaded from a recorder snapshot
+    bool IsPushed(void)  const { return m_pushed; }
     int  GetCurPos(void) const { return m_curpos; }
     int  ProgramIsAt(uint chanid, const QDateTime &starttime) const;
     int  ProgramIsAt(const ProgramInfo &pginfo) const;
@@ -83,15 +86,20 @@ class MTV_PUBLIC LiveTVChain
     void DelHostSocket(MythSocket *sock);
  
     QString toString() const;
+    void ToStringList(QStringList &list) const;
+
+    static void FlushWrites(void);
 
   private:
     void BroadcastUpdate();
+    bool LoadFromStringList(const QStringList &list);
     void GetEntryAt(int at, LiveTVChainEntry &entry) const;
     static ProgramInfo *EntryToProgram(const LiveTVChainEntry &entry);
 
     QString m_id;
     QList<LiveTVChainEntry> m_chain;
     int m_maxpos;
+    bool m_pushed;
     mutable QMutex m_lock;
 
     QString m_hostprefix;
@@ -3,6 +3,8 @@
 #include <QRegion>
 #include <QBitArray>
 #include <QVector>
+#include <QPainter>
+#include <QTime>
 
 #include "mhi.h"
 #include "interactivescreen.h"
@@ -44,6 +46,9 @@ class MHIImageData
     QImage m_image;
     int    m_x;
     int    m_y;
+    uint   m_id;      // Names the OSD image, "itv<id>"
+    bool   m_shown;   // There is an OSD image for it
+    bool   m_changed; // The OSD image has to be replaced
 };
 
 // Special value for the NetworkBootInfo version.  Real values are a byte.
@@ -55,6 +60,7 @@ MHIContext::MHIContext(InteractiveTV *parent)
       m_engine(NULL),       m_stop(false),
       m_updated(false),
       m_displayWidth(StdDisplayWidth), m_displayHeight(StdDisplayHeight),
+      m_redrawAll(true),    m_nextImageId(0),
       m_face_loaded(false), m_engineThread(NULL), m_currentChannel(-1),
       m_currentStream(-1),  m_isLive(false),      m_currentSource(-1),
       m_audioTag(-1),       m_videoTag(-1),
@@ -126,10 +132,74 @@ void MHIContext::ClearDisplay(void)
 {
     list<MHIImageData*>::iterator it = m_display.begin();
     for (; it != m_display.end(); ++it)
+    {
+        m_removed.push_back((*it)->m_id);
         delete *it;
+    }
     m_display.clear();
 }
 
+// Remove an area from the display items.  Items entirely within it are
+// dropped, the others are made transparent there.
+void MHIContext::EraseDisplay(const QRegion &area)
+{
+    if (area.isEmpty())
+        return;
+
+    list<MHIImageData*>::iterator it = m_display.begin();
+    while (it != m_display.end())
+    {
+        MHIImageData *data = *it;
+        QRect imageRect(data->m_x, data->m_y,
+                        data->m_image.width(), data->m_image.height());
+        QRegion covered = area & imageRect;
+
+        if (covered.isEmpty())
+        {
+            ++it;
+            continue;
+        }
+
+        if ((QRegion(imageRect) - area).isEmpty())
+        {
+            m_removed.push_back(data->m_id);
+            delete data;
+            it = m_display.erase(it);
+            continue;
+        }
+
+        if (!data->m_image.hasAlphaChannel())
+            data->m_image =
+                data->m_image.convertToFormat(QImage::Format_ARGB32);
+
+        QPainter painter(&data->m_image);
+        painter.setCompositionMode(QPainter::CompositionMode_Clear);
+        QVector<QRect> rects = covered.rects();
+        for (uint j = 0; j < (uint)rects.size(); j++)
+            painter.fillRect(rects[j].translated(-data->m_x, -data->m_y),
+                             Qt::transparent);
+
+        data->m_changed = true;
+        ++it;
+    }
+}
+
+// Convert a region in MHEG coordinates to one on the display.
+QRegion MHIContext::ScaleRegion(const QRegion &region) const
+{
+    QRegion result;
+    QVector<QRect> rects = region.rects();
+    for (uint i = 0; i < (uint)rects.size(); i++)
+    {
+        const QRect &r = rects[i];
+        // Scale both edges so neighbouring rectangles still meet.
+        result += QRect(QPoint(SCALED_X(r.left()), SCALED_Y(r.top())),
+                        QPoint(SCALED_X(r.right() + 1) - 1,
+                               SCALED_Y(r.bottom() + 1) - 1));
+    }
+    return result.translated(m_displayRect.topLeft());
+}
+
 void MHIContext::ClearQueue(void)
 {
     MythDeque<DSMCCPacket*>::iterator it = m_dsmccQueue.begin();
@@ -487,6 +557,10 @@ void MHIContext::Reinit(const QRect &display)
     m_yScale = (float)m_displayHeight / (float)MHIContext::StdDisplayHeight;
     m_videoRect   = QRect(QPoint(0,0), display.size());
     m_displayRect = display;
+
+    // Everything has to be redrawn at the new scale.
+    QMutexLocker locker(&m_display_lock);
+    m_redrawAll = true;
 }
 
 void MHIContext::SetInputRegister(int num)
@@ -506,27 +580,70 @@ void MHIContext::UpdateOSD(InteractiveScreen *osdWindow,
 
     QMutexLocker locker(&m_display_lock);
     m_updated = false;
-    osdWindow->DeleteAllChildren();
-    // Copy all the display items into the display.
+
+    QTime t; t.start();
+
+    // Drop the images of items that have gone.
+    int removed = m_removed.size();
+    for (int i = 0; i < removed; i++)
+        osdWindow->DeleteChild(QString("itv%1").arg(m_removed[i]));
+    m_removed.clear();
+
+    // If the window doesn't hold exactly the images we have shown,
+    // e.g. because the OSD was recreated, start again.
+    int shown = 0;
     list<MHIImageData*>::iterator it = m_display.begin();
-    for (int count = 0; it != m_display.end(); ++it, count++)
+    for (; it != m_display.end(); ++it)
+        shown += (*it)->m_shown ? 1 : 0;
+
+    if (shown != osdWindow->GetAllChildren()->size())
+    {
+        osdWindow->DeleteAllChildren();
+        for (it = m_display.begin(); it != m_display.end(); ++it)
+            (*it)->m_shown = false;
+    }
+
+    // Only new and changed items are copied into the display, the
+    // images of the rest are kept along with their textures.
+    // New items are always above the old ones where they overlap.
+    int uploaded = 0;
+    for (it = m_display.begin(); it != m_display.end(); ++it)
     {
         MHIImageData *data = *it;
-        MythImage* image = osdPainter->GetFormatImage();
-        if (!image)
-            continue;
+        MythUIImage *uiimage = NULL;
 
-        image->Assign(data->m_image);
-        MythUIImage *uiimage = new MythUIImage(osdWindow, QString("itv%1")
-                                               .arg(count));
-        if (uiimage)
+        if (data->m_shown)
         {
+            uiimage = dynamic_cast<MythUIImage*>(
+                osdWindow->GetChild(QString("itv%1").arg(data->m_id)));
+        }
+
+        if (!uiimage || data->m_changed)
+        {
+            MythImage* image = osdPainter->GetFormatImage();
+            if (!image)
+                continue;
+
+            image->Assign(data->m_image);
+            if (!uiimage)
+                uiimage = new MythUIImage(osdWindow,
+                                          QString("itv%1").arg(data->m_id));
             uiimage->SetImage(image);
-            uiimage->SetArea(MythRect(data->m_x, data->m_y,
-                             data->m_image.width(), data->m_image.height()));
+            data->m_shown   = true;
+            data->m_changed = false;
+            uploaded++;
         }
+
+        // OptimiseDisplayedArea() moves the images, put them back first.
+        uiimage->SetArea(MythRect(data->m_x, data->m_y,
+                         data->m_image.width(), data->m_image.height()));
     }
     osdWindow->OptimiseDisplayedArea();
+
+    LOG(VB_PLAYBACK, LOG_DEBUG,
+        QString("[mhi] OSD update: %1 images, %2 uploaded, %3 removed "
+                "in %4 ms").arg(m_display.size()).arg(uploaded)
+            .arg(removed).arg(t.elapsed()));
     // N.B. bypasses OSD class hence no expiry set
     osdWindow->SetVisible(true);
 }
@@ -540,27 +657,82 @@ void MHIContext::GetInitialStreams(int &audioTag, int &videoTag)
 
 // An area of the screen/image needs to be redrawn.
 // Called from the MHEG engine.
-// We always redraw the whole scene.
-void MHIContext::RequireRedraw(const QRegion &)
+// Only the damaged region is redrawn, what is left of the items
+// outside it stays in the display.
+void MHIContext::RequireRedraw(const QRegion &region)
 {
+    QTime t; t.start();
+    QRegion toDraw = region;
+
     m_display_lock.lock();
-    ClearDisplay();
+    if (m_redrawAll)
+    {
+        toDraw = QRegion(0, 0, StdDisplayWidth, StdDisplayHeight);
+        ClearDisplay();
+        m_redrawAll = false;
+    }
+    m_damage = ScaleRegion(toDraw);
+    EraseDisplay(m_damage);
     m_display_lock.unlock();
-    // Always redraw the whole screen
-    m_engine->DrawDisplay(QRegion(0, 0, StdDisplayWidth, StdDisplayHeight));
+
+    m_engine->DrawDisplay(toDraw);
+    m_damage = QRegion();
     m_updated = true;
+
+    LOG(VB_PLAYBACK, LOG_DEBUG,
+        QString("[mhi] Redrew %1 rects, bounds %2x%3, in %4 ms")
+            .arg(toDraw.rects().size())
+            .arg(toDraw.boundingRect().width())
+            .arg(toDraw.boundingRect().height()).arg(t.elapsed()));
 }
 
+// Items are added from the bottom of the display stack up.  During a
+// redraw they are cut down to the damaged region.
 void MHIContext::AddToDisplay(const QImage &image, int x, int y)
 {
-    MHIImageData *data = new MHIImageData;
     int dispx = x + m_displayRect.left();
     int dispy = y + m_displayRect.top();
+    QRect imageRect(dispx, dispy, image.width(), image.height());
 
+    MHIImageData *data = new MHIImageData;
     data->m_image = image;
     data->m_x = dispx;
     data->m_y = dispy;
+
+    QRegion clip = m_damage & imageRect;
+    if (!m_damage.isEmpty() && clip != QRegion(imageRect))
+    {
+        if (clip.isEmpty())
+        {
+            delete data;
+            return;
+        }
+
+        QRect bounds = clip.boundingRect();
+        data->m_image = image.copy(bounds.translated(-dispx, -dispy));
+        data->m_x = bounds.x();
+        data->m_y = bounds.y();
+
+        QRegion outside = QRegion(bounds) - clip;
+        if (!outside.isEmpty())
+        {
+            if (!data->m_image.hasAlphaChannel())
+                data->m_image =
+                    data->m_image.convertToFormat(QImage::Format_ARGB32);
+
+            QPainter painter(&data->m_image);
+            painter.setCompositionMode(QPainter::CompositionMode_Clear);
+            QVector<QRect> rects = outside.rects();
+            for (uint j = 0; j < (uint)rects.size(); j++)
+                painter.fillRect(rects[j].translated(-data->m_x, -data->m_y),
+                                 Qt::transparent);
+        }
+    }
+
     QMutexLocker locker(&m_display_lock);
+    data->m_id      = m_nextImageId++;
+    data->m_shown   = false;
+    data->m_changed = false;
     m_display.push_back(data);
 }
 
@@ -587,41 +759,14 @@ void MHIContext::DrawVideo(const QRect &videoRect, const QRect &dispRect)
         }
     }
 
-    QMutexLocker locker(&m_display_lock);
-    QRect displayRect(SCALED_X(dispRect.x()),
-                      SCALED_Y(dispRect.y()),
-                      SCALED_X(dispRect.width()),
-                      SCALED_Y(dispRect.height()));
-
-    list<MHIImageData*>::iterator it = m_display.begin();
-    for (; it != m_display.end(); ++it)
-    {
-        MHIImageData *data = *it;
-        QRect imageRect(data->m_x, data->m_y,
-                        data->m_image.width(), data->m_image.height());
-        if (displayRect.intersects(imageRect))
-        {
-            // Replace this item with a set of cut-outs.
-            it = m_display.erase(it);
+    // Items above the video outside the damaged region have already been
+    // drawn, so only cut out what is being redrawn.
+    QRegion hole = ScaleRegion(QRegion(dispRect));
+    if (!m_damage.isEmpty())
+        hole &= m_damage;
 
-            QVector<QRect> rects =
-                (QRegion(imageRect) - QRegion(displayRect)).rects();
-            for (uint j = 0; j < (uint)rects.size(); j++)
-            {
-                QRect &rect = rects[j];
-                QImage image =
-                    data->m_image.copy(rect.x()-data->m_x, rect.y()-data->m_y,
-                                       rect.width(), rect.height());
-                MHIImageData *newData = new MHIImageData;
-                newData->m_image = image;
-                newData->m_x = rect.x();
-                newData->m_y = rect.y();
-                m_display.insert(it, newData);
-                ++it;
-            }
-            delete data;
-        }
-    }
+    QMutexLocker locker(&m_display_lock);
+    EraseDisplay(hole);
 }
 
 
@@ -848,14 +993,7 @@ void MHIContext::DrawRect(int xPos, int yPos, int width, int height,
     int scaledWidth  = SCALED_X(width);
     int scaledHeight = SCALED_Y(height);
     QImage qImage(scaledWidth, scaledHeight, QImage::Format_ARGB32);
-
-    for (int i = 0; i < scaledHeight; i++)
-    {
-        for (int j = 0; j < scaledWidth; j++)
-        {
-            qImage.setPixel(j, i, qColour);
-        }
-    }
+    qImage.fill(qColour);
 
     AddToDisplay(qImage, SCALED_X(xPos), SCALED_Y(yPos));
 }
@@ -16,6 +16,8 @@ using namespace std;
 #include <QString>
 #include <QMutex>
 #include <QImage>
+#include <QRegion>
+#include <QList>
 
 // MythTV headers
 #include "../libmythfreemheg/freemheg.h"
@@ -142,6 +144,8 @@ class MHIContext : public MHContext, public QRunnable
     void ProcessDSMCCQueue(void);
     void NetworkBootRequested(void);
     void ClearDisplay(void);
+    void EraseDisplay(const QRegion &area);
+    QRegion ScaleRegion(const QRegion &region) const;
     void ClearQueue(void);
 
     InteractiveTV   *m_parent;
@@ -167,6 +171,10 @@ class MHIContext : public MHContext, public QRunnable
     float            m_yScale;
 
     list<MHIImageData*> m_display; // List of items to display
+    QList<uint>      m_removed;   // Items dropped since the last UpdateOSD
+    bool             m_redrawAll; // Redraw the whole scene next time
+    uint             m_nextImageId;
+    QRegion          m_damage;    // Display area being redrawn
 
     FT_Face          m_face;
     bool             m_face_loaded;
@@ -192,6 +192,7 @@ MythPlayer::MythPlayer(bool muted)
       play_speed(1.0f),             normal_speed(true),
       frame_interval((int)(1000000.0f / 30)), m_frame_interval(0),
       ffrew_skip(1),ffrew_adjust(0),
+      trickplay_frames(0),          trickplay_fps(0.0f),
       // Audio and video synchronization stuff
       videosync(NULL),              avsync_delay(0),
       avsync_adjustment(0),         avsync_avg(0),
@@ -1062,11 +1063,13 @@ void MythPlayer::InitFilters(void)
         VideoFrameType itmp = FMT_YV12;
         VideoFrameType otmp = FMT_YV12;
         int btmp;
+        int threads = videoOutput ? videoOutput->GetFilterThreads() : 1;
         postfilt_width = video_dim.width();
         postfilt_height = video_dim.height();
 
         videoFilters = FiltMan->LoadFilters(
-            filters, itmp, otmp, postfilt_width, postfilt_height, btmp);
+            filters, itmp, otmp, postfilt_width, postfilt_height, btmp,
+            threads);
     }
 
     videofiltersLock.unlock();
@@ -2952,8 +2955,55 @@ void MythPlayer::DecoderLoop(bool pause)
     decoderSeek = -1;
 }
 
+/** \brief Returns true if fast forward and rewind should only decode
+ *         keyframes from the position map.
+ *
+ *   This is the case once we skip at least a whole GOP for every frame
+ *   displayed, since decoding the frames in between is wasted effort.
+ */
+bool MythPlayer::UseTrickPlay(void) const
+{
+    if (ffrew_skip == 0 || ffrew_skip == 1 || keyframedist <= 1)
+        return false;
+    if (player_ctx->buffer->IsDisc())
+        return false;
+    return (uint)abs(ffrew_skip) >= keyframedist;
+}
+
+/** \brief Hands the position of the next few keyframes trick-play will
+ *         show to the RingBuffer, so the read ahead thread can have them
+ *         fetched from storage while the current keyframe is displayed.
+ */
+void MythPlayer::PrefetchTrickPlay(void)
+{
+    const uint kPrefetchKeyframes = 3;
+
+    QList<long long> positions;
+    long long step = ffrew_skip + ffrew_adjust;
+    if (!decoder->GetTrickPlayPositions(decoder->GetFramesRead(), step,
+                                        kPrefetchKeyframes, positions))
+    {
+        return;
+    }
+
+    // Roughly one keyframe worth of data at the current bitrate.
+    uint length = (uint)((decoder->GetRawBitrate() * 1000.0 / 8.0) *
+                         keyframedist / max(video_frame_rate, 1.0));
+    length = max(length, (uint)(128 * 1024));
+    player_ctx->buffer->SetPrefetchHints(positions, length);
+}
+
 bool MythPlayer::DecoderGetFrameFFREW(void)
 {
+    bool trickplay = UseTrickPlay();
+    if (decoder->GetTrickPlay() != trickplay)
+    {
+        decoder->SetTrickPlay(trickplay);
+        trickplay_frames = 0;
+        trickplay_fps    = 0.0f;
+        trickplay_timer.start();
+    }
+
     if (ffrew_skip > 0)
     {
         long long delta = decoder->GetFramesRead() - framesPlayed;
@@ -2970,7 +3020,27 @@ bool MythPlayer::DecoderGetFrameFFREW(void)
     {
         DecoderGetFrameREW();
     }
-    return decoder->GetFrame(kDecodeVideo);
+
+    if (!trickplay)
+        return decoder->GetFrame(kDecodeVideo);
+
+    PrefetchTrickPlay();
+
+    bool ret = decoder->GetFrame(kDecodeVideo);
+    if (ret)
+        trickplay_frames++;
+
+    int elapsed = trickplay_timer.elapsed();
+    if (elapsed >= 1000)
+    {
+        trickplay_fps    = trickplay_frames * 1000.0f / elapsed;
+        trickplay_frames = 0;
+        trickplay_timer.restart();
+        LOG(VB_PLAYBACK, LOG_DEBUG, LOC +
+            QString("Trick-play at %1x is showing %2 keyframes/sec")
+                .arg(play_speed).arg(trickplay_fps, 0, 'f', 1));
+    }
+    return ret;
 }
 
 bool MythPlayer::DecoderGetFrameREW(void)
@@ -3019,7 +3089,11 @@ bool MythPlayer::DecoderGetFrame(DecodeType decodetype, bool unsafe)
     }
 
     if (ffrew_skip == 1 || decodeOneFrame)
+    {
+        if (decoder->GetTrickPlay())
+            decoder->SetTrickPlay(false);
         ret = decoder->GetFrame(decodetype);
+    }
     else if (ffrew_skip != 0)
         ret = DecoderGetFrameFFREW();
     decoder_change_lock.unlock();
@@ -4360,6 +4434,8 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
     infoMap.insert("decoderrate", player_ctx->buffer->GetDecoderRate());
     infoMap.insert("storagerate", player_ctx->buffer->GetStorageRate());
     infoMap.insert("bufferavail", player_ctx->buffer->GetAvailableBuffer());
+    infoMap.insert("readaheadstats", player_ctx->buffer->GetReadAheadStats());
+    infoMap.insert("remotecache", player_ctx->buffer->GetRemoteCacheStats());
     infoMap.insert("buffersize",
         QString::number(player_ctx->buffer->GetBufferSize() >> 20));
     infoMap.insert("avsync",
@@ -4369,9 +4445,21 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
         QString frames = QString("%1/%2").arg(videoOutput->ValidVideoFrames())
                                          .arg(videoOutput->FreeVideoFrames());
         infoMap.insert("videoframes", frames);
+        infoMap.insert("framepool", videoOutput->GetFramePoolStats());
     }
     if (decoder)
+    {
         infoMap["videodecoder"] = decoder->GetCodecDecoderName();
+        if (decoder->GetTrickPlay())
+        {
+            infoMap["trickplayfps"] = QObject::tr("%1 keyframes/sec at %2x")
+                .arg(trickplay_fps, 0, 'f', 1).arg(play_speed);
+        }
+        else
+        {
+            infoMap["trickplayfps"] = QObject::tr("Off");
+        }
+    }
     if (output_jmeter)
     {
         infoMap["framerate"] = QString("%1%2%3")
@@ -14,6 +14,7 @@
 #include "ringbuffer.h"
 #include "osd.h"
 #include "jitterometer.h"
+#include "mythtimer.h"
 #include "videooutbase.h"
 #include "teletextreader.h"
 #include "subtitlereader.h"
@@ -489,6 +490,8 @@ class MTV_PUBLIC MythPlayer
     virtual bool DecoderGetFrameFFREW(void);
     virtual bool DecoderGetFrameREW(void);
     bool         DecoderGetFrame(DecodeType, bool unsafe = false);
+    bool         UseTrickPlay(void) const;
+    void         PrefetchTrickPlay(void);
 
     // These actually execute commands requested by public members
     virtual void ChangeSpeed(void);
@@ -707,6 +710,11 @@ class MTV_PUBLIC MythPlayer
     int        ffrew_skip;
     int        ffrew_adjust;
 
+    // Keyframe only trick-play, used by the decoder thread
+    MythTimer  trickplay_timer;
+    uint       trickplay_frames;
+    float      trickplay_fps;
+
     // Audio and video synchronization stuff
     VideoSync *videosync;
     int        avsync_delay;
@@ -485,22 +485,34 @@ void PlayerContext::StopPlaying(void)
         player->StopPlaying();
 }
 
-void PlayerContext::UpdateTVChain(void)
+/**
+ *  \brief Reloads the chain and lets the player switch to a new program.
+ *  \param data The chain pushed with the LIVETV_CHAIN UPDATE event,
+ *              it is read from the database when this is empty.
+ */
+void PlayerContext::UpdateTVChain(const QStringList &data)
 {
     QMutexLocker locker(&deletePlayerLock);
     if (tvchain && player)
     {
-        tvchain->ReloadAll();
+        tvchain->ReloadAll(data);
         player->CheckTVChain();
     }
 }
 
+/**
+ *  \brief Reloads the chain from the recorder and makes the last
+ *         program in it the playing program.
+ */
 bool PlayerContext::ReloadTVChain(void)
 {
     if (!tvchain)
         return false;
 
-    tvchain->ReloadAll();
+    QStringList data;
+    if (recorder)
+        data = recorder->GetLiveTVChain();
+    tvchain->ReloadAll(data);
     ProgramInfo *pinfo = tvchain->GetProgramAt(-1);
     if (pinfo)
     {
@@ -333,6 +333,23 @@ void RemoteEncoder::SpawnLiveTV(QString chainId, bool pip, QString startchan)
     SendReceiveStringList(strlist);
 }
 
+/**
+ *  \brief Returns the recorder's LiveTV chain, as serialized by
+ *         LiveTVChain::ToStringList(), or an empty list on failure.
+ *  \sa LiveTVChain::ReloadAll(const QStringList&)
+ */
+QStringList RemoteEncoder::GetLiveTVChain(void)
+{
+    QStringList strlist( QString("QUERY_RECORDER %1").arg(recordernum));
+    strlist << "GET_LIVETV_CHAIN";
+
+    // A recorder without a chain replies with a single empty string
+    if (!SendReceiveStringList(strlist, 1) || strlist.size() < 2)
+        return QStringList();
+
+    return strlist;
+}
+
 /**
  *  \brief Tells TVRec to stop a "Live TV" recorder.
  *         <b>This only works on local recorders.</b>
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include <QStringList>
 #include <QString>
 #include <QMutex>
 #include <QHash>
@@ -40,6 +41,7 @@ class MTV_PUBLIC RemoteEncoder
                          QMap<long long, long long> &positionMap);
     void StopPlaying(void);
     void SpawnLiveTV(QString chainid, bool pip, QString startchan);
+    QStringList GetLiveTVChain(void);
     void StopLiveTV(void);
     void PauseRecorder(void);
     void FinishRecording(void);
@@ -34,6 +34,12 @@
 #define BUFFER_FACTOR_BITRATE  2
 #define BUFFER_FACTOR_MATROSKA 2
 
+// limits for the adaptive read ahead buffer
+#define ADAPT_SIZE_MINIMUM (1 * 1024 * 1024)
+#define ADAPT_SIZE_MAXIMUM (64 * 1024 * 1024)
+#define ADAPT_INTERVAL     1000  /* ms between model updates */
+#define ADAPT_RESIZE_DELAY 10000 /* ms between buffer resizes */
+
 const int  RingBuffer::kDefaultOpenTimeout = 2000; // ms
 const int  RingBuffer::kLiveTVOpenTimeout  = 10000;
 
@@ -194,7 +200,12 @@ RingBuffer::RingBuffer(RingBufferType rbtype) :
     numfailures(0),           commserror(false),
     oldfile(false),           livetvchain(NULL),
     ignoreliveeof(false),     readAdjust(0),
-    bitrateMonitorEnabled(false)
+    bitrateMonitorEnabled(false),
+    prefetchLength(0),
+    consumedBytes(0),         seekCount(0),
+    consumerKbps(0.0f),       storageLatency(0.0f),
+    seeksPerMinute(0.0f),     targetSecs(0.0f),
+    targetBufferSize(0),      prefetchedTo(0)
 {
     {
         QMutexLocker locker(&subExtLock);
@@ -330,6 +341,50 @@ void RingBuffer::SetBufferSizeFactors(bool estbitrate, bool matroska)
     CreateReadAheadBuffer();
 }
 
+/** \brief Queues stream positions the reader will jump to shortly.
+ *
+ *   The read ahead thread passes these on to PrefetchHint() so that
+ *   the data for e.g. the next trick-play keyframes is already on its
+ *   way from storage while the current one is being displayed. Any
+ *   hints not yet serviced are replaced by the new ones.
+ *
+ *  \param positions Byte offsets in the stream.
+ *  \param length    Number of bytes wanted at each position.
+ */
+void RingBuffer::SetPrefetchHints(const QList<long long> &positions,
+                                  uint length)
+{
+    QMutexLocker locker(&prefetchLock);
+    prefetchPositions = positions;
+    prefetchLength    = length;
+    if (!positions.empty())
+        generalWait.wakeAll();
+}
+
+/// \brief Passes any queued prefetch hints on to PrefetchHint().
+/// WARNING: Must be called with rwlock in locked state.
+void RingBuffer::ServicePrefetchHints(void)
+{
+    QList<long long> positions;
+    uint length;
+    {
+        QMutexLocker locker(&prefetchLock);
+        if (prefetchPositions.empty())
+            return;
+        positions = prefetchPositions;
+        length    = prefetchLength;
+        prefetchPositions.clear();
+    }
+
+    QList<long long>::const_iterator it = positions.begin();
+    for (; it != positions.end(); ++it)
+        PrefetchHint(*it, length);
+
+    LOG(VB_FILE, LOG_DEBUG, LOC +
+        QString("Serviced %1 prefetch hints of %2 KB")
+            .arg(positions.size()).arg(length / 1024));
+}
+
 /** \fn RingBuffer::CalcReadAheadThresh(void)
  *  \brief Calculates fill_min, fill_threshold, and readblocksize
  *         from the estimated effective bitrate of the stream.
@@ -376,6 +431,219 @@ void RingBuffer::CalcReadAheadThresh(void)
             .arg(fill_min/1024).arg(readblocksize/1024));
 }
 
+/** \fn RingBuffer::AdaptReadAhead(void)
+ *  \brief Sizes the read ahead buffer and read requests from what the
+ *         stream and the storage are actually doing.
+ *
+ *   Once a second the rate at which the reader consumes data, the
+ *   average latency of our storage reads and the rate of seeks which
+ *   discard the buffer are folded into running averages. From these:
+ *
+ *   - the buffer should hold 2 seconds of data plus 20 times the
+ *     storage latency, capped at 10 seconds, and less when seeks are
+ *     frequent since a seek throws the buffered data away,
+ *   - each read request should cover 4 times the storage latency
+ *     worth of data, so that slow storage is asked for fewer, larger
+ *     blocks.
+ *
+ *   Requests are resized right away, the buffer itself only when it
+ *   is off by 50% and at most every ADAPT_RESIZE_DELAY ms.
+ *
+ *   WARNING: Must be called with rwlock in read lock state,
+ *            from the read ahead thread.
+ */
+void RingBuffer::AdaptReadAhead(void)
+{
+    if (!adaptTimer.isRunning())
+    {
+        adaptTimer.start();
+        resizeTimer.start();
+        consumedBytes.fetchAndStoreOrdered(0);
+        return;
+    }
+
+    int elapsed = adaptTimer.elapsed();
+    if (elapsed < ADAPT_INTERVAL)
+        return;
+    adaptTimer.restart();
+
+    int consumed = consumedBytes.fetchAndStoreOrdered(0);
+
+    adaptLock.lock();
+
+    // bytes per ms * 8 == kbits per second
+    float kbps = (float) consumed * 8.0f / (float) elapsed;
+    if (consumed > 0 && !paused && !request_pause)
+    {
+        consumerKbps = (consumerKbps < 1.0f) ? kbps :
+            (consumerKbps * 3.0f + kbps) * 0.25f;
+    }
+
+    float seeks = (float) seekCount * 60000.0f / (float) elapsed;
+    seekCount = 0;
+    seeksPerMinute = (seeksPerMinute * 9.0f + seeks) * 0.1f;
+
+    // don't trust the measured rate more than the stream's own rate
+    // when playing at normal speed, the reader may be catching up
+    float estkbps = max(abs(rawbitrate * playspeed), 0.5f * rawbitrate);
+    float ratekbps = max(consumerKbps, min(estkbps, (float) rawbitrate * 3));
+    float bytes_per_sec = ratekbps * 125.0f;
+
+    float secs = 2.0f + storageLatency * 0.02f;
+    secs = min(secs, 10.0f);
+    secs = secs / (1.0f + seeksPerMinute * 0.25f);
+    secs = max(secs, 1.0f);
+
+    uint newsize = (uint) (bytes_per_sec * secs);
+    if (fileismatroska)
+        newsize *= BUFFER_FACTOR_MATROSKA;
+    if (unknownbitrate)
+        newsize *= BUFFER_FACTOR_BITRATE;
+    newsize = max(newsize, (uint) ADAPT_SIZE_MINIMUM);
+    newsize = min(newsize, (uint) ADAPT_SIZE_MAXIMUM);
+    newsize = ((newsize + CHUNK - 1) / CHUNK) * CHUNK;
+
+    float req_secs = max(storageLatency * 0.004f, 0.05f);
+    int newblock = (int) (bytes_per_sec * req_secs);
+    newblock = ((newblock + CHUNK - 1) / CHUNK) * CHUNK;
+    newblock = max(newblock, CHUNK);
+    newblock = min(newblock, (int) (min(newsize, bufferSize) / 4));
+
+    targetSecs       = secs;
+    targetBufferSize = newsize;
+    float latency    = storageLatency;
+    float seekrate   = seeksPerMinute;
+
+    adaptLock.unlock();
+
+    bool resize = ((newsize > bufferSize * 3 / 2) ||
+                   (newsize < bufferSize * 2 / 3)) &&
+                  (resizeTimer.elapsed() > ADAPT_RESIZE_DELAY);
+
+    if (!resize && newblock == readblocksize)
+        return;
+
+    rwlock.unlock();
+    rwlock.lockForWrite();
+
+    // A pause, seek or stop may have come in while we were unlocked
+    if (!readaheadrunning || request_pause)
+    {
+        rwlock.unlock();
+        rwlock.lockForRead();
+        return;
+    }
+
+    newblock = min(newblock, (int) (bufferSize / 4));
+    if (newblock != readblocksize)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("AdaptReadAhead(%1 Kb, %2 ms, %3 seeks/min) "
+                    "-> %4K -> %5K block size")
+                .arg((int)ratekbps).arg((int)latency)
+                .arg(seekrate, 0, 'f', 1)
+                .arg(readblocksize/1024).arg(newblock/1024));
+        readblocksize = newblock;
+    }
+
+    if (resize)
+    {
+        ResizeReadAheadBuffer(newsize);
+        resizeTimer.restart();
+    }
+
+    rwlock.unlock();
+    rwlock.lockForRead();
+}
+
+/** \fn RingBuffer::ResizeReadAheadBuffer(uint)
+ *  \brief Moves the buffered data into a buffer of 'newsize' bytes.
+ *
+ *   Unlike CreateReadAheadBuffer() this can shrink the buffer, only
+ *   the data not yet read is kept. Nothing is done if that data would
+ *   not leave room for at least another quarter buffer of reads.
+ *
+ *   WARNING: Must be called with rwlock in write lock state.
+ */
+void RingBuffer::ResizeReadAheadBuffer(uint newsize)
+{
+    if (!readAheadBuffer || newsize == bufferSize)
+        return;
+
+    poslock.lockForWrite();
+    rbrlock.lockForWrite();
+    rbwlock.lockForWrite();
+
+    uint avail = (rbwpos >= rbrpos) ?
+        rbwpos - rbrpos : bufferSize - rbrpos + rbwpos;
+
+    if (avail > newsize * 3 / 4)
+    {
+        rbwlock.unlock();
+        rbrlock.unlock();
+        poslock.unlock();
+        return;
+    }
+
+    char *newbuffer = new char[newsize + 1024];
+    if (rbwpos >= rbrpos)
+    {
+        memcpy(newbuffer, readAheadBuffer + rbrpos, avail);
+    }
+    else
+    {
+        memcpy(newbuffer, readAheadBuffer + rbrpos, bufferSize - rbrpos);
+        memcpy(newbuffer + (bufferSize - rbrpos), readAheadBuffer, rbwpos);
+    }
+    delete [] readAheadBuffer;
+    readAheadBuffer = newbuffer;
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Resized readAheadBuffer: %1K -> %2K, kept %3K")
+            .arg(bufferSize/1024).arg(newsize/1024).arg(avail/1024));
+
+    bufferSize = newsize;
+    rbrpos = 0;
+    rbwpos = avail;
+    CalcReadAheadThresh();
+    generalWait.wakeAll();
+
+    rbwlock.unlock();
+    rbrlock.unlock();
+    poslock.unlock();
+}
+
+/** \fn RingBuffer::PrefetchAhead(void)
+ *  \brief Hints to the storage that the next buffer full of data past
+ *         the read ahead position will be wanted soon.
+ *
+ *   The hint is renewed once half of the hinted window has been read,
+ *   so the storage always has between half and a whole buffer of
+ *   requests queued ahead of us.
+ *
+ *   WARNING: Must be called with rwlock in locked state.
+ */
+void RingBuffer::PrefetchAhead(void)
+{
+    if (ateof || setswitchtonext)
+        return;
+
+    poslock.lockForRead();
+    long long ahead = internalreadpos;
+    poslock.unlock();
+
+    long long window = bufferSize;
+    if (prefetchedTo < ahead || prefetchedTo > ahead + 2 * window)
+        prefetchedTo = ahead;
+
+    if (prefetchedTo - ahead >= window / 2)
+        return;
+
+    long long end = ahead + window;
+    PrefetchHint(prefetchedTo, (uint)(end - prefetchedTo));
+    prefetchedTo = end;
+}
+
 bool RingBuffer::IsNearEnd(double fps, uint vvf) const
 {
     rwlock.lockForRead();
@@ -445,6 +713,12 @@ void RingBuffer::ResetReadAhead(long long newinternal)
         QString("ResetReadAhead(internalreadpos = %1->%2)")
             .arg(internalreadpos).arg(newinternal));
 
+    if (newinternal != internalreadpos)
+    {
+        QMutexLocker locker(&adaptLock);
+        seekCount++;
+    }
+
     rbrlock.lockForWrite();
     rbwlock.lockForWrite();
 
@@ -702,13 +976,6 @@ void RingBuffer::run(void)
 {
     RunProlog();
 
-    // These variables are used to adjust the read block size
-    struct timeval lastread, now;
-    int readtimeavg = 300;
-    bool ignore_for_read_timing = true;
-
-    gettimeofday(&lastread, NULL); // this is just to keep gcc happy
-
     CreateReadAheadBuffer();
     rwlock.lockForWrite();
     poslock.lockForWrite();
@@ -733,10 +1000,11 @@ void RingBuffer::run(void)
     while (readaheadrunning)
     {
         if (PauseAndWait())
-        {
-            ignore_for_read_timing = true;
             continue;
-        }
+
+        ServicePrefetchHints();
+        AdaptReadAhead();
+        PrefetchAhead();
 
         long long totfree = ReadBufFree();
 
@@ -746,8 +1014,6 @@ void RingBuffer::run(void)
         if (((totfree < KB32) && readsallowed) ||
             (ignorereadpos >= 0) || commserror || stopreads)
         {
-            ignore_for_read_timing |=
-                (ignorereadpos >= 0) || commserror || stopreads;
             generalWait.wait(&rwlock, (stopreads) ? 50 : 1000);
             continue;
         }
@@ -756,7 +1022,6 @@ void RingBuffer::run(void)
         // other threads to do stuff.
         if (setswitchtonext || (ateof && readsallowed))
         {
-            ignore_for_read_timing = true;
             generalWait.wait(&rwlock, 1000);
             totfree = ReadBufFree();
         }
@@ -771,43 +1036,6 @@ void RingBuffer::run(void)
             else
                 totfree = readblocksize;
 
-            // adapt blocksize
-            gettimeofday(&now, NULL);
-            if (!ignore_for_read_timing)
-            {
-                int readinterval = (now.tv_sec  - lastread.tv_sec ) * 1000 +
-                    (now.tv_usec - lastread.tv_usec) / 1000;
-                readtimeavg = (readtimeavg * 9 + readinterval) / 10;
-
-                if (readtimeavg < 150 && 
-                    (uint)readblocksize < (BUFFER_SIZE_MINIMUM >>2))
-                {
-                    int old_block_size = readblocksize;
-                    readblocksize = 3 * readblocksize / 2;
-                    readblocksize = ((readblocksize+CHUNK-1) / CHUNK) * CHUNK;
-                    LOG(VB_FILE, LOG_INFO, LOC +
-                        QString("Avg read interval was %1 msec. "
-                                "%2K -> %3K block size")
-                            .arg(readtimeavg)
-                            .arg(old_block_size/1024)
-                            .arg(readblocksize/1024));
-                    readtimeavg = 225;
-                }
-                else if (readtimeavg > 300 && readblocksize > CHUNK)
-                {
-                    readblocksize -= CHUNK;
-                    LOG(VB_FILE, LOG_INFO, LOC +
-                        QString("Avg read interval was %1 msec. "
-                                "%2K -> %3K block size")
-                            .arg(readtimeavg)
-                            .arg((readblocksize+CHUNK)/1024)
-                            .arg(readblocksize/1024));
-                    readtimeavg = 225;
-                }
-            }
-            ignore_for_read_timing = (totfree < readblocksize) ? true : false;
-            lastread = now;
-
             rbwlock.lockForRead();
             if (rbwpos + totfree > bufferSize)
             {
@@ -818,7 +1046,8 @@ void RingBuffer::run(void)
 
             if (internalreadpos == 0)
             {
-                totfree = max(fill_min, readblocksize);
+                totfree = min(max(fill_min, readblocksize),
+                              (int)bufferSize - rbwpos);
                 LOG(VB_FILE, LOG_DEBUG, LOC +
                     "Reading enough data to start playback");
             }
@@ -852,6 +1081,12 @@ void RingBuffer::run(void)
                     .arg(QString("(%1Mbps)").arg((double)bps / 1000000.0)));
             UpdateStorageRate(bps);
 
+            if (read_return > 0)
+            {
+                QMutexLocker locker(&adaptLock);
+                storageLatency = (storageLatency * 7.0f + sr_elapsed) * 0.125f;
+            }
+
             if (read_return >= 0)
             {
                 poslock.lockForWrite();
@@ -1021,9 +1256,13 @@ bool RingBuffer::WaitForAvail(int count)
 
     if (livetvchain && setswitchtonext && avail < count)
     {
-        LOG(VB_GENERAL, LOG_INFO, LOC +
-            "Checking to see if there's a new livetv program to switch to..");
-        livetvchain->ReloadAll();
+        // A chain the recorder pushes updates to is already current
+        if (!livetvchain->IsPushed())
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC + "Checking to see if there's "
+                "a new livetv program to switch to..");
+            livetvchain->ReloadAll();
+        }
         return false;
     }
 
@@ -1284,6 +1523,7 @@ int RingBuffer::Read(void *buf, int count)
         poslock.lockForWrite();
         readpos += ret;
         poslock.unlock();
+        consumedBytes.fetchAndAddOrdered(ret);
     }
 
     UpdateDecoderRate(ret);
@@ -1327,9 +1567,15 @@ QString RingBuffer::GetDecoderRate(void)
     return BitrateToString(UpdateDecoderRate());
 }
 
+/// \brief Returns the storage read rate and the average read latency.
 QString RingBuffer::GetStorageRate(void)
 {
-    return BitrateToString(UpdateStorageRate());
+    adaptLock.lock();
+    int latency = (int) storageLatency;
+    adaptLock.unlock();
+
+    return QString("%1 (%2ms)")
+        .arg(BitrateToString(UpdateStorageRate())).arg(latency);
 }
 
 QString RingBuffer::GetAvailableBuffer(void)
@@ -1338,6 +1584,39 @@ QString RingBuffer::GetAvailableBuffer(void)
     return QString("%1%").arg((int)(((float)avail / (float)bufferSize) * 100.0));
 }
 
+/// \brief Returns the buffering and read size chosen by AdaptReadAhead().
+QString RingBuffer::GetReadAheadStats(void)
+{
+    int block = readblocksize;
+
+    adaptLock.lock();
+    float secs   = targetSecs;
+    float seeks  = seeksPerMinute;
+    uint  target = targetBufferSize;
+    adaptLock.unlock();
+
+    if (!target)
+        return QString();
+
+    return QObject::tr("target %1s/%2MB, %3K reads, %4 seeks/min")
+        .arg(secs, 0, 'f', 1)
+        .arg((double)target / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(block / 1024).arg(seeks, 0, 'f', 1);
+}
+
+/// \brief Returns the block cache statistics of a remote file that
+///        is read over HTTP.
+QString RingBuffer::GetRemoteCacheStats(void) const
+{
+    QString msg;
+    rwlock.lockForRead();
+    if (remotefile)
+        msg = remotefile->GetCacheStats();
+    rwlock.unlock();
+
+    return msg.isEmpty() ? QObject::tr("N/A") : msg;
+}
+
 uint64_t RingBuffer::UpdateDecoderRate(uint64_t latest)
 {
     if (!bitrateMonitorEnabled)
@@ -6,11 +6,14 @@
 #include <QReadWriteLock>
 #include <QWaitCondition>
 #include <QString>
+#include <QAtomicInt>
 #include <QMutex>
+#include <QList>
 #include <QMap>
 
 #include "mythconfig.h"
 #include "mthread.h"
+#include "mythtimer.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -57,6 +60,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void UpdatePlaySpeed(float playspeed);
     void EnableBitrateMonitor(bool enable) { bitrateMonitorEnabled = enable; }
     void SetBufferSizeFactors(bool estbitrate, bool matroska);
+    void SetPrefetchHints(const QList<long long> &positions, uint length);
 
     // Gets
     QString   GetSafeFilename(void) { return safefilename; }
@@ -71,6 +75,8 @@ class MTV_PUBLIC RingBuffer : protected MThread
     QString GetDecoderRate(void);
     QString GetStorageRate(void);
     QString GetAvailableBuffer(void);
+    QString GetReadAheadStats(void);
+    QString GetRemoteCacheStats(void) const;
     uint    GetBufferSize(void) { return bufferSize; }
     long long GetWritePosition(void) const;
     /// \brief Returns the size of the file we are reading/writing,
@@ -156,8 +162,15 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void run(void); // MThread
     void CreateReadAheadBuffer(void);
     void CalcReadAheadThresh(void);
+    void AdaptReadAhead(void);
+    void ResizeReadAheadBuffer(uint newsize);
+    void PrefetchAhead(void);
     bool PauseAndWait(void);
     virtual int safe_read(void *data, uint sz) = 0;
+    /// \brief Hints that 'length' bytes at 'pos' will be read soon.
+    virtual void PrefetchHint(long long pos, uint length)
+        { (void)pos; (void)length; }
+    void ServicePrefetchHints(void);
 
     int ReadPriv(void *buf, int count, bool peek);
     int ReadDirect(void *buf, int count, bool peek);
@@ -237,6 +250,24 @@ class MTV_PUBLIC RingBuffer : protected MThread
     QMutex            storageReadLock;
     QMap<qint64, uint64_t> storageReads;
 
+    // prefetch hints serviced by the read ahead thread
+    QMutex            prefetchLock;
+    QList<long long>  prefetchPositions; // protected by prefetchLock
+    uint              prefetchLength;    // protected by prefetchLock
+
+    // adaptive read ahead model, see AdaptReadAhead()
+    mutable QMutex    adaptLock;
+    QAtomicInt        consumedBytes;     // bytes handed to the reader
+    uint              seekCount;         // protected by adaptLock
+    float             consumerKbps;      // protected by adaptLock
+    float             storageLatency;    // protected by adaptLock (ms)
+    float             seeksPerMinute;    // protected by adaptLock
+    float             targetSecs;        // protected by adaptLock
+    uint              targetBufferSize;  // protected by adaptLock
+    MythTimer         adaptTimer;        // read ahead thread only
+    MythTimer         resizeTimer;       // read ahead thread only
+    long long         prefetchedTo;      // read ahead thread only
+
     // note 1: numfailures is modified with only a read lock in the
     // read ahead thread, but this is safe since all other places
     // that use it are protected by a write lock. But this is a
@@ -8,6 +8,8 @@
 
 // MythTV headers
 #include "scriptsignalmonitor.h"
+#include "tsfilesignalmonitor.h"
+#include "tsfilechannel.h"
 #include "signalmonitor.h"
 #include "mythcontext.h"
 #include "compat.h"
@@ -144,6 +146,13 @@ SignalMonitor *SignalMonitor::Init(QString cardtype, int db_cardnum,
     }
 #endif
 
+    if (cardtype.toUpper() == "TSFILE")
+    {
+        TSFileChannel *fc = dynamic_cast<TSFileChannel*>(channel);
+        if (fc)
+            signalMonitor = new TSFileSignalMonitor(db_cardnum, fc);
+    }
+
     if (!signalMonitor && channel)
     {
         signalMonitor = new ScriptSignalMonitor(db_cardnum, channel);
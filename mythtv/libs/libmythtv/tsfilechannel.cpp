@@ -0,0 +1,94 @@
+/** -*- Mode: c++ -*-
+ *  Class TSFileChannel
+ */
+
+// Qt includes
+#include <QFileInfo>
+#include <QDir>
+
+// MythTV includes
+#include "mythlogging.h"
+#include "tsfilechannel.h"
+
+#define LOC     QString("TSFileChan(%1): ").arg(GetDevice())
+
+TSFileChannel::TSFileChannel(TVRec *parent, const QString &device) :
+    DTVChannel(parent), m_device(device), m_isopen(false)
+{
+    m_device.detach();
+}
+
+TSFileChannel::~TSFileChannel(void)
+{
+    if (IsOpen())
+        Close();
+}
+
+bool TSFileChannel::Open(void)
+{
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "Open()");
+
+    if (m_isopen)
+        return true;
+
+    if (!QFileInfo(m_device).isDir())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Not a directory of captures");
+        return false;
+    }
+
+    m_isopen = true;
+
+    return true;
+}
+
+void TSFileChannel::Close(void)
+{
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "Close()");
+
+    QMutexLocker locker(&m_lock);
+    m_curfile.clear();
+    m_isopen = false;
+}
+
+bool TSFileChannel::Tune(const DTVMultiplex &tuning, QString inputname)
+{
+    if (!Tune(tuning.frequency, inputname))
+        return false;
+
+    SetSIStandard(tuning.sistandard);
+
+    return true;
+}
+
+bool TSFileChannel::Tune(uint64_t frequency, QString /*inputname*/)
+{
+    QString filename = GetFileName(frequency);
+
+    QMutexLocker locker(&m_lock);
+
+    if (!QFileInfo(filename).isReadable())
+    {
+        LOG(VB_CHANNEL, LOG_INFO, LOC +
+            QString("No capture for %1 Hz").arg(frequency));
+        m_curfile.clear();
+        return false;
+    }
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Tuned to %1").arg(filename));
+    m_curfile = filename;
+
+    return true;
+}
+
+QString TSFileChannel::GetCurrentFile(void) const
+{
+    QMutexLocker locker(&m_lock);
+    QString tmp = m_curfile; tmp.detach();
+    return tmp;
+}
+
+QString TSFileChannel::GetFileName(uint64_t frequency) const
+{
+    return QDir(m_device).filePath(QString("%1.ts").arg(frequency));
+}
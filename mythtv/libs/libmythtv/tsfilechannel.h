@@ -0,0 +1,54 @@
+/// -*- Mode: c++ -*-
+
+#ifndef _TSFILE_CHANNEL_H_
+#define _TSFILE_CHANNEL_H_
+
+// Qt headers
+#include <QString>
+#include <QMutex>
+
+// MythTV headers
+#include "dtvchannel.h"
+
+/** \class TSFileChannel
+ *  \brief Replays captured multiplexes in place of a tuner.
+ *
+ *   The device is a directory of transport stream captures named
+ *   after the frequency they were captured from, "<frequency>.ts".
+ *   Tuning to a frequency selects the matching file, tuning to a
+ *   frequency without a capture fails as a tuner without signal
+ *   would. TSFileSignalMonitor feeds the selected file to the
+ *   stream data, this lets channel scans be run and timed
+ *   without any hardware.
+ */
+class TSFileChannel : public DTVChannel
+{
+  public:
+    TSFileChannel(TVRec *parent, const QString &device);
+    ~TSFileChannel(void);
+
+    // Commands
+    virtual bool Open(void);
+    virtual void Close(void);
+    virtual bool Tune(const DTVMultiplex &tuning, QString inputname);
+    virtual bool Tune(uint64_t frequency, QString inputname);
+
+    // Gets
+    virtual bool IsOpen(void) const { return m_isopen; }
+    virtual QString GetDevice(void) const { return m_device; }
+    virtual bool IsPIDTuningSupported(void) const { return true; }
+
+    /// Capture selected by the last successful Tune()
+    QString GetCurrentFile(void) const;
+
+  private:
+    QString GetFileName(uint64_t frequency) const;
+
+  private:
+    QString         m_device;
+    bool            m_isopen;
+    mutable QMutex  m_lock;
+    QString         m_curfile;
+};
+
+#endif // _TSFILE_CHANNEL_H_
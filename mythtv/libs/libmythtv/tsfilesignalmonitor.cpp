@@ -0,0 +1,128 @@
+// -*- Mode: c++ -*-
+
+#include "mythlogging.h"
+#include "tsfilesignalmonitor.h"
+#include "mpegstreamdata.h"
+#include "tsfilechannel.h"
+#include "tspacket.h"
+
+#define LOC QString("TSFileSM(%1): ").arg(channel->GetDevice())
+
+/// Bytes fed to the stream data every UpdateValues() call, at the
+/// default 25 ms update rate this replays at roughly 60 Mbit/s.
+static const int kReadSize = TSPacket::kSize * 1000;
+
+/**
+ *  \brief Initializes signal lock and signal values.
+ *
+ *   Start() must be called to actually begin continuous
+ *   signal monitoring. The signal is locked whenever the
+ *   channel has a capture for the tuned frequency.
+ *
+ *  \param db_cardnum Recorder number to monitor,
+ *                    if this is less than 0, SIGNAL events will not be
+ *                    sent to the frontend even if SetNotifyFrontend(true)
+ *                    is called.
+ *  \param _channel TSFileChannel replaying the captures
+ *  \param _flags   Flags to start with
+ */
+TSFileSignalMonitor::TSFileSignalMonitor(
+    int db_cardnum, TSFileChannel *_channel, uint64_t _flags) :
+    DTVSignalMonitor(db_cardnum, _channel, _flags),
+    buffer(new unsigned char[kReadSize])
+{
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "ctor");
+}
+
+/** \fn TSFileSignalMonitor::~TSFileSignalMonitor()
+ *  \brief Stops signal monitoring and table monitoring threads.
+ */
+TSFileSignalMonitor::~TSFileSignalMonitor()
+{
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "dtor");
+    Stop();
+    delete [] buffer;
+}
+
+/** \fn TSFileSignalMonitor::Stop(void)
+ *  \brief Stop signal monitoring, the next Start() replays the
+ *         capture of the tuned frequency from its beginning.
+ */
+void TSFileSignalMonitor::Stop(void)
+{
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "Stop() -- begin");
+    SignalMonitor::Stop();
+    file.close();
+    LOG(VB_CHANNEL, LOG_INFO, LOC + "Stop() -- end");
+}
+
+TSFileChannel *TSFileSignalMonitor::GetTSFileChannel(void)
+{
+    return dynamic_cast<TSFileChannel*>(channel);
+}
+
+/** \fn TSFileSignalMonitor::UpdateValues(void)
+ *  \brief Fills in the signal values and feeds the next part of
+ *         the capture to the stream data.
+ *
+ *   This is automatically called by run(), after Start()
+ *   has been used to start the signal monitoring thread.
+ */
+void TSFileSignalMonitor::UpdateValues(void)
+{
+    if (!running || exit)
+        return;
+
+    QString filename = GetTSFileChannel()->GetCurrentFile();
+    if (file.fileName() != filename)
+    {
+        file.close();
+        file.setFileName(filename);
+    }
+
+    if (!file.isOpen() && !filename.isEmpty() &&
+        !file.open(QIODevice::ReadOnly))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to open '%1'").arg(filename));
+    }
+
+    bool isLocked = file.isOpen();
+    {
+        QMutexLocker locker(&statusLock);
+        signalStrength.SetValue(isLocked ? 100 : 0);
+        signalLock.SetValue(isLocked ? 1 : 0);
+    }
+
+    EmitStatus();
+    if (IsAllGood())
+        SendMessageAllGood();
+
+    // Feed the tables as long as we are waiting on any of them
+    if (isLocked && GetStreamData() &&
+        HasAnyFlag(kDTVSigMon_WaitForPAT | kDTVSigMon_WaitForPMT |
+                   kDTVSigMon_WaitForMGT | kDTVSigMon_WaitForVCT |
+                   kDTVSigMon_WaitForNIT | kDTVSigMon_WaitForSDT))
+    {
+        ReadCapture();
+    }
+
+    update_done = true;
+}
+
+/// Reads the next kReadSize bytes, starting over at the end of the
+/// capture as tables in a real multiplex would be repeated.
+void TSFileSignalMonitor::ReadCapture(void)
+{
+    qint64 len = file.read((char*)buffer, kReadSize);
+
+    if (len <= 0)
+    {
+        file.seek(0);
+        return;
+    }
+
+    int remainder = GetStreamData()->ProcessData(buffer, len);
+    if (remainder > 0 && remainder < len)
+        file.seek(file.pos() - remainder);
+}
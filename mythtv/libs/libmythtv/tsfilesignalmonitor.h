@@ -0,0 +1,35 @@
+// -*- Mode: c++ -*-
+
+#ifndef TSFILESIGNALMONITOR_H
+#define TSFILESIGNALMONITOR_H
+
+#include <QFile>
+
+#include "dtvsignalmonitor.h"
+
+class TSFileChannel;
+
+class TSFileSignalMonitor: public DTVSignalMonitor
+{
+  public:
+    TSFileSignalMonitor(int db_cardnum, TSFileChannel *_channel,
+                        uint64_t _flags = 0);
+    virtual ~TSFileSignalMonitor();
+
+    void Stop(void);
+
+  protected:
+    TSFileSignalMonitor(void);
+    TSFileSignalMonitor(const TSFileSignalMonitor&);
+
+    virtual void UpdateValues(void);
+    TSFileChannel *GetTSFileChannel(void);
+
+    void ReadCapture(void);
+
+  protected:
+    QFile             file;
+    unsigned char    *buffer;
+};
+
+#endif // TSFILESIGNALMONITOR_H
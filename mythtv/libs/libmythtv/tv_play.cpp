@@ -2458,6 +2458,7 @@ void TV::timerEvent(QTimerEvent *te)
 
     // Check if it matches a tvchainUpdateTimerId
     ctx = NULL;
+    QStringList chain;
     {
         QMutexLocker locker(&timerIdLock);
         TimerContextMap::iterator it = tvchainUpdateTimerId.find(timer_id);
@@ -2466,6 +2467,7 @@ void TV::timerEvent(QTimerEvent *te)
             KillTimer(timer_id);
             ctx = *it;
             tvchainUpdateTimerId.erase(it);
+            chain = tvchainUpdateData.take(timer_id);
         }
     }
 
@@ -2475,7 +2477,7 @@ void TV::timerEvent(QTimerEvent *te)
         bool still_exists = find_player_index(ctx) >= 0;
 
         if (still_exists)
-            ctx->UpdateTVChain();
+            ctx->UpdateTVChain(chain);
 
         ReturnPlayerLock(mctx);
         handled = true;
@@ -8420,7 +8422,9 @@ void TV::customEvent(QEvent *e)
             if (ctx->tvchain && ctx->tvchain->GetID() == id)
             {
                 QMutexLocker locker(&timerIdLock);
-                tvchainUpdateTimerId[StartTimer(1, __LINE__)] = ctx;
+                int timer_id = StartTimer(1, __LINE__);
+                tvchainUpdateTimerId[timer_id] = ctx;
+                tvchainUpdateData[timer_id] = me->ExtraDataList();
                 break;
             }
         }
@@ -817,6 +817,8 @@ class MTV_PUBLIC TV : public QObject
     TimerContextMap      stateChangeTimerId;
     TimerContextMap      signalMonitorTimerId;
     TimerContextMap      tvchainUpdateTimerId;
+    /// Chains pushed with the LIVETV_CHAIN UPDATE events, per timer
+    QMap<int,QStringList> tvchainUpdateData;
 
   public:
     // Constants
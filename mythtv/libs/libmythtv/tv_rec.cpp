@@ -214,6 +214,9 @@ void TVRec::TeardownAll(void)
     TeardownRecorder(true);
 
     SetRingBuffer(NULL);
+
+    // Don't lose the end of a LiveTV chain still queued for the database
+    LiveTVChain::FlushWrites();
 }
 
 void TVRec::WakeEventLoop(void)
@@ -773,6 +776,9 @@ void TVRec::StartedRecording(RecordingInfo *curRec)
     LOG(VB_RECORD, LOG_INFO, LOC + QString("StartedRecording(0x%1) fn(%2)")
             .arg((uint64_t)curRec,0,16).arg(curRec->GetPathname()));
 
+    // The file is created right after, tell the backend's file index now
+    StorageGroup::AddToFileIndex(curRec->GetPathname());
+
     if (curRec->IsCommercialFree())
         curRec->SaveCommFlagged(COMM_FLAG_COMMFREE);
 
@@ -2,6 +2,7 @@
 // based on earlier work in MythTV's videout_xvmc.cpp
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #include "mythconfig.h"
 
@@ -115,6 +116,12 @@ YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o)
  *        decoder (in the decode queue) then it is placed in the finished queue
  *        until the decoder is no longer using it (not in the decode queue).
  *
+ *  Which queues a frame is in is also kept in a per-frame state mask, so
+ *  that contains() and remove() do not need to search every queue. The
+ *  "decode" state is not a real queue but a per-frame atomic reference,
+ *  which lets the decoder drop frames it has already released for display
+ *  without taking the global lock.
+ *
  * \see VideoOutput
  */
 
@@ -122,7 +129,8 @@ VideoBuffers::VideoBuffers()
     : needfreeframes(0), needprebufferframes(0),
       needprebufferframes_normal(0), needprebufferframes_small(0),
       keepprebufferframes(0), createdpauseframe(false), rpos(0), vpos(0),
-      global_lock(QMutex::Recursive)
+      global_lock(QMutex::Recursive),
+      lockWaitUsecs(0), lockWaits(0), lockAcquires(0), framesStarved(0)
 {
 }
 
@@ -167,6 +175,10 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
     buffers.reserve(max(numcreate, (uint)128));
 
     buffers.resize(numcreate);
+    frameStates.reserve(buffers.capacity());
+    frameStates.assign(numcreate, QAtomicInt(0));
+    decodeRefs.reserve(buffers.capacity());
+    decodeRefs.assign(numcreate, QAtomicInt(0));
     for (uint i = 0; i < numcreate; i++)
     {
         memset(at(i), 0, sizeof(VideoFrame));
@@ -183,6 +195,11 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
     keepprebufferframes         = keepprebuffer;
     createdpauseframe           = extra_for_pause;
 
+    lockWaitUsecs               = 0;
+    lockWaits                   = 0;
+    lockAcquires                = 0;
+    framesStarved               = 0;
+
     if (createdpauseframe)
         enqueue(kVideoBuffer_pause, at(numcreate - 1));
 
@@ -214,10 +231,80 @@ void VideoBuffers::Reset()
     used.clear();
     limbo.clear();
     finished.clear();
-    decode.clear();
     pause.clear();
     displayed.clear();
     vbufferMap.clear();
+
+    for (uint i = 0; i < frameStates.size(); i++)
+        frameStates[i] = 0;
+    for (uint i = 0; i < decodeRefs.size(); i++)
+        decodeRefs[i] = 0;
+}
+
+/// \brief Returns the index of frame in buffers, or -1 if it is not ours.
+int VideoBuffers::FrameIndex(const VideoFrame *frame) const
+{
+    if (!frame || buffers.empty())
+        return -1;
+
+    ptrdiff_t i = frame - &buffers[0];
+    if (i < 0 || i >= (ptrdiff_t)frameStates.size())
+        return -1;
+
+    return (int)i;
+}
+
+/// \brief Returns the BufferType bits of the queues frame is in.
+/// Frames we do not track are reported as being in all queues.
+uint VideoBuffers::FrameState(const VideoFrame *frame) const
+{
+    int i = FrameIndex(frame);
+    return (i < 0) ? (uint)kVideoBuffer_all : (uint)(int)frameStates[i];
+}
+
+/// \brief Updates the state mask of frame.
+/// WARNING: Must be called with global_lock held.
+void VideoBuffers::SetFrameState(const VideoFrame *frame, uint set, uint clear)
+{
+    int i = FrameIndex(frame);
+    if (i >= 0)
+        frameStates[i] = (int)(((uint)(int)frameStates[i] & ~clear) | set);
+}
+
+bool VideoBuffers::InUseByDecoder(const VideoFrame *frame) const
+{
+    int i = FrameIndex(frame);
+    return (i >= 0) && ((int)decodeRefs[i] != 0);
+}
+
+void VideoBuffers::SetInUseByDecoder(const VideoFrame *frame, bool in_use)
+{
+    int i = FrameIndex(frame);
+    if (i >= 0)
+        decodeRefs[i].fetchAndStoreOrdered(in_use ? 1 : 0);
+}
+
+VideoBuffers::TimedLocker::TimedLocker(const VideoBuffers *vbuffers)
+    : m_vbuffers(vbuffers)
+{
+    if (!m_vbuffers->global_lock.tryLock())
+    {
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+        m_vbuffers->global_lock.lock();
+        gettimeofday(&end, NULL);
+
+        int64_t waited = (end.tv_sec  - start.tv_sec) * 1000000LL +
+                         (end.tv_usec - start.tv_usec);
+        m_vbuffers->lockWaitUsecs += max(waited, (int64_t)0);
+        m_vbuffers->lockWaits++;
+    }
+    m_vbuffers->lockAcquires++;
+}
+
+VideoBuffers::TimedLocker::~TimedLocker()
+{
+    m_vbuffers->global_lock.unlock();
 }
 
 /**
@@ -233,25 +320,25 @@ void VideoBuffers::SetPrebuffering(bool normal)
 
 VideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType enqueue_to)
 {
-    QMutexLocker locker(&global_lock);
+    TimedLocker locker(this);
     VideoFrame *frame = NULL;
 
     // Try to get a frame not being used by the decoder
     for (uint i = 0; i < available.size(); i++)
     {
-        frame = available.dequeue();
-        if (decode.contains(frame))
-            available.enqueue(frame);
+        frame = dequeue(kVideoBuffer_avail);
+        if (InUseByDecoder(frame))
+            enqueue(kVideoBuffer_avail, frame);
         else
             break;
     }
 
-    while (frame && used.contains(frame))
+    while (frame && (FrameState(frame) & kVideoBuffer_used))
     {
         LOG(VB_PLAYBACK, LOG_NOTICE,
             QString("GetNextFreeFrame() served a busy frame %1. Dropping. %2")
                 .arg(DebugString(frame, true)).arg(GetStatus()));
-        frame = available.dequeue();
+        frame = dequeue(kVideoBuffer_avail);
     }
 
     if (frame)
@@ -275,6 +362,12 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(BufferType enqueue_to)
         if (frame)
             return frame;
 
+        if (tries == 1)
+        {
+            QMutexLocker locker(&global_lock);
+            framesStarved++;
+        }
+
         if (tries >= TRY_LOCK_SPINS)
         {
             LOG(VB_GENERAL, LOG_ERR,
@@ -305,12 +398,12 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(BufferType enqueue_to)
  */
 void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TimedLocker locker(this);
 
     vpos = vbufferMap[frame];
-    limbo.remove(frame);
-    decode.enqueue(frame);
-    used.enqueue(frame);
+    remove(kVideoBuffer_limbo, frame);
+    SetInUseByDecoder(frame, true);
+    enqueue(kVideoBuffer_used, frame);
 }
 
 /**
@@ -320,18 +413,26 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
  */
 void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
-    if (limbo.contains(frame))
-        limbo.remove(frame);
+    // The common case is the decoder letting go of a frame it has already
+    // released for display, which only needs the atomic reference dropped.
+    // Any finished frame is returned to available by DoneDisplayingFrame().
+    if ((FrameIndex(frame) >= 0) && InUseByDecoder(frame) &&
+        !(FrameState(frame) & kVideoBuffer_limbo))
+    {
+        SetInUseByDecoder(frame, false);
+        return;
+    }
+
+    TimedLocker locker(this);
+    remove(kVideoBuffer_limbo, frame);
 
     // if decoder didn't release frame and the buffer is getting released by
     // the decoder assume that the frame is lost and return to available
-    if (!decode.contains(frame))
+    if (!InUseByDecoder(frame))
         safeEnqueue(kVideoBuffer_avail, frame);
 
     // remove from decode queue since the decoder is finished
-    while (decode.contains(frame))
-        decode.remove(frame);
+    SetInUseByDecoder(frame, false);
 }
 
 /**
@@ -340,7 +441,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *frame)
  */
 void VideoBuffers::StartDisplayingFrame(void)
 {
-    QMutexLocker locker(&global_lock);
+    TimedLocker locker(this);
     rpos = vbufferMap[used.head()];
 }
 
@@ -350,10 +451,9 @@ void VideoBuffers::StartDisplayingFrame(void)
  */
 void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TimedLocker locker(this);
 
-    if(used.contains(frame))
-        remove(kVideoBuffer_used, frame);
+    remove(kVideoBuffer_used, frame);
 
     enqueue(kVideoBuffer_finished, frame);
 
@@ -362,7 +462,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
     frame_queue_t::iterator it = ula.begin();
     for (; it != ula.end(); ++it)
     {
-        if (!decode.contains(*it))
+        if (!InUseByDecoder(*it))
         {
             remove(kVideoBuffer_finished, *it);
             enqueue(kVideoBuffer_avail, *it);
@@ -377,7 +477,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
  */
 void VideoBuffers::DiscardFrame(VideoFrame *frame)
 {
-    QMutexLocker locker(&global_lock);
+    TimedLocker locker(this);
     safeEnqueue(kVideoBuffer_avail, frame);
 }
 
@@ -397,8 +497,6 @@ frame_queue_t *VideoBuffers::queue(BufferType type)
         q = &limbo;
     else if (type == kVideoBuffer_pause)
         q = &pause;
-    else if (type == kVideoBuffer_decode)
-        q = &decode;
     else if (type == kVideoBuffer_finished)
         q = &finished;
 
@@ -421,8 +519,6 @@ const frame_queue_t *VideoBuffers::queue(BufferType type) const
         q = &limbo;
     else if (type == kVideoBuffer_pause)
         q = &pause;
-    else if (type == kVideoBuffer_decode)
-        q = &decode;
     else if (type == kVideoBuffer_finished)
         q = &finished;
 
@@ -438,7 +534,11 @@ VideoFrame *VideoBuffers::dequeue(BufferType type)
     if (!q)
         return NULL;
 
-    return q->dequeue();
+    VideoFrame *frame = q->dequeue();
+    if (frame)
+        SetFrameState(frame, 0, type);
+
+    return frame;
 }
 
 VideoFrame *VideoBuffers::head(BufferType type)
@@ -476,13 +576,21 @@ void VideoBuffers::enqueue(BufferType type, VideoFrame *frame)
     if (!frame)
         return;
 
+    if (type == kVideoBuffer_decode)
+    {
+        SetInUseByDecoder(frame, true);
+        return;
+    }
+
     frame_queue_t *q = queue(type);
     if (!q)
         return;
 
     global_lock.lock();
-    q->remove(frame);
+    if (FrameState(frame) & type)
+        q->remove(frame);
     q->enqueue(frame);
+    SetFrameState(frame, type, 0);
     global_lock.unlock();
 
     return;
@@ -495,20 +603,25 @@ void VideoBuffers::remove(BufferType type, VideoFrame *frame)
 
     QMutexLocker locker(&global_lock);
 
-    if ((type & kVideoBuffer_avail) == kVideoBuffer_avail)
+    // Only search the queues the frame is actually in
+    uint present = FrameState(frame) & type;
+
+    if ((present & kVideoBuffer_avail) == kVideoBuffer_avail)
         available.remove(frame);
-    if ((type & kVideoBuffer_used) == kVideoBuffer_used)
+    if ((present & kVideoBuffer_used) == kVideoBuffer_used)
         used.remove(frame);
-    if ((type & kVideoBuffer_displayed) == kVideoBuffer_displayed)
+    if ((present & kVideoBuffer_displayed) == kVideoBuffer_displayed)
         displayed.remove(frame);
-    if ((type & kVideoBuffer_limbo) == kVideoBuffer_limbo)
+    if ((present & kVideoBuffer_limbo) == kVideoBuffer_limbo)
         limbo.remove(frame);
-    if ((type & kVideoBuffer_pause) == kVideoBuffer_pause)
+    if ((present & kVideoBuffer_pause) == kVideoBuffer_pause)
         pause.remove(frame);
     if ((type & kVideoBuffer_decode) == kVideoBuffer_decode)
-        decode.remove(frame);
-    if ((type & kVideoBuffer_finished) == kVideoBuffer_finished)
+        SetInUseByDecoder(frame, false);
+    if ((present & kVideoBuffer_finished) == kVideoBuffer_finished)
         finished.remove(frame);
+
+    SetFrameState(frame, 0, present);
 }
 
 void VideoBuffers::requeue(BufferType dst, BufferType src, int num)
@@ -561,6 +674,14 @@ frame_queue_t::iterator VideoBuffers::end(BufferType type)
 
 uint VideoBuffers::size(BufferType type) const
 {
+    if (type == kVideoBuffer_decode)
+    {
+        uint count = 0;
+        for (uint i = 0; i < decodeRefs.size(); i++)
+            count += ((int)decodeRefs[i] != 0) ? 1 : 0;
+        return count;
+    }
+
     QMutexLocker locker(&global_lock);
 
     const frame_queue_t *q = queue(type);
@@ -572,8 +693,14 @@ uint VideoBuffers::size(BufferType type) const
 
 bool VideoBuffers::contains(BufferType type, VideoFrame *frame) const
 {
+    if (type == kVideoBuffer_decode)
+        return InUseByDecoder(frame);
+
     QMutexLocker locker(&global_lock);
 
+    if (FrameIndex(frame) >= 0)
+        return FrameState(frame) & type;
+
     const frame_queue_t *q = queue(type);
     if (q)
         return q->contains(frame);
@@ -646,9 +773,9 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
     {
         for (uint i=0; i < Size(); i++)
         {
-            if (!available.contains(at(i)) &&
-                !pause.contains(at(i)) &&
-                !displayed.contains(at(i)))
+            if (!contains(kVideoBuffer_avail, at(i)) &&
+                !contains(kVideoBuffer_pause, at(i)) &&
+                !contains(kVideoBuffer_displayed, at(i)))
             {
                 LOG(VB_GENERAL, LOG_ERR,
                     QString("VideoBuffers::DiscardFrames(): ERROR, %1 (%2) not "
@@ -662,11 +789,13 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
 
     // Make sure frames used by decoder are last...
     // This is for libmpeg2 which still uses the frames after a reset.
-    for (it = decode.begin(); it != decode.end(); ++it)
-        remove(kVideoBuffer_all, *it);
-    for (it = decode.begin(); it != decode.end(); ++it)
-        available.enqueue(*it);
-    decode.clear();
+    for (uint i = 0; i < Size(); i++)
+    {
+        if (!InUseByDecoder(at(i)))
+            continue;
+        safeEnqueue(kVideoBuffer_avail, at(i));
+        SetInUseByDecoder(at(i), false);
+    }
 
     LOG(VB_PLAYBACK, LOG_INFO,
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
@@ -683,14 +812,14 @@ void VideoBuffers::ClearAfterSeek(void)
 
         while (used.count() > 1)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
+            VideoFrame *buffer = dequeue(kVideoBuffer_used);
+            enqueue(kVideoBuffer_avail, buffer);
         }
 
         if (used.count() > 0)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
+            VideoFrame *buffer = dequeue(kVideoBuffer_used);
+            enqueue(kVideoBuffer_avail, buffer);
             vpos = vbufferMap[buffer];
             rpos = vpos;
         }
@@ -769,6 +898,8 @@ uint VideoBuffers::AddBuffer(int width, int height, void* data,
 
     uint num = Size();
     buffers.resize(num + 1);
+    frameStates.push_back(QAtomicInt(0));
+    decodeRefs.push_back(QAtomicInt(0));
     memset(&buffers[num], 0, sizeof(VideoFrame));
     buffers[num].interlaced_frame = -1;
     buffers[num].top_field_first  = 1;
@@ -815,6 +946,12 @@ QString VideoBuffers::GetStatus(int n) const
         unsigned long long l = to_bitmap(limbo);
         unsigned long long p = to_bitmap(pause);
         unsigned long long f = to_bitmap(finished);
+        frame_queue_t decode;
+        for (uint i = 0; i < Size(); i++)
+        {
+            if (InUseByDecoder(at(i)))
+                decode.enqueue(const_cast<VideoFrame*>(at(i)));
+        }
         unsigned long long x = to_bitmap(decode);
         for (uint i=0; i<(uint)n; i++)
         {
@@ -850,6 +987,16 @@ QString VideoBuffers::GetStatus(int n) const
     return str;
 }
 
+/// \brief Returns frame pool lock contention and starvation counters.
+QString VideoBuffers::GetPoolStats(void) const
+{
+    QMutexLocker locker(&global_lock);
+    return QString("%1/%2 waits (%3 ms) %4 starved")
+        .arg(lockWaits).arg(lockAcquires)
+        .arg(lockWaitUsecs / 1000.0, 0, 'f', 1)
+        .arg(framesStarved);
+}
+
 void VideoBuffers::Clear(uint i)
 {
     clear(at(i));
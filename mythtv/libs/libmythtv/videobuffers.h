@@ -12,6 +12,7 @@ using namespace std;
 
 #include <QMutex>
 #include <QString>
+#include <QAtomicInt>
 #include <QWaitCondition>
 
 #include "mythdeque.h"
@@ -26,6 +27,7 @@ typedef map<const unsigned char*, void*>      buffer_map_t;
 typedef map<const VideoFrame*, uint>          vbuffer_map_t;
 typedef map<const VideoFrame*, QMutex*>       frame_lock_map_t;
 typedef vector<unsigned char*>                uchar_vector_t;
+typedef vector<QAtomicInt>                    atomic_vector_t;
 
 
 const QString& DebugString(const VideoFrame *frame, bool short_str=false);
@@ -129,12 +131,39 @@ class VideoBuffers
                    VideoFrameType fmt);
 
     QString GetStatus(int n=-1) const; // debugging method
+    QString GetPoolStats(void) const;  // debugging method
+
   private:
+    /// \brief QMutexLocker for global_lock that accounts contention.
+    class TimedLocker
+    {
+      public:
+        explicit TimedLocker(const VideoBuffers *vbuffers);
+        ~TimedLocker();
+      private:
+        const VideoBuffers *m_vbuffers;
+    };
+    friend class TimedLocker;
+
     frame_queue_t         *queue(BufferType type);
     const frame_queue_t   *queue(BufferType type) const;
     VideoFrame            *GetNextFreeFrameInternal(BufferType enqueue_to);
-
-    frame_queue_t          available, used, limbo, pause, displayed, decode, finished;
+    int                    FrameIndex(const VideoFrame *frame) const;
+    uint                   FrameState(const VideoFrame *frame) const;
+    void                   SetFrameState(const VideoFrame *frame,
+                                         uint set, uint clear);
+    bool                   InUseByDecoder(const VideoFrame *frame) const;
+    void                   SetInUseByDecoder(const VideoFrame *frame,
+                                             bool in_use);
+
+    frame_queue_t          available, used, limbo, pause, displayed, finished;
+    /// BufferType bits of the queues each frame is in, changed under
+    /// global_lock, but may be read without it.
+    atomic_vector_t        frameStates;
+    /// Frames released for display but still referenced by the decoder.
+    /// This is what the decode "queue" reports, it is updated without
+    /// the global_lock so decoder threads can drop frames cheaply.
+    atomic_vector_t        decodeRefs;
     vbuffer_map_t          vbufferMap; // videobuffers to buffer's index
     frame_vector_t         buffers;
     uchar_vector_t         allocated_arrays;  // for DeleteBuffers
@@ -150,6 +179,12 @@ class VideoBuffers
     uint                   vpos;
 
     mutable QMutex         global_lock;
+
+    // contention statistics, protected by global_lock
+    mutable uint64_t       lockWaitUsecs;
+    mutable uint           lockWaits;
+    mutable uint           lockAcquires;
+    uint                   framesStarved;
 };
 
 #endif // __VIDEOBUFFERS_H__
@@ -166,6 +166,11 @@ class VideoOutput
         { return vbuffers.ValidVideoFrames(); }
     /// \brief Returns number of frames available for decoding onto.
     int FreeVideoFrames(void) { return vbuffers.FreeVideoFrames(); }
+    /// \brief Returns frame pool lock contention and starvation counters.
+    QString GetFramePoolStats(void) const { return vbuffers.GetPoolStats(); }
+    /// \brief Returns the number of threads software filters may use.
+    int GetFilterThreads(void) const
+        { return db_vdisp_profile ? db_vdisp_profile->GetMaxCPUs() : 1; }
     /// \brief Returns true iff enough frames are available to decode onto.
     bool EnoughFreeFrames(void) { return vbuffers.EnoughFreeFrames(); }
     /// \brief Returns true iff there are plenty of decoded frames ready
@@ -1,6 +1,10 @@
 // Config header generated in base directory by configure
 #include "config.h"
 
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
 // QT headers
 #include <QCoreApplication>
 #include <QPainter>
@@ -11,16 +15,130 @@
 
 // Mythui headers
 #include "mythrender_opengl.h"
+#include "mythfontproperties.h"
 
 // Own header
 #include "mythpainter_ogl.h"
 
 using namespace std;
 
+/// Size of an atlas texture, when the hardware allows it
+#define ATLAS_SIZE       1024
+/// Largest image put in the atlas, wide enough for most lines of text
+#define ATLAS_MAX_WIDTH  512
+#define ATLAS_MAX_HEIGHT 128
+/// Transparent border around each image, so filtering doesn't bleed
+#define ATLAS_BORDER     1
+#define MAX_ATLAS_PAGES  4
+
+/** \fn MythGLAtlasPage::Allocate(const QSize&, QPoint&)
+ *  \brief Finds room for an image of size, in the space of a released
+ *         image, on the current shelf or on a new one below it.
+ */
+bool MythGLAtlasPage::Allocate(const QSize &size, QPoint &pos)
+{
+    int width  = size.width();
+    int height = size.height();
+
+    // Reuse the narrowest released space the image fits in
+    int best = -1;
+    for (int i = 0; i < m_free.size(); i++)
+    {
+        if (width <= m_free[i].width() && height <= m_free[i].height() &&
+            (best < 0 || m_free[i].width() < m_free[best].width()))
+        {
+            best = i;
+        }
+    }
+
+    if (best >= 0)
+    {
+        QRect space = m_free.takeAt(best);
+        if (space.width() > width)
+        {
+            m_free.push_back(QRect(space.left() + width, space.top(),
+                                   space.width() - width, space.height()));
+        }
+        pos = space.topLeft();
+        m_images++;
+        return true;
+    }
+
+    if (m_shelfX + width > m_size.width() || height > m_shelfHeight)
+    {
+        // An image lower than the shelf may still fit on it
+        if (m_shelfX + width > m_size.width() ||
+            (m_shelfX && height > m_shelfHeight))
+        {
+            m_shelves[m_shelfTop] = m_shelfHeight;
+            m_shelfTop   += m_shelfHeight;
+            m_shelfX      = 0;
+            m_shelfHeight = 0;
+        }
+        if (m_shelfTop + height > m_size.height())
+            return false;
+        m_shelfHeight = max(m_shelfHeight, height);
+    }
+
+    pos = QPoint(m_shelfX, m_shelfTop);
+    m_shelfX += width;
+    m_images++;
+    return true;
+}
+
+/** \fn MythGLAtlasPage::Release(const QRect&)
+ *  \brief Frees the space of the image at rect, so images that change
+ *         all the time don't fill the page while others stay on it.
+ */
+void MythGLAtlasPage::Release(const QRect &rect)
+{
+    if (--m_images <= 0)
+    {
+        m_images      = 0;
+        m_shelfTop    = 0;
+        m_shelfHeight = 0;
+        m_shelfX      = 0;
+        m_shelves.clear();
+        m_free.clear();
+        return;
+    }
+
+    // The space is as high as its shelf, a full one can't grow anymore
+    QRect space(rect.left(), rect.top(), rect.width(),
+                m_shelves.value(rect.top(), m_shelfHeight));
+
+    // Join the released space on either side of it
+    for (int i = m_free.size() - 1; i >= 0; i--)
+    {
+        const QRect &other = m_free[i];
+        if (other.top() != space.top() || other.height() != space.height())
+            continue;
+
+        if (other.left() + other.width() == space.left() ||
+            space.left() + space.width() == other.left())
+        {
+            space = space.united(other);
+            m_free.removeAt(i);
+        }
+    }
+
+    // Space at the end of the current shelf goes back to the shelf
+    if (space.top() == m_shelfTop && !m_shelves.contains(m_shelfTop) &&
+        space.left() + space.width() == m_shelfX)
+    {
+        m_shelfX = space.left();
+        return;
+    }
+
+    m_free.push_back(space);
+}
+
 MythOpenGLPainter::MythOpenGLPainter(MythRenderOpenGL *render,
                                      QGLWidget *parent) :
     MythPainter(), realParent(parent), realRender(render),
-    target(0), swapControl(true)
+    target(0), swapControl(true),
+    m_frameDrawCalls(0), m_frameUploads(0),
+    m_statsDrawCalls(0), m_statsUploads(0), m_statsFrames(0)
 {
     if (realRender)
         LOG(VB_GENERAL, LOG_INFO,
@@ -70,6 +188,19 @@ void MythOpenGLPainter::ClearCache(void)
         m_ImageExpireList.remove(it.key());
     }
     m_ImageIntMap.clear();
+
+    QMap<MythImage *, QPair<int, QRect> >::iterator ait =
+        m_ImageAtlasMap.begin();
+    for (; ait != m_ImageAtlasMap.end(); ++ait)
+        m_ImageExpireList.remove(ait.key());
+    m_ImageAtlasMap.clear();
+
+    while (!m_atlasPages.isEmpty())
+    {
+        MythGLAtlasPage *page = m_atlasPages.takeFirst();
+        m_textureDeleteList.push_back(page->m_texture);
+        delete page;
+    }
 }
 
 void MythOpenGLPainter::Begin(QPaintDevice *parent)
@@ -100,6 +231,9 @@ void MythOpenGLPainter::Begin(QPaintDevice *parent)
     DeleteTextures();
     realRender->makeCurrent();
 
+    m_frameDrawCalls = realRender->GetDrawCallCount();
+    m_frameUploads   = realRender->GetTextureUploadCount();
+
     if (target || swapControl)
     {
         realRender->BindFramebuffer(target);
@@ -119,6 +253,7 @@ void MythOpenGLPainter::End(void)
     }
     else
     {
+        DrawStats();
         realRender->Flush(false);
         if (target == 0 && swapControl)
             realRender->swapBuffers();
@@ -128,18 +263,29 @@ void MythOpenGLPainter::End(void)
     MythPainter::End();
 }
 
-int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
+/** \fn MythOpenGLPainter::GetTextureFromCache(MythImage*, QPoint&)
+ *  \brief Returns the texture holding im, uploading it if needed.
+ *  \param offset set to the position of im in the texture, for images
+ *                in the atlas.
+ */
+int MythOpenGLPainter::GetTextureFromCache(MythImage *im, QPoint &offset)
 {
+    offset = QPoint(0, 0);
+
     if (!realRender)
         return 0;
 
-    if (m_ImageIntMap.contains(im))
+    if (m_ImageIntMap.contains(im) || m_ImageAtlasMap.contains(im))
     {
         if (!im->IsChanged())
         {
             m_ImageExpireList.remove(im);
             m_ImageExpireList.push_back(im);
-            return m_ImageIntMap[im];
+            if (m_ImageIntMap.contains(im))
+                return m_ImageIntMap[im];
+            const QPair<int, QRect> &entry = m_ImageAtlasMap[im];
+            offset = entry.second.topLeft();
+            return m_atlasPages[entry.first]->m_texture;
         }
         else
         {
@@ -150,6 +296,14 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     im->SetChanged(false);
 
     QImage tx = QGLWidget::convertToGLFormat(*im);
+
+    if (AddToAtlas(im, tx))
+    {
+        const QPair<int, QRect> &entry = m_ImageAtlasMap[im];
+        offset = entry.second.topLeft();
+        return m_atlasPages[entry.first]->m_texture;
+    }
+
     GLuint tx_id =
         realRender->CreateTexture(tx.size(),false, 0,
                                   GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8,
@@ -169,7 +323,13 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     m_ImageIntMap[im] = tx_id;
     m_ImageExpireList.push_back(im);
 
-    while (m_HardwareCacheSize > m_MaxHardwareCacheSize)
+    // Expiring images doesn't free atlas textures, they don't count
+    int atlasSize = 0;
+    for (int i = 0; i < m_atlasPages.size(); i++)
+        atlasSize += realRender->GetTextureDataSize(m_atlasPages[i]->m_texture);
+
+    while (m_HardwareCacheSize - atlasSize > m_MaxHardwareCacheSize &&
+           !m_ImageExpireList.empty())
     {
         MythImage *expiredIm = m_ImageExpireList.front();
         m_ImageExpireList.pop_front();
@@ -180,12 +340,127 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     return tx_id;
 }
 
+/** \fn MythOpenGLPainter::AddToAtlas(MythImage*, const QImage&)
+ *  \brief Uploads a small image into an atlas texture, so images drawn
+ *         one after another share a texture and can be drawn together.
+ *  \return false if the image is too large or the atlas is full.
+ */
+bool MythOpenGLPainter::AddToAtlas(MythImage *im, const QImage &tx)
+{
+    if (tx.width() > ATLAS_MAX_WIDTH || tx.height() > ATLAS_MAX_HEIGHT)
+        return false;
+
+    QMutexLocker locker(&m_textureDeleteLock);
+
+    // The border is uploaded with the image, it clears whatever a
+    // released image left next to it
+    QImage padded(tx.width()  + ATLAS_BORDER * 2,
+                  tx.height() + ATLAS_BORDER * 2, tx.format());
+    padded.fill(0);
+    for (int y = 0; y < tx.height(); y++)
+    {
+        memcpy(padded.scanLine(y + ATLAS_BORDER) + ATLAS_BORDER * 4,
+               tx.scanLine(y), tx.width() * 4);
+    }
+
+    QPoint pos;
+    int idx = 0;
+    for (; idx < m_atlasPages.size(); idx++)
+    {
+        if (m_atlasPages[idx]->Allocate(padded.size(), pos))
+            break;
+    }
+
+    if (idx == m_atlasPages.size())
+    {
+        if (m_atlasPages.size() >= MAX_ATLAS_PAGES)
+            return false;
+
+        int size = min(ATLAS_SIZE, realRender->GetMaxTextureSize());
+        if (size < ATLAS_MAX_WIDTH)
+            return false;
+
+        GLuint tex = realRender->CreateTexture(QSize(size, size), false, 0,
+                                               GL_UNSIGNED_BYTE, GL_RGBA,
+                                               GL_RGBA8, GL_LINEAR);
+        if (!tex)
+            return false;
+
+        m_HardwareCacheSize += realRender->GetTextureDataSize(tex);
+        m_atlasPages.push_back(new MythGLAtlasPage(tex, QSize(size, size)));
+        if (!m_atlasPages.back()->Allocate(padded.size(), pos))
+            return false;
+    }
+
+    CheckFormatImage(im);
+    realRender->UpdateTextureRegion(m_atlasPages[idx]->m_texture,
+                                    QRect(pos, padded.size()),
+                                    padded.bits());
+
+    m_ImageAtlasMap[im] = qMakePair(idx, QRect(pos, padded.size()).adjusted(
+        ATLAS_BORDER, ATLAS_BORDER, -ATLAS_BORDER, -ATLAS_BORDER));
+    m_ImageExpireList.push_back(im);
+    return true;
+}
+
 void MythOpenGLPainter::DrawImage(const QRect &r, MythImage *im,
                                   const QRect &src, int alpha)
 {
-    if (realRender)
-        realRender->DrawBitmap(GetTextureFromCache(im), target,
-                               &src, &r, 0, alpha);
+    if (!realRender)
+        return;
+
+    QPoint offset;
+    int tex = GetTextureFromCache(im, offset);
+    if (!m_ImageAtlasMap.contains(im))
+    {
+        realRender->DrawBitmap(tex, target, &src, &r, 0, alpha);
+        return;
+    }
+
+    // Never sample the neighbours of an image in the atlas
+    QRect source = src & im->rect();
+    QRect dest   = r.adjusted(source.left() - src.left(),
+                              source.top() - src.top(),
+                              source.right() - src.right(),
+                              source.bottom() - src.bottom());
+    if (source.isEmpty() || dest.isEmpty())
+        return;
+
+    source.translate(offset);
+    realRender->DrawBitmap(tex, target, &source, &dest, 0, alpha);
+}
+
+/** \fn MythOpenGLPainter::DrawStats(void)
+ *  \brief Shows the draw calls and texture uploads per frame with the
+ *         debug borders, to see how well the atlas and batching work.
+ */
+void MythOpenGLPainter::DrawStats(void)
+{
+    m_statsDrawCalls += realRender->GetDrawCallCount() - m_frameDrawCalls;
+    m_statsUploads   += realRender->GetTextureUploadCount() - m_frameUploads;
+    m_statsFrames++;
+
+    if (!m_statsTime.isValid() || m_statsTime.elapsed() >= 1000)
+    {
+        m_stats = QString("OpenGL: %1 draw calls, %2 texture uploads per "
+                          "frame, %3 images in %4 atlas textures")
+            .arg((double) m_statsDrawCalls / m_statsFrames, 0, 'f', 1)
+            .arg((double) m_statsUploads / m_statsFrames, 0, 'f', 1)
+            .arg(m_ImageAtlasMap.size()).arg(m_atlasPages.size());
+        m_statsDrawCalls = m_statsUploads = 0;
+        m_statsFrames = 0;
+        m_statsTime.start();
+    }
+
+    if (!ShowBorders() || !realParent)
+        return;
+
+    MythFontProperties font;
+    font.SetFace(QFont("Droid Sans"));
+    font.SetColor(Qt::yellow);
+    font.SetPointSize(10);
+    QRect area(10, 10, realParent->width() - 20, 30);
+    DrawText(area, m_stats, Qt::AlignLeft | Qt::AlignTop, font, 255, area);
 }
 
 void MythOpenGLPainter::DrawRect(const QRect &area, const QBrush &fillBrush,
@@ -226,4 +501,16 @@ void MythOpenGLPainter::DeleteFormatImagePriv(MythImage *im)
         m_ImageIntMap.remove(im);
         m_ImageExpireList.remove(im);
     }
+    else if (m_ImageAtlasMap.contains(im))
+    {
+        QMutexLocker locker(&m_textureDeleteLock);
+        const QPair<int, QRect> &entry = m_ImageAtlasMap[im];
+        if (entry.first < m_atlasPages.size())
+        {
+            m_atlasPages[entry.first]->Release(entry.second.adjusted(
+                -ATLAS_BORDER, -ATLAS_BORDER, ATLAS_BORDER, ATLAS_BORDER));
+        }
+        m_ImageAtlasMap.remove(im);
+        m_ImageExpireList.remove(im);
+    }
 }
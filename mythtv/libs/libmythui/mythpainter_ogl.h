@@ -2,6 +2,8 @@
 #define MYTHPAINTER_OPENGL_H_
 
 #include <QMutex>
+#include <QTime>
+#include <QPair>
 #include <QGLWidget>
 
 #include <list>
@@ -10,6 +12,29 @@
 #include "mythimage.h"
 #include "mythrender_opengl.h"
 
+/// A texture shared by many small images, filled shelf by shelf
+class MythGLAtlasPage
+{
+  public:
+    MythGLAtlasPage(uint tex, const QSize &size) :
+        m_texture(tex), m_size(size), m_images(0),
+        m_shelfTop(0), m_shelfHeight(0), m_shelfX(0) {}
+
+    bool Allocate(const QSize &size, QPoint &pos);
+    void Release(const QRect &rect);
+
+    uint  m_texture;
+    QSize m_size;
+    int   m_images;       ///< images using the page
+
+  private:
+    int   m_shelfTop;
+    int   m_shelfHeight;
+    int   m_shelfX;
+    QMap<int, int> m_shelves;   ///< height of the full shelves, by top
+    QList<QRect>   m_free;      ///< released space on the shelves
+};
+
 class MUI_PUBLIC MythOpenGLPainter : public MythPainter
 {
   public:
@@ -40,7 +65,9 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
 
     void       ClearCache(void);
     void       DeleteTextures(void);
-    int        GetTextureFromCache(MythImage *im);
+    int        GetTextureFromCache(MythImage *im, QPoint &offset);
+    bool       AddToAtlas(MythImage *im, const QImage &tx);
+    void       DrawStats(void);
 
     QGLWidget        *realParent;
     MythRenderOpenGL *realRender;
@@ -51,6 +78,19 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     std::list<MythImage *>     m_ImageExpireList;
     std::list<uint>            m_textureDeleteList;
     QMutex                     m_textureDeleteLock;
+
+    // Small images and text share the textures of an atlas
+    QList<MythGLAtlasPage*>                   m_atlasPages;
+    QMap<MythImage *, QPair<int, QRect> >     m_ImageAtlasMap;
+
+    // Debug overlay
+    uint64_t                   m_frameDrawCalls;
+    uint64_t                   m_frameUploads;
+    uint64_t                   m_statsDrawCalls;
+    uint64_t                   m_statsUploads;
+    uint                       m_statsFrames;
+    QTime                      m_statsTime;
+    QString                    m_stats;
 };
 
 #endif
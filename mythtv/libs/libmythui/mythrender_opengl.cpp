@@ -111,6 +111,10 @@ void MythRenderOpenGL::makeCurrent()
 
 void MythRenderOpenGL::doneCurrent()
 {
+    // Queued draws must not outlive our hold on the context
+    if (m_lock_level == 1)
+        FlushBatch();
+
     m_lock_level--;
     if (m_lock_level == 0)
         QGLContext::doneCurrent();
@@ -140,6 +144,7 @@ void MythRenderOpenGL::SetViewPort(const QRect &rect)
         return;
 
     makeCurrent();
+    FlushBatch();
     m_viewport = rect;
     glViewport(m_viewport.left(), m_viewport.top(),
                m_viewport.width(), m_viewport.height());
@@ -150,6 +155,7 @@ void MythRenderOpenGL::SetViewPort(const QRect &rect)
 void MythRenderOpenGL::Flush(bool use_fence)
 {
     makeCurrent();
+    FlushBatch();
 
     if ((m_exts_used & kGLAppleFence) &&
         (m_fence && use_fence))
@@ -173,7 +179,11 @@ void MythRenderOpenGL::Flush(bool use_fence)
 
 void MythRenderOpenGL::SetBlend(bool enable)
 {
+    if (enable == m_blend)
+        return;
+
     makeCurrent();
+    FlushBatch();
     if (enable && !m_blend)
         glEnable(GL_BLEND);
     else if (!enable && m_blend)
@@ -218,6 +228,7 @@ void* MythRenderOpenGL::GetTextureBuffer(uint tex, bool create_buffer)
         return NULL;
 
     makeCurrent(); // associated doneCurrent() in UpdateTexture
+    FlushBatch();
 
     EnableTextures(tex);
     glBindTexture(m_textures[tex].m_type, tex);
@@ -268,6 +279,29 @@ void MythRenderOpenGL::UpdateTexture(uint tex, void *buf)
                         m_textures[tex].m_data_type, buf);
     }
 
+    m_texture_uploads++;
+    doneCurrent();
+}
+
+/** \fn MythRenderOpenGL::UpdateTextureRegion(uint, const QRect&, void*)
+ *  \brief Uploads buf to the area of texture tex, without a PBO.
+ */
+void MythRenderOpenGL::UpdateTextureRegion(uint tex, const QRect &area,
+                                           void *buf)
+{
+    if (!m_textures.contains(tex))
+        return;
+
+    makeCurrent();
+    FlushBatch();
+
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+    glTexSubImage2D(m_textures[tex].m_type, 0, area.left(), area.top(),
+                    area.width(), area.height(), m_textures[tex].m_data_fmt,
+                    m_textures[tex].m_data_type, buf);
+
+    m_texture_uploads++;
     doneCurrent();
 }
 
@@ -480,6 +514,7 @@ void MythRenderOpenGL::DeleteTexture(uint tex)
         return;
 
     makeCurrent();
+    FlushBatch();
 
     GLuint gltex = tex;
     glDeleteTextures(1, &gltex);
@@ -613,6 +648,7 @@ void MythRenderOpenGL::BindFramebuffer(uint fb)
         return;
 
     makeCurrent();
+    FlushBatch();
     m_glBindFramebuffer(GL_FRAMEBUFFER, fb);
     doneCurrent();
     m_active_fb = fb;
@@ -621,6 +657,7 @@ void MythRenderOpenGL::BindFramebuffer(uint fb)
 void MythRenderOpenGL::ClearFramebuffer(void)
 {
     makeCurrent();
+    FlushBatch();
     glClear(GL_COLOR_BUFFER_BIT);
     doneCurrent();
 }
@@ -653,6 +690,7 @@ void MythRenderOpenGL::DrawBitmap(uint *textures, uint texture_count,
 
     makeCurrent();
     BindFramebuffer(target);
+    FlushBatch();
     DrawBitmapPriv(textures, texture_count, src, dst, prog);
     doneCurrent();
 }
@@ -662,6 +700,7 @@ void MythRenderOpenGL::DrawRect(const QRect &area, const QBrush &fillBrush,
 {
     makeCurrent();
     BindFramebuffer(0);
+    FlushBatch();
     DrawRectPriv(area, fillBrush, linePen, alpha);
     doneCurrent();
 }
@@ -672,10 +711,18 @@ void MythRenderOpenGL::DrawRoundRect(const QRect &area, int cornerRadius,
 {
     makeCurrent();
     BindFramebuffer(0);
+    FlushBatch();
     DrawRoundRectPriv(area, cornerRadius, fillBrush, linePen, alpha);
     doneCurrent();
 }
 
+/// \brief glDrawArrays(), counted for the painter statistics.
+void MythRenderOpenGL::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawArrays(mode, first, count);
+    m_draw_calls++;
+}
+
 void MythRenderOpenGL::Init2DState(void)
 {
     SetBlend(false);
@@ -920,6 +967,9 @@ void MythRenderOpenGL::ResetVars(void)
     m_active_fb       = 0;
     m_blend           = false;
     m_background      = 0x00000000;
+
+    m_draw_calls      = 0;
+    m_texture_uploads = 0;
 }
 
 void MythRenderOpenGL::ResetProcs(void)
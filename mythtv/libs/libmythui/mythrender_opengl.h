@@ -126,6 +126,7 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
 
     void* GetTextureBuffer(uint tex, bool create_buffer = true);
     void  UpdateTexture(uint tex, void *buf);
+    void  UpdateTextureRegion(uint tex, const QRect &area, void *buf);
     int   GetTextureType(bool &rect);
     bool  IsRectTexture(uint type);
     uint  CreateTexture(QSize act_size, bool use_pbo, uint type,
@@ -164,6 +165,9 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
                        int alpha);
     virtual bool RectanglesAreAccelerated(void) { return false; }
 
+    uint64_t GetDrawCallCount(void) const      { return m_draw_calls;      }
+    uint64_t GetTextureUploadCount(void) const { return m_texture_uploads; }
+
   protected:
     virtual ~MythRenderOpenGL();
     virtual void DrawBitmapPriv(uint tex, const QRect *src, const QRect *dst,
@@ -177,6 +181,8 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     virtual void DrawRoundRectPriv(const QRect &area, int cornerRadius,
                                    const QBrush &fillBrush, const QPen &linePen,
                                    int alpha) = 0;
+    virtual void FlushBatch(void) { }
+    void DrawArrays(GLenum mode, GLint first, GLsizei count);
 
     virtual void Init2DState(void);
     virtual void InitProcs(void);
@@ -230,6 +236,10 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     bool     m_blend;
     uint32_t m_background;
 
+    // Statistics
+    uint64_t m_draw_calls;
+    uint64_t m_texture_uploads;
+
     // vertex cache
     QMap<uint64_t,GLfloat*> m_cachedVertices;
     QList<uint64_t>         m_vertexExpiry;
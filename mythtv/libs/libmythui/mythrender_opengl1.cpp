@@ -313,7 +313,7 @@ void MythRenderOpenGL1::DrawBitmapPriv(uint tex, const QRect *src,
     UpdateTextureVertices(tex, src, dst);
     glVertexPointer(2, GL_FLOAT, 0, m_textures[tex].m_vertex_data);
     glTexCoordPointer(2, GL_FLOAT, 0, m_textures[tex].m_vertex_data + TEX_OFFSET);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -347,7 +347,7 @@ void MythRenderOpenGL1::DrawBitmapPriv(uint *textures, uint texture_count,
     UpdateTextureVertices(first, src, dst);
     glVertexPointer(2, GL_FLOAT, 0, m_textures[first].m_vertex_data);
     glTexCoordPointer(2, GL_FLOAT, 0, m_textures[first].m_vertex_data + TEX_OFFSET);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
     ActiveTexture(GL_TEXTURE0);
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -367,7 +367,7 @@ void MythRenderOpenGL1::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                  fillBrush.color().blue(), fillBrush.color().alpha());
         GLfloat *vertices = GetCachedVertices(GL_TRIANGLE_STRIP, area);
         glVertexPointer(2, GL_FLOAT, 0, vertices);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     }
 
     if (linePen.style() != Qt::NoPen)
@@ -377,7 +377,7 @@ void MythRenderOpenGL1::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
         glLineWidth(linePen.width());
         GLfloat *vertices = GetCachedVertices(GL_LINE_LOOP, area);
         glVertexPointer(2, GL_FLOAT, 0, vertices);
-        glDrawArrays(GL_LINE_LOOP, 0, 4);
+        DrawArrays(GL_LINE_LOOP, 0, 4);
     }
 
     glDisableClientState(GL_VERTEX_ARRAY);
@@ -13,6 +13,11 @@ static const GLuint kVertexOffset  = 0;
 static const GLuint kTextureOffset = 8 * sizeof(GLfloat);
 static const GLuint kVertexSize    = 16 * sizeof(GLfloat);
 
+// Batched bitmaps are drawn as triangles with a color per vertex
+#define BATCH_STRIDE  8
+#define BATCH_QUAD    (6 * BATCH_STRIDE)
+#define MAX_BATCH     256
+
 static const QString kDefaultVertexShader =
 "GLSL_DEFINES"
 "attribute vec2 a_position;\n"
@@ -172,6 +177,10 @@ void MythRenderOpenGL2::ResetVars(void)
     memset(m_parameters, 0, sizeof(m_parameters));
     memset(m_shaders, 0, sizeof(m_shaders));
     m_active_obj = 0;
+    m_batch.clear();
+    m_batch_tex  = 0;
+    m_batch_prog = 0;
+    m_batch_vbo  = 0;
 }
 
 void MythRenderOpenGL2::ResetProcs(void)
@@ -359,6 +368,8 @@ void MythRenderOpenGL2::EnableShaderObject(uint obj)
     if (obj == m_active_obj)
         return;
 
+    FlushBatch();
+
     if (!obj && m_active_obj)
     {
         makeCurrent();
@@ -381,6 +392,7 @@ void MythRenderOpenGL2::SetShaderParams(uint obj, void* vals,
                                         const char* uniform)
 {
     makeCurrent();
+    FlushBatch();
     const float *v = (float*)vals;
 
     EnableShaderObject(obj);
@@ -398,6 +410,52 @@ void MythRenderOpenGL2::DrawBitmapPriv(uint tex, const QRect *src,
     if (prog == 0)
         prog = m_shaders[kShaderDefault];
 
+    if (tex != m_batch_tex || prog != m_batch_prog ||
+        m_batch.size() >= MAX_BATCH * BATCH_QUAD)
+    {
+        FlushBatch();
+    }
+
+    m_batch_tex  = tex;
+    m_batch_prog = prog;
+
+    UpdateTextureVertices(tex, src, dst);
+    const GLfloat *data = m_textures[tex].m_vertex_data;
+    GLfloat color[4] = { red / 255.0f, green / 255.0f,
+                         blue / 255.0f, alpha / 255.0f };
+
+    // The strip 0 1 2 3 as the triangles 0 1 2 and 2 1 3
+    static const int order[6] = { 0, 1, 2, 2, 1, 3 };
+    for (int i = 0; i < 6; i++)
+    {
+        int v = order[i];
+        m_batch << data[v * 2] << data[v * 2 + 1]
+                << data[TEX_OFFSET + v * 2] << data[TEX_OFFSET + v * 2 + 1]
+                << color[0] << color[1] << color[2] << color[3];
+    }
+}
+
+/** \fn MythRenderOpenGL2::FlushBatch(void)
+ *  \brief Draws the queued bitmaps with a single vertex buffer upload and
+ *         draw call.
+ */
+void MythRenderOpenGL2::FlushBatch(void)
+{
+    if (m_batch.isEmpty())
+        return;
+
+    // Anything called from here must see an empty batch
+    QVector<GLfloat> batch;
+    batch.swap(m_batch);
+    uint tex  = m_batch_tex;
+    uint prog = m_batch_prog;
+    m_batch_tex = m_batch_prog = 0;
+
+    if (!m_textures.contains(tex))
+        return;
+
+    makeCurrent();
+
     EnableShaderObject(prog);
     SetShaderParams(prog, &m_projection[0][0], "u_projection");
     SetBlend(true);
@@ -405,33 +463,43 @@ void MythRenderOpenGL2::DrawBitmapPriv(uint tex, const QRect *src,
     EnableTextures(tex);
     glBindTexture(m_textures[tex].m_type, tex);
 
-    m_glBindBuffer(GL_ARRAY_BUFFER, m_textures[tex].m_vbo);
-    UpdateTextureVertices(tex, src, dst);
-    m_glBufferData(GL_ARRAY_BUFFER, kVertexSize, NULL, GL_STREAM_DRAW);
-    void* target = m_glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-    if (target)
-        memcpy(target, m_textures[tex].m_vertex_data, kVertexSize);
-    m_glUnmapBuffer(GL_ARRAY_BUFFER);
+    if (!m_batch_vbo)
+        m_batch_vbo = CreateVBO();
+
+    // Without VBOs the vertices are read from client memory
+    const char *base = NULL;
+    if (m_batch_vbo)
+    {
+        m_glBindBuffer(GL_ARRAY_BUFFER, m_batch_vbo);
+        m_glBufferData(GL_ARRAY_BUFFER, batch.size() * sizeof(GLfloat),
+                       batch.constData(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        base = (const char *) batch.constData();
+    }
 
     m_glEnableVertexAttribArray(VERTEX_INDEX);
     m_glEnableVertexAttribArray(TEXTURE_INDEX);
+    m_glEnableVertexAttribArray(COLOR_INDEX);
 
+    GLsizei stride = BATCH_STRIDE * sizeof(GLfloat);
     m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
-                            VERTEX_SIZE * sizeof(GLfloat),
-                            (const void *) kVertexOffset);
-    m_glVertexAttrib4f(COLOR_INDEX, red / 255.0, green / 255.0, blue / 255.0, alpha / 255.0);
+                            stride, base);
     m_glVertexAttribPointer(TEXTURE_INDEX, TEXTURE_SIZE, GL_FLOAT, GL_FALSE,
-                            TEXTURE_SIZE * sizeof(GLfloat),
-                            (const void *) kTextureOffset);
+                            stride, base + 2 * sizeof(GLfloat));
+    m_glVertexAttribPointer(COLOR_INDEX, 4, GL_FLOAT, GL_FALSE,
+                            stride, base + 4 * sizeof(GLfloat));
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    DrawArrays(GL_TRIANGLES, 0, batch.size() / BATCH_STRIDE);
 
+    m_glDisableVertexAttribArray(COLOR_INDEX);
     m_glDisableVertexAttribArray(TEXTURE_INDEX);
     m_glDisableVertexAttribArray(VERTEX_INDEX);
     m_glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
 
+    doneCurrent();
+}
 
 void MythRenderOpenGL2::DrawBitmapPriv(uint *textures, uint texture_count,
                                        const QRectF *src, const QRectF *dst,
@@ -478,7 +546,7 @@ void MythRenderOpenGL2::DrawBitmapPriv(uint *textures, uint texture_count,
                             TEXTURE_SIZE * sizeof(GLfloat),
                             (const void *) kTextureOffset);
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
     m_glDisableVertexAttribArray(TEXTURE_INDEX);
     m_glDisableVertexAttribArray(VERTEX_INDEX);
@@ -536,7 +604,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the top right segment
         m_parameters[0][0] = tr.left();
@@ -546,7 +614,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the bottom left segment
         m_parameters[0][0] = bl.left() + rad;
@@ -556,7 +624,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the bottom right segment
         m_parameters[0][0] = br.left();
@@ -566,7 +634,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Fill the remaining areas
         QRect main(area.left() + rad, area.top(), area.width() - dia, area.height());
@@ -580,17 +648,17 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         GetCachedVBO(GL_TRIANGLE_STRIP, left);
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         GetCachedVBO(GL_TRIANGLE_STRIP, right);
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         m_glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
@@ -623,7 +691,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the top right edge segment
         m_parameters[0][0] = tr.left();
@@ -633,7 +701,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the bottom left edge segment
         m_parameters[0][0] = bl.left() + rad;
@@ -643,7 +711,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the bottom right edge segment
         m_parameters[0][0] = br.left();
@@ -653,7 +721,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Vertical lines
         SetShaderParams(vline, &m_projection[0][0], "u_projection");
@@ -668,7 +736,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the right line segment
         vl.translate(area.width() - linePen.width(), 0);
@@ -678,7 +746,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Horizontal lines
         SetShaderParams(hline, &m_projection[0][0], "u_projection");
@@ -692,7 +760,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         // Draw the bottom line segment
         hl.translate(0, area.height() - linePen.width());
@@ -702,7 +770,7 @@ void MythRenderOpenGL2::DrawRoundRectPriv(const QRect &area, int cornerRadius,
         m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
                                 VERTEX_SIZE * sizeof(GLfloat),
                                (const void *) kVertexOffset);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         m_glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
@@ -826,6 +894,12 @@ void MythRenderOpenGL2::OptimiseShaderSource(QString &source)
 void MythRenderOpenGL2::DeleteOpenGLResources(void)
 {
     LOG(VB_GENERAL, LOG_INFO, LOC + "Deleting OpenGL Resources");
+    m_batch.clear();
+    if (m_batch_vbo)
+    {
+        m_glDeleteBuffers(1, &m_batch_vbo);
+        m_batch_vbo = 0;
+    }
     DeleteDefaultShaders();
     DeleteShaders();
     MythRenderOpenGL::DeleteOpenGLResources();
@@ -1,6 +1,8 @@
 #ifndef MYTHRENDEROPENGL2_H
 #define MYTHRENDEROPENGL2_H
 
+#include <QVector>
+
 #include "mythrender_opengl.h"
 #include "mythrender_opengl_defs2.h"
 
@@ -44,6 +46,7 @@ class MUI_PUBLIC MythRenderOpenGL2 : public MythRenderOpenGL
     virtual void DrawRoundRectPriv(const QRect &area, int cornerRadius,
                                    const QBrush &fillBrush, const QPen &linePen,
                                    int alpha);
+    virtual void FlushBatch(void);
 
     virtual void Init2DState(void);
     virtual void InitProcs(void);
@@ -75,6 +78,12 @@ class MUI_PUBLIC MythRenderOpenGL2 : public MythRenderOpenGL
     float m_parameters[4][4];
     QString m_qualifiers;
 
+    // Bitmaps sharing a texture and shader, drawn with one call
+    QVector<GLfloat> m_batch;
+    uint     m_batch_tex;
+    uint     m_batch_prog;
+    GLuint   m_batch_vbo;
+
     // Procs
     MYTH_GLGETSHADERIVPROC               m_glGetShaderiv;
     MYTH_GLCREATESHADERPROC              m_glCreateShader;
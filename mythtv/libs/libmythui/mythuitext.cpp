@@ -6,7 +6,9 @@
 #include <QDomDocument>
 #include <QFontMetrics>
 #include <QString>
+#include <QMutex>
 #include <QHash>
+#include <QMap>
 
 #include "mythlogging.h"
 
@@ -18,6 +20,129 @@
 
 #include "compat.h"
 
+/// Layouts kept before the least recently used ones are dropped
+#define MAX_LAYOUTS 2000
+
+/** \class TextLayoutCache
+ *  \brief Cut down messages and minimum areas of MythUIText, shared by
+ *         every text widget.
+ *
+ *  Button lists set the same few texts on the same few widgets over and
+ *  over while scrolling, measuring them with QFontMetrics each time is
+ *  what makes that slow. The key holds everything the result depends on.
+ */
+class TextLayoutCache
+{
+  public:
+    TextLayoutCache() :
+        m_enabled(true), m_useCount(0), m_hits(0), m_misses(0) {}
+
+    bool Find(const QString &key, QString &cut, QRect &rect)
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_enabled)
+            return false;
+
+        QHash<QString,Layout>::iterator it = m_layouts.find(key);
+        if (it == m_layouts.end())
+        {
+            m_misses++;
+            return false;
+        }
+
+        m_hits++;
+        (*it).lastUsed = ++m_useCount;
+        cut  = (*it).cut;
+        rect = (*it).rect;
+        return true;
+    }
+
+    void Insert(const QString &key, const QString &cut, const QRect &rect)
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_enabled)
+            return;
+
+        Layout &layout  = m_layouts[key];
+        layout.cut      = cut;
+        layout.rect     = rect;
+        layout.lastUsed = ++m_useCount;
+
+        if (m_layouts.size() > MAX_LAYOUTS)
+            Expire();
+    }
+
+    void SetEnabled(bool enable)
+    {
+        QMutexLocker locker(&m_lock);
+        m_enabled = enable;
+        m_layouts.clear();
+        m_hits = m_misses = 0;
+    }
+
+    QString GetStats(void)
+    {
+        QMutexLocker locker(&m_lock);
+        return QString("%1 layouts, %2").arg(m_layouts.size())
+            .arg(GetStatsPriv());
+    }
+
+  private:
+    /// Drops the least recently used quarter of the layouts
+    void Expire(void)
+    {
+        QMap<quint64,QString> byUse;
+        QHash<QString,Layout>::const_iterator it = m_layouts.begin();
+        for (; it != m_layouts.end(); ++it)
+            byUse[(*it).lastUsed] = it.key();
+
+        QMap<quint64,QString>::const_iterator uit = byUse.begin();
+        for (; uit != byUse.end() && m_layouts.size() > MAX_LAYOUTS * 3 / 4;
+             ++uit)
+        {
+            m_layouts.remove(*uit);
+        }
+
+        LOG(VB_GUI, LOG_DEBUG,
+            QString("MythUIText: Layout cache expired, %1").arg(GetStatsPriv()));
+    }
+
+    QString GetStatsPriv(void) const
+    {
+        quint64 lookups = m_hits + m_misses;
+        return QString("%1% of %2 lookups hit")
+            .arg(lookups ? m_hits * 100 / lookups : 0).arg(lookups);
+    }
+
+    class Layout
+    {
+      public:
+        Layout() : lastUsed(0) {}
+        QString  cut;
+        QRect    rect;
+        quint64  lastUsed;
+    };
+
+    QMutex                 m_lock;
+    QHash<QString,Layout>  m_layouts;
+    bool                   m_enabled;
+    quint64                m_useCount;
+    quint64                m_hits;
+    quint64                m_misses;
+};
+
+static TextLayoutCache s_layoutCache;
+
+/// Builds a TextLayoutCache key, type tells the kind of layout apart
+static QString layout_key(char type, const QString &text, const QFont &font,
+                          const QRect &rect, int flags, int extra = 0)
+{
+    return QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+        .arg(type).arg(font.key())
+        .arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height())
+        .arg(flags).arg(extra).arg(text.length()) + text;
+}
+
 MythUIText::MythUIText(MythUIType *parent, const QString &name)
     : MythUIType(parent, name),
       m_Justification(Qt::AlignLeft | Qt::AlignTop), m_OrigDisplayRect(),
@@ -492,10 +617,21 @@ void MythUIText::FillCutMessage(bool reset_size)
 
         if (!m_CutMessage.isEmpty())
         {
-            if (m_ShrinkNarrow)
-                MakeNarrow(rect);
-            else
-                MakeShort(rect);
+            int flags = m_Justification | (m_ShrinkNarrow ? 1 << 30 : 0) |
+                        (m_scrolling ? 1 << 29 : 0);
+            QString key = layout_key('N', m_CutMessage, m_Font->face(),
+                                     m_Area, flags, m_MinSize.x());
+            QString unused;
+
+            if (!s_layoutCache.Find(key, unused, rect))
+            {
+                if (m_ShrinkNarrow)
+                    MakeNarrow(rect);
+                else
+                    MakeShort(rect);
+
+                s_layoutCache.Insert(key, QString(), rect);
+            }
         }
 
         // Record the minimal area needed for the message.
@@ -506,7 +642,34 @@ void MythUIText::FillCutMessage(bool reset_size)
     }
 
     if (m_Cutdown && !m_CutMessage.isEmpty())
-        m_CutMessage = cutDown(m_CutMessage, m_Font, m_MultiLine);
+    {
+        QString key = layout_key('C', m_CutMessage, m_Font->face(),
+                                 GetArea(), m_MultiLine);
+        QString cut;
+        QRect unused;
+
+        if (!s_layoutCache.Find(key, cut, unused))
+        {
+            cut = cutDown(m_CutMessage, m_Font, m_MultiLine);
+            s_layoutCache.Insert(key, cut, QRect());
+        }
+
+        m_CutMessage = cut;
+    }
+}
+
+/** \brief Turns the layout cache shared by all text widgets on or off,
+ *         either way it starts out empty.
+ */
+void MythUIText::SetLayoutCacheEnabled(bool enable)
+{
+    s_layoutCache.SetEnabled(enable);
+}
+
+/// \brief Returns the size and hit rate of the shared layout cache.
+QString MythUIText::GetLayoutCacheStats(void)
+{
+    return s_layoutCache.GetStats();
 }
 
 void MythUIText::Pulse(void)
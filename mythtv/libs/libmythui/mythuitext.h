@@ -53,6 +53,9 @@ class MUI_PUBLIC MythUIText : public MythUIType, public StorageUser
     void SetFontState(const QString&);
     void SetJustification(int just);
 
+    static void SetLayoutCacheEnabled(bool enable);
+    static QString GetLayoutCacheStats(void);
+
   protected:
     virtual void DrawSelf(MythPainter *p, int xoffset, int yoffset,
                           int alphaMod, QRect clipRect);
@@ -6,7 +6,7 @@
 #include <typeinfo>
 
 // QT headers
-#include <QFile>
+#include <QTime>
 #include <QDomDocument>
 #include <QString>
 #include <QBrush>
@@ -18,6 +18,7 @@
 // Mythui headers
 #include "mythmainwindow.h"
 #include "mythuihelper.h"
+#include "xmlparsecache.h"
 
 /* ui type includes */
 #include "mythscreentype.h"
@@ -290,6 +291,7 @@ void XMLParseBase::ClearGlobalObjectStore(void)
 
     // clear any loaded base xml files which will force a reload the next time they are used
     loadedBaseFiles.clear();
+    XMLParseCache::Clear();
 }
 
 void XMLParseBase::ParseChildren(const QString &filename,
@@ -556,28 +558,10 @@ bool XMLParseBase::WindowExists(const QString &xmlfile,
     for (; it != searchpath.end(); ++it)
     {
         QString themefile = *it + xmlfile;
-        QFile f(themefile);
-
-        if (!f.open(QIODevice::ReadOnly))
-            continue;
-
         QDomDocument doc;
-        QString errorMsg;
-        int errorLine = 0;
-        int errorColumn = 0;
 
-        if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Location: '%1' @ %2 column: %3"
-                        "\n\t\t\tError: %4")
-                    .arg(qPrintable(themefile)).arg(errorLine).arg(errorColumn)
-                    .arg(qPrintable(errorMsg)));
-            f.close();
+        if (!XMLParseCache::LoadDocument(themefile, doc))
             continue;
-        }
-
-        f.close();
 
         QDomElement docElem = doc.documentElement();
         QDomNode n = docElem.firstChild();
@@ -613,9 +597,15 @@ bool XMLParseBase::LoadWindowFromXML(const QString &xmlfile,
     {
         QString themefile = *it + xmlfile;
         LOG(VB_GUI, LOG_INFO, LOC + "Loading window theme from " + themefile);
+
+        QTime timer;
+        timer.start();
         if (doLoad(windowname, parent, themefile,
                    onlyLoadWindows, showWarnings))
         {
+            LOG(VB_GUI, LOG_DEBUG, LOC +
+                QString("Loaded window '%1' in %2 ms")
+                    .arg(windowname).arg(timer.elapsed()));
             return true;
         }
         else
@@ -638,28 +628,10 @@ bool XMLParseBase::doLoad(const QString &windowname,
                           bool showWarnings)
 {
     QDomDocument doc;
-    QFile f(filename);
 
-    if (!f.open(QIODevice::ReadOnly))
+    if (!XMLParseCache::LoadDocument(filename, doc))
         return false;
 
-    QString errorMsg;
-    int errorLine = 0;
-    int errorColumn = 0;
-
-    if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC +
-            QString("Location: '%1' @ %2 column: %3"
-                    "\n\t\t\tError: %4")
-                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
-                .arg(qPrintable(errorMsg)));
-        f.close();
-        return false;
-    }
-
-    f.close();
-
     QDomElement docElem = doc.documentElement();
     QDomNode n = docElem.firstChild();
     while (!n.isNull())
@@ -0,0 +1,361 @@
+
+// Own header
+#include "xmlparsecache.h"
+
+// QT headers
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QDataStream>
+#include <QStringList>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QFile>
+#include <QDir>
+
+// libmyth headers
+#include "mythlogging.h"
+
+// Mythui headers
+#include "mythuihelper.h"
+
+#define LOC      QString("XMLParseCache: ")
+
+/// "MTXC", Myth Theme XML Compiled
+#define COMPILED_MAGIC   0x4d545843
+#define COMPILED_VERSION 1
+/// Deeper nesting means a corrupt file, no theme comes close
+#define MAX_DEPTH        64
+
+enum CompiledNodeType
+{
+    kCompiledElement = 1,
+    kCompiledText    = 2,
+};
+
+class XMLParseCache::CachedDocument
+{
+  public:
+    QDateTime    modified;
+    qint64       size;
+    QDomDocument doc;
+};
+
+QMutex                                        XMLParseCache::s_lock;
+QMap<QString,XMLParseCache::CachedDocument*>  XMLParseCache::s_documents;
+bool                                          XMLParseCache::s_enabled = true;
+
+/// Builds the string table of a compiled document while writing its nodes
+class CompiledWriter
+{
+  public:
+    CompiledWriter() : m_out(&m_body, QIODevice::WriteOnly)
+    {
+        m_out.setVersion(QDataStream::Qt_4_6);
+    }
+
+    void WriteElement(const QDomElement &element)
+    {
+        QList<QDomNode> children;
+        for (QDomNode n = element.firstChild(); !n.isNull();
+             n = n.nextSibling())
+        {
+            // Comments and processing instructions are of no use
+            if (n.isElement() || n.isText())
+                children.push_back(n);
+        }
+
+        QDomNamedNodeMap attrs = element.attributes();
+
+        m_out << (quint8) kCompiledElement << String(element.tagName())
+              << (quint32) attrs.count();
+        for (int i = 0; i < attrs.count(); i++)
+        {
+            QDomAttr attr = attrs.item(i).toAttr();
+            m_out << String(attr.name()) << String(attr.value());
+        }
+
+        m_out << (quint32) children.size();
+        QList<QDomNode>::const_iterator it = children.begin();
+        for (; it != children.end(); ++it)
+        {
+            if ((*it).isElement())
+                WriteElement((*it).toElement());
+            else
+                m_out << (quint8) kCompiledText
+                      << String((*it).toCharacterData().data());
+        }
+    }
+
+    QByteArray Finish(void)
+    {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_4_6);
+        out << (quint32) COMPILED_MAGIC << (quint32) COMPILED_VERSION
+            << m_strings;
+        data.append(m_body);
+        return data;
+    }
+
+  private:
+    quint32 String(const QString &str)
+    {
+        QHash<QString,quint32>::const_iterator it = m_index.find(str);
+        if (it != m_index.end())
+            return *it;
+        quint32 idx = m_strings.size();
+        m_strings.push_back(str);
+        m_index[str] = idx;
+        return idx;
+    }
+
+    QByteArray             m_body;
+    QDataStream            m_out;
+    QStringList            m_strings;
+    QHash<QString,quint32> m_index;
+};
+
+static bool read_string(QDataStream &in, const QStringList &strings,
+                        QString &str)
+{
+    quint32 idx;
+    in >> idx;
+    if (in.status() != QDataStream::Ok || idx >= (quint32) strings.size())
+        return false;
+    str = strings[idx];
+    return true;
+}
+
+/// Reads an element, after its kCompiledElement node type was read
+static bool read_element(QDataStream &in, const QStringList &strings,
+                         QDomDocument &doc, QDomElement &element, int depth)
+{
+    QString tag;
+    quint32 count;
+
+    if (depth > MAX_DEPTH || !read_string(in, strings, tag))
+        return false;
+
+    element = doc.createElement(tag);
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        QString name, value;
+        if (!read_string(in, strings, name) ||
+            !read_string(in, strings, value))
+            return false;
+        element.setAttribute(name, value);
+    }
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        quint8 type;
+        in >> type;
+        if (type == kCompiledText)
+        {
+            QString text;
+            if (!read_string(in, strings, text))
+                return false;
+            element.appendChild(doc.createTextNode(text));
+        }
+        else if (type == kCompiledElement)
+        {
+            QDomElement child;
+            if (!read_element(in, strings, doc, child, depth + 1))
+                return false;
+            element.appendChild(child);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+void XMLParseCache::SetEnabled(bool enable)
+{
+    QMutexLocker locker(&s_lock);
+    s_enabled = enable;
+}
+
+bool XMLParseCache::IsEnabled(void)
+{
+    QMutexLocker locker(&s_lock);
+    return s_enabled;
+}
+
+/// \brief Forgets the documents kept in memory, the compiled files stay.
+void XMLParseCache::Clear(void)
+{
+    QMutexLocker locker(&s_lock);
+
+    QMap<QString,CachedDocument*>::iterator it = s_documents.begin();
+    for (; it != s_documents.end(); ++it)
+        delete *it;
+    s_documents.clear();
+}
+
+/** \fn XMLParseCache::LoadDocument(const QString&, QDomDocument&)
+ *  \brief Returns the parsed theme file filename.
+ *
+ *  The document is shared with the cache, callers must not modify it
+ *  in ways that change how the theme is parsed.
+ *
+ *  \return false if the file does not exist or is not valid XML.
+ */
+bool XMLParseCache::LoadDocument(const QString &filename, QDomDocument &doc)
+{
+    QFileInfo fi(filename);
+    if (!fi.exists())
+        return false;
+
+    QMutexLocker locker(&s_lock);
+    bool enabled = s_enabled;
+
+    if (enabled)
+    {
+        QMap<QString,CachedDocument*>::const_iterator it =
+            s_documents.find(filename);
+        if (it != s_documents.end() && (*it)->size == fi.size() &&
+            (*it)->modified == fi.lastModified())
+        {
+            doc = (*it)->doc;
+            return true;
+        }
+    }
+    locker.unlock();
+
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray data = f.readAll();
+    f.close();
+
+    if (!enabled)
+        return ParseXML(filename, data, doc);
+
+    QString cachefile = GetMythUI()->GetThemeCacheDir() + "/" +
+        QString(QCryptographicHash::hash(data,
+                                         QCryptographicHash::Md5).toHex()) +
+        ".xmlc";
+
+    if (ReadCompiled(cachefile, doc))
+    {
+        LOG(VB_GUI | VB_FILE, LOG_DEBUG, LOC +
+            QString("Loaded '%1' from '%2'").arg(filename).arg(cachefile));
+    }
+    else
+    {
+        if (!ParseXML(filename, data, doc))
+            return false;
+        WriteCompiled(cachefile, doc);
+    }
+
+    CachedDocument *cached = new CachedDocument();
+    cached->modified = fi.lastModified();
+    cached->size     = fi.size();
+    cached->doc      = doc;
+
+    locker.relock();
+    if (s_documents.contains(filename))
+        delete s_documents[filename];
+    s_documents[filename] = cached;
+
+    return true;
+}
+
+bool XMLParseCache::ParseXML(const QString &filename, const QByteArray &data,
+                             QDomDocument &doc)
+{
+    QString errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+
+    if (!doc.setContent(data, false, &errorMsg, &errorLine, &errorColumn))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Location: '%1' @ %2 column: %3"
+                    "\n\t\t\tError: %4")
+                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
+                .arg(qPrintable(errorMsg)));
+        return false;
+    }
+
+    return true;
+}
+
+bool XMLParseCache::ReadCompiled(const QString &cachefile, QDomDocument &doc)
+{
+    QFile f(cachefile);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version;
+    QStringList strings;
+    quint8 type;
+    in >> magic >> version;
+    if (magic != COMPILED_MAGIC || version != COMPILED_VERSION)
+        return false;
+    in >> strings >> type;
+
+    QDomDocument compiled;
+    QDomElement root;
+    if (type != kCompiledElement ||
+        !read_element(in, strings, compiled, root, 0))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Ignoring corrupt compiled theme file '%1'")
+                .arg(cachefile));
+        return false;
+    }
+
+    compiled.appendChild(root);
+    doc = compiled;
+    return true;
+}
+
+bool XMLParseCache::WriteCompiled(const QString &cachefile,
+                                  const QDomDocument &doc)
+{
+    QFileInfo fi(cachefile);
+    QDir dir(fi.absolutePath());
+    if (!dir.exists() && !dir.mkpath(fi.absolutePath()))
+        return false;
+
+    CompiledWriter writer;
+    writer.WriteElement(doc.documentElement());
+    QByteArray data = writer.Finish();
+
+    // Written under a temporary name, so a crash can't leave a partial file
+    QString tmpfile = cachefile + ".tmp";
+    QFile f(tmpfile);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        f.write(data) != data.size())
+    {
+        LOG(VB_GUI | VB_FILE, LOG_WARNING, LOC +
+            QString("Unable to write compiled theme file '%1'").arg(tmpfile));
+        f.close();
+        QFile::remove(tmpfile);
+        return false;
+    }
+    f.close();
+
+    QFile::remove(cachefile);
+    if (!QFile::rename(tmpfile, cachefile))
+    {
+        QFile::remove(tmpfile);
+        return false;
+    }
+
+    LOG(VB_GUI | VB_FILE, LOG_DEBUG, LOC +
+        QString("Compiled '%1', %2 bytes").arg(cachefile).arg(data.size()));
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef XMLPARSECACHE_H_
+#define XMLPARSECACHE_H_
+
+#include <QString>
+#include <QMutex>
+#include <QMap>
+
+#include "mythuiexp.h"
+
+class QDomDocument;
+class QByteArray;
+
+/** \class MUI_PUBLIC XMLParseCache
+ *  \brief Keeps theme XML files parsed, so windows are created without
+ *         parsing their XML again.
+ *
+ *  Documents stay in memory until the theme is reloaded. On their first
+ *  use they are also compiled into a compact binary form in the theme
+ *  cache directory, keyed by the MD5 of the XML, which is much cheaper
+ *  to load than the XML itself on the next start.
+ */
+class MUI_PUBLIC XMLParseCache
+{
+  public:
+    static bool LoadDocument(const QString &filename, QDomDocument &doc);
+    static void Clear(void);
+
+    static void SetEnabled(bool enable);
+    static bool IsEnabled(void);
+
+  private:
+    static bool ParseXML(const QString &filename, const QByteArray &data,
+                         QDomDocument &doc);
+    static bool ReadCompiled(const QString &cachefile, QDomDocument &doc);
+    static bool WriteCompiled(const QString &cachefile,
+                              const QDomDocument &doc);
+
+    class CachedDocument;
+    static QMutex                         s_lock;
+    static QMap<QString,CachedDocument*>  s_documents;
+    static bool                           s_enabled;
+};
+
+#endif
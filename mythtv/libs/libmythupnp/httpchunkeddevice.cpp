@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkeddevice.cpp
+//
+// Purpose     : Streams a response body with chunked transfer encoding
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or at your option any later version of the LGPL.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httpchunkeddevice.h"
+#include "httprequest.h"
+#include "mythlogging.h"
+
+const int HTTPChunkedDevice::kChunkSize = 32768;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedDevice::HTTPChunkedDevice( HTTPRequest *pRequest )
+                 : m_pRequest( pRequest ), m_bHeaderSent( false ),
+                   m_bError( false ), m_nBytesSent( 0 )
+{
+    m_buffer.reserve( kChunkSize + 16 );
+    open( QIODevice::WriteOnly );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedDevice::~HTTPChunkedDevice()
+{
+    close();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedDevice::readData( char *, qint64 )
+{
+    return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedDevice::writeData( const char *pData, qint64 nLen )
+{
+    if (m_bError)
+        return -1;
+
+    m_buffer.append( pData, nLen );
+
+    if (m_buffer.size() >= kChunkSize && !SendChunk())
+        return -1;
+
+    return nLen;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Sends the header before the first chunk, the response headers have to be
+// complete by the time the buffer first fills up.
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedDevice::SendChunk()
+{
+    if (!m_bHeaderSent)
+    {
+        QByteArray sHeader = m_pRequest->BuildHeader( -1 ).toUtf8();
+
+        if (m_pRequest->WriteBlockDirect( sHeader.constData(),
+                                          sHeader.length() ) < 0)
+        {
+            m_bError = true;
+            return false;
+        }
+
+        m_nBytesSent += sHeader.length();
+        m_bHeaderSent = true;
+    }
+
+    if (m_buffer.isEmpty())
+        return true;
+
+    // Size line, data and trailing CRLF go out in one write
+
+    QByteArray chunk = QByteArray::number( m_buffer.size(), 16 ) + "\r\n";
+    chunk.reserve( chunk.size() + m_buffer.size() + 2 );
+    chunk.append( m_buffer );
+    chunk.append( "\r\n" );
+    m_buffer.clear();
+
+    if (m_pRequest->WriteBlockDirect( chunk.constData(), chunk.length() ) < 0)
+    {
+        LOG(VB_UPNP, LOG_ERR, "HTTPChunkedDevice: Error writing chunk");
+        m_bError = true;
+        return false;
+    }
+
+    m_nBytesSent += chunk.length();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Returns what was buffered if nothing has been sent yet
+//////////////////////////////////////////////////////////////////////////////
+
+QByteArray HTTPChunkedDevice::TakeBuffer()
+{
+    QByteArray buffer;
+
+    if (!m_bHeaderSent)
+    {
+        buffer = m_buffer;
+        m_buffer.clear();
+    }
+
+    return buffer;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Drops what was buffered and refuses further writes, the last chunk is
+// never sent so a client that already got the header sees the body cut off
+//////////////////////////////////////////////////////////////////////////////
+
+void HTTPChunkedDevice::Abort()
+{
+    m_buffer.clear();
+    m_bError = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Sends the rest of the data and the last chunk, returns the bytes written
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedDevice::Finish()
+{
+    if (m_bError || !SendChunk())
+        return -1;
+
+    static const char lastChunk[] = "0\r\n\r\n";
+
+    if (m_pRequest->WriteBlockDirect( lastChunk, sizeof( lastChunk ) - 1 ) < 0)
+        return -1;
+
+    m_nBytesSent += sizeof( lastChunk ) - 1;
+
+    return m_nBytesSent;
+}
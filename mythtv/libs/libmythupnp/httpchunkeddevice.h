@@ -0,0 +1,70 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkeddevice.h
+//
+// Purpose     : Streams a response body with chunked transfer encoding
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or at your option any later version of the LGPL.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __HTTPCHUNKEDDEVICE_H__
+#define __HTTPCHUNKEDDEVICE_H__
+
+#include <QIODevice>
+#include <QByteArray>
+
+class HTTPRequest;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Write only device that sends what is written to it to the client of an
+// HTTP/1.1 request as it is produced.  Up to kChunkSize bytes are buffered,
+// a response that never fills the buffer is handed back to the request and
+// sent the usual way with a Content-Length.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+class HTTPChunkedDevice : public QIODevice
+{
+    public:
+
+        static const int kChunkSize;
+
+                 HTTPChunkedDevice( HTTPRequest *pRequest );
+        virtual ~HTTPChunkedDevice();
+
+        bool        HeaderSent  () const { return m_bHeaderSent; }
+        QByteArray  TakeBuffer  ();
+        qint64      Finish      ();
+        void        Abort       ();
+
+        virtual bool isSequential() const { return true; }
+
+    protected:
+
+        virtual qint64 readData ( char *pData, qint64 nMaxLen );
+        virtual qint64 writeData( const char *pData, qint64 nLen );
+
+    private:
+
+        bool           SendChunk();
+
+        HTTPRequest   *m_pRequest;
+        QByteArray     m_buffer;
+        bool           m_bHeaderSent;
+        bool           m_bError;
+        qint64         m_nBytesSent;
+};
+
+#endif
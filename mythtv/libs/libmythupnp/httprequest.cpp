@@ -46,6 +46,7 @@
 #endif
 
 #include "upnp.h"
+#include "httpchunkeddevice.h"
 
 #include "compat.h"
 #include "mythlogging.h"
@@ -138,7 +139,10 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_bSOAPRequest   ( false ),
                              m_eResponseType  ( ResponseTypeUnknown),
                              m_nResponseStatus( 200 ),
-                             m_pPostProcess   ( NULL )
+                             m_llFileStart    (   0 ),
+                             m_llFileLength   (  -1 ),
+                             m_pPostProcess   ( NULL ),
+                             m_pChunked       ( NULL )
 {
     m_response.open( QIODevice::ReadWrite );
 }
@@ -147,6 +151,15 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    delete m_pChunked;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 RequestType HTTPRequest::SetRequestType( const QString &sType )
 {
     if (sType == "GET"        ) return( m_eType = RequestTypeGet         );
@@ -187,11 +200,16 @@ QString HTTPRequest::BuildHeader( long long nSize )
     sHeader += GetAdditionalHeaders();
 
     sHeader += QString( "Connection: %1\r\n"
-                        "Content-Type: %2\r\n"
-                        "Content-Length: %3\r\n" )
+                        "Content-Type: %2\r\n" )
                         .arg( GetKeepAlive() ? "Keep-Alive" : "Close" )
-                        .arg( sContentType )
-                        .arg( nSize );
+                        .arg( sContentType );
+
+    // A negative size is a body of unknown length sent in chunks
+
+    if (nSize < 0)
+        sHeader += "Transfer-Encoding: chunked\r\n";
+    else
+        sHeader += QString( "Content-Length: %1\r\n" ).arg( nSize );
 
     // ----------------------------------------------------------------------
     // Temp Hack to process DLNA header
@@ -239,6 +257,46 @@ long HTTPRequest::SendResponse( void )
             break;
     }
 
+    // ----------------------------------------------------------------------
+    // A streamed response has already sent its header and most of its
+    // data, one that stayed small is sent like any other.
+    // ----------------------------------------------------------------------
+
+    if (m_pChunked != NULL)
+    {
+        // A service that failed part way has formatted an error response,
+        // what it streamed so far must not be sent along with it.  Once the
+        // header is out the client can only learn of the failure by the
+        // connection closing before the last chunk.
+
+        if (m_nResponseStatus >= 400)
+        {
+            m_pChunked->Abort();
+
+            if (m_pChunked->HeaderSent())
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("HTTPRequest::SendResponse(chunked) (%1) :%2 -> "
+                            "%3: Error after the header was sent")
+                        .arg(m_sFileName) .arg(GetResponseStatus())
+                        .arg(GetPeerAddress()));
+
+                return( -1 );
+            }
+        }
+        else if (m_pChunked->HeaderSent())
+        {
+            LOG(VB_UPNP, LOG_INFO,
+                QString("HTTPRequest::SendResponse(chunked) (%1) :%2 -> %3:")
+                    .arg(m_sFileName) .arg(GetResponseStatus())
+                    .arg(GetPeerAddress()));
+
+            return( m_pChunked->Finish() );
+        }
+        else
+            m_response.write( m_pChunked->TakeBuffer() );
+    }
+
     LOG(VB_UPNP, LOG_INFO,
         QString("HTTPRequest::SendResponse(xml/html) (%1) :%2 -> %3: %4")
              .arg(m_sFileName) .arg(GetResponseStatus())
@@ -295,6 +353,8 @@ long HTTPRequest::SendResponseFile( QString sFileName )
 
     LOG(VB_UPNP, LOG_INFO, QString("SendResponseFile ( %1 )").arg(sFileName));
 
+    QString sResponseTypeText = m_sResponseTypeText;
+
     m_eResponseType     = ResponseTypeOther;
     m_sResponseTypeText = "text/plain";
 
@@ -321,13 +381,26 @@ long HTTPRequest::SendResponseFile( QString sFileName )
     if (tmpFile.exists( ) && tmpFile.open( QIODevice::ReadOnly ))
     {
 
-        m_sResponseTypeText = TestMimeType( sFileName );
-
         // ------------------------------------------------------------------
-        // Get File size
+        // Get File size, a part of a file is sent as its own resource
         // ------------------------------------------------------------------
 
-        llSize = llEnd = tmpFile.size( );
+        if (m_filePrefix.isEmpty() && m_llFileStart == 0 && m_llFileLength < 0)
+        {
+            m_sResponseTypeText = TestMimeType( sFileName );
+            llSize = llEnd = tmpFile.size( );
+        }
+        else
+        {
+            m_sResponseTypeText = sResponseTypeText;
+
+            long long llFileSize = std::max( tmpFile.size() - m_llFileStart,
+                                             (qint64)0 );
+            if (m_llFileLength >= 0)
+                llFileSize = std::min( llFileSize, (long long)m_llFileLength );
+
+            llSize = llEnd = m_filePrefix.size() + llFileSize;
+        }
 
         m_nResponseStatus = 200;
 
@@ -409,7 +482,28 @@ long HTTPRequest::SendResponseFile( QString sFileName )
 #endif
     if (( m_eType != RequestTypeHead ) && (llSize != 0))
     {
-        long long sent = SendFile( tmpFile, llStart, llSize );
+        long long sent = 0;
+
+        if (llStart < m_filePrefix.size())
+        {
+            qint64 llPrefix = std::min( (qint64)(m_filePrefix.size() - llStart),
+                                        (qint64)llSize );
+
+            sent = WriteBlockDirect( m_filePrefix.constData() + llStart,
+                                     llPrefix );
+            if (sent != -1)
+            {
+                llSize  -= llPrefix;
+                llStart  = m_filePrefix.size();
+            }
+        }
+
+        if (sent != -1 && llSize > 0)
+        {
+            sent = SendFile( tmpFile,
+                             m_llFileStart + llStart - m_filePrefix.size(),
+                             llSize );
+        }
 
         if (sent == -1)
         {
@@ -685,6 +779,22 @@ void HTTPRequest::FormatFileResponse( const QString &sFileName )
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Sends llLength bytes of the file from llStart, after the prefix, as if
+// they were a file of their own.  Range requests are relative to the prefix.
+/////////////////////////////////////////////////////////////////////////////
+
+void HTTPRequest::FormatFileResponse( const QString &sFileName,
+                                      qint64 llStart, qint64 llLength,
+                                      const QByteArray &prefix )
+{
+    FormatFileResponse( sFileName );
+
+    m_filePrefix   = prefix;
+    m_llFileStart  = llStart;
+    m_llFileLength = llLength;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -1398,30 +1508,51 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 Serializer *HTTPRequest::GetSerializer()
 {
     Serializer *pSerializer = NULL;
+    QIODevice  *pDevice     = GetResponseDevice();
 
     if (m_bSOAPRequest) 
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetHeaderValue( "Accept", "*/*" );
         
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
 
     return pSerializer;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Returns the device a response body can be written to as it is produced.
+// HTTP/1.1 responses are sent while they are written, so the response type
+// and headers must be set before writing to it.
+/////////////////////////////////////////////////////////////////////////////
+
+QIODevice *HTTPRequest::GetResponseDevice()
+{
+    bool bChunked = (( m_nMajor > 1 ) || ( m_nMajor == 1 && m_nMinor >= 1 ))
+                    && ( m_eType != RequestTypeHead );
+
+    if (!bChunked)
+        return &m_response;
+
+    if (m_pChunked == NULL)
+        m_pChunked = new HTTPChunkedDevice( this );
+
+    return m_pChunked;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
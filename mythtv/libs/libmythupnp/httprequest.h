@@ -41,6 +41,8 @@ using namespace std;
                              "<s:Body>"
 #define SOAP_ENVELOPE_END    "</s:Body>\r\n</s:Envelope>";
 
+class HTTPChunkedDevice;
+
 
 /////////////////////////////////////////////////////////////////////////////
 // Typedefs / Defines
@@ -102,6 +104,8 @@ class IPostProcess
 
 class UPNP_PUBLIC HTTPRequest
 {
+    friend class HTTPChunkedDevice;
+
     protected:
 
         static const char  *m_szServerHeaders;
@@ -143,6 +147,9 @@ class UPNP_PUBLIC HTTPRequest
         QStringMap          m_mapRespHeaders;
 
         QString             m_sFileName;
+        QByteArray          m_filePrefix;       // sent ahead of the file
+        qint64              m_llFileStart;      // part of the file sent,
+        qint64              m_llFileLength;     // -1 for all of the rest
 
         QBuffer             m_response;
 
@@ -150,6 +157,8 @@ class UPNP_PUBLIC HTTPRequest
 
     protected:
 
+        HTTPChunkedDevice  *m_pChunked;
+
         RequestType     SetRequestType      ( const QString &sType  );
         void            SetRequestProtocol  ( const QString &sLine  );
         ContentType     SetContentType      ( const QString &sType  );
@@ -180,7 +189,7 @@ class UPNP_PUBLIC HTTPRequest
     public:
         
                         HTTPRequest     ();
-        virtual        ~HTTPRequest     () {};
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
@@ -191,6 +200,9 @@ class UPNP_PUBLIC HTTPRequest
         void            FormatActionResponse( Serializer *ser );
         void            FormatActionResponse( const NameValues &pArgs );
         void            FormatFileResponse  ( const QString &sFileName );
+        void            FormatFileResponse  ( const QString &sFileName,
+                                              qint64 llStart, qint64 llLength,
+                                              const QByteArray &prefix );
         void            FormatRawResponse   ( const QString &sXML );
 
         long            SendResponse    ( void );
@@ -201,6 +213,7 @@ class UPNP_PUBLIC HTTPRequest
         bool            GetKeepAlive    ();
 
         Serializer *    GetSerializer   ();
+        QIODevice  *    GetResponseDevice();
 
         static QString  GetMimeType     ( const QString &sFileExtension );
         static QString  TestMimeType    ( const QString &sFileName );
@@ -250,26 +250,50 @@ QString JSONSerializer::Encode(const QString &sIn)
     if (sIn.isEmpty())
         return sIn;
 
-    QString sStr = sIn;
-
-    // -=>TODO: Would it be better to just loop through string once and build 
-    // new string with encoded chars instead of calling replace multiple times?
-    // It might perform better.
-
-    sStr.replace( '\\', "\\\\" ); // This must be first
-    sStr.replace( '"' , "\\\"" ); 
-
-    sStr.replace( '\b', "\\b"  );
-    sStr.replace( '\f', "\\f"  );
-    sStr.replace( '\n', "\\n"  );
-    sStr.replace( "\r", "\\r"  );
-    sStr.replace( "\t", "\\t"  );
-    sStr.replace(  "/", "\\/"  );
-
-    // we don't handle hex values yet...
-    /*
-    if(ch>='\u0000' && ch<='\u001F')
-        sb.append("\\u####"); 
-    */
+    // Most strings need no escaping, don't copy those
+
+    const QChar *pIn  = sIn.constData();
+    int          nLen = sIn.length();
+    int          nIdx = 0;
+
+    for (; nIdx < nLen; ++nIdx)
+    {
+        ushort c = pIn[ nIdx ].unicode();
+
+        if (c < 0x20 || c == '"' || c == '\\' || c == '/')
+            break;
+    }
+
+    if (nIdx == nLen)
+        return sIn;
+
+    QString sStr = sIn.left( nIdx );
+    sStr.reserve( nLen + 16 );
+
+    for (; nIdx < nLen; ++nIdx)
+    {
+        ushort c = pIn[ nIdx ].unicode();
+
+        switch( c )
+        {
+            case '\\': sStr += "\\\\"; break;
+            case '"' : sStr += "\\\""; break;
+            case '/' : sStr += "\\/";  break;
+            case '\b': sStr += "\\b";  break;
+            case '\f': sStr += "\\f";  break;
+            case '\n': sStr += "\\n";  break;
+            case '\r': sStr += "\\r";  break;
+            case '\t': sStr += "\\t";  break;
+            default:
+            {
+                if (c < 0x20)
+                    sStr += QString( "\\u%1" ).arg( c, 4, 16, QChar('0') );
+                else
+                    sStr += pIn[ nIdx ];
+                break;
+            }
+        }
+    }
+
     return sStr;
 }
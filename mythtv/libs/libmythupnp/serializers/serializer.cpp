@@ -25,6 +25,14 @@
 
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QReadWriteLock>
+#include <QHash>
+
+// Property tables are built once per class and never freed, there is
+// only a fixed number of classes.
+
+static QReadWriteLock                                        s_propLock;
+static QHash< const QMetaObject *, SerializerProperties * >  s_propCache;
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -98,27 +106,65 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != NULL)
     {
-        const QMetaObject *pMetaObject = pObject->metaObject();
+        const QMetaObject          *pMetaObject = pObject->metaObject();
+        const SerializerProperties &props       = GetProperties( pMetaObject );
 
-        int nCount = pMetaObject->propertyCount();
+        SerializerProperties::const_iterator it = props.begin();
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        for (; it != props.end(); ++it)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            // Designable can depend on the object, so it's checked each time
 
-            if (metaProperty.isDesignable( pObject ))
+            if ((*it).m_metaProp.isDesignable( pObject ))
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
-
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-
-                QVariant value( pObject->property( pszPropName ) );
+                QVariant value( (*it).m_metaProp.read( pObject ) );
 
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                AddProperty( (*it).m_sName, value, pMetaObject, &(*it).m_metaProp );
             }
         }
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Returns the properties of a class, without objectName
+//////////////////////////////////////////////////////////////////////////////
+
+const SerializerProperties &Serializer::GetProperties( const QMetaObject *pMetaObject )
+{
+    {
+        QReadLocker locker( &s_propLock );
+
+        QHash< const QMetaObject *, SerializerProperties * >::const_iterator it =
+            s_propCache.find( pMetaObject );
+
+        if (it != s_propCache.end())
+            return *(*it);
+    }
+
+    QWriteLocker locker( &s_propLock );
+
+    if (s_propCache.contains( pMetaObject ))
+        return *s_propCache.value( pMetaObject );
+
+    SerializerProperties *pProps = new SerializerProperties;
+
+    int nCount = pMetaObject->propertyCount();
+
+    for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+    {
+        SerializerProperty prop;
+
+        prop.m_metaProp = pMetaObject->property( nIdx );
+        prop.m_sName    = prop.m_metaProp.name();
+
+        if ( prop.m_sName.compare( "objectName" ) == 0)
+            continue;
+
+        pProps->append( prop );
+    }
+
+    s_propCache.insert( pMetaObject, pProps );
+
+    return *pProps;
+}
+
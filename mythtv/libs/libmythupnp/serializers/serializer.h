@@ -29,6 +29,21 @@
 
 #include <QList>
 #include <QMetaType>
+#include <QMetaProperty>
+
+//////////////////////////////////////////////////////////////////////////////
+// A property of a class that may be serialized, looked up once per class
+//////////////////////////////////////////////////////////////////////////////
+
+class SerializerProperty
+{
+    public:
+
+        QMetaProperty   m_metaProp;
+        QString         m_sName;
+};
+
+typedef QList< SerializerProperty > SerializerProperties;
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -58,6 +73,8 @@ class UPNP_PUBLIC Serializer
         void SerializeObject          ( const QObject *pObject, const QString &sName );
         void SerializeObjectProperties( const QObject *pObject );
 
+        static const SerializerProperties &GetProperties( const QMetaObject *pMetaObject );
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
@@ -75,6 +92,8 @@ class UPNP_PUBLIC Serializer
         {
             qRegisterMetaType< QList<QObject*> >("QList<QObject*>");
         }
+
+        virtual ~Serializer() {}
 };
 
 Q_DECLARE_METATYPE( QList<QObject*> )
@@ -24,6 +24,8 @@
 #include "xmlSerializer.h"
 
 #include <QMetaClassInfo>
+#include <QReadWriteLock>
+#include <QHash>
 
 // --------------------------------------------------------------------------
 // This version should be bumped if the serializer code is changed in a way
@@ -32,6 +34,14 @@
 
 #define XML_SERIALIZER_VERSION "1.1"
 
+// Content names by class and property, the class info lookup is a linear
+// search that would otherwise be repeated for every object of a list.
+
+typedef QHash< QString, QString > ContentNames;
+
+static QReadWriteLock                                s_contentLock;
+static QHash< const QMetaObject *, ContentNames >    s_contentNames;
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
@@ -274,12 +284,35 @@ QString XmlSerializer::GetContentName( const QString        &sName,
                                        const QMetaObject   *pMetaObject,
                                        const QMetaProperty *pMetaProp )
 {
+    if (pMetaObject == NULL)
+        return sName;
+
+    {
+        QReadLocker locker( &s_contentLock );
+
+        QHash< const QMetaObject *, ContentNames >::const_iterator it =
+            s_contentNames.find( pMetaObject );
+
+        if (it != s_contentNames.end())
+        {
+            ContentNames::const_iterator nit = (*it).find( sName );
+
+            if (nit != (*it).end())
+                return *nit;
+        }
+    }
+
+    QString sContentName     = sName;
     QString sMethodClassInfo = sName + "_type";
 
     int nClassIdx = pMetaObject->indexOfClassInfo( sMethodClassInfo.toAscii() );
 
     if (nClassIdx >=0)
-        return GetItemName( pMetaObject->classInfo( nClassIdx ).value() );
+        sContentName = GetItemName( pMetaObject->classInfo( nClassIdx ).value() );
+
+    QWriteLocker locker( &s_contentLock );
+
+    s_contentNames[ pMetaObject ].insert( sName, sContentName );
 
-    return sName;
+    return sContentName;
 }
@@ -422,10 +422,13 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QObject *pResults )
     {
         Serializer *pSer = pRequest->GetSerializer();
 
-        pSer->Serialize( pResults );
+        // The headers must be known before the response starts streaming
 
         pRequest->FormatActionResponse( pSer );
 
+        pSer->Serialize( pResults );
+
+        delete pSer;
         delete pResults;
 
         return true;
@@ -487,9 +490,11 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QVariant vValue )
     
     Serializer *pSer = pRequest->GetSerializer();
 
+    pRequest->FormatActionResponse( pSer );
+
     pSer->Serialize( vValue, vValue.typeName() );
 
-    pRequest->FormatActionResponse( pSer );
+    delete pSer;
 
     return true;
 }
@@ -0,0 +1,603 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httplivestream.cpp
+//
+// Purpose - Serves recordings as HTTP Live Streaming playlists & segments
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// ANSI C headers
+#include <cmath>
+
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QTextStream>
+#include <QFileInfo>
+#include <QFile>
+#include <QUrl>
+
+// MythTV headers
+#include "httplivestream.h"
+
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "programinfo.h"
+#include "backendutil.h"
+#include "upnp.h"
+
+#define LOC QString("HLS: ")
+
+/// Size of an MPEG-TS packet
+#define TS_PACKET_SIZE      188
+/// How far into a recording the PAT and PMT are looked for
+#define PSI_SEARCH_SIZE     (2 * 1024 * 1024)
+/// Playlists kept, one per recording and segment length
+#define MAX_PLAYLISTS       16
+/// Seconds before the playlist of a recording in progress is rebuilt
+#define PLAYLIST_REFRESH    3
+/// Segments whose place in their recording is kept
+#define MAX_SEGMENTS        256
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpLiveStream::HttpLiveStream( const QString &sSharePath )
+    : HttpServerExtension( "HttpLiveStream", sSharePath )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpLiveStream::~HttpLiveStream()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QStringList HttpLiveStream::GetBasePaths()
+{
+    return QStringList( "/HLS" );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpLiveStream::ProcessRequest( HTTPRequest *pRequest )
+{
+    try
+    {
+        if (pRequest)
+        {
+            if (pRequest->m_sBaseUrl != "/HLS")
+                return false;
+
+            LOG(VB_UPNP, LOG_INFO,
+                QString("HttpLiveStream::ProcessRequest: %1 : %2")
+                    .arg(pRequest->m_sMethod)
+                    .arg(pRequest->m_sRawRequest));
+
+            if (pRequest->m_sMethod == "GetRecordingPlaylist")
+            {
+                GetRecordingPlaylist( pRequest );
+                return true;
+            }
+
+            if (pRequest->m_sMethod == "GetRecordingSegment")
+            {
+                GetRecordingSegment( pRequest );
+                return true;
+            }
+        }
+    }
+    catch( ... )
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "HttpLiveStream::ProcessRequest() - Unexpected Exception" );
+    }
+
+    return false;
+}
+
+// ==========================================================================
+// Request handler Methods
+// ==========================================================================
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpLiveStream::GetRecordingPlaylist( HTTPRequest *pRequest )
+{
+    HLSPlaylist playlist;
+    QString     sKey;
+    int         nSegmentLength;
+
+    if (!GetPlaylist( pRequest, playlist, sKey, nSegmentLength ))
+        return;
+
+    double dMaxDuration = 0.0;
+    for (int i = 0; i < playlist.segments.size(); i++)
+        dMaxDuration = std::max( dMaxDuration, playlist.segments[i].duration );
+
+    // Segment URLs are relative to the playlist
+
+    QString sParams = QString( "ChanId=%1&StartTime=%2&SegmentLength=%3" )
+        .arg( pRequest->m_mapParams[ "ChanId" ] )
+        .arg( QString( QUrl::toPercentEncoding(
+                           pRequest->m_mapParams[ "StartTime" ] )))
+        .arg( nSegmentLength );
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = "application/vnd.apple.mpegurl";
+    pRequest->m_nResponseStatus   = 200;
+    pRequest->m_mapRespHeaders[ "Cache-Control" ] =
+        playlist.complete ? "max-age = 5000" : "no-cache";
+
+    QTextStream stream( &pRequest->m_response );
+
+    stream << "#EXTM3U\n"
+           << "#EXT-X-VERSION:3\n"
+           << "#EXT-X-TARGETDURATION:"
+           << std::max( (int) ceil( dMaxDuration ), 1 ) << "\n"
+           << "#EXT-X-MEDIA-SEQUENCE:0\n";
+
+    if (playlist.complete)
+        stream << "#EXT-X-PLAYLIST-TYPE:VOD\n";
+    else
+        stream << "#EXT-X-PLAYLIST-TYPE:EVENT\n";
+
+    for (int i = 0; i < playlist.segments.size(); i++)
+    {
+        stream << "#EXTINF:"
+               << QString::number( playlist.segments[i].duration, 'f', 3 )
+               << ",\n"
+               << "GetRecordingSegment?" << sParams
+               << "&Segment=" << i << "\n";
+    }
+
+    if (playlist.complete)
+        stream << "#EXT-X-ENDLIST\n";
+
+    stream.flush();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpLiveStream::GetRecordingSegment( HTTPRequest *pRequest )
+{
+    uint      nChanId;
+    QDateTime dtStartTime;
+    QString   sKey;
+    int       nSegmentLength;
+
+    if (!ParseRequest( pRequest, nChanId, dtStartTime, sKey, nSegmentLength ))
+        return;
+
+    bool bOk;
+    int  nSegment = pRequest->m_mapParams[ "Segment" ].toInt( &bOk );
+
+    if (!bOk || nSegment < 0)
+    {
+        SendError( pRequest, 404, "Segment not found" );
+        return;
+    }
+
+    // Segments don't change once they are in a playlist, players fetch
+    // them one after another, usually while the playlist of a recording
+    // in progress is due for a rebuild
+
+    QString        sSegmentKey = sKey + QString( "_%1" ).arg( nSegment );
+    HLSSegmentFile file;
+    bool           bCached;
+
+    {
+        QMutexLocker locker( &m_lock );
+
+        QMap<QString, HLSSegmentFile>::const_iterator it =
+            m_segments.find( sSegmentKey );
+
+        bCached = (it != m_segments.end());
+
+        if (bCached)
+        {
+            file = *it;
+            m_segmentLRU.removeOne( sSegmentKey );
+            m_segmentLRU.push_back( sSegmentKey );
+        }
+    }
+
+    if (!bCached)
+    {
+        HLSPlaylist playlist;
+
+        if (!GetPlaylist( pRequest, playlist, sKey, nSegmentLength ))
+            return;
+
+        if (nSegment >= playlist.segments.size())
+        {
+            SendError( pRequest, 404, "Segment not found" );
+            return;
+        }
+
+        // Decoders need the PAT & PMT before the first keyframe, the rest
+        // is sent straight from the file
+
+        const HLSSegment &segment = playlist.segments[ nSegment ];
+
+        file.filename = playlist.filename;
+        file.start    = segment.start;
+        file.length   = segment.end - segment.start;
+        if (segment.start > 0)
+            file.psi  = playlist.psi;
+
+        QMutexLocker locker( &m_lock );
+
+        m_segments.insert( sSegmentKey, file );
+        m_segmentLRU.push_back( sSegmentKey );
+
+        while (m_segmentLRU.size() > MAX_SEGMENTS)
+            m_segments.remove( m_segmentLRU.takeFirst() );
+    }
+
+    pRequest->FormatFileResponse( file.filename, file.start, file.length,
+                                  file.psi );
+
+    if (pRequest->m_eResponseType != ResponseTypeFile)
+    {
+        QMutexLocker locker( &m_lock );
+
+        m_segments.remove( sSegmentKey );
+        m_segmentLRU.removeOne( sSegmentKey );
+
+        SendError( pRequest, 404, "Recording not found" );
+        return;
+    }
+
+    pRequest->m_sResponseTypeText = "video/MP2T";
+    pRequest->m_mapRespHeaders[ "Cache-Control" ] = "max-age = 5000";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Reads the recording and segment length of the request, sKey names the
+// playlist of both.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpLiveStream::ParseRequest( HTTPRequest *pRequest, uint &nChanId,
+                                   QDateTime &dtStartTime, QString &sKey,
+                                   int &nSegmentLength )
+{
+    nChanId     = pRequest->m_mapParams[ "ChanId" ].toUInt();
+    dtStartTime = QDateTime::fromString(
+        pRequest->m_mapParams[ "StartTime" ], Qt::ISODate );
+
+    if (!nChanId || !dtStartTime.isValid())
+    {
+        SendError( pRequest, 400, "ChanId and StartTime are required" );
+        return false;
+    }
+
+    nSegmentLength = pRequest->m_mapParams.value( "SegmentLength", "10" ).toInt();
+    nSegmentLength = std::max( 2, std::min( nSegmentLength, 60 ));
+
+    sKey = ProgramInfo::MakeUniqueKey( nChanId, dtStartTime ) +
+           QString( "_%1" ).arg( nSegmentLength );
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Returns the playlist of the recording in the request, building it if it
+// isn't known yet or the recording has grown since.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpLiveStream::GetPlaylist( HTTPRequest *pRequest, HLSPlaylist &playlist,
+                                  QString &sKey, int &nSegmentLength )
+{
+    uint      nChanId;
+    QDateTime dtStartTime;
+
+    if (!ParseRequest( pRequest, nChanId, dtStartTime, sKey, nSegmentLength ))
+        return false;
+
+    {
+        QMutexLocker locker( &m_lock );
+
+        QMap<QString, HLSPlaylist>::const_iterator it = m_playlists.find( sKey );
+
+        if (it != m_playlists.end() &&
+            ((*it).complete ||
+             (*it).built.secsTo( QDateTime::currentDateTime() ) <
+                 PLAYLIST_REFRESH))
+        {
+            playlist = *it;
+            return true;
+        }
+    }
+
+    ProgramInfo pginfo( nChanId, dtStartTime );
+
+    if (!pginfo.GetChanID())
+    {
+        SendError( pRequest, 404, "Recording not found" );
+        return false;
+    }
+
+    if (pginfo.GetHostname() != gCoreContext->GetHostName())
+    {
+        // We only handle requests for local resources
+
+        UPnp::FormatRedirectResponse( pRequest, pginfo.GetHostname() );
+        return false;
+    }
+
+    if (!BuildPlaylist( pginfo, nSegmentLength, playlist ))
+    {
+        SendError( pRequest, 404, "Recording can't be segmented" );
+        return false;
+    }
+
+    QMutexLocker locker( &m_lock );
+
+    m_playlists.insert( sKey, playlist );
+
+    while (m_playlists.size() > MAX_PLAYLISTS)
+    {
+        QMap<QString, HLSPlaylist>::iterator oldest = m_playlists.begin();
+        QMap<QString, HLSPlaylist>::iterator it     = m_playlists.begin();
+
+        for (; it != m_playlists.end(); ++it)
+        {
+            if ((*it).built < (*oldest).built)
+                oldest = it;
+        }
+
+        m_playlists.erase( oldest );
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Splits the recording into segments of about nSegmentLength seconds at
+// the keyframes of the position map.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpLiveStream::BuildPlaylist( ProgramInfo &pginfo, int nSegmentLength,
+                                    HLSPlaylist &playlist )
+{
+    playlist.filename = GetPlaybackURL( &pginfo );
+    playlist.built    = QDateTime::currentDateTime();
+    playlist.complete = pginfo.GetRecordingEndTime() < playlist.built;
+
+    QFileInfo fileInfo( playlist.filename );
+
+    if (!fileInfo.exists())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("'%1' does not exist").arg(playlist.filename));
+        return false;
+    }
+
+    // The PAT & PMT don't change, the last playlist of the recording has
+    // them unless this is its first one
+
+    {
+        QMutexLocker locker( &m_lock );
+
+        QMap<QString, HLSPlaylist>::const_iterator it = m_playlists.begin();
+        for (; it != m_playlists.end() && playlist.psi.isEmpty(); ++it)
+        {
+            if ((*it).filename == playlist.filename)
+                playlist.psi = (*it).psi;
+        }
+    }
+
+    if (playlist.psi.isEmpty())
+        playlist.psi = ReadPSI( playlist.filename );
+
+    if (playlist.psi.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No PAT/PMT in '%1', only MPEG-TS recordings "
+                    "can be segmented").arg(playlist.filename));
+        return false;
+    }
+
+    frm_pos_map_t posMap;
+    pginfo.QueryPositionMap( posMap, MARK_GOP_BYFRAME );
+
+    if (posMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No position map for '%1'").arg(playlist.filename));
+        return false;
+    }
+
+    double fps = pginfo.QueryAverageFrameRate() / 1000.0;
+    if (fps <= 0.0)
+        fps = 29.97;
+
+    uint64_t fileSize   = fileInfo.size();
+    uint64_t startFrame = posMap.begin().key();
+    uint64_t startPos   = posMap.begin().value();
+
+    startPos -= startPos % TS_PACKET_SIZE;
+
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (++it; it != posMap.end(); ++it)
+    {
+        uint64_t pos = it.value() - it.value() % TS_PACKET_SIZE;
+
+        if ((it.key() - startFrame) / fps < nSegmentLength ||
+            pos <= startPos || pos > fileSize)
+        {
+            continue;
+        }
+
+        HLSSegment segment;
+        segment.start    = startPos;
+        segment.end      = pos;
+        segment.duration = (it.key() - startFrame) / fps;
+        playlist.segments.push_back( segment );
+
+        startFrame = it.key();
+        startPos   = pos;
+    }
+
+    // The rest of a finished recording is the last segment, the rest of a
+    // recording in progress isn't complete yet.
+
+    if (playlist.complete && fileSize > startPos)
+    {
+        int64_t totalFrames = pginfo.QueryTotalFrames();
+
+        HLSSegment segment;
+        segment.start    = startPos;
+        segment.end      = fileSize;
+        segment.duration = ((uint64_t) totalFrames > startFrame) ?
+            (totalFrames - startFrame) / fps : nSegmentLength;
+        playlist.segments.push_back( segment );
+    }
+
+    LOG(VB_UPNP, LOG_INFO, LOC +
+        QString("%1 segments of %2 seconds for '%3'")
+            .arg(playlist.segments.size()).arg(nSegmentLength)
+            .arg(playlist.filename));
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Returns the first PAT and all packets of the PMT of its first program,
+// or nothing if the file isn't an MPEG-TS.
+/////////////////////////////////////////////////////////////////////////////
+
+QByteArray HttpLiveStream::ReadPSI( const QString &sFileName )
+{
+    QFile file( sFileName );
+
+    if (!file.open( QIODevice::ReadOnly ))
+        return QByteArray();
+
+    QByteArray  data = file.read( PSI_SEARCH_SIZE );
+    const unsigned char *buf = (const unsigned char *) data.constData();
+    int         size = data.size();
+
+    // Find the packet alignment
+
+    int nSync = 0;
+    while (nSync < TS_PACKET_SIZE && nSync + 2 * TS_PACKET_SIZE < size &&
+           (buf[ nSync ] != 0x47 || buf[ nSync + TS_PACKET_SIZE ] != 0x47))
+    {
+        nSync++;
+    }
+
+    QByteArray pat;
+    QByteArray pmt;
+    int        nPMTPid  = -1;
+    int        nPMTLeft = 0;    // bytes of the PMT section still to come
+
+    for (int i = nSync; i + TS_PACKET_SIZE <= size; i += TS_PACKET_SIZE)
+    {
+        const unsigned char *pkt = buf + i;
+
+        if (pkt[0] != 0x47)
+            return QByteArray();
+
+        int  nPid = ((pkt[1] & 0x1f) << 8) | pkt[2];
+        bool bPUSI = pkt[1] & 0x40;
+
+        // Skip the adaptation field
+
+        int nOff = 4;
+        if (pkt[3] & 0x20)
+            nOff += 1 + pkt[4];
+        if (nOff >= TS_PACKET_SIZE)
+            continue;
+
+        // A PMT that doesn't fit in one packet continues in the next ones
+        // of its PID
+
+        if (nPid == nPMTPid && nPMTLeft > 0 && !bPUSI)
+        {
+            pmt.append( (const char *) pkt, TS_PACKET_SIZE );
+            nPMTLeft -= TS_PACKET_SIZE - nOff;
+            if (nPMTLeft <= 0)
+                break;
+            continue;
+        }
+
+        if (!bPUSI)
+            continue;
+
+        // Skip the pointer field
+
+        nOff += 1 + pkt[ nOff ];
+
+        if (nOff + 3 >= TS_PACKET_SIZE)
+            continue;
+
+        int nSectionLen = ((pkt[ nOff + 1 ] & 0x0f) << 8) | pkt[ nOff + 2 ];
+
+        if (nPid == 0 && pat.isEmpty())
+        {
+            if (nOff + 8 >= TS_PACKET_SIZE || pkt[ nOff ] != 0x00)
+                continue;
+
+            int nEnd = std::min( nOff + 3 + nSectionLen - 4, TS_PACKET_SIZE );
+
+            for (int p = nOff + 8; p + 4 <= nEnd; p += 4)
+            {
+                int nProgram = (pkt[p] << 8) | pkt[p + 1];
+                if (nProgram != 0)
+                {
+                    nPMTPid = ((pkt[p + 2] & 0x1f) << 8) | pkt[p + 3];
+                    break;
+                }
+            }
+
+            if (nPMTPid >= 0)
+                pat = QByteArray( (const char *) pkt, TS_PACKET_SIZE );
+        }
+        else if (nPid == nPMTPid && pkt[ nOff ] == 0x02)
+        {
+            // Starts over if an earlier PMT was cut short
+
+            pmt      = QByteArray( (const char *) pkt, TS_PACKET_SIZE );
+            nPMTLeft = nOff + 3 + nSectionLen - TS_PACKET_SIZE;
+            if (nPMTLeft <= 0)
+                break;
+        }
+    }
+
+    if (pat.isEmpty() || pmt.isEmpty() || nPMTLeft > 0)
+        return QByteArray();
+
+    return pat + pmt;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpLiveStream::SendError( HTTPRequest *pRequest, long nStatus,
+                                const QString &sMsg )
+{
+    LOG(VB_UPNP, LOG_ERR, LOC + sMsg);
+
+    pRequest->m_eResponseType   = ResponseTypeHTML;
+    pRequest->m_nResponseStatus = nStatus;
+
+    QTextStream stream( &pRequest->m_response );
+    stream << "<HTML><BODY>" << sMsg << "</BODY></HTML>";
+    stream.flush();
+}
@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httplivestream.h
+//
+// Purpose - Serves recordings as HTTP Live Streaming playlists & segments
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPLIVESTREAM_H_
+#define HTTPLIVESTREAM_H_
+
+#include <stdint.h>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+#include "httpserver.h"
+
+class ProgramInfo;
+
+/// A range of the recording that starts on a keyframe
+class HLSSegment
+{
+  public:
+    HLSSegment() : start(0), end(0), duration(0.0) {}
+
+    uint64_t start;
+    uint64_t end;
+    double   duration;   ///< in seconds
+};
+
+/// The segments of one recording, built from its position map
+class HLSPlaylist
+{
+  public:
+    HLSPlaylist() : complete(false) {}
+
+    QString             filename;
+    QByteArray          psi;        ///< PAT & PMT packets from the start
+    QVector<HLSSegment> segments;
+    bool                complete;   ///< recording has finished
+    QDateTime           built;
+};
+
+/// Where a segment is sent from, once it has been found in its playlist
+class HLSSegmentFile
+{
+  public:
+    HLSSegmentFile() : start(0), length(0) {}
+
+    QString    filename;
+    uint64_t   start;
+    uint64_t   length;
+    QByteArray psi;         ///< sent in front, empty for the first segment
+};
+
+/** \class HttpLiveStream
+ *  \brief Serves MPEG-TS recordings as HLS without transcoding.
+ *
+ *  Segments are ranges of the recording that start on a keyframe from the
+ *  position map, sent as they are with the PAT and PMT of the recording
+ *  in front so every segment can be decoded on its own.
+ *
+ *  Segment data isn't kept in memory, the page cache holds the recently
+ *  sent parts of a recording and sendfile sends them from there. What is
+ *  kept is where the recently requested segments are in their files, so
+ *  requests for them skip the playlist, and the PAT & PMT of each
+ *  recording, which are only read when its first playlist is built.
+ *
+ *  /HLS/GetRecordingPlaylist?ChanId=&StartTime=[&SegmentLength=]
+ *  /HLS/GetRecordingSegment?ChanId=&StartTime=&Segment=[&SegmentLength=]
+ */
+class HttpLiveStream : public HttpServerExtension
+{
+    public:
+                 HttpLiveStream( const QString &sSharePath );
+        virtual ~HttpLiveStream();
+
+        virtual QStringList GetBasePaths();
+
+        bool     ProcessRequest( HTTPRequest *pRequest );
+
+    private:
+
+        void     GetRecordingPlaylist( HTTPRequest *pRequest );
+        void     GetRecordingSegment ( HTTPRequest *pRequest );
+
+        static bool ParseRequest( HTTPRequest *pRequest, uint &nChanId,
+                                  QDateTime &dtStartTime, QString &sKey,
+                                  int &nSegmentLength );
+
+        bool     GetPlaylist   ( HTTPRequest *pRequest, HLSPlaylist &playlist,
+                                 QString &sKey, int &nSegmentLength );
+        bool     BuildPlaylist ( ProgramInfo &pginfo, int nSegmentLength,
+                                 HLSPlaylist &playlist );
+
+        static QByteArray ReadPSI( const QString &sFileName );
+        static void       SendError( HTTPRequest *pRequest, long nStatus,
+                                     const QString &sMsg );
+
+    private:
+
+        QMutex                        m_lock;
+        QMap<QString, HLSPlaylist>    m_playlists;
+        QMap<QString, HLSSegmentFile> m_segments;   ///< by playlist & segment
+        QList<QString>                m_segmentLRU; ///< least recent first
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include "mythsystem.h"
 #include "exitcodes.h"
 #include "jobqueue.h"
+#include "storagegroup.h"
 #include "upnp.h"
 #include <util.h>
 
@@ -143,8 +144,11 @@ void HttpStatus::GetStatusXML( HTTPRequest *pRequest )
     pRequest->m_eResponseType   = ResponseTypeXML;
     pRequest->m_mapRespHeaders[ "Cache-Control" ] = "no-cache=\"Ext\", max-age = 5000";
 
-    QTextStream stream( &pRequest->m_response );
-    stream << doc.toString();
+    // Written straight to the client instead of into a string first
+
+    QTextStream stream( pRequest->GetResponseDevice() );
+    stream.setCodec( "UTF-8" );
+    doc.save( stream, 1 );
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -160,7 +164,8 @@ void HttpStatus::GetStatusHTML( HTTPRequest *pRequest )
 
     FillStatusXML( &doc );
 
-    QTextStream stream( &pRequest->m_response );
+    QTextStream stream( pRequest->GetResponseDevice() );
+    stream.setCodec( "UTF-8" );
     PrintStatus( stream, &doc );
 }
 
@@ -507,6 +512,17 @@ void HttpStatus::FillStatusXML( QDomDocument *pDoc )
             storage.appendChild(fsXML[fs_index]);
     }
 
+    uint nIndexFiles = 0;
+    quint64 nIndexHits = 0, nIndexMisses = 0;
+    if (StorageGroup::GetFileIndexStats(nIndexFiles, nIndexHits, nIndexMisses))
+    {
+        QDomElement fileIndex = pDoc->createElement("FileIndex");
+        fileIndex.setAttribute("files" , nIndexFiles );
+        fileIndex.setAttribute("hits"  , nIndexHits );
+        fileIndex.setAttribute("misses", nIndexMisses );
+        storage.appendChild(fileIndex);
+    }
+
     // load average ---------------------
 
     double rgdAverages[3];
@@ -1380,6 +1396,26 @@ int HttpStatus::PrintMachineInfo( QTextStream &os, QDomElement info )
 
     os << "      </ul>\r\n";
 
+    node = storage.namedItem( "FileIndex" );
+
+    if (!node.isNull())
+    {
+        QDomElement e = node.toElement();
+        QLocale c(QLocale::C);
+
+        os << "      Storage Group File Index:<br />\r\n"
+           << "      <ul>\r\n"
+           << "        <li>Files Indexed: "
+           << c.toString(e.attribute("files", "0").toUInt()) << "</li>\r\n"
+           << "        <li>Lookups Found: "
+           << c.toString(e.attribute("hits", "0").toULongLong())
+           << "</li>\r\n"
+           << "        <li>Lookups Scanned: "
+           << c.toString(e.attribute("misses", "0").toULongLong())
+           << "</li>\r\n"
+           << "      </ul>\r\n";
+    }
+
     // Guide Info ---------------------
 
     node = info.namedItem( "Guide" );
@@ -644,6 +644,7 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         httpStatus->SetMainServer(mainServer);
 
     StorageGroup::CheckAllStorageGroupDirs();
+    StorageGroup::StartFileIndex();
 
     if (gCoreContext->IsMasterBackend())
         SendMythSystemEvent("MASTER_STARTED");
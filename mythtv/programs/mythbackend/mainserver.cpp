@@ -292,6 +292,13 @@ MainServer::~MainServer()
 {
     if (!m_stopped)
         Stop();
+
+    QMutexLocker locker(&m_recListHistoryLock);
+    QMap<QString, RecordingListHistory*>::iterator it =
+        m_recListHistory.begin();
+    for (; it != m_recListHistory.end(); ++it)
+        delete *it;
+    m_recListHistory.clear();
 }
 
 void MainServer::Stop()
@@ -339,6 +346,9 @@ void MainServer::Stop()
             masterFreeSpaceListWait.wait(locker.mutex());
         }
     }
+
+    // Finish the LiveTV chain writes before the database goes away
+    LiveTVChain::FlushWrites();
 }
 
 void MainServer::autoexpireUpdate(void)
@@ -428,6 +438,13 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         else
             HandleQueryRecordings(tokens[1], pbs);
     }
+    else if (command == "QUERY_RECORDINGS_DELTA")
+    {
+        if (tokens.size() != 3)
+            LOG(VB_GENERAL, LOG_ERR, "Bad QUERY_RECORDINGS_DELTA query");
+        else
+            HandleQueryRecordingsDelta(tokens, pbs);
+    }
     else if (command == "QUERY_RECORDING")
     {
         HandleQueryRecording(tokens, pbs);
@@ -1656,7 +1673,62 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
  */
 void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
 {
-    MythSocket *pbssock = pbs->getSocket();
+    ProgramList destination;
+    FillRecordingList(type, pbs, destination);
+
+    QStringList outputlist(QString::number(destination.size()));
+    ProgramList::const_iterator it = destination.begin();
+    for (; it != destination.end(); ++it)
+        (*it)->ToStringList(outputlist);
+
+    SendResponse(pbs->getSocket(), outputlist);
+}
+
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS_DELTA \e epoch \e generation
+ * Returns the unsorted recording list, or only the recordings added,
+ * changed or removed since the list of \e generation of \e epoch. Pass
+ * "0 0" when there is no list yet.
+ * Returns epoch, generation, "FULL" or "DELTA", length, checksum and the
+ * Base64 encoded list described in RecordingListHistory::Update().
+ */
+void MainServer::HandleQueryRecordingsDelta(QStringList &slist,
+                                            PlaybackSock *pbs)
+{
+    QString playbackhost = pbs->getHostname();
+
+    ProgramList destination;
+    FillRecordingList("Unsorted", pbs, destination);
+
+    m_recListHistoryLock.lock();
+    RecordingListHistory *history = m_recListHistory.value(playbackhost);
+    if (!history)
+    {
+        history = new RecordingListHistory();
+        m_recListHistory[playbackhost] = history;
+    }
+    m_recListHistoryLock.unlock();
+
+    bool full;
+    uint generation;
+    QByteArray data = history->Update(destination, slist[1],
+                                      slist[2].toUInt(), full, generation);
+
+    QStringList outputlist(history->GetEpoch());
+    outputlist << QString::number(generation)
+               << (full ? "FULL" : "DELTA")
+               << QString::number(data.size())
+               << QString::number(qChecksum(data.constData(), data.size()))
+               << QString(data.toBase64());
+
+    SendResponse(pbs->getSocket(), outputlist);
+}
+
+/// \brief Loads the recording list QUERY_RECORDINGS \e type returns to pbs.
+void MainServer::FillRecordingList(const QString &type, PlaybackSock *pbs,
+                                   ProgramList &destination)
+{
     QString playbackhost = pbs->getHostname();
 
     QMap<QString,ProgramInfo*> recMap;
@@ -1675,7 +1747,6 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
     else if ((type == "Descending") || (type == "Delete"))
         sort = -1;
 
-    ProgramList destination;
     LoadFromRecorded(
         destination, (type == "Recording"),
         inUseMap, isJobRunning, recMap, sort);
@@ -1684,7 +1755,6 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
     for (; mit != recMap.end(); mit = recMap.erase(mit))
         delete *mit;
 
-    QStringList outputlist(QString::number(destination.size()));
     QMap<QString, QString> backendIpMap;
     QMap<QString, QString> backendPortMap;
     QString ip   = gCoreContext->GetSetting("BackendServerIP");
@@ -1774,11 +1844,7 @@ void MainServer::HandleQueryRecordings(QString type, PlaybackSock *pbs)
 
         if (slave)
             slave->DownRef();
-
-        proginfo->ToStringList(outputlist);
     }
-
-    SendResponse(pbssock, outputlist);
 }
 
 /**
@@ -2157,6 +2223,8 @@ int MainServer::DeleteFile(const QString &filename, bool followLinks,
     LOG(VB_FILE, LOG_INFO, QString("About to unlink/delete file: '%1'")
             .arg(fname.constData()));
 
+    StorageGroup::RemoveFromFileIndex(filename);
+
     QString errmsg = QString("Delete Error '%1'").arg(fname.constData());
     if (finfo.isSymLink())
     {
@@ -3848,11 +3916,23 @@ void MainServer::HandleRecorderQuery(QStringList &slist, QStringList &commands,
         enc->SpawnLiveTV(chain, slist[3].toInt(), slist[4]);
         retlist << "ok";
     }
+    else if (command == "GET_LIVETV_CHAIN")
+    {
+        LiveTVChain *chain = GetExistingChain(enc->GetChainID());
+        if (chain)
+            chain->ToStringList(retlist);
+        else
+            retlist << "";
+    }
     else if (command == "STOP_LIVETV")
     {
         QString chainid = enc->GetChainID();
         enc->StopLiveTV();
 
+        // The next recorder may be on another backend, which will
+        // read the chain back from the database.
+        LiveTVChain::FlushWrites();
+
         LiveTVChain *chain = GetExistingChain(chainid);
         if (chain)
         {
@@ -23,6 +23,7 @@ using namespace std;
 #include "mythsocket.h"
 #include "mythdeque.h"
 #include "mythdownloadmanager.h"
+#include "recordinglisthistory.h"
 
 #ifdef DeleteFile
 #undef DeleteFile
@@ -141,7 +142,10 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(QString filename, QString storagegroup,
                           PlaybackSock *pbs = NULL);
+    void FillRecordingList(const QString &type, PlaybackSock *pbs,
+                           ProgramList &destination);
     void HandleQueryRecordings(QString type, PlaybackSock *pbs);
+    void HandleQueryRecordingsDelta(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -303,6 +307,9 @@ class MainServer : public QObject, public MythSocketCBs
     QMutex                     m_downloadURLsLock;
     QMap<QString, QString>     m_downloadURLs;
 
+    QMutex                     m_recListHistoryLock;
+    QMap<QString, RecordingListHistory*> m_recListHistory; ///< by hostname
+
     int m_exitCode;
 
     typedef QHash<QString,QString> RequestedBy;
@@ -11,6 +11,7 @@
 #include "mediaserver.h"
 #include "httpconfig.h"
 #include "internetContent.h"
+#include "httplivestream.h"
 #include "mythdirs.h"
 
 #include "upnpcdstv.h"
@@ -115,6 +116,8 @@ void MediaServer::Init(bool bIsMaster, bool bDisableUPnp /* = false */)
     m_pHttpServer->RegisterExtension( new ChannelServiceHost( m_sSharePath ));
     m_pHttpServer->RegisterExtension( new VideoServiceHost  ( m_sSharePath ));
 
+    m_pHttpServer->RegisterExtension( new HttpLiveStream    ( m_sSharePath ));
+
     QString sIP = g_pConfig->GetValue( "BackendServerIP"  , ""   );
     if (sIP.isEmpty())
     {
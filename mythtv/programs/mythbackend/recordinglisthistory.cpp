@@ -0,0 +1,157 @@
+// Qt headers
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QStringList>
+#include <QDateTime>
+
+// MythTV headers
+#include "recordinglisthistory.h"
+
+/// Removals remembered before clients that are further behind get it all
+#define MAX_REMOVED 10000
+
+RecordingListHistory::RecordingListHistory() :
+    m_epoch(QString::number(QDateTime::currentDateTime().toTime_t())),
+    m_generation(0), m_oldest(0)
+{
+}
+
+/** \fn RecordingListHistory::Update(const ProgramList&, const QString&, uint, bool&, uint&)
+ *  \brief Records list as the current recording list and serializes what
+ *         changed since generation since of epoch.
+ *
+ *  Everything is sent when the client has no list yet, has a list of
+ *  another backend run, or is further behind than the removals kept.
+ *
+ *  The data is compressed with qCompress(), uncompressed it holds:
+ *   - quint32 count of added or changed recordings, each of them a
+ *     quint32 count of fields followed by the UTF-8 QByteArray of every
+ *     field of ProgramInfo::ToStringList()
+ *   - quint32 count of removed recordings, each of them the UTF-8
+ *     QByteArray of ProgramInfo::MakeUniqueKey()
+ *
+ *  \param full set if the data holds the whole list.
+ *  \param generation set to the generation of list.
+ */
+QByteArray RecordingListHistory::Update(
+    const ProgramList &list, const QString &epoch, uint since, bool &full,
+    uint &generation)
+{
+    QHash<QString,QByteArray> current;
+    ProgramList::const_iterator it = list.begin();
+    for (; it != list.end(); ++it)
+    {
+        QStringList fields;
+        (*it)->ToStringList(fields);
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_4_6);
+        out << (quint32) fields.size();
+        QStringList::const_iterator fit = fields.begin();
+        for (; fit != fields.end(); ++fit)
+            out << (*fit).toUtf8();
+
+        current[(*it)->MakeUniqueKey()] = data;
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    uint next = m_generation + 1;
+    bool changed = false;
+
+    QHash<QString,QByteArray>::const_iterator cit = current.begin();
+    for (; cit != current.end(); ++cit)
+    {
+        QByteArray hash = QCryptographicHash::hash(*cit,
+                                                   QCryptographicHash::Md5);
+        QHash<QString,Entry>::iterator eit = m_entries.find(cit.key());
+        if (eit == m_entries.end())
+        {
+            m_entries.insert(cit.key(), Entry(hash, next));
+            m_removed.remove(cit.key());
+            changed = true;
+        }
+        else if ((*eit).hash != hash)
+        {
+            (*eit).hash       = hash;
+            (*eit).generation = next;
+            changed = true;
+        }
+    }
+
+    QHash<QString,Entry>::iterator eit = m_entries.begin();
+    while (eit != m_entries.end())
+    {
+        if (current.contains(eit.key()))
+        {
+            ++eit;
+            continue;
+        }
+        m_removed[eit.key()] = next;
+        eit = m_entries.erase(eit);
+        changed = true;
+    }
+
+    if (changed)
+        m_generation = next;
+    generation = m_generation;
+
+    if (m_removed.size() > MAX_REMOVED)
+    {
+        QMap<uint,QString> byGeneration;
+        QMap<QString,uint>::const_iterator rit = m_removed.begin();
+        for (; rit != m_removed.end(); ++rit)
+            byGeneration.insertMulti(*rit, rit.key());
+
+        QMap<uint,QString>::const_iterator git = byGeneration.begin();
+        for (; git != byGeneration.end() &&
+                 m_removed.size() > MAX_REMOVED * 3 / 4; ++git)
+        {
+            m_removed.remove(*git);
+            m_oldest = git.key();
+        }
+    }
+
+    full = (epoch != m_epoch) || !since || (since > m_generation) ||
+           (since < m_oldest);
+
+    QList<QString> upserts;
+    for (cit = current.begin(); cit != current.end(); ++cit)
+    {
+        if (full || m_entries[cit.key()].generation > since)
+            upserts.push_back(cit.key());
+    }
+
+    QStringList removed;
+    if (!full)
+    {
+        QMap<QString,uint>::const_iterator rit = m_removed.begin();
+        for (; rit != m_removed.end(); ++rit)
+        {
+            if (*rit > since)
+                removed.push_back(rit.key());
+        }
+    }
+
+    locker.unlock();
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << (quint32) upserts.size();
+    QList<QString>::const_iterator uit = upserts.begin();
+    for (; uit != upserts.end(); ++uit)
+    {
+        const QByteArray &entry = current[*uit];
+        out.writeRawData(entry.constData(), entry.size());
+    }
+
+    out << (quint32) removed.size();
+    QStringList::const_iterator rit = removed.begin();
+    for (; rit != removed.end(); ++rit)
+        out << (*rit).toUtf8();
+
+    return qCompress(data);
+}
@@ -0,0 +1,50 @@
+#ifndef RECORDINGLISTHISTORY_H_
+#define RECORDINGLISTHISTORY_H_
+
+// Qt headers
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QMap>
+
+// MythTV headers
+#include "programinfo.h"
+
+/** \class RecordingListHistory
+ *  \brief Remembers the recording list sent to one host, so
+ *         QUERY_RECORDINGS_DELTA can send only what changed since a
+ *         generation that host already has.
+ *
+ *  The generation is bumped whenever a new list differs from the previous
+ *  one. The epoch tells generations of different backend runs apart.
+ */
+class RecordingListHistory
+{
+  public:
+    RecordingListHistory();
+
+    QByteArray Update(const ProgramList &list, const QString &epoch,
+                      uint since, bool &full, uint &generation);
+
+    QString GetEpoch(void) const { return m_epoch; }
+
+  private:
+    class Entry
+    {
+      public:
+        Entry() : generation(0) {}
+        Entry(const QByteArray &h, uint g) : hash(h), generation(g) {}
+        QByteArray hash;        ///< MD5 of the serialized recording
+        uint       generation;  ///< generation it last changed in
+    };
+
+    mutable QMutex        m_lock;
+    QString               m_epoch;
+    uint                  m_generation;
+    uint                  m_oldest;    ///< removals before it are forgotten
+    QHash<QString,Entry>  m_entries;
+    QMap<QString,uint>    m_removed;   ///< key, generation it was removed in
+};
+
+#endif // RECORDINGLISTHISTORY_H_
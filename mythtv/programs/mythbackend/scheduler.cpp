@@ -44,6 +44,7 @@ using namespace std;
 #include "mythdb.h"
 #include "mythsystemevent.h"
 #include "mythlogging.h"
+#include "ioaccounting.h"
 
 #define LOC QString("Scheduler: ")
 #define LOC_WARN QString("Scheduler, Warning: ")
@@ -3867,6 +3868,7 @@ void Scheduler::AddNewRecords(void)
             result.value(39).toUInt(),//videoproperties
             result.value(41).toUInt(),//audioproperties
             result.value(46).toInt());//future
+        p->Compact();
 
         if (!p->future && !p->IsReactivated() &&
             p->oldrecstatus != rsAborted &&
@@ -4300,6 +4302,20 @@ static bool comp_storage_disk_io(FileSystemInfo *a, FileSystemInfo *b)
 
 /////////////////////////////////////////////////////////////////////////////
 
+/// Bytes per second a card records at most, asked once per card
+static long long card_byterate(QMap<int, EncoderLink *> *tvList, uint cardid,
+                               QMap<uint, long long> &cache)
+{
+    QMap<uint, long long>::const_iterator it = cache.find(cardid);
+    if (it != cache.end())
+        return *it;
+
+    EncoderLink *tv = tvList->value(cardid);
+    long long byterate = tv ? tv->GetMaxBitrate() / 8 : 0;
+    cache[cardid] = byterate;
+    return byterate;
+}
+
 void Scheduler::GetNextLiveTVDir(uint cardid)
 {
     QMutexLocker lockit(&schedLock);
@@ -4383,6 +4399,16 @@ int Scheduler::FillRecordingDir(
     int remoteStartingWeight =
             gCoreContext->GetNumSetting("SGweightRemoteStarting", 0);
     int maxOverlap = gCoreContext->GetNumSetting("SGmaxRecOverlapMins", 3) * 60;
+    int weightPerIOLoad =
+            gCoreContext->GetNumSetting("SGweightPerIOLoad",
+                                        2 * weightPerRecording);
+
+    // Bytes per second each filesystem is expected to move while this
+    // recording runs, on top of the recording itself
+    QMap<uint, long long> byterates;
+    QMap<int, double> projectedIO;
+    long long recByterate = card_byterate(m_tvList, cardid, byterates);
+    bool startsSoon = recstartts <= mythCurrentDateTime().addSecs(5 * 60);
 
     FillDirectoryInfoCache();
 
@@ -4485,6 +4511,10 @@ int Scheduler::FillRecordingDir(
                             weightOffset += weightPerRecording;
                             recsCounted << QString::number(recChanid) + ":" +
                                            recStart.toString(Qt::ISODate);
+
+                            // When it starts soon the measured I/O has it
+                            if (!startsSoon)
+                                projectedIO[fs->getFSysID()] += recByterate;
                         }
                     }
                     else if (recUsage.contains(kPlayerInUseID))
@@ -4562,6 +4592,9 @@ int Scheduler::FillRecordingDir(
                         .arg(fs->getHostname()).arg(fs->getPath())
                         .arg(fs->getFSysID()).arg(weightPerRecording));
 
+                projectedIO[fs->getFSysID()] +=
+                    card_byterate(m_tvList, thispg->GetCardID(), byterates);
+
                 for (fsit2 = fsInfoCache.begin();
                      fsit2 != fsInfoCache.end(); ++fsit2)
                 {
@@ -4582,6 +4615,72 @@ int Scheduler::FillRecordingDir(
         }
     }
 
+    LOG(VB_FILE | VB_SCHEDULE, LOG_INFO, LOC +
+        "FillRecordingDir: Adjusting FS Weights from measured I/O.");
+
+    // Only the I/O of this backend is measured, so only its own
+    // filesystems get a load.
+    QMap<int, IOAccounting::Stats> fsIO;
+    for (fslistit = fsInfoList.begin();
+         fslistit != fsInfoList.end(); ++fslistit)
+    {
+        FileSystemInfo *fs = *fslistit;
+        IOAccounting::Stats stats;
+        if ((fs->getHostname() != gCoreContext->GetHostName()) ||
+            !IOAccounting::GetStats(fs->getPath(), stats))
+            continue;
+
+        IOAccounting::Stats &total = fsIO[fs->getFSysID()];
+        total.writeRate += stats.writeRate;
+        total.readRate  += stats.readRate;
+        total.throughput = max(total.throughput, stats.throughput);
+        total.latency    = max(total.latency, stats.latency);
+    }
+
+    QMap<int, IOAccounting::Stats>::const_iterator ioit = fsIO.begin();
+    for (; ioit != fsIO.end(); ++ioit)
+    {
+        // Nothing to compare the load with until enough I/O was timed
+        if ((*ioit).throughput <= 0.0)
+            continue;
+
+        double projected = projectedIO[ioit.key()] + recByterate;
+        if (startsSoon)
+            projected += (*ioit).writeRate + (*ioit).readRate;
+
+        double load = min(projected / (*ioit).throughput, 4.0);
+        int weightOffset = (int)(weightPerIOLoad * load);
+
+        LOG(VB_FILE | VB_SCHEDULE, LOG_INFO,
+            QString("  FSID #%1 writes %2 KB/s, reads %3 KB/s, sustains "
+                    "%4 KB/s at %5 ms per call, projected %6 KB/s, "
+                    "weightPerIOLoad +%7.")
+                .arg(ioit.key())
+                .arg((long long)((*ioit).writeRate / 1024))
+                .arg((long long)((*ioit).readRate / 1024))
+                .arg((long long)((*ioit).throughput / 1024))
+                .arg((*ioit).latency / 1000.0, 0, 'f', 1)
+                .arg((long long)(projected / 1024)).arg(weightOffset));
+
+        if (!weightOffset)
+            continue;
+
+        for (fsit2 = fsInfoCache.begin(); fsit2 != fsInfoCache.end(); ++fsit2)
+        {
+            FileSystemInfo *fs2 = &(*fsit2);
+            if (fs2->getFSysID() == ioit.key())
+            {
+                LOG(VB_FILE | VB_SCHEDULE, LOG_INFO,
+                    QString("    %1:%2 => old weight %3 plus %4 = %5")
+                        .arg(fs2->getHostname()).arg(fs2->getPath())
+                        .arg(fs2->getWeight()).arg(weightOffset)
+                        .arg(fs2->getWeight() + weightOffset));
+
+                fs2->setWeight(fs2->getWeight() + weightOffset);
+            }
+        }
+    }
+
     LOG(VB_FILE | VB_SCHEDULE, LOG_INFO,
         QString("Using '%1' Storage Scheduler directory sorting algorithm.")
             .arg(storageScheduler));
@@ -4620,8 +4719,7 @@ int Scheduler::FillRecordingDir(
     // recording will record at for analog broadcasts that are encoded locally.
     // maxSizeKB is 1/3 larger than required as this is what the auto expire
     // uses
-    EncoderLink *nexttv = (*m_tvList)[cardid];
-    long long maxByterate = nexttv->GetMaxBitrate() / 8;
+    long long maxByterate = recByterate;
     long long maxSizeKB = (maxByterate + maxByterate/3) *
         recstartts.secsTo(recendts) / 1024;
 
@@ -28,6 +28,12 @@ void MythFrontendCommandLineParser::LoadArguments(void)
         "Always prompt for backend selection.", "");
     add(QStringList( QStringList() << "-d" << "--disable-autodiscovery" ),
         "noautodiscovery", false, "Prevent frontend from using UPnP autodiscovery.", "");
+    add("--theme-timing", "themetiming", false,
+        "Print the load time of every window of the theme with and "
+        "without the compiled theme cache, then exit.", "");
+    add("--list-timing", "listtiming", false,
+        "Print how long scrolling through a long button list takes with "
+        "and without the text layout cache, then exit.", "");
 }
 
 QString MythFrontendCommandLineParser::GetHelpHeader(void) const
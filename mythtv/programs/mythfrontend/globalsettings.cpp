@@ -2715,6 +2715,19 @@ static HostCheckBox *RealtimePriority()
     return gc;
 }
 
+static HostCheckBox *RemoteFileHTTPRange()
+{
+    HostCheckBox *gc = new HostCheckBox("RemoteFileHTTPRange");
+    gc->setLabel(QObject::tr("Read remote recordings over HTTP"));
+    gc->setHelpText(QObject::tr("If enabled, recordings on a backend are "
+                    "read in blocks from its web server and the most recently "
+                    "read blocks are kept in memory, so seeking back is "
+                    "faster. Disable this if the backend's web server is not "
+                    "reachable from this frontend."));
+    gc->setValue(true);
+    return gc;
+}
+
 static HostCheckBox *EnableMediaMon()
 {
     HostCheckBox *gc = new HostCheckBox("MonitorDrives");
@@ -3343,6 +3356,7 @@ PlaybackSettings::PlaybackSettings()
     column1->addChild(RealtimePriority());
     column1->addChild(DecodeExtraAudio());
     column1->addChild(JumpToProgramOSD());
+    column1->addChild(RemoteFileHTTPRange());
     columns->addChild(column1);
 
     VerticalConfigurationGroup *column2 =
@@ -0,0 +1,313 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QRunnable>
+
+#include "guidedatacache.h"
+#include "mthreadpool.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdbcon.h"
+
+/// Blocks kept before the least recently used ones are dropped
+#define MAX_BLOCKS 4000
+
+class GuideDataLoader : public QRunnable
+{
+  public:
+    GuideDataLoader(GuideDataCache &c, const vector<uint> &chanids,
+                    int block, uint generation) :
+        m_cache(c), m_chanids(chanids), m_block(block),
+        m_generation(generation) {}
+
+    void run(void)
+    {
+        bool ok = m_cache.LoadBlock(m_chanids, m_block, m_generation);
+
+        // Notify if the UI waits for any of the blocks, it may have
+        // asked for them after a prefetch had already started loading
+        QMutexLocker locker(&m_cache.m_lock);
+        bool notify = false;
+        vector<uint>::const_iterator it = m_chanids.begin();
+        for (; it != m_chanids.end(); ++it)
+        {
+            GuideDataCache::BlockKey key(*it, m_block);
+            notify |= m_cache.m_waitedFor.remove(key);
+        }
+
+        if (ok && notify)
+            QCoreApplication::postEvent(
+                m_cache.m_listener, new MythEvent("GUIDE_DATA_LOADED"));
+        m_cache.m_loads_in_progress--;
+        m_cache.m_load_wait.wakeAll();
+    }
+
+    GuideDataCache &m_cache;
+    vector<uint>    m_chanids;
+    int             m_block;
+    uint            m_generation;
+};
+
+GuideDataCache::GuideDataCache(QObject *listener) :
+    m_listener(listener), m_generation(0), m_useCount(0),
+    m_hits(0), m_misses(0), m_queries(0), m_loads_in_progress(0)
+{
+}
+
+GuideDataCache::~GuideDataCache()
+{
+    QMutexLocker locker(&m_lock);
+
+    while (m_loads_in_progress)
+        m_load_wait.wait(&m_lock);
+
+    QMap<BlockKey,Block*>::iterator it = m_blocks.begin();
+    for (; it != m_blocks.end(); ++it)
+        delete *it;
+    m_blocks.clear();
+}
+
+int GuideDataCache::BlockFor(const QDateTime &time)
+{
+    return time.toTime_t() / kBlockSecs;
+}
+
+/** \brief Replaces the schedule used for the recording status of the
+ *         listings and drops every cached block.
+ */
+void GuideDataCache::SetScheduleList(const ProgramList &schedList)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_schedList.clear();
+    ProgramList::const_iterator pit = schedList.begin();
+    for (; pit != schedList.end(); ++pit)
+        m_schedList.push_back(new ProgramInfo(**pit));
+
+    QMap<BlockKey,Block*>::iterator it = m_blocks.begin();
+    for (; it != m_blocks.end(); ++it)
+        delete *it;
+    m_blocks.clear();
+    m_loading.clear();
+    m_waitedFor.clear();
+    m_generation++;
+}
+
+/** \brief Copies the programs of chanid shown between start and end
+ *         to proglist.
+ *  \return false if some of the listings are not cached yet.
+ */
+bool GuideDataCache::GetPrograms(uint chanid, const QDateTime &start,
+                                 const QDateTime &end, ProgramList &proglist)
+{
+    proglist.clear();
+
+    QMutexLocker locker(&m_lock);
+
+    int first = BlockFor(start), last = BlockFor(end);
+    for (int b = first; b <= last; b++)
+    {
+        if (!m_blocks.contains(BlockKey(chanid, b)))
+        {
+            m_misses++;
+            return false;
+        }
+    }
+    m_hits++;
+
+    // A program overlapping two blocks is in both of them
+    QDateTime lastStart;
+    for (int b = first; b <= last; b++)
+    {
+        Block *block = m_blocks[BlockKey(chanid, b)];
+        block->lastUsed = ++m_useCount;
+
+        ProgramList::const_iterator it = block->programs.begin();
+        for (; it != block->programs.end(); ++it)
+        {
+            const ProgramInfo *pginfo = *it;
+            if (pginfo->GetScheduledEndTime() < start ||
+                pginfo->GetScheduledStartTime() > end ||
+                (lastStart.isValid() &&
+                 pginfo->GetScheduledStartTime() <= lastStart))
+            {
+                continue;
+            }
+            proglist.push_back(new ProgramInfo(*pginfo));
+            lastStart = pginfo->GetScheduledStartTime();
+        }
+    }
+
+    return true;
+}
+
+vector<uint> GuideDataCache::Missing(const vector<uint> &chanids,
+                                     int block) const
+{
+    vector<uint> missing;
+    vector<uint>::const_iterator it = chanids.begin();
+    for (; it != chanids.end(); ++it)
+    {
+        BlockKey key(*it, block);
+        if (*it && !m_blocks.contains(key) && !m_loading.contains(key))
+            missing.push_back(*it);
+    }
+    return missing;
+}
+
+/** \brief Loads the listings of chanids between start and end on the
+ *         calling thread, one query per time block.
+ */
+void GuideDataCache::Load(const vector<uint> &chanids,
+                          const QDateTime &start, const QDateTime &end)
+{
+    for (int b = BlockFor(start); b <= BlockFor(end); b++)
+    {
+        QMutexLocker locker(&m_lock);
+        vector<uint> missing = Missing(chanids, b);
+        uint generation = m_generation;
+        locker.unlock();
+
+        if (!missing.empty())
+            LoadBlock(missing, b, generation);
+    }
+}
+
+/** \brief Loads the listings of chanids between start and end in the
+ *         background.
+ *  \param notify post "GUIDE_DATA_LOADED" to the listener when done.
+ */
+void GuideDataCache::ScheduleLoad(const vector<uint> &chanids,
+                                  const QDateTime &start,
+                                  const QDateTime &end, bool notify)
+{
+    QMutexLocker locker(&m_lock);
+
+    for (int b = BlockFor(start); b <= BlockFor(end); b++)
+    {
+        // Blocks a prefetch is still loading notify when they arrive
+        vector<uint>::const_iterator it = chanids.begin();
+        for (; notify && it != chanids.end(); ++it)
+        {
+            if (m_loading.contains(BlockKey(*it, b)))
+                m_waitedFor.insert(BlockKey(*it, b));
+        }
+
+        vector<uint> missing = Missing(chanids, b);
+        if (missing.empty())
+            continue;
+
+        for (it = missing.begin(); it != missing.end(); ++it)
+        {
+            m_loading.insert(BlockKey(*it, b));
+            if (notify)
+                m_waitedFor.insert(BlockKey(*it, b));
+        }
+
+        m_loads_in_progress++;
+        MThreadPool::globalInstance()->start(
+            new GuideDataLoader(*this, missing, b, m_generation),
+            "GuideDataLoader");
+    }
+}
+
+/** \brief Loads one time block of chanids with a single query.
+ *  \return false if the query failed or the schedule changed meanwhile.
+ */
+bool GuideDataCache::LoadBlock(const vector<uint> &chanids, int block,
+                               uint generation)
+{
+    QStringList ids;
+    vector<uint>::const_iterator it = chanids.begin();
+    for (; it != chanids.end(); ++it)
+        ids << QString::number(*it);
+
+    QDateTime start = QDateTime::fromTime_t(block * kBlockSecs);
+    QDateTime end   = QDateTime::fromTime_t((block + 1) * kBlockSecs);
+
+    MSqlBindings bindings;
+    QString querystr = QString(
+        "WHERE program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime <= :ENDTS "
+        "  AND program.manualid = 0 ").arg(ids.join(","));
+    bindings[":STARTTS"] = start.toString("yyyy-MM-ddThh:mm:00");
+    bindings[":ENDTS"]   = end.toString("yyyy-MM-ddThh:mm:00");
+
+    QMutexLocker locker(&m_lock);
+    ProgramList schedList;
+    ProgramList::const_iterator sit = m_schedList.begin();
+    for (; sit != m_schedList.end(); ++sit)
+        schedList.push_back(new ProgramInfo(**sit));
+    locker.unlock();
+
+    ProgramList proglist;
+    bool ok = LoadFromProgram(proglist, querystr, bindings, schedList, false);
+
+    locker.relock();
+    m_queries++;
+
+    for (it = chanids.begin(); it != chanids.end(); ++it)
+        m_loading.remove(BlockKey(*it, block));
+
+    // The schedule changed while the query ran
+    if (!ok || generation != m_generation)
+        return false;
+
+    QMap<uint,Block*> loaded;
+    for (it = chanids.begin(); it != chanids.end(); ++it)
+        loaded[*it] = new Block();
+
+    // The listings are sorted by start time, so each block is too
+    while (!proglist.empty())
+    {
+        ProgramInfo *pginfo = proglist.take(0);
+        QMap<uint,Block*>::iterator bit = loaded.find(pginfo->GetChanID());
+        if (bit == loaded.end())
+            delete pginfo;
+        else
+            (*bit)->programs.push_back(pginfo);
+    }
+
+    QMap<uint,Block*>::iterator bit = loaded.begin();
+    for (; bit != loaded.end(); ++bit)
+    {
+        BlockKey key(bit.key(), block);
+        if (m_blocks.contains(key))
+            delete m_blocks[key];
+        (*bit)->lastUsed = ++m_useCount;
+        m_blocks[key] = *bit;
+    }
+
+    Expire();
+
+    return true;
+}
+
+/// \brief Drops the least recently used blocks when there are too many.
+void GuideDataCache::Expire(void)
+{
+    if (m_blocks.size() <= MAX_BLOCKS)
+        return;
+
+    QMap<uint64_t,BlockKey> byUse;
+    QMap<BlockKey,Block*>::const_iterator it = m_blocks.begin();
+    for (; it != m_blocks.end(); ++it)
+        byUse[(*it)->lastUsed] = it.key();
+
+    QMap<uint64_t,BlockKey>::const_iterator uit = byUse.begin();
+    for (; uit != byUse.end() && m_blocks.size() > MAX_BLOCKS * 3 / 4; ++uit)
+        delete m_blocks.take(*uit);
+}
+
+QString GuideDataCache::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    uint lookups = m_hits + m_misses;
+    return QString("%1 blocks, %2% of %3 row lookups hit, %4 queries")
+        .arg(m_blocks.size())
+        .arg(lookups ? m_hits * 100 / lookups : 0).arg(lookups)
+        .arg(m_queries);
+}
@@ -0,0 +1,90 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+#ifndef _GUIDE_DATA_CACHE_H_
+#define _GUIDE_DATA_CACHE_H_
+
+// ANSI C headers
+#include <stdint.h>
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QMutex>
+#include <QPair>
+#include <QMap>
+#include <QSet>
+
+// MythTV headers
+#include "programinfo.h"
+
+class GuideDataLoader;
+class QObject;
+
+/** \class GuideDataCache
+ *  \brief Program guide listings of the frontend, cached by channel and
+ *         by kBlockSecs long time block.
+ *
+ *  Missing blocks are loaded for many channels with a single query on the
+ *  global MThreadPool. When a load fills a block the UI asked for, even
+ *  one a prefetch had started on, a "GUIDE_DATA_LOADED" MythEvent is
+ *  posted to the listener. A schedule change invalidates every block,
+ *  since the recording status of the listings depends on the schedule.
+ */
+class GuideDataCache
+{
+    friend class GuideDataLoader;
+  public:
+    GuideDataCache(QObject *listener);
+    ~GuideDataCache();
+
+    void SetScheduleList(const ProgramList &schedList);
+
+    bool GetPrograms(uint chanid, const QDateTime &start,
+                     const QDateTime &end, ProgramList &proglist);
+    void Load(const vector<uint> &chanids, const QDateTime &start,
+              const QDateTime &end);
+    void ScheduleLoad(const vector<uint> &chanids, const QDateTime &start,
+                      const QDateTime &end, bool notify);
+
+    QString GetStats(void) const;
+
+    /// Length of a cached time block, in seconds
+    static const int kBlockSecs = 3 * 60 * 60;
+
+  private:
+    typedef QPair<uint,int> BlockKey;   ///< chanid, time block
+
+    class Block
+    {
+      public:
+        Block() : lastUsed(0) {}
+        ProgramList programs;
+        uint64_t    lastUsed;
+    };
+
+    static int BlockFor(const QDateTime &time);
+    vector<uint> Missing(const vector<uint> &chanids, int block) const;
+    bool LoadBlock(const vector<uint> &chanids, int block, uint generation);
+    void Expire(void);
+
+  private:
+    mutable QMutex          m_lock;
+    QMap<BlockKey,Block*>   m_blocks;
+    QSet<BlockKey>          m_loading;
+    QSet<BlockKey>          m_waitedFor;   ///< loading blocks the UI needs
+    ProgramList             m_schedList;
+    QObject                *m_listener;
+    uint                    m_generation;  ///< bumped on every invalidation
+    uint64_t                m_useCount;
+    uint                    m_hits;
+    uint                    m_misses;
+    uint                    m_queries;
+    uint                    m_loads_in_progress;
+    QWaitCondition          m_load_wait;
+};
+
+#endif // _GUIDE_DATA_CACHE_H_
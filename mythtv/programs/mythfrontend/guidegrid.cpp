@@ -31,6 +31,7 @@ using namespace std;
 #include "mythuiguidegrid.h"
 #include "mythdialogbox.h"
 #include "progfind.h"
+#include "guidedatacache.h"
 
 QWaitCondition epgIsVisibleCond;
 
@@ -230,6 +231,8 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
     m_jumpToChannelLock(QMutex::Recursive),
     m_jumpToChannel(NULL)
 {
+    m_guideDataCache = new GuideDataCache(this);
+
     connect(m_previewVideoRefreshTimer, SIGNAL(timeout()),
             this,                     SLOT(refreshVideo()));
 
@@ -311,13 +314,17 @@ bool GuideGrid::Create()
 
 void GuideGrid::Load(void)
 {
-    LoadFromScheduler(m_recList);
+    setScheduleList();
     fillChannelInfos();
 
     int maxchannel = max((int)GetChannelCount() - 1, 0);
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
+    // One query for all the visible channels instead of one per row
+    m_guideDataCache->Load(getVisibleChanIDs(m_currentStartChannel),
+                           m_currentStartTime, m_currentEndTime);
+
     for (int y = 0; y < m_channelCount; ++y)
     {
         int chanNum = y + m_currentStartChannel;
@@ -364,6 +371,9 @@ GuideGrid::~GuideGrid()
 {
     gCoreContext->removeListener(this);
 
+    LOG(VB_GUI, LOG_INFO, LOC + m_guideDataCache->GetStats());
+    delete m_guideDataCache;
+
     while (!m_programs.empty())
     {
         if (m_programs.back())
@@ -1034,27 +1044,84 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
     {
         fillProgramRowInfos(y, useExistingData);
     }
+
+    prefetchProgramInfos();
 }
 
+/** \fn GuideGrid::getProgramListFromProgram(int)
+ *  \brief Returns the programs of a channel in the current time window.
+ *
+ *  If the guide data cache does not have them yet they are loaded in
+ *  the background, together with the other visible channels, and NULL
+ *  is returned. The row is filled in once "GUIDE_DATA_LOADED" arrives.
+ */
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
     ProgramList *proglist = new ProgramList();
 
-    if (proglist)
+    if (m_guideDataCache->GetPrograms(GetChannelInfo(chanNum)->chanid,
+                                      m_currentStartTime, m_currentEndTime,
+                                      *proglist))
     {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.manualid = 0 ";
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] = m_currentStartTime.toString("yyyy-MM-ddThh:mm:00");
-        bindings[":ENDTS"] = m_currentEndTime.toString("yyyy-MM-ddThh:mm:00");
+        return proglist;
+    }
+
+    delete proglist;
+    m_guideDataCache->ScheduleLoad(getVisibleChanIDs(m_currentStartChannel),
+                                   m_currentStartTime, m_currentEndTime,
+                                   true);
+    return NULL;
+}
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList, false);
+/// \brief Returns the chanids of the rows shown from startChannel on.
+vector<uint> GuideGrid::getVisibleChanIDs(int startChannel) const
+{
+    vector<uint> chanids;
+    int count = (int) m_channelInfos.size();
+    if (!count)
+        return chanids;
+
+    startChannel %= count;
+    if (startChannel < 0)
+        startChannel += count;
+
+    for (int y = 0; y < m_channelCount && y < count; ++y)
+    {
+        int chanNum = y + startChannel;
+        if (chanNum >= count)
+            chanNum -= count;
+        chanids.push_back(GetChannelInfo(chanNum)->chanid);
     }
 
-    return proglist;
+    return chanids;
+}
+
+/** \fn GuideGrid::prefetchProgramInfos(void)
+ *  \brief Loads the pages next to the current one in the background, so
+ *         paging through the guide is served from the cache.
+ */
+void GuideGrid::prefetchProgramInfos(void)
+{
+    int secs = m_currentStartTime.secsTo(m_currentEndTime);
+
+    vector<uint> chanids = getVisibleChanIDs(m_currentStartChannel);
+    m_guideDataCache->ScheduleLoad(chanids, m_currentEndTime,
+                                   m_currentEndTime.addSecs(secs), false);
+    m_guideDataCache->ScheduleLoad(chanids, m_currentStartTime.addSecs(-secs),
+                                   m_currentStartTime, false);
+
+    int start = m_currentStartChannel;
+    m_guideDataCache->ScheduleLoad(getVisibleChanIDs(start + m_channelCount),
+                                   m_currentStartTime, m_currentEndTime, false);
+    m_guideDataCache->ScheduleLoad(getVisibleChanIDs(start - m_channelCount),
+                                   m_currentStartTime, m_currentEndTime, false);
+}
+
+/// \brief Reloads the schedule, which the cached guide data depends on.
+void GuideGrid::setScheduleList(void)
+{
+    LoadFromScheduler(m_recList);
+    m_guideDataCache->SetScheduleList(m_recList);
 }
 
 void GuideGrid::fillProgramRowInfos(unsigned int row, bool useExistingData)
@@ -1325,10 +1392,24 @@ void GuideGrid::customEvent(QEvent *event)
 
         if (message == "SCHEDULE_CHANGE")
         {
-            LoadFromScheduler(m_recList);
+            setScheduleList();
             fillProgramInfos();
             updateInfo();
         }
+        else if (message == "GUIDE_DATA_LOADED")
+        {
+            bool changed = false;
+            for (int y = 0; y < m_channelCount; ++y)
+            {
+                if (!m_programs[y])
+                {
+                    fillProgramRowInfos(y);
+                    changed |= (m_programs[y] != NULL);
+                }
+            }
+            if (changed)
+                updateInfo();
+        }
         else if (message == "STOP_VIDEO_REFRESH_TIMER")
         {
             m_previewVideoRefreshTimer->stop();
@@ -1615,7 +1696,7 @@ void GuideGrid::generateListings()
     maxchannel = max((int)GetChannelCount() - 1, 0);
     m_channelCount = min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
-    LoadFromScheduler(m_recList);
+    setScheduleList();
     fillProgramInfos();
 }
 
@@ -1925,7 +2006,7 @@ void GuideGrid::quickRecord()
     ri.ToggleRecord();
     *pginfo = ri;
 
-    LoadFromScheduler(m_recList);
+    setScheduleList();
     fillProgramInfos();
     updateInfo();
 }
@@ -27,6 +27,7 @@ class TV;
 class QTimer;
 class MythUIButtonList;
 class MythUIGuideGrid;
+class GuideDataCache;
 
 #define MAX_DISPLAY_CHANS 12
 #define MAX_DISPLAY_TIMES 36
@@ -174,6 +175,9 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void fillProgramInfos(bool useExistingData = false);
     void fillProgramRowInfos(unsigned int row, bool useExistingData = false);
     ProgramList *getProgramListFromProgram(int chanNum);
+    vector<uint> getVisibleChanIDs(int startChannel) const;
+    void prefetchProgramInfos(void);
+    void setScheduleList(void);
 
     void setStartChannel(int newStartChannel);
 
@@ -197,6 +201,7 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     vector<ProgramList*> m_programs;
     ProgramInfo *m_programInfos[MAX_DISPLAY_CHANS][MAX_DISPLAY_TIMES];
     ProgramList  m_recList;
+    GuideDataCache *m_guideDataCache;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
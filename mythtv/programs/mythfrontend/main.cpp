@@ -1,3 +1,4 @@
+#include <sys/time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -16,6 +17,7 @@ using namespace std;
 #include <QWidget>
 #include <QApplication>
 #include <QTimer>
+#include <QDomDocument>
 
 #include "previewgeneratorqueue.h"
 #include "mythconfig.h"
@@ -68,6 +70,11 @@ using namespace std;
 #include "screenwizard.h"
 #include "mythcontrols.h"
 #include "mythuihelper.h"
+#include "xmlparsebase.h"
+#include "xmlparsecache.h"
+#include "mythscreentype.h"
+#include "mythuibuttonlist.h"
+#include "mythuitext.h"
 #include "mythdirs.h"
 #include "mythdb.h"
 #include "backendconnectionmanager.h"
@@ -1429,6 +1436,172 @@ static void CleanupMyOldInUsePrograms(void)
         MythDB::DBError("CleanupMyOldInUsePrograms", query);
 }
 
+static double time_window_load(const QString &xmlfile,
+                               const QString &windowname)
+{
+    MythScreenType *screen =
+        new MythScreenType((MythUIType *) NULL, "themetiming");
+
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    bool ok = XMLParseBase::LoadWindowFromXML(xmlfile, windowname, screen);
+    gettimeofday(&end, NULL);
+
+    delete screen;
+
+    if (!ok)
+        return -1.0;
+    return (end.tv_sec - start.tv_sec) * 1000.0 +
+           (end.tv_usec - start.tv_usec) / 1000.0;
+}
+
+/** \brief Prints how long every window of the theme takes to load from
+ *         the XML, from the compiled theme cache on disk, and from the
+ *         parsed documents kept in memory.
+ */
+static int RunThemeTiming(void)
+{
+    // The first theme directory with a file wins, like LoadWindowFromXML()
+    QMap<QString,QStringList> windows;
+    XMLParseCache::SetEnabled(false);
+    const QStringList searchpath = GetMythUI()->GetThemeSearchPath();
+    QStringList::const_iterator it = searchpath.begin();
+    for (; it != searchpath.end(); ++it)
+    {
+        QStringList files = QDir(*it).entryList(QStringList("*.xml"),
+                                                QDir::Files, QDir::Name);
+        QStringList::const_iterator fit = files.begin();
+        for (; fit != files.end(); ++fit)
+        {
+            QDomDocument doc;
+            if (windows.contains(*fit) ||
+                !XMLParseCache::LoadDocument(*it + *fit, doc))
+                continue;
+
+            QStringList &names = windows[*fit];
+            QDomElement e = doc.documentElement().firstChildElement("window");
+            for (; !e.isNull(); e = e.nextSiblingElement("window"))
+                names.push_back(e.attribute("name"));
+        }
+    }
+
+    cout << qPrintable(QString("%1 %2 %3 %4 %5")
+                       .arg("File", -24).arg("Window", -28)
+                       .arg("XML ms", 9).arg("Compiled", 9).arg("Memory", 9))
+         << endl;
+
+    double totals[3] = { 0.0, 0.0, 0.0 };
+    QMap<QString,QStringList>::const_iterator wit = windows.begin();
+    for (; wit != windows.end(); ++wit)
+    {
+        QStringList::const_iterator nit = (*wit).begin();
+        for (; nit != (*wit).end(); ++nit)
+        {
+            double times[3];
+
+            XMLParseCache::SetEnabled(false);
+            times[0] = time_window_load(wit.key(), *nit);
+
+            // The first load compiles the file if it isn't yet
+            XMLParseCache::SetEnabled(true);
+            time_window_load(wit.key(), *nit);
+            XMLParseCache::Clear();
+            times[1] = time_window_load(wit.key(), *nit);
+            times[2] = time_window_load(wit.key(), *nit);
+
+            if (times[0] < 0.0 || times[1] < 0.0 || times[2] < 0.0)
+                continue;
+
+            for (int i = 0; i < 3; i++)
+                totals[i] += times[i];
+
+            cout << qPrintable(QString("%1 %2 %3 %4 %5")
+                               .arg(wit.key(), -24).arg(*nit, -28)
+                               .arg(times[0], 9, 'f', 2)
+                               .arg(times[1], 9, 'f', 2)
+                               .arg(times[2], 9, 'f', 2))
+                 << endl;
+        }
+    }
+
+    cout << qPrintable(QString("%1 %2 %3 %4 %5")
+                       .arg("Total", -24).arg("", -28)
+                       .arg(totals[0], 9, 'f', 2)
+                       .arg(totals[1], 9, 'f', 2)
+                       .arg(totals[2], 9, 'f', 2))
+         << endl;
+
+    return GENERIC_EXIT_OK;
+}
+
+static double time_list_scroll(MythUIButtonList *list)
+{
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    list->SetItemCurrent(0);
+    list->GetVisibleCount();
+    for (int i = 1; i < list->GetCount(); i++)
+    {
+        list->MoveDown();
+        // Lays out the visible buttons, like drawing the list would
+        list->GetVisibleCount();
+    }
+    gettimeofday(&end, NULL);
+
+    return (end.tv_sec - start.tv_sec) * 1000.0 +
+           (end.tv_usec - start.tv_usec) / 1000.0;
+}
+
+/** \brief Prints how long scrolling through a 5000 item button list of
+ *         the theme takes with and without the MythUIText layout cache.
+ *
+ *  The list is never shown, so only the layout of the buttons is timed.
+ */
+static int RunListTiming(void)
+{
+    MythScreenType *screen =
+        new MythScreenType((MythUIType *) NULL, "listtiming");
+    MythUIButtonList *list = NULL;
+    if (XMLParseBase::LoadWindowFromXML("base.xml", "MythDialogBox", screen))
+        list = dynamic_cast<MythUIButtonList *>(screen->GetChild("list"));
+
+    if (!list)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "The theme has no MythDialogBox list");
+        delete screen;
+        return GENERIC_EXIT_NO_THEME;
+    }
+
+    // A few distinct texts, a real list repeats titles and dates too
+    for (int i = 0; i < 5000; i++)
+    {
+        new MythUIButtonListItem(
+            list, QString("Recording %1 - Episode title that is long enough "
+                          "to be cut down").arg(i % 50), qVariantFromValue(i));
+    }
+
+    MythUIText::SetLayoutCacheEnabled(false);
+    double uncached = time_list_scroll(list);
+    MythUIText::SetLayoutCacheEnabled(true);
+    double first = time_list_scroll(list);
+    double cached = time_list_scroll(list);
+
+    cout << qPrintable(QString("%1 items, %2 visible")
+                       .arg(list->GetCount()).arg(list->GetVisibleCount()))
+         << endl
+         << qPrintable(QString("Without layout cache %1 ms")
+                       .arg(uncached, 0, 'f', 2)) << endl
+         << qPrintable(QString("Layout cache, first pass %1 ms")
+                       .arg(first, 0, 'f', 2)) << endl
+         << qPrintable(QString("Layout cache, second pass %1 ms")
+                       .arg(cached, 0, 'f', 2)) << endl
+         << qPrintable(MythUIText::GetLayoutCacheStats()) << endl;
+
+    delete screen;
+
+    return GENERIC_EXIT_OK;
+}
+
 int main(int argc, char **argv)
 {
     bool bPromptForBackend    = false;
@@ -1578,6 +1751,12 @@ int main(int argc, char **argv)
     mainWindow->Init();
     mainWindow->setWindowTitle(QObject::tr("MythTV Frontend"));
 
+    if (cmdline.toBool("themetiming"))
+        return RunThemeTiming();
+
+    if (cmdline.toBool("listtiming"))
+        return RunListTiming();
+
     // We must reload the translation after a language change and this
     // also means clearing the cached/loaded theme strings, so reload the
     // theme which also triggers a translation reload
@@ -44,7 +44,8 @@ class ProgramInfoLoader : public QRunnable
 
 ProgramInfoCache::ProgramInfoCache(QObject *o) :
     m_next_cache(NULL), m_listener(o),
-    m_load_is_queued(false), m_loads_in_progress(0)
+    m_load_is_queued(false), m_loads_in_progress(0),
+    m_remote_generation(0)
 {
 }
 
@@ -57,6 +58,10 @@ ProgramInfoCache::~ProgramInfoCache()
 
     Clear();
     free_vec(m_next_cache);
+
+    QMap<QString,ProgramInfo*>::iterator it = m_remote.begin();
+    for (; it != m_remote.end(); ++it)
+        delete *it;
 }
 
 void ProgramInfoCache::ScheduleLoad(const bool updateUI)
@@ -78,9 +83,8 @@ void ProgramInfoCache::Load(const bool updateUI)
 
     locker.unlock();
     /**/
-    // Get an unsorted list (sort = 0) from RemoteGetRecordedList
-    // we sort the list later anyway.
-    vector<ProgramInfo*> *tmp = RemoteGetRecordedList(0);
+    // Get an unsorted list, we sort the list later anyway.
+    vector<ProgramInfo*> *tmp = LoadRemote();
     /**/
     locker.relock();
 
@@ -95,6 +99,70 @@ void ProgramInfoCache::Load(const bool updateUI)
     m_load_wait.wakeAll();
 }
 
+/** \brief Returns the recording list of the backend.
+ *
+ *  Only the recordings that changed since the previous load are sent by
+ *  the backend. If QUERY_RECORDINGS_DELTA fails the whole list is loaded
+ *  with QUERY_RECORDINGS and the next load starts over.
+ */
+vector<ProgramInfo*> *ProgramInfoCache::LoadRemote(void)
+{
+    QMutexLocker locker(&m_remote_lock);
+
+    QString epoch = m_remote_epoch;
+    uint generation = m_remote_generation;
+    bool full = false;
+    vector<ProgramInfo*> changed;
+    QStringList removed;
+
+    if (!RemoteGetRecordedListDelta(epoch, generation, full, changed, removed))
+    {
+        QMap<QString,ProgramInfo*>::iterator it = m_remote.begin();
+        for (; it != m_remote.end(); ++it)
+            delete *it;
+        m_remote.clear();
+        m_remote_epoch.clear();
+        m_remote_generation = 0;
+
+        return RemoteGetRecordedList(0);
+    }
+
+    if (full)
+    {
+        QMap<QString,ProgramInfo*>::iterator it = m_remote.begin();
+        for (; it != m_remote.end(); ++it)
+            delete *it;
+        m_remote.clear();
+    }
+
+    QStringList::const_iterator rit = removed.begin();
+    for (; rit != removed.end(); ++rit)
+        delete m_remote.take(*rit);
+
+    vector<ProgramInfo*>::iterator cit = changed.begin();
+    for (; cit != changed.end(); ++cit)
+    {
+        QString key = (*cit)->MakeUniqueKey();
+        delete m_remote.value(key);
+        m_remote[key] = *cit;
+    }
+
+    m_remote_epoch = epoch;
+    m_remote_generation = generation;
+
+    LOG(VB_GUI, LOG_DEBUG, QString("ProgramInfoCache: %1 recordings, "
+                                   "%2 sent, %3 removed")
+            .arg(m_remote.size()).arg(changed.size()).arg(removed.size()));
+
+    vector<ProgramInfo*> *list = new vector<ProgramInfo*>;
+    list->reserve(m_remote.size());
+    QMap<QString,ProgramInfo*>::const_iterator it = m_remote.begin();
+    for (; it != m_remote.end(); ++it)
+        list->push_back(new ProgramInfo(**it));
+
+    return list;
+}
+
 bool ProgramInfoCache::IsLoadInProgress(void) const
 {
     QMutexLocker locker(&m_lock);
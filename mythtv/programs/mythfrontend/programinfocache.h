@@ -15,6 +15,7 @@ using namespace std;
 #include <QWaitCondition>
 #include <QDateTime>
 #include <QMutex>
+#include <QMap>
 
 class ProgramInfoLoader;
 class ProgramInfo;
@@ -47,6 +48,7 @@ class ProgramInfoCache
 
   private:
     void Load(const bool updateUI = true);
+    vector<ProgramInfo*> *LoadRemote(void);
     void Clear(void);
 
   private:
@@ -77,6 +79,12 @@ class ProgramInfoCache
     bool                    m_load_is_queued;
     uint                    m_loads_in_progress;
     mutable QWaitCondition  m_load_wait;
+
+    // The list as the backend last sent it, only used by the loader
+    QMutex                      m_remote_lock;
+    QMap<QString,ProgramInfo*>  m_remote;
+    QString                     m_remote_epoch;
+    uint                        m_remote_generation;
 };
 
 #endif // _PROGRAM_INFO_CACHE_H_
@@ -0,0 +1,1176 @@
+// C headers
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QFileInfo>
+
+// MythTV headers
+#include "h264smartcut.h"
+#include "H264Parser.h"
+#include "mpeg2fix.h"
+#include "mythlogging.h"
+
+#define LOC QString("H264SmartCut: ")
+
+/// Timestamps in a transport stream wrap after 33 bits
+#define PTS_WRAP          (1LL << 33)
+#define PTS_END           0x7fffffffffffffffLL
+/// Encoded pieces are short, so quality matters more than their size
+#define ENCODE_CRF        18.0f
+/// Packets with SPS/PPS NALs are tiny, a keyframe never fits in this
+#define MAX_PARAMSET_SIZE 4096
+
+static bool pts_less_than(const h264cut_frame_t &a, const h264cut_frame_t &b)
+{
+    return a.pts < b.pts;
+}
+
+H264SmartCut::H264SmartCut(const QString &inf, const QString &outf,
+                           frm_dir_map_t *deleteMap, bool showprog,
+                           void (*update_func)(float), int (*check_func)()) :
+    m_infile(inf),              m_outfile(outf),
+    m_inputFC(NULL),            m_decodeFC(NULL),
+    m_outputFC(NULL),           m_vidId(-1),
+    m_parser(new H264Parser()),
+    m_frameDuration(3003),      m_reorderDelay(0),
+    m_encoder(NULL),            m_encodeCtx(NULL),
+    m_encodeBuf(NULL),          m_encodeBufSize(0),
+    m_encodedFrames(0),         m_encodeOffset(0),
+    m_restoreParamSets(false),
+    m_lastVideoDts(AV_NOPTS_VALUE),
+    check_abort(check_func),    update_status(update_func),
+    m_showprogress(showprog),   m_statusUpdateTime(5),
+    m_filesize(0)
+{
+    if (deleteMap)
+        m_delMap = *deleteMap;
+
+    av_register_all();
+    av_log_set_callback(my_av_print);
+
+    if (m_showprogress || update_status)
+    {
+        if (update_status)
+        {
+            m_statusUpdateTime = 20;
+            update_status(0);
+        }
+        m_statustime = QDateTime::currentDateTime();
+        m_statustime = m_statustime.addSecs(m_statusUpdateTime);
+    }
+
+    const QFileInfo finfo(inf);
+    m_filesize = finfo.size();
+}
+
+H264SmartCut::~H264SmartCut()
+{
+    CloseEncoder();
+    CloseOutput();
+    if (m_decodeFC)
+        av_close_input_file(m_decodeFC);
+    if (m_inputFC)
+        av_close_input_file(m_inputFC);
+    delete m_parser;
+}
+
+/** \fn H264SmartCut::Unwrap(int64_t, int64_t)
+ *  \brief Returns the 33 bit timestamp ts as the value closest to ref,
+ *         so timestamps keep increasing across a wrap.
+ */
+int64_t H264SmartCut::Unwrap(int64_t ts, int64_t ref)
+{
+    if (ts == (int64_t) AV_NOPTS_VALUE || ref == (int64_t) AV_NOPTS_VALUE)
+        return ts;
+
+    int64_t diff  = ref - ts;
+    int64_t wraps = (diff >= 0) ? (diff + PTS_WRAP / 2) / PTS_WRAP :
+                                 -((PTS_WRAP / 2 - diff) / PTS_WRAP);
+    return ts + wraps * PTS_WRAP;
+}
+
+bool H264SmartCut::InitInput(AVFormatContext **fc)
+{
+    QByteArray ifarray = m_infile.toLocal8Bit();
+    const char *ifname = ifarray.constData();
+
+    int ret = av_open_input_file(fc, ifname, NULL, 0, NULL);
+    if (ret)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open input file, error #%1").arg(ret));
+        *fc = NULL;
+        return false;
+    }
+
+    ret = av_find_stream_info(*fc);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info, error #%1").arg(ret));
+        av_close_input_file(*fc);
+        *fc = NULL;
+        return false;
+    }
+
+    if (strcmp((*fc)->iformat->name, "mpegts"))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("%1 is not a transport stream").arg(m_infile));
+        av_close_input_file(*fc);
+        *fc = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/** \fn H264SmartCut::InitOutput(void)
+ *  \brief Creates a transport stream with the video stream and every
+ *         audio stream the muxer can carry without re-encoding.
+ */
+bool H264SmartCut::InitOutput(void)
+{
+    AVOutputFormat *fmt = av_guess_format("mpegts", NULL, NULL);
+    if (!fmt)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No mpegts muxer available");
+        return false;
+    }
+
+    m_outputFC = avformat_alloc_context();
+    if (!m_outputFC)
+        return false;
+    m_outputFC->oformat = fmt;
+
+    QByteArray ofarray = m_outfile.toLocal8Bit();
+    snprintf(m_outputFC->filename, sizeof(m_outputFC->filename), "%s",
+             ofarray.constData());
+
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream       *ist = m_inputFC->streams[i];
+        AVCodecContext *ic  = ist->codec;
+
+        if ((int) i != m_vidId)
+        {
+            if (ic->codec_type != CODEC_TYPE_AUDIO || ic->channels == 0)
+                continue;
+            if (ic->codec_id != CODEC_ID_MP2 && ic->codec_id != CODEC_ID_MP3 &&
+                ic->codec_id != CODEC_ID_AC3 && ic->codec_id != CODEC_ID_AAC)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Dropping unsupported audio stream %1").arg(i));
+                continue;
+            }
+        }
+
+        AVStream *ost = av_new_stream(m_outputFC, m_outputFC->nb_streams);
+        if (!ost)
+            return false;
+        AVCodecContext *oc = ost->codec;
+
+        oc->codec_type      = ic->codec_type;
+        oc->codec_id        = ic->codec_id;
+        oc->codec_tag       = 0;
+        oc->bit_rate        = ic->bit_rate;
+        oc->time_base       = ic->time_base;
+        oc->width           = ic->width;
+        oc->height          = ic->height;
+        oc->pix_fmt         = ic->pix_fmt;
+        oc->sample_aspect_ratio  = ic->sample_aspect_ratio;
+        ost->sample_aspect_ratio = ist->sample_aspect_ratio;
+        oc->channels        = ic->channels;
+        oc->sample_rate     = ic->sample_rate;
+        oc->frame_size      = ic->frame_size;
+        oc->block_align     = ic->block_align;
+        ost->r_frame_rate   = ist->r_frame_rate;
+
+        if (ic->extradata_size)
+        {
+            oc->extradata = (uint8_t *) av_mallocz(
+                ic->extradata_size + FF_INPUT_BUFFER_PADDING_SIZE);
+            memcpy(oc->extradata, ic->extradata, ic->extradata_size);
+            oc->extradata_size = ic->extradata_size;
+        }
+
+        AVMetadataTag *lang = av_metadata_get(ist->metadata, "language",
+                                              NULL, 0);
+        if (lang)
+            av_metadata_set2(&ost->metadata, "language", lang->value, 0);
+
+        m_streamMap[i] = ost->index;
+    }
+
+    if (av_set_parameters(m_outputFC, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Invalid output parameters");
+        return false;
+    }
+
+    if (url_fopen(&m_outputFC->pb, ofarray.constData(), URL_WRONLY) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open output file %1").arg(m_outfile));
+        return false;
+    }
+
+    if (av_write_header(m_outputFC) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write the output header");
+        url_fclose(m_outputFC->pb);
+        m_outputFC->pb = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void H264SmartCut::CloseOutput(void)
+{
+    if (!m_outputFC)
+        return;
+
+    if (m_outputFC->pb)
+        url_fclose(m_outputFC->pb);
+    avformat_free_context(m_outputFC);
+    m_outputFC = NULL;
+}
+
+/** \fn H264SmartCut::BuildIndex(bool)
+ *  \brief Reads the video stream once to find the timestamps, byte
+ *         positions and keyframes of all video packets.
+ *  \param report true to report progress, the first fifth of the job.
+ */
+int H264SmartCut::BuildIndex(bool report)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+
+    bool    pendingField = false;
+    int     fieldType    = H264Parser::FRAME;
+    int64_t ref          = AV_NOPTS_VALUE;
+
+    m_parser->Reset();
+    while (av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (pkt.stream_index != m_vidId)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        h264cut_frame_t frame;
+        frame.pts         = Unwrap(pkt.pts, ref);
+        frame.dts         = Unwrap(pkt.dts, ref);
+        frame.pos         = pkt.pos;
+        frame.keyframe    = pkt.flags & PKT_FLAG_KEY;
+        frame.secondField = false;
+
+        if (frame.dts == (int64_t) AV_NOPTS_VALUE)
+            frame.dts = m_frames.empty() ? frame.pts :
+                        m_frames.last().dts + m_frameDuration;
+        if (frame.pts == (int64_t) AV_NOPTS_VALUE)
+            frame.pts = frame.dts;
+        if (frame.pts == (int64_t) AV_NOPTS_VALUE)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+        ref = frame.dts;
+
+        // Look for the first picture in the packet, a second field
+        // is not a frame of its own for MythTV's frame numbering.
+        bool found = false;
+        uint32_t used = 0;
+        while (used < (uint32_t) pkt.size && !found)
+        {
+            used += m_parser->addBytes(pkt.data + used, pkt.size - used,
+                                       pkt.pos);
+            if (!m_parser->stateChanged() || !m_parser->onFrameStart())
+                continue;
+
+            found = true;
+            frame.keyframe |= m_parser->onKeyFrameStart();
+            if (m_parser->FieldType() == H264Parser::FRAME)
+            {
+                pendingField = false;
+            }
+            else if (pendingField && m_parser->FieldType() != fieldType)
+            {
+                frame.secondField = true;
+                pendingField = false;
+            }
+            else
+            {
+                pendingField = true;
+                fieldType = m_parser->FieldType();
+            }
+        }
+        frame.keyframe &= !frame.secondField;
+
+        if (frame.keyframe)
+            m_keyframes.push_back(m_frames.size());
+        m_frames.push_back(frame);
+
+        if (report && !UpdateProgress(pkt.pos / 5))
+        {
+            av_free_packet(&pkt);
+            return REENCODE_STOPPED;
+        }
+        av_free_packet(&pkt);
+    }
+
+    if (m_keyframes.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No keyframes found");
+        return REENCODE_ERROR;
+    }
+
+    // Display order, the most common frame interval is the frame duration
+    QVector<h264cut_frame_t> sorted;
+    for (int i = 0; i < m_frames.size(); i++)
+    {
+        if (!m_frames[i].secondField)
+        {
+            sorted.push_back(m_frames[i]);
+            sorted.last().pos = i;
+        }
+    }
+    stable_sort(sorted.begin(), sorted.end(), pts_less_than);
+
+    QMap<int64_t, int> intervals;
+    for (int i = 0; i < sorted.size(); i++)
+    {
+        m_display.push_back(sorted[i].pos);
+        if (i && i < 500 && sorted[i].pts > sorted[i - 1].pts)
+            intervals[sorted[i].pts - sorted[i - 1].pts]++;
+    }
+
+    int best = 0;
+    QMap<int64_t, int>::const_iterator it = intervals.begin();
+    for (; it != intervals.end(); ++it)
+    {
+        if (*it > best)
+        {
+            best = *it;
+            m_frameDuration = it.key();
+        }
+    }
+
+    const h264cut_frame_t &first = m_frames[m_keyframes.first()];
+    m_reorderDelay = max((int64_t) 0, first.pts - first.dts);
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Indexed %1 video frames, %2 keyframes, %3 ticks per frame")
+            .arg(m_display.size()).arg(m_keyframes.size())
+            .arg(m_frameDuration));
+
+    return REENCODE_OK;
+}
+
+/// \brief Returns the pts of display order frame number frame.
+int64_t H264SmartCut::DisplayPts(long long frame) const
+{
+    if (frame >= m_display.size())
+        return PTS_END;
+    return m_frames[m_display[max(frame, 0LL)]].pts;
+}
+
+/** \fn H264SmartCut::FindKeyframe(int64_t, bool)
+ *  \brief Returns the m_keyframes index of the last keyframe shown at or
+ *         before pts, or of the first keyframe shown at or after pts.
+ *  \return -1 if there is no such keyframe.
+ */
+int H264SmartCut::FindKeyframe(int64_t pts, bool before) const
+{
+    int found = -1;
+    for (int i = 0; i < m_keyframes.size(); i++)
+    {
+        int64_t kpts = m_frames[m_keyframes[i]].pts;
+        if (before && kpts <= pts)
+            found = i;
+        else if (!before && kpts >= pts)
+            return i;
+    }
+    return found;
+}
+
+int H264SmartCut::FindSegment(int64_t pts) const
+{
+    for (int i = 0; i < m_segments.size(); i++)
+    {
+        if (pts >= m_segments[i].startPts && pts < m_segments[i].endPts)
+            return i;
+    }
+    return -1;
+}
+
+/** \fn H264SmartCut::BuildPieces(void)
+ *  \brief Turns the cutlist into kept segments and splits each segment
+ *         into copied GOPs and re-encoded partial GOPs.
+ */
+bool H264SmartCut::BuildPieces(void)
+{
+    // Kept frame ranges, a mark applies from its own frame on
+    QList<QPair<long long, long long> > keep;
+    long long start = 0;
+    bool discard = !m_delMap.empty() &&
+        (m_delMap.begin().value() == MARK_CUT_END ||
+         (m_delMap.begin().key() == 0 &&
+          m_delMap.begin().value() == MARK_CUT_START));
+
+    frm_dir_map_t::const_iterator it = m_delMap.begin();
+    for (; it != m_delMap.end(); ++it)
+    {
+        long long frame = min((long long) it.key(),
+                              (long long) m_display.size());
+        if (*it == MARK_CUT_START && !discard)
+        {
+            if (frame > start)
+                keep.push_back(qMakePair(start, frame));
+            discard = true;
+        }
+        else if (*it == MARK_CUT_END && discard)
+        {
+            start = frame;
+            discard = false;
+        }
+    }
+    if (!discard && start < m_display.size())
+        keep.push_back(qMakePair(start, (long long) m_display.size()));
+
+    int64_t firstKey = m_frames[m_keyframes.first()].pts;
+    for (int i = 0; i < keep.size(); i++)
+    {
+        h264cut_segment_t seg;
+        seg.startPts = max(DisplayPts(keep[i].first), firstKey);
+        seg.endPts   = DisplayPts(keep[i].second);
+        seg.offset   = 0;
+
+        if (!m_encoder)
+        {
+            // No encoder for the partial GOPs, keep them complete
+            int k = FindKeyframe(seg.startPts, true);
+            seg.startPts = m_frames[m_keyframes[max(k, 0)]].pts;
+            if (seg.endPts != PTS_END)
+            {
+                k = FindKeyframe(seg.endPts, false);
+                seg.endPts = (k < 0) ? PTS_END : m_frames[m_keyframes[k]].pts;
+            }
+        }
+
+        if (seg.endPts <= seg.startPts)
+            continue;
+
+        if (!m_segments.empty() && seg.startPts <= m_segments.last().endPts)
+            m_segments.last().endPts = max(m_segments.last().endPts,
+                                           seg.endPts);
+        else
+            m_segments.push_back(seg);
+    }
+
+    if (m_segments.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist removes everything");
+        return false;
+    }
+
+    int64_t lastPts = DisplayPts(m_display.size() - 1) + m_frameDuration;
+    int64_t outPos  = m_segments.first().startPts;
+    for (int s = 0; s < m_segments.size(); s++)
+    {
+        h264cut_segment_t &seg = m_segments[s];
+
+        int k1 = FindKeyframe(seg.startPts, false);
+        int kn = FindKeyframe(seg.endPts, true);
+
+        h264cut_piece_t piece;
+        piece.segment = s;
+        piece.first   = piece.last = 0;
+
+        if (k1 < 0 || m_frames[m_keyframes[k1]].pts >= seg.endPts ||
+            (seg.endPts != PTS_END && kn <= k1))
+        {
+            // Nothing but partial GOPs
+            if (seg.endPts == PTS_END)
+                seg.endPts = lastPts;
+            piece.encode   = true;
+            piece.startPts = seg.startPts;
+            piece.endPts   = seg.endPts;
+            m_pieces.push_back(piece);
+        }
+        else
+        {
+            int64_t copyStart = m_frames[m_keyframes[k1]].pts;
+            if (seg.startPts < copyStart)
+            {
+                piece.encode   = true;
+                piece.startPts = seg.startPts;
+                piece.endPts   = copyStart;
+                m_pieces.push_back(piece);
+            }
+
+            piece.encode   = false;
+            piece.first    = m_keyframes[k1];
+            piece.last     = (seg.endPts == PTS_END) ?
+                             m_frames.size() : m_keyframes[kn];
+            piece.startPts = copyStart;
+            piece.endPts   = (seg.endPts == PTS_END) ?
+                             PTS_END : m_frames[m_keyframes[kn]].pts;
+
+            // Leading pictures of the last keyframe are not copied
+            int64_t copyEnd = copyStart;
+            for (int i = piece.first; i < piece.last; i++)
+            {
+                if (m_frames[i].pts >= copyStart && !m_frames[i].secondField)
+                    copyEnd = max(copyEnd, m_frames[i].pts + m_frameDuration);
+            }
+            m_pieces.push_back(piece);
+
+            if (seg.endPts == PTS_END)
+                seg.endPts = copyEnd;
+            else if (!m_encoder)
+                seg.endPts = min(seg.endPts, copyEnd);
+            else if (copyEnd < seg.endPts)
+            {
+                piece.encode   = true;
+                piece.startPts = copyEnd;
+                piece.endPts   = seg.endPts;
+                m_pieces.push_back(piece);
+            }
+        }
+
+        seg.offset = seg.startPts - outPos;
+        outPos += seg.endPts - seg.startPts;
+
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Keeping %1 - %2")
+                .arg((seg.startPts - firstKey) / 90000.0, 0, 'f', 2)
+                .arg((seg.endPts - firstKey) / 90000.0, 0, 'f', 2));
+    }
+
+    int encoded = 0;
+    for (int i = 0; i < m_pieces.size(); i++)
+        encoded += m_pieces[i].encode ? 1 : 0;
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 segments, %2 partial GOPs to re-encode")
+            .arg(m_segments.size()).arg(encoded));
+
+    return true;
+}
+
+/** \fn H264SmartCut::Start(void)
+ *  \brief Writes the output file.
+ *  \return REENCODE_OK, REENCODE_ERROR or REENCODE_STOPPED
+ */
+int H264SmartCut::Start(void)
+{
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Opening %1").arg(m_infile));
+
+    if (!InitInput(&m_inputFC))
+        return REENCODE_ERROR;
+
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVCodecContext *ctx = m_inputFC->streams[i]->codec;
+        if (ctx->codec_type == CODEC_TYPE_VIDEO && ctx->codec_id == CODEC_ID_H264)
+        {
+            m_vidId = i;
+            break;
+        }
+    }
+    if (m_vidId < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No H.264 video stream found");
+        return REENCODE_ERROR;
+    }
+
+    m_encoder = avcodec_find_encoder(CODEC_ID_H264);
+    if (m_encoder &&
+        m_inputFC->streams[m_vidId]->codec->pix_fmt != PIX_FMT_YUV420P)
+    {
+        m_encoder = NULL;
+    }
+    if (!m_encoder)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "No H.264 encoder available, "
+            "cuts will be moved to the nearest keyframes");
+    }
+
+    int ret = BuildIndex(true);
+    if (ret != REENCODE_OK)
+        return ret;
+
+    if (!BuildPieces())
+        return REENCODE_ERROR;
+
+    if (av_seek_frame(m_inputFC, m_vidId, 0, AVSEEK_FLAG_BYTE) < 0)
+        return REENCODE_ERROR;
+
+    if (!InitOutput())
+        return REENCODE_ERROR;
+
+    ret = CopyPackets();
+    if (ret == REENCODE_OK)
+        av_write_trailer(m_outputFC);
+    CloseOutput();
+    if (ret != REENCODE_OK)
+        return ret;
+
+    // Index the output, so the position map uses its real byte offsets
+    av_close_input_file(m_inputFC);
+    m_inputFC = NULL;
+    m_frames.clear();
+    m_keyframes.clear();
+    m_display.clear();
+
+    QString infile = m_infile;
+    m_infile = m_outfile;
+    bool ok = InitInput(&m_inputFC);
+    m_infile = infile;
+    if (!ok)
+        return REENCODE_ERROR;
+
+    m_vidId = -1;
+    for (uint i = 0; i < m_inputFC->nb_streams && m_vidId < 0; i++)
+    {
+        if (m_inputFC->streams[i]->codec->codec_type == CODEC_TYPE_VIDEO)
+            m_vidId = i;
+    }
+
+    ret = BuildIndex(false);
+    if (ret != REENCODE_OK)
+        return ret;
+
+    int count = 0;
+    for (int i = 0; i < m_frames.size(); i++)
+    {
+        if (m_frames[i].secondField)
+            continue;
+        if (m_frames[i].keyframe)
+            m_posMap[count] = m_frames[i].pos;
+        count++;
+    }
+
+    if (update_status)
+        update_status(100);
+
+    return REENCODE_OK;
+}
+
+/** \fn H264SmartCut::CopyPackets(void)
+ *  \brief Reads the input again, copying the packets of the copied
+ *         pieces and the audio of the kept segments, and encodes each
+ *         re-encoded piece when the read position reaches it.
+ */
+int H264SmartCut::CopyPackets(void)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+
+    int     piece = 0;
+    int     vidx  = 0;
+    int64_t ref   = m_frames.first().dts;
+
+    while (true)
+    {
+        while (piece < m_pieces.size() && m_pieces[piece].encode)
+        {
+            if (!EncodePiece(m_pieces[piece++]))
+                return REENCODE_ERROR;
+        }
+
+        if (av_read_frame(m_inputFC, &pkt) < 0)
+            break;
+
+        if (!UpdateProgress(m_filesize / 5 + pkt.pos * 4 / 5))
+        {
+            av_free_packet(&pkt);
+            return REENCODE_STOPPED;
+        }
+
+        if (!m_streamMap.contains(pkt.stream_index))
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        if (pkt.stream_index != m_vidId)
+        {
+            int64_t pts = Unwrap(pkt.pts, ref);
+            int64_t dts = Unwrap(pkt.dts, ref);
+            if (dts == (int64_t) AV_NOPTS_VALUE)
+                dts = pts;
+
+            int seg = (pts == (int64_t) AV_NOPTS_VALUE) ? -1 : FindSegment(pts);
+            if (seg >= 0)
+            {
+                int64_t offset = m_segments[seg].offset;
+                if (!WritePacket(pkt, pts - offset, dts - offset))
+                {
+                    av_free_packet(&pkt);
+                    return REENCODE_ERROR;
+                }
+            }
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        // BuildIndex() leaves out packets it can't place in time, like
+        // the leading ones of a stream that starts without timestamps,
+        // so packets are matched to the index by their position
+        if (vidx >= m_frames.size() || m_frames[vidx].pos != pkt.pos)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+        int i = vidx++;
+        const h264cut_frame_t &frame = m_frames[i];
+        ref = frame.dts;
+        SaveParameterSets(pkt.data, pkt.size);
+
+        while (piece < m_pieces.size() && !m_pieces[piece].encode &&
+               i >= m_pieces[piece].last)
+        {
+            piece++;
+            while (piece < m_pieces.size() && m_pieces[piece].encode)
+            {
+                if (!EncodePiece(m_pieces[piece++]))
+                {
+                    av_free_packet(&pkt);
+                    return REENCODE_ERROR;
+                }
+            }
+        }
+
+        if (piece < m_pieces.size() && i >= m_pieces[piece].first &&
+            frame.pts >= m_pieces[piece].startPts)
+        {
+            int64_t offset = m_segments[m_pieces[piece].segment].offset;
+
+            if (m_restoreParamSets && !m_paramSets.isEmpty() &&
+                !HasParameterSets(pkt.data, pkt.size))
+            {
+                AVPacket sets;
+                av_init_packet(&sets);
+                sets.size = m_paramSets.size() + pkt.size;
+                sets.data = (uint8_t *) av_malloc(
+                    sets.size + FF_INPUT_BUFFER_PADDING_SIZE);
+                memcpy(sets.data, m_paramSets.constData(), m_paramSets.size());
+                memcpy(sets.data + m_paramSets.size(), pkt.data, pkt.size);
+                sets.stream_index = pkt.stream_index;
+
+                bool ok = WriteVideo(sets, frame.pts - offset,
+                                     frame.dts - offset, frame.keyframe);
+                av_free(sets.data);
+                if (!ok)
+                {
+                    av_free_packet(&pkt);
+                    return REENCODE_ERROR;
+                }
+            }
+            else if (!WriteVideo(pkt, frame.pts - offset, frame.dts - offset,
+                                 frame.keyframe))
+            {
+                av_free_packet(&pkt);
+                return REENCODE_ERROR;
+            }
+            m_restoreParamSets = false;
+        }
+        av_free_packet(&pkt);
+    }
+
+    for (; piece < m_pieces.size(); piece++)
+    {
+        if (m_pieces[piece].encode && !EncodePiece(m_pieces[piece]))
+            return REENCODE_ERROR;
+    }
+
+    return REENCODE_OK;
+}
+
+/** \fn H264SmartCut::SaveParameterSets(const uint8_t*, int)
+ *  \brief Remembers the most recent SPS and PPS NAL units of the input.
+ *
+ *  A copied GOP following a re-encoded piece needs the input's parameter
+ *  sets again, the encoder's parameter sets use the same ids.
+ */
+void H264SmartCut::SaveParameterSets(const uint8_t *data, int size)
+{
+    if (!HasParameterSets(data, size))
+        return;
+
+    QByteArray sets;
+    const uint8_t *end = data + size;
+    const uint8_t *p   = data;
+    while (p + 3 < end)
+    {
+        if (p[0] || p[1] || p[2] != 1)
+        {
+            p++;
+            continue;
+        }
+
+        const uint8_t *nal  = p + 3;
+        const uint8_t *next = nal;
+        while (next + 3 <= end && (next[0] || next[1] || next[2] != 1))
+            next++;
+        if (next + 3 > end)
+            next = end;
+
+        int type = nal[0] & 0x1f;
+        if (type == H264Parser::SPS || type == H264Parser::PPS)
+        {
+            sets.append("\x00\x00\x00\x01", 4);
+            const uint8_t *nal_end = next;
+            while (nal_end > nal && nal_end[-1] == 0 && nal_end < end)
+                nal_end--;
+            sets.append((const char *) nal, nal_end - nal);
+        }
+        p = next;
+    }
+
+    if (!sets.isEmpty() && sets.size() < MAX_PARAMSET_SIZE)
+        m_paramSets = sets;
+}
+
+bool H264SmartCut::HasParameterSets(const uint8_t *data, int size)
+{
+    for (int i = 0; i + 3 < size; i++)
+    {
+        if (!data[i] && !data[i + 1] && data[i + 2] == 1 &&
+            (data[i + 3] & 0x1f) == H264Parser::SPS)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \fn H264SmartCut::EncodePiece(const h264cut_piece_t&)
+ *  \brief Decodes the GOPs around the piece and re-encodes the frames
+ *         shown in [piece.startPts, piece.endPts).
+ */
+bool H264SmartCut::EncodePiece(const h264cut_piece_t &piece)
+{
+    int k = FindKeyframe(piece.startPts, true);
+    if (k < 0 || !m_encoder)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "Skipping undecodable frames");
+        return true;
+    }
+
+    if (!m_decodeFC && !InitInput(&m_decodeFC))
+        return false;
+
+    const h264cut_frame_t &key = m_frames[m_keyframes[k]];
+    if (av_seek_frame(m_decodeFC, m_vidId, key.pos, AVSEEK_FLAG_BYTE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't seek to %1").arg(key.pos));
+        return false;
+    }
+
+    AVCodecContext *dec = avcodec_alloc_context();
+    AVCodec *codec = avcodec_find_decoder(CODEC_ID_H264);
+    if (!dec || !codec || avcodec_open(dec, codec) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the H.264 decoder");
+        av_free(dec);
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Re-encoding %1 frames")
+            .arg((piece.endPts - piece.startPts) / m_frameDuration));
+
+    m_encodeOffset = m_segments[piece.segment].offset;
+
+    AVFrame *frame = avcodec_alloc_frame();
+    AVPacket pkt;
+    av_init_packet(&pkt);
+
+    bool    ok    = true;
+    bool    done  = false;
+    bool    eof   = false;
+    int64_t ref   = key.dts;
+
+    while (ok && !done)
+    {
+        if (!eof && av_read_frame(m_decodeFC, &pkt) < 0)
+        {
+            eof = true;
+            av_init_packet(&pkt);
+            pkt.data = NULL;
+            pkt.size = 0;
+        }
+        else if (!eof && pkt.stream_index != m_vidId)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        if (!eof)
+        {
+            int64_t pts = Unwrap(pkt.pts, ref);
+            ref = Unwrap(pkt.dts, ref);
+            if (ref == (int64_t) AV_NOPTS_VALUE)
+                ref = pts;
+            dec->reordered_opaque = pts;
+
+            // The frames needed can't be far behind the end of the piece
+            if (pts != (int64_t) AV_NOPTS_VALUE &&
+                pts > piece.endPts + 10 * 90000)
+            {
+                done = true;
+            }
+        }
+
+        int got_picture = 0;
+        if (avcodec_decode_video2(dec, frame, &got_picture, &pkt) < 0 && eof)
+            done = true;
+        if (!eof)
+            av_free_packet(&pkt);
+        else if (!got_picture)
+            done = true;
+
+        if (!got_picture)
+            continue;
+
+        int64_t pts = frame->reordered_opaque;
+        if (pts == (int64_t) AV_NOPTS_VALUE || pts < piece.startPts)
+            continue;
+        if (pts >= piece.endPts)
+        {
+            done = true;
+            continue;
+        }
+
+        if (!m_encodeCtx && !InitEncoder(frame))
+            ok = false;
+        else
+            ok = EncodeFrame(frame, pts);
+    }
+
+    // Flush the encoder's delayed frames
+    while (ok && m_encodeCtx)
+    {
+        int size = avcodec_encode_video(m_encodeCtx, m_encodeBuf,
+                                        m_encodeBufSize, NULL);
+        if (size <= 0)
+            break;
+        ok = WriteEncoded(size);
+    }
+
+    CloseEncoder();
+    av_free(frame);
+    avcodec_close(dec);
+    av_free(dec);
+
+    m_restoreParamSets = true;
+    return ok;
+}
+
+/** \fn H264SmartCut::InitEncoder(AVFrame*)
+ *  \brief Opens the H.264 encoder for frames like frame.
+ *
+ *  B-frames are disabled, so encoded frames come out in display order
+ *  and their timestamps only need the input's reorder delay.
+ */
+bool H264SmartCut::InitEncoder(AVFrame *frame)
+{
+    AVCodecContext *ic = m_inputFC->streams[m_vidId]->codec;
+
+    m_encodeCtx = avcodec_alloc_context();
+    if (!m_encodeCtx)
+        return false;
+
+    AVCodecContext *c = m_encodeCtx;
+    c->codec_type          = CODEC_TYPE_VIDEO;
+    c->codec_id            = CODEC_ID_H264;
+    c->pix_fmt             = PIX_FMT_YUV420P;
+    c->width               = ic->width;
+    c->height              = ic->height;
+    c->sample_aspect_ratio = ic->sample_aspect_ratio;
+    c->time_base.num       = m_frameDuration;
+    c->time_base.den       = 90000;
+    c->gop_size            = 250;
+    c->keyint_min          = 25;
+    c->max_b_frames        = 0;
+    c->crf                 = ENCODE_CRF;
+    c->qmin                = 10;
+    c->qmax                = 51;
+    c->max_qdiff           = 4;
+    c->qcompress           = 0.6f;
+    c->qblur               = 0.5f;
+    c->complexityblur      = 20.0f;
+    c->i_quant_factor      = 0.71f;
+    c->refs                = 3;
+    c->me_method           = ME_HEX;
+    c->me_range            = 16;
+    c->me_subpel_quality   = 7;
+    c->me_cmp             |= FF_CMP_CHROMA;
+    c->trellis             = 1;
+    c->directpred          = 1;
+    c->aq_mode             = 1;
+    c->aq_strength         = 1.0f;
+    c->psy_rd              = 1.0f;
+    c->rc_lookahead        = 10;
+    c->scenechange_threshold = 40;
+    c->coder_type          = FF_CODER_TYPE_AC;
+    c->partitions          = X264_PART_I4X4 | X264_PART_I8X8 |
+                             X264_PART_P8X8;
+    c->flags              |= CODEC_FLAG_LOOP_FILTER;
+    c->flags2             |= CODEC_FLAG2_8X8DCT | CODEC_FLAG2_MIXED_REFS |
+                             CODEC_FLAG2_FASTPSKIP | CODEC_FLAG2_PSY;
+    if (frame->interlaced_frame)
+        c->flags          |= CODEC_FLAG_INTERLACED_DCT;
+    c->thread_count        = 1;
+
+    if (avcodec_open(c, m_encoder) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the H.264 encoder");
+        av_free(m_encodeCtx);
+        m_encodeCtx = NULL;
+        return false;
+    }
+
+    m_encodeBufSize = max(c->width * c->height * 4, 1024 * 1024);
+    m_encodeBuf = (uint8_t *) av_malloc(m_encodeBufSize);
+    m_encodedFrames = 0;
+    m_encodePts.clear();
+
+    return m_encodeBuf;
+}
+
+void H264SmartCut::CloseEncoder(void)
+{
+    if (m_encodeCtx)
+    {
+        avcodec_close(m_encodeCtx);
+        av_free(m_encodeCtx);
+        m_encodeCtx = NULL;
+    }
+    av_free(m_encodeBuf);
+    m_encodeBuf = NULL;
+    m_encodePts.clear();
+}
+
+bool H264SmartCut::EncodeFrame(AVFrame *frame, int64_t pts)
+{
+    AVFrame picture;
+    avcodec_get_frame_defaults(&picture);
+    for (int i = 0; i < 3; i++)
+    {
+        picture.data[i]     = frame->data[i];
+        picture.linesize[i] = frame->linesize[i];
+    }
+    picture.interlaced_frame = frame->interlaced_frame;
+    picture.top_field_first  = frame->top_field_first;
+    picture.pts       = m_encodedFrames;
+    picture.pict_type = m_encodedFrames ? 0 : FF_I_TYPE;
+    m_encodedFrames++;
+
+    m_encodePts.enqueue(pts);
+
+    int size = avcodec_encode_video(m_encodeCtx, m_encodeBuf,
+                                    m_encodeBufSize, &picture);
+    if (size < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Encoding failed");
+        return false;
+    }
+
+    return !size || WriteEncoded(size);
+}
+
+bool H264SmartCut::WriteEncoded(int size)
+{
+    if (m_encodePts.isEmpty())
+        return false;
+
+    int64_t pts = m_encodePts.dequeue() - m_encodeOffset;
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data         = m_encodeBuf;
+    pkt.size         = size;
+    pkt.stream_index = m_vidId;
+
+    bool key = m_encodeCtx->coded_frame &&
+               m_encodeCtx->coded_frame->key_frame;
+    return WriteVideo(pkt, pts, pts - m_reorderDelay, key);
+}
+
+/// \brief Writes a video packet, keeping its decode timestamps increasing.
+bool H264SmartCut::WriteVideo(AVPacket &pkt, int64_t pts, int64_t dts,
+                              bool keyframe)
+{
+    if (m_lastVideoDts != (int64_t) AV_NOPTS_VALUE && dts <= m_lastVideoDts)
+        dts = m_lastVideoDts + 1;
+    pts = max(pts, dts);
+    m_lastVideoDts = dts;
+
+    if (keyframe)
+        pkt.flags |= PKT_FLAG_KEY;
+    else
+        pkt.flags &= ~PKT_FLAG_KEY;
+
+    return WritePacket(pkt, pts, dts);
+}
+
+bool H264SmartCut::WritePacket(AVPacket &pkt, int64_t pts, int64_t dts)
+{
+    AVPacket out = pkt;
+    AVStream *ist = m_inputFC->streams[pkt.stream_index];
+    AVStream *ost = m_outputFC->streams[m_streamMap[pkt.stream_index]];
+
+    // Output timestamps start at zero, but never wrap
+    pts = (pts < 0) ? 0 : pts % PTS_WRAP;
+    dts = (dts < 0) ? 0 : dts % PTS_WRAP;
+
+    out.stream_index = ost->index;
+    out.pts = av_rescale_q(pts, ist->time_base, ost->time_base);
+    out.dts = av_rescale_q(dts, ist->time_base, ost->time_base);
+    out.pos = -1;
+    out.destruct = NULL;
+
+    int ret = av_interleaved_write_frame(m_outputFC, &out);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Error writing packet, error #%1").arg(ret));
+        return false;
+    }
+    return true;
+}
+
+/// \brief Reports progress, returns false if the job was stopped.
+bool H264SmartCut::UpdateProgress(int64_t pos)
+{
+    if ((!m_showprogress && !update_status) || !m_filesize ||
+        QDateTime::currentDateTime() <= m_statustime)
+    {
+        return true;
+    }
+
+    float percent_done = 100.0 * pos / m_filesize;
+    if (update_status)
+        update_status(percent_done);
+    if (m_showprogress)
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                .arg(percent_done, 0, 'f', 1));
+    if (check_abort && check_abort())
+        return false;
+
+    m_statustime = QDateTime::currentDateTime();
+    m_statustime = m_statustime.addSecs(m_statusUpdateTime);
+    return true;
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -0,0 +1,144 @@
+#ifndef H264SMARTCUT_H
+#define H264SMARTCUT_H
+
+extern "C"
+{
+//AVFormat/AVCodec
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+//Qt
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+#include <QQueue>
+#include <QList>
+#include <QMap>
+
+// MythTV
+#include "transcodedefs.h"
+#include "programtypes.h"
+
+class H264Parser;
+
+/// One video packet of the input, in decode order
+typedef struct {
+    int64_t pts;          ///< unwrapped 90kHz timestamps
+    int64_t dts;
+    int64_t pos;          ///< byte position of the packet in the input
+    bool    keyframe;     ///< IDR, or I frame recovery point
+    bool    secondField;  ///< second field of the preceding packet
+} h264cut_frame_t;
+
+/// Part of a kept segment that is either copied or re-encoded
+typedef struct {
+    bool    encode;
+    int64_t startPts;     ///< display range [startPts, endPts)
+    int64_t endPts;
+    int     first;        ///< decode order packet range [first, last)
+    int     last;         ///< of a copied piece
+    int     segment;
+} h264cut_piece_t;
+
+/// A kept range of the input and its timestamp offset in the output
+typedef struct {
+    int64_t startPts;
+    int64_t endPts;
+    int64_t offset;
+} h264cut_segment_t;
+
+/** \class H264SmartCut
+ *  \brief Applies a cutlist to an H.264 transport stream without
+ *         re-encoding the whole recording.
+ *
+ *  Complete GOPs are copied packet for packet. Only the partial GOPs at
+ *  the cut boundaries are decoded and re-encoded, when an H.264 encoder
+ *  is available. Without one the cuts are moved outward to the nearest
+ *  keyframes. Audio packets are copied when they fall into a kept
+ *  range. Timestamps are made continuous across the cuts and the
+ *  transport stream is remultiplexed, which also restarts the
+ *  continuity counters.
+ */
+class H264SmartCut
+{
+  public:
+    H264SmartCut(const QString &inf, const QString &outf,
+                 frm_dir_map_t *deleteMap, bool showprog,
+                 void (*update_func)(float) = NULL,
+                 int (*check_func)() = NULL);
+    ~H264SmartCut();
+
+    int Start(void);
+
+    /// \brief Keyframe positions of the output, by video frame number.
+    const frm_pos_map_t &GetPositionMap(void) const { return m_posMap; }
+
+  private:
+    bool InitInput(AVFormatContext **fc);
+    bool InitOutput(void);
+    void CloseOutput(void);
+    bool InitEncoder(AVFrame *frame);
+    void CloseEncoder(void);
+    int  BuildIndex(bool report);
+    bool BuildPieces(void);
+    int  FindKeyframe(int64_t pts, bool before) const;
+    int64_t DisplayPts(long long frame) const;
+    int  FindSegment(int64_t pts) const;
+    int  CopyPackets(void);
+    bool EncodePiece(const h264cut_piece_t &piece);
+    bool EncodeFrame(AVFrame *frame, int64_t pts);
+    bool WriteEncoded(int size);
+    bool WriteVideo(AVPacket &pkt, int64_t pts, int64_t dts, bool keyframe);
+    bool WritePacket(AVPacket &pkt, int64_t pts, int64_t dts);
+    bool UpdateProgress(int64_t pos);
+    void SaveParameterSets(const uint8_t *data, int size);
+    static bool HasParameterSets(const uint8_t *data, int size);
+    static int64_t Unwrap(int64_t ts, int64_t ref);
+
+    QString            m_infile;
+    QString            m_outfile;
+    frm_dir_map_t      m_delMap;
+
+    AVFormatContext   *m_inputFC;
+    AVFormatContext   *m_decodeFC;
+    AVFormatContext   *m_outputFC;
+    int                m_vidId;
+    QMap<int, int>     m_streamMap;   ///< input to output stream index
+    H264Parser        *m_parser;
+
+    QVector<h264cut_frame_t>   m_frames;
+    QVector<int>               m_display; ///< frame number to m_frames index
+    QVector<int>               m_keyframes;
+    QList<h264cut_piece_t>     m_pieces;
+    QList<h264cut_segment_t>   m_segments;
+    int64_t            m_frameDuration;
+    int64_t            m_reorderDelay;
+
+    AVCodec           *m_encoder;
+    AVCodecContext    *m_encodeCtx;
+    uint8_t           *m_encodeBuf;
+    int                m_encodeBufSize;
+    int                m_encodedFrames;
+    QQueue<int64_t>    m_encodePts;
+    int64_t            m_encodeOffset;
+    bool               m_restoreParamSets;
+    QByteArray         m_paramSets;
+
+    int64_t            m_lastVideoDts;
+    int                m_outFrames;
+    frm_pos_map_t      m_posMap;
+
+    int              (*check_abort)();
+    void             (*update_status)(float percent_done);
+    bool               m_showprogress;
+    QDateTime          m_statustime;
+    int                m_statusUpdateTime;
+    uint64_t           m_filesize;
+};
+
+#endif // H264SMARTCUT_H
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -21,6 +21,7 @@ using namespace std;
 #include "util.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "h264smartcut.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "mythlogging.h"
@@ -551,6 +552,31 @@ int main(int argc, char *argv[])
         }
         delete m2f;
     }
+    else if (result == REENCODE_H264TRANS)
+    {
+        void (*update_func)(float) = NULL;
+        int (*check_func)() = NULL;
+        if (useCutlist && !found_infile)
+            pginfo->QueryCutList(deleteMap);
+        if (jobID >= 0)
+        {
+           glbl_jobID = jobID;
+           update_func = &UpdateJobQueue;
+           check_func = &CheckJobQueue;
+        }
+
+        H264SmartCut cutter(infile, outfile, &deleteMap, showprogress,
+                            update_func, check_func);
+        result = cutter.Start();
+        if (result == REENCODE_OK)
+        {
+            posMap = cutter.GetPositionMap();
+            if (update_index)
+                UpdatePositionMap(posMap, NULL, pginfo);
+            else
+                UpdatePositionMap(posMap, outfile + QString(".map"), pginfo);
+        }
+    }
 
     if (result == REENCODE_OK)
     {
@@ -57,7 +57,7 @@ static void *my_malloc(unsigned size, mpeg2_alloc_t reason)
     return NULL;
 }
 
-static void my_av_print(void *ptr, int level, const char* fmt, va_list vl)
+void my_av_print(void *ptr, int level, const char* fmt, va_list vl)
 {
     (void) ptr;
 
@@ -66,7 +66,7 @@ static void my_av_print(void *ptr, int level, const char* fmt, va_list vl)
 
     if (level > AV_LOG_INFO)
         return;
-    vsprintf(str, fmt, vl);
+    vsnprintf(str, sizeof(str), fmt, vl);
 
     full_line += QString(str);
     if (full_line.endsWith("\n"))
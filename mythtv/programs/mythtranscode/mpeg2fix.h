@@ -3,6 +3,7 @@
 
 // C
 #include <cstdlib>
+#include <cstdarg>
 
 extern "C"
 {
@@ -39,6 +40,9 @@ enum MPFListType {
     MPF_TYPE_SAVELIST,
 };
 
+/// av_log callback passing complete lines on to LOG()
+void my_av_print(void *ptr, int level, const char* fmt, va_list vl);
+
 class MPEG2frame
 {
   public:
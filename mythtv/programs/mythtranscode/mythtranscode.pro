@@ -13,11 +13,13 @@ QMAKE_CLEAN += $(TARGET)
 QMAKE_CFLAGS += -w
 
 # Input
-SOURCES += main.cpp transcode.cpp mpeg2fix.cpp helper.c
+SOURCES += main.cpp transcode.cpp transcodepipeline.cpp mpeg2fix.cpp
+SOURCES += h264smartcut.cpp helper.c
 SOURCES += commandlineparser.cpp
 SOURCES += replex/element.c replex/mpg_common.c replex/multiplex.c \
            replex/pes.c     replex/ringbuffer.c replex/ts.c
-HEADERS += mpeg2fix.h transcodedefs.h commandlineparser.h
+HEADERS += transcodepipeline.h mpeg2fix.h h264smartcut.h transcodedefs.h
+HEADERS += commandlineparser.h
 HEADERS += replex/element.h replex/mpg_common.h replex/multiplex.h \
            replex/pes.h     replex/ringbuffer.h replex/ts.h
 
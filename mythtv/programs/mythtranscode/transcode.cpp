@@ -16,6 +16,7 @@
 #include "exitcodes.h"
 
 #include "NuppelVideoRecorder.h"
+#include "transcodepipeline.h"
 #include "mythplayer.h"
 #include "programinfo.h"
 #include "mythdbcon.h"
@@ -375,6 +376,13 @@ static void TranscodeWriteText(void *ptr, unsigned char *buf, int len,
   nvr->WriteText(buf, len, timecode, pagenr);
 }
 
+static void TranscodePipelineWriteText(void *ptr, unsigned char *buf, int len,
+                                       int timecode, int pagenr)
+{
+  TranscodePipeline *pipeline = (TranscodePipeline *)ptr;
+  pipeline->PushText(buf, len, timecode, pagenr);
+}
+
 int Transcode::TranscodeFile(const QString &inputname,
                              const QString &outputname,
                              const QString &profileName,
@@ -550,6 +558,15 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_MPEG2TRANS;
         }
 
+        if (encodingType == "H.264" &&
+            get_int_option(profile, "transcodelossless"))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, "Switching to H.264 smart cut.");
+            if (player_ctx)
+                delete player_ctx;
+            return REENCODE_H264TRANS;
+        }
+
         // Recorder setup
         if (get_int_option(profile, "transcodelossless"))
         {
@@ -875,6 +892,7 @@ int Transcode::TranscodeFile(const QString &inputname,
     frame.buf = newFrame;
     AVPicture imageIn, imageOut;
     struct SwsContext  *scontext = NULL;
+    TranscodePipeline  *pipeline = NULL;
 
     if (fifow)
         LOG(VB_GENERAL, LOG_INFO, "Dumping Video and Audio data to fifos");
@@ -1097,6 +1115,13 @@ int Transcode::TranscodeFile(const QString &inputname,
         }
         else
         {
+            if (!pipeline)
+            {
+                pipeline = new TranscodePipeline(nvr, newWidth, newHeight,
+                                                 forceKeyFrames);
+                pipeline->Start();
+            }
+
             if (did_ff == 1)
             {
                 did_ff = 2;
@@ -1107,7 +1132,7 @@ int Transcode::TranscodeFile(const QString &inputname,
             if (video_aspect != new_aspect)
             {
                 video_aspect = new_aspect;
-                nvr->SetNewVideoParams(video_aspect);
+                pipeline->PushAspect(video_aspect);
             }
 
 
@@ -1125,65 +1150,40 @@ int Transcode::TranscodeFile(const QString &inputname,
                         .arg(newWidth).arg(newHeight));
             }
 
-            if ((video_width == newWidth) && (video_height == newHeight))
-            {
-                frame.buf = lastDecode->buf;
-            }
-            else
-            {
-                frame.buf = newFrame;
-                avpicture_fill(&imageIn, lastDecode->buf, PIX_FMT_YUV420P,
-                               video_width, video_height);
-                avpicture_fill(&imageOut, frame.buf, PIX_FMT_YUV420P,
-                               newWidth, newHeight);
-
-                int bottomBand = (video_height == 1088) ? 8 : 0;
-                scontext = sws_getCachedContext(scontext, video_width,
-                               video_height, PIX_FMT_YUV420P, newWidth,
-                               newHeight, PIX_FMT_YUV420P,
-                               SWS_FAST_BILINEAR, NULL, NULL, NULL);
-
-                sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
-                          video_height - bottomBand,
-                          imageOut.data, imageOut.linesize);
-            }
-
             // audio is fully decoded, so we need to reencode it
             audioframesize = arb->audiobuffer_len;
             if (arb->ab_count)
             {
                 for (int loop = 0; loop < arb->ab_count; loop++)
                 {
-                    nvr->SetOption("audioframesize", arb->ab_len[loop]);
-                    nvr->WriteAudio(arb->audiobuffer + arb->ab_offset[loop],
-                                    audioFrame++,
-                                    arb->ab_time[loop] - timecodeOffset);
-                    if (nvr->IsErrored())
-                    {
-                        LOG(VB_GENERAL, LOG_ERR,
-                            "Transcode: Encountered irrecoverable error in "
-                            "NVR::WriteAudio");
-
-                        delete [] newFrame;
-                        if (player_ctx)
-                            delete player_ctx;
-                        return REENCODE_ERROR;
-                    }
+                    pipeline->PushAudio(arb->audiobuffer + arb->ab_offset[loop],
+                                        arb->ab_len[loop], audioFrame++,
+                                        arb->ab_time[loop] - timecodeOffset);
                 }
                 arb->ab_count = 0;
                 arb->audiobuffer_len = 0;
             }
 
-            player->GetCC608Reader()->TranscodeWriteText(&TranscodeWriteText,
-                                                   (void *)(nvr));
+            player->GetCC608Reader()->TranscodeWriteText(
+                &TranscodePipelineWriteText, (void *)(pipeline));
 
             lasttimecode = frame.timecode;
             frame.timecode -= timecodeOffset;
 
-            if (forceKeyFrames)
-                nvr->WriteVideo(&frame, true, true);
-            else
-                nvr->WriteVideo(&frame);
+            // Scaling and encoding run on the pipeline's threads
+            if (!pipeline->PushVideo(lastDecode->buf, video_width,
+                                     video_height, frame.timecode))
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    "Transcode: Encountered irrecoverable error in "
+                    "the encoding pipeline");
+
+                delete pipeline;
+                delete [] newFrame;
+                if (player_ctx)
+                    delete player_ctx;
+                return REENCODE_ERROR;
+            }
         }
         if (showprogress && QDateTime::currentDateTime() > statustime)
         {
@@ -1203,6 +1203,7 @@ int Transcode::TranscodeFile(const QString &inputname,
                     "Transcoding aborted, cutlist updated");
 
                 unlink(outputname.toLocal8Bit().constData());
+                delete pipeline;
                 delete [] newFrame;
                 if (player_ctx)
                     delete player_ctx;
@@ -1217,6 +1218,7 @@ int Transcode::TranscodeFile(const QString &inputname,
                         "Transcoding STOPped by JobQueue");
 
                     unlink(outputname.toLocal8Bit().constData());
+                    delete pipeline;
                     delete [] newFrame;
                     if (player_ctx)
                         delete player_ctx;
@@ -1250,6 +1252,20 @@ int Transcode::TranscodeFile(const QString &inputname,
 
     sws_freeContext(scontext);
 
+    if (pipeline)
+    {
+        bool ok = pipeline->Finish();
+        delete pipeline;
+        if (!ok)
+        {
+            LOG(VB_GENERAL, LOG_ERR, "Transcoding aborted, encoding failed");
+            delete [] newFrame;
+            if (player_ctx)
+                delete player_ctx;
+            return REENCODE_ERROR;
+        }
+    }
+
     if (! fifow)
     {
         if (m_proginfo)
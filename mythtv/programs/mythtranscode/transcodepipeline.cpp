@@ -0,0 +1,385 @@
+#include <sys/time.h>
+#include <cstring>
+
+#include "transcodepipeline.h"
+#include "NuppelVideoRecorder.h"
+#include "mythlogging.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libswscale/swscale.h"
+}
+
+using namespace std;
+
+#define LOC QString("TranscodePipeline: ")
+
+/// Upper bound of the audio packets a decoded frame comes with, times
+/// the pipeline depth. The decoder never blocks on this queue.
+#define MAX_PACKETS 4096
+
+static int64_t now_usecs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/// Accepts the packets which have to be written before frame seq
+class PacketBefore
+{
+  public:
+    explicit PacketBefore(uint64_t seq) : m_seq(seq) {}
+    bool operator()(const PipelinePacket &pkt) const
+        { return pkt.seq <= m_seq; }
+  private:
+    uint64_t m_seq;
+};
+
+QString PipelineStageStats::toString(const QString &name) const
+{
+    double busysecs = busy / 1000000.0;
+    int64_t total   = busy + waiting;
+    return QString("%1 stage: %2 frames, %3 fps while busy, %4% waiting")
+        .arg(name).arg(frames)
+        .arg(busysecs > 0.0 ? frames / busysecs : 0.0, 0, 'f', 1)
+        .arg(total ? (int) (waiting * 100 / total) : 0);
+}
+
+void PipelineThread::run(void)
+{
+    RunProlog();
+    (m_parent->*m_loop)();
+    RunEpilog();
+}
+
+TranscodePipeline::TranscodePipeline(NuppelVideoRecorder *nvr,
+                                     int outWidth, int outHeight,
+                                     bool forceKeyFrames, int depth) :
+    m_nvr(nvr),
+    m_outWidth(outWidth),            m_outHeight(outHeight),
+    m_forceKeyFrames(forceKeyFrames),
+    m_started(false),                m_errored(false),
+    m_seq(0),                        m_lastPush(0),
+    m_scontext(NULL),
+    m_freeQueue("free", depth),      m_scaleQueue("scale", depth),
+    m_encodeQueue("encode", depth),  m_packetQueue("audio", MAX_PACKETS),
+    m_audioPackets(0),
+    m_scaleThread(NULL),             m_encodeThread(NULL)
+{
+    for (int i = 0; i < depth; i++)
+    {
+        m_frames.push_back(new PipelineFrame());
+        m_freeQueue.Push(m_frames.back());
+    }
+}
+
+TranscodePipeline::~TranscodePipeline()
+{
+    Abort();
+
+    while (!m_frames.isEmpty())
+        delete m_frames.takeFirst();
+
+    if (m_scontext)
+        sws_freeContext(m_scontext);
+}
+
+void TranscodePipeline::Start(void)
+{
+    m_scaleThread  = new PipelineThread("TranscodeScale", this,
+                                        &TranscodePipeline::ScaleLoop);
+    m_encodeThread = new PipelineThread("TranscodeEncode", this,
+                                        &TranscodePipeline::EncodeLoop);
+    m_scaleThread->start();
+    m_encodeThread->start();
+    m_started = true;
+    m_lastPush = now_usecs();
+}
+
+/** \fn TranscodePipeline::PushVideo(const unsigned char*, int, int, long long)
+ *  \brief Copies a decoded YV12 frame into the pipeline, blocking while
+ *         every frame of the pipeline is in use.
+ *  \return false if the pipeline failed.
+ */
+bool TranscodePipeline::PushVideo(const unsigned char *buf, int width,
+                                  int height, long long timecode)
+{
+    // Everything since the last push was spent decoding
+    int64_t start = now_usecs();
+    m_decodeStats.busy += start - m_lastPush;
+
+    PipelineFrame *frame = NULL;
+    if (m_errored || !m_freeQueue.Pop(frame))
+        return false;
+
+    int64_t got = now_usecs();
+    m_decodeStats.waiting += got - start;
+
+    int size = width * height * 3 / 2;
+    if (frame->rawSize < size)
+    {
+        delete [] frame->raw;
+        frame->raw = new unsigned char[size];
+        frame->rawSize = size;
+    }
+    memcpy(frame->raw, buf, size);
+    frame->width    = width;
+    frame->height   = height;
+    frame->timecode = timecode;
+    frame->seq      = m_seq++;
+
+    int64_t copied = now_usecs();
+    m_decodeStats.busy += copied - got;
+
+    bool ok = m_scaleQueue.Push(frame);
+
+    m_lastPush = now_usecs();
+    m_decodeStats.waiting += m_lastPush - copied;
+    m_decodeStats.frames++;
+
+    return ok && !m_errored;
+}
+
+/// \brief Queues audio to be written before the next video frame.
+void TranscodePipeline::PushAudio(const unsigned char *buf, int len,
+                                  int audioframe, long long timecode)
+{
+    PipelinePacket pkt;
+    pkt.type     = PipelinePacket::kAudio;
+    pkt.data     = QByteArray((const char *) buf, len);
+    pkt.number   = audioframe;
+    pkt.timecode = timecode;
+    pkt.aspect   = 0.0f;
+    pkt.seq      = m_seq;
+    m_packetQueue.Push(pkt);
+}
+
+/// \brief Queues a caption packet to be written before the next video frame.
+void TranscodePipeline::PushText(const unsigned char *buf, int len,
+                                 int timecode, int pagenr)
+{
+    PipelinePacket pkt;
+    pkt.type     = PipelinePacket::kText;
+    pkt.data     = QByteArray((const char *) buf, len);
+    pkt.number   = pagenr;
+    pkt.timecode = timecode;
+    pkt.aspect   = 0.0f;
+    pkt.seq      = m_seq;
+    m_packetQueue.Push(pkt);
+}
+
+/// \brief Queues an aspect ratio change for the next video frame.
+void TranscodePipeline::PushAspect(float aspect)
+{
+    PipelinePacket pkt;
+    pkt.type     = PipelinePacket::kAspect;
+    pkt.number   = 0;
+    pkt.timecode = 0;
+    pkt.aspect   = aspect;
+    pkt.seq      = m_seq;
+    m_packetQueue.Push(pkt);
+}
+
+void TranscodePipeline::ScaleLoop(void)
+{
+    PipelineFrame *frame = NULL;
+    int64_t start = now_usecs();
+
+    while (m_scaleQueue.Pop(frame))
+    {
+        int64_t got = now_usecs();
+        m_scaleStats.waiting += got - start;
+
+        if (frame->width == m_outWidth && frame->height == m_outHeight)
+        {
+            frame->out = frame->raw;
+        }
+        else
+        {
+            int size = m_outWidth * m_outHeight * 3 / 2;
+            if (frame->scaledSize < size)
+            {
+                delete [] frame->scaled;
+                frame->scaled = new unsigned char[size];
+                frame->scaledSize = size;
+            }
+
+            AVPicture imageIn, imageOut;
+            avpicture_fill(&imageIn, frame->raw, PIX_FMT_YUV420P,
+                           frame->width, frame->height);
+            avpicture_fill(&imageOut, frame->scaled, PIX_FMT_YUV420P,
+                           m_outWidth, m_outHeight);
+
+            int bottomBand = (frame->height == 1088) ? 8 : 0;
+            m_scontext = sws_getCachedContext(m_scontext, frame->width,
+                           frame->height, PIX_FMT_YUV420P, m_outWidth,
+                           m_outHeight, PIX_FMT_YUV420P,
+                           SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+            sws_scale(m_scontext, imageIn.data, imageIn.linesize, 0,
+                      frame->height - bottomBand,
+                      imageOut.data, imageOut.linesize);
+            frame->out = frame->scaled;
+        }
+
+        int64_t done = now_usecs();
+        m_scaleStats.busy += done - got;
+        m_scaleStats.frames++;
+
+        if (!m_encodeQueue.Push(frame))
+            break;
+
+        start = now_usecs();
+        m_scaleStats.waiting += start - done;
+    }
+
+    m_encodeQueue.Close();
+}
+
+/** \fn TranscodePipeline::WritePackets(uint64_t)
+ *  \brief Writes the queued audio, captions and aspect changes which
+ *         preceded video frame seq.
+ */
+bool TranscodePipeline::WritePackets(uint64_t seq)
+{
+    PipelinePacket pkt;
+    while (m_packetQueue.PopIf(pkt, PacketBefore(seq)))
+    {
+        switch (pkt.type)
+        {
+            case PipelinePacket::kAudio:
+                m_nvr->SetOption("audioframesize", pkt.data.size());
+                m_nvr->WriteAudio((unsigned char *) pkt.data.data(),
+                                  pkt.number, pkt.timecode);
+                if (m_nvr->IsErrored())
+                {
+                    LOG(VB_GENERAL, LOG_ERR, LOC + "Encountered "
+                        "irrecoverable error in NVR::WriteAudio");
+                    return false;
+                }
+                m_audioPackets++;
+                break;
+            case PipelinePacket::kText:
+                m_nvr->WriteText((unsigned char *) pkt.data.data(),
+                                 pkt.data.size(), pkt.timecode, pkt.number);
+                break;
+            case PipelinePacket::kAspect:
+                m_nvr->SetNewVideoParams(pkt.aspect);
+                break;
+        }
+    }
+    return true;
+}
+
+void TranscodePipeline::EncodeLoop(void)
+{
+    PipelineFrame *frame = NULL;
+    int64_t start = now_usecs();
+
+    VideoFrame vframe;
+    memset(&vframe, 0, sizeof(vframe));
+    vframe.codec  = FMT_YV12;
+    vframe.width  = m_outWidth;
+    vframe.height = m_outHeight;
+    vframe.size   = m_outWidth * m_outHeight * 3 / 2;
+
+    while (!m_errored && m_encodeQueue.Pop(frame))
+    {
+        int64_t got = now_usecs();
+        m_encodeStats.waiting += got - start;
+
+        if (!WritePackets(frame->seq))
+        {
+            m_errored = true;
+            m_freeQueue.Push(frame);
+            break;
+        }
+
+        vframe.buf         = frame->out;
+        vframe.timecode    = frame->timecode;
+        vframe.frameNumber = 1 + (frame->seq << 1);
+
+        if (m_forceKeyFrames)
+            m_nvr->WriteVideo(&vframe, true, true);
+        else
+            m_nvr->WriteVideo(&vframe);
+
+        int64_t done = now_usecs();
+        m_encodeStats.busy += done - got;
+        m_encodeStats.frames++;
+
+        m_freeQueue.Push(frame);
+        start = now_usecs();
+    }
+
+    // Audio which arrived after the last video frame
+    if (!m_errored && !WritePackets(m_seq))
+        m_errored = true;
+
+    // Wake everything still waiting on the pipeline, including a decoder
+    // blocked pushing audio into a full packet queue
+    if (m_errored)
+    {
+        m_scaleQueue.Close();
+        m_encodeQueue.Close();
+        m_freeQueue.Close();
+        m_packetQueue.Close();
+    }
+}
+
+/** \fn TranscodePipeline::Finish(void)
+ *  \brief Waits until every queued frame and packet has been written.
+ *  \return false if the pipeline failed.
+ */
+bool TranscodePipeline::Finish(void)
+{
+    m_decodeStats.busy += now_usecs() - m_lastPush;
+
+    m_scaleQueue.Close();
+    delete m_scaleThread;
+    m_scaleThread = NULL;
+    delete m_encodeThread;
+    m_encodeThread = NULL;
+    m_packetQueue.Close();
+    m_started = false;
+
+    LogStats();
+    return !m_errored;
+}
+
+/// \brief Stops the pipeline, frames not yet encoded are dropped.
+void TranscodePipeline::Abort(void)
+{
+    if (!m_started)
+        return;
+
+    m_errored = true;
+    m_freeQueue.Close();
+    m_scaleQueue.Close();
+    m_encodeQueue.Close();
+    m_packetQueue.Close();
+    delete m_scaleThread;
+    m_scaleThread = NULL;
+    delete m_encodeThread;
+    m_encodeThread = NULL;
+    m_started = false;
+}
+
+bool TranscodePipeline::IsErrored(void) const
+{
+    return m_errored;
+}
+
+void TranscodePipeline::LogStats(void) const
+{
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_decodeStats.toString("Decode"));
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_scaleStats.toString("Scale"));
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_encodeStats.toString("Encode") +
+        QString(", %1 audio packets").arg(m_audioPackets));
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_scaleQueue.GetStats());
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_encodeQueue.GetStats());
+    LOG(VB_GENERAL, LOG_INFO, LOC + m_packetQueue.GetStats());
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,232 @@
+#ifndef TRANSCODEPIPELINE_H
+#define TRANSCODEPIPELINE_H
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QString>
+#include <QQueue>
+#include <QMutex>
+#include <QList>
+
+#include "mthread.h"
+
+struct SwsContext;
+class NuppelVideoRecorder;
+class TranscodePipeline;
+
+/// A video frame on its way through the pipeline
+class PipelineFrame
+{
+  public:
+    PipelineFrame() :
+        raw(NULL), rawSize(0), scaled(NULL), scaledSize(0), out(NULL),
+        width(0), height(0), timecode(0), seq(0) {}
+    ~PipelineFrame() { delete [] raw; delete [] scaled; }
+
+    unsigned char *raw;       ///< copy of the decoded frame
+    int            rawSize;
+    unsigned char *scaled;    ///< raw scaled to the output size
+    int            scaledSize;
+    unsigned char *out;       ///< raw or scaled, whichever is encoded
+    int            width;     ///< size of raw
+    int            height;
+    long long      timecode;
+    uint64_t       seq;
+};
+
+/// Audio, caption and aspect changes, written before video frame seq
+class PipelinePacket
+{
+  public:
+    enum PacketType { kAudio, kText, kAspect };
+
+    PacketType     type;
+    QByteArray     data;
+    int            number;    ///< audio frame number or teletext page
+    long long      timecode;
+    float          aspect;
+    uint64_t       seq;
+};
+
+/** \class PipelineQueue
+ *  \brief Bounded queue between two pipeline stages which keeps
+ *         occupancy statistics.
+ */
+template <typename T>
+class PipelineQueue
+{
+  public:
+    PipelineQueue(const QString &name, int capacity) :
+        m_name(name), m_capacity(capacity), m_closed(false),
+        m_samples(0), m_occupancy(0), m_max(0) {}
+
+    /// \brief Adds item, blocking while the queue is full.
+    /// \return false if the queue was closed.
+    bool Push(const T &item)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_items.size() >= m_capacity && !m_closed)
+            m_notFull.wait(&m_lock);
+        if (m_closed)
+            return false;
+        m_items.enqueue(item);
+        m_samples++;
+        m_occupancy += m_items.size();
+        m_max = std::max(m_max, m_items.size());
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    /// \brief Removes the oldest item, blocking while the queue is empty.
+    /// \return false once the queue is closed and empty.
+    bool Pop(T &item)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_items.isEmpty() && !m_closed)
+            m_notEmpty.wait(&m_lock);
+        if (m_items.isEmpty())
+            return false;
+        item = m_items.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    /// \brief Removes the oldest item if accept(item) is true, never blocks.
+    template <typename Pred>
+    bool PopIf(T &item, Pred accept)
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_items.isEmpty() || !accept(m_items.head()))
+            return false;
+        item = m_items.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    /// \brief Wakes all waiters, Pop() returns the remaining items first.
+    void Close(void)
+    {
+        QMutexLocker locker(&m_lock);
+        m_closed = true;
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+    QString GetStats(void) const
+    {
+        QMutexLocker locker(&m_lock);
+        return QString("%1 queue: average %2, max %3 of %4")
+            .arg(m_name)
+            .arg(m_samples ? (double) m_occupancy / m_samples : 0.0, 0, 'f', 1)
+            .arg(m_max).arg(m_capacity);
+    }
+
+  private:
+    QString        m_name;
+    int            m_capacity;
+    mutable QMutex m_lock;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QQueue<T>      m_items;
+    bool           m_closed;
+    uint64_t       m_samples;
+    uint64_t       m_occupancy;
+    int            m_max;
+};
+
+/// Time a pipeline stage spent working and waiting
+class PipelineStageStats
+{
+  public:
+    PipelineStageStats() : frames(0), busy(0), waiting(0) {}
+    QString toString(const QString &name) const;
+
+    uint64_t frames;
+    int64_t  busy;      ///< usecs
+    int64_t  waiting;   ///< usecs
+};
+
+class PipelineThread : public MThread
+{
+  public:
+    typedef void (TranscodePipeline::*Loop)(void);
+    PipelineThread(const QString &name, TranscodePipeline *parent, Loop loop) :
+        MThread(name), m_parent(parent), m_loop(loop) {}
+    virtual ~PipelineThread() { wait(); }
+    virtual void run(void);
+  private:
+    TranscodePipeline *m_parent;
+    Loop               m_loop;
+};
+
+/** \class TranscodePipeline
+ *  \brief Runs the scaling and the encoding of a re-encoding transcode on
+ *         their own threads, so decoding, scaling and encoding overlap.
+ *
+ *  The decoder (MythPlayer) runs on the caller's thread and hands every
+ *  decoded frame to PushVideo(), which copies it into one of a fixed
+ *  number of frames. The scale stage resizes frames to the output size,
+ *  the encode stage hands them to the NuppelVideoRecorder, which encodes
+ *  and writes them. Audio, captions and aspect changes take their own
+ *  queue and are written by the encode stage just before the video frame
+ *  they preceded, so the output is interleaved exactly like a serial
+ *  transcode.
+ */
+class TranscodePipeline
+{
+    friend class PipelineThread;
+  public:
+    TranscodePipeline(NuppelVideoRecorder *nvr, int outWidth, int outHeight,
+                      bool forceKeyFrames, int depth = 8);
+    ~TranscodePipeline();
+
+    void Start(void);
+    bool PushVideo(const unsigned char *buf, int width, int height,
+                   long long timecode);
+    void PushAudio(const unsigned char *buf, int len, int audioframe,
+                   long long timecode);
+    void PushText(const unsigned char *buf, int len, int timecode,
+                  int pagenr);
+    void PushAspect(float aspect);
+    bool Finish(void);
+    void Abort(void);
+    bool IsErrored(void) const;
+    void LogStats(void) const;
+
+  private:
+    void ScaleLoop(void);
+    void EncodeLoop(void);
+    bool WritePackets(uint64_t seq);
+
+    NuppelVideoRecorder *m_nvr;
+    int                  m_outWidth;
+    int                  m_outHeight;
+    bool                 m_forceKeyFrames;
+    bool                 m_started;
+    volatile bool        m_errored;
+    uint64_t             m_seq;
+    int64_t              m_lastPush;
+    SwsContext          *m_scontext;
+
+    QList<PipelineFrame*>          m_frames;
+    PipelineQueue<PipelineFrame*>  m_freeQueue;
+    PipelineQueue<PipelineFrame*>  m_scaleQueue;
+    PipelineQueue<PipelineFrame*>  m_encodeQueue;
+    PipelineQueue<PipelinePacket>  m_packetQueue;
+
+    PipelineStageStats   m_decodeStats;
+    PipelineStageStats   m_scaleStats;
+    PipelineStageStats   m_encodeStats;
+    uint64_t             m_audioPackets;
+
+    PipelineThread      *m_scaleThread;
+    PipelineThread      *m_encodeThread;
+};
+
+#endif // TRANSCODEPIPELINE_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */